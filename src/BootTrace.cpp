@@ -0,0 +1,145 @@
+#include "BootTrace.h"
+#include "MeshService.h"
+#include "RTC.h"
+#include "configuration.h"
+#include "main.h"
+#if ARCH_PORTDUINO
+#include "PortduinoGlue.h"
+#include <fstream>
+#endif
+
+BootTrace bootTrace;
+
+int BootTrace::add(const char *name, uint8_t depth, uint32_t startUs)
+{
+    if (numEvents >= BOOT_TRACE_MAX_EVENTS)
+        return -1;
+    events[numEvents] = {name, startUs, 0, depth};
+    return numEvents++;
+}
+
+void BootTrace::close(int &open, uint32_t now)
+{
+    if (open >= 0)
+        events[open].durationUs = now - events[open].startUs;
+    open = -1;
+}
+
+void BootTrace::phase(const char *name)
+{
+    if (finished)
+        return;
+    uint32_t now = micros();
+    close(openModule, now);
+    close(openPhase, now);
+    openPhase = add(name, 0, now);
+}
+
+void BootTrace::module(const char *name)
+{
+    // Modules created once we are up and running aren't part of boot
+    if (finished || openPhase < 0)
+        return;
+    uint32_t now = micros();
+    close(openModule, now);
+    openModule = add(name, 1, now);
+}
+
+void BootTrace::span(const char *name, uint32_t startUs)
+{
+    int i = add(name, 0, startUs);
+    if (i >= 0)
+        events[i].durationUs = micros() - startUs;
+}
+
+uint32_t BootTrace::getBootUs() const
+{
+    return numEvents && finished ? finishedUs - events[0].startUs : 0;
+}
+
+size_t BootTrace::formatSlowest(char *buf, size_t len, size_t max) const
+{
+    size_t used = 0;
+    buf[0] = '\0';
+    uint32_t below = UINT32_MAX; // Walk the phases from slowest down, one duration at a time
+    for (size_t n = 0; n < max; n++) {
+        const Event *slowest = nullptr;
+        for (size_t i = 0; i < numEvents; i++) {
+            const Event &e = events[i];
+            if (e.depth == 0 && e.durationUs < below && (!slowest || e.durationUs > slowest->durationUs))
+                slowest = &e;
+        }
+        if (!slowest || used >= len)
+            break;
+        int w = snprintf(buf + used, len - used, "%s%s %ums", n ? ", " : "", slowest->name, slowest->durationUs / 1000);
+        if (w < 0)
+            break;
+        used += w;
+        below = slowest->durationUs;
+    }
+    return used < len ? used : len - 1;
+}
+
+std::string BootTrace::toChromeTrace() const
+{
+    std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    char line[160];
+    for (size_t i = 0; i < numEvents; i++) {
+        const Event &e = events[i];
+        std::string name;
+        for (const char *c = e.name; *c; c++) {
+            if (*c == '"' || *c == '\\')
+                name += '\\';
+            name += *c;
+        }
+        snprintf(line, sizeof(line), "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%u,\"dur\":%u,\"pid\":1,\"tid\":1}",
+                 i ? "," : "", name.c_str(), e.depth ? "module" : "boot", e.startUs, e.durationUs);
+        out += line;
+    }
+    out += "]}";
+    return out;
+}
+
+void BootTrace::finish()
+{
+    if (finished)
+        return;
+    uint32_t now = micros();
+    close(openModule, now);
+    close(openPhase, now);
+    finished = true;
+    finishedUs = now;
+
+    const char *phaseName = "";
+    for (size_t i = 0; i < numEvents; i++) {
+        const Event &e = events[i];
+        // Modules are many and mostly instant, only mention the ones worth looking at
+        if (e.depth == 0) {
+            phaseName = e.name;
+            LOG_INFO("Boot phase %s took %u ms", e.name, e.durationUs / 1000);
+        } else if (e.durationUs >= 10 * 1000) {
+            LOG_INFO("Boot phase %s: module %s took %u ms", phaseName, e.name, e.durationUs / 1000);
+        }
+    }
+
+    char slowest[128];
+    formatSlowest(slowest, sizeof(slowest), 3);
+    LOG_INFO("Boot took %u ms, slowest: %s", getBootUs() / 1000, slowest);
+
+    if (service) {
+        meshtastic_ClientNotification *cn = clientNotificationPool.allocZeroed();
+        cn->level = meshtastic_LogRecord_Level_DEBUG;
+        cn->time = getValidTime(RTCQualityFromNet);
+        snprintf(cn->message, sizeof(cn->message), "Boot took %u ms, slowest: %s", getBootUs() / 1000, slowest);
+        service->sendClientNotification(cn);
+    }
+
+#if ARCH_PORTDUINO
+    if (settingsStrings[bootTraceFilename] != "") {
+        std::ofstream file(settingsStrings[bootTraceFilename]);
+        file << toChromeTrace();
+        if (!file)
+            LOG_WARN("Can't write boot trace to %s", settingsStrings[bootTraceFilename].c_str());
+    }
+#endif
+}
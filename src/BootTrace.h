@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+/// Spans kept, enough for every phase of setup() and every module constructor
+#ifndef BOOT_TRACE_MAX_EVENTS
+#define BOOT_TRACE_MAX_EVENTS 96
+#endif
+
+/**
+ * Records where boot time goes: the phases of setup(), the constructor of every module and slow work that continues after
+ * setup() such as the GPS probe.
+ *
+ * Phases are sequential, starting one ends the last. Modules are recorded as they register in MeshModule's constructor, each
+ * one lasting until the next registers, so a module's span also covers whatever setupModules() does right after creating it.
+ */
+class BootTrace
+{
+  public:
+    struct Event {
+        const char *name; // Must outlive the trace, string literals and module names do
+        uint32_t startUs;
+        uint32_t durationUs;
+        uint8_t depth; // 0 for phases and spans, 1 for modules
+    };
+
+    /// Start a phase of setup(), ending the previous one
+    void phase(const char *name);
+
+    /// Start a module constructor inside the current phase, ending the previous module
+    void module(const char *name);
+
+    /// Record work that started at `startUs` (micros()) and ends now
+    void span(const char *name, uint32_t startUs);
+
+    /// End the last phase, log where the time went and tell the client
+    void finish();
+
+    bool isFinished() const { return finished; }
+
+    size_t getNumEvents() const { return numEvents; }
+
+    const Event &getEvent(size_t i) const { return events[i]; }
+
+    /// Microseconds from the first phase to finish()
+    uint32_t getBootUs() const;
+
+    /// Everything recorded, in the Chrome trace event format (chrome://tracing, Perfetto)
+    std::string toChromeTrace() const;
+
+    /// Names and durations of the slowest phases, for a one line summary
+    size_t formatSlowest(char *buf, size_t len, size_t max) const;
+
+  private:
+    Event events[BOOT_TRACE_MAX_EVENTS];
+    size_t numEvents = 0;
+    int openPhase = -1;
+    int openModule = -1;
+    bool finished = false;
+    uint32_t finishedUs = 0;
+
+    int add(const char *name, uint8_t depth, uint32_t startUs);
+
+    void close(int &open, uint32_t now);
+};
+
+extern BootTrace bootTrace;
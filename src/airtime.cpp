@@ -2,6 +2,12 @@
 #include "NodeDB.h"
 #include "configuration.h"
 
+#ifdef ARCH_PORTDUINO
+#define TOP_TALKERS_GUARD() std::lock_guard<std::mutex> guard(topTalkersMutex)
+#else
+#define TOP_TALKERS_GUARD()
+#endif
+
 AirTime *airTime = NULL;
 
 // Don't read out of this directly. Use the helper functions.
@@ -29,6 +35,32 @@ void AirTime::logAirtime(reportTypes reportType, uint32_t airtime_ms)
 
     // Log all airtime type for channel utilization
     this->channelUtilization[this->getPeriodUtilMinute()] = channelUtilization[this->getPeriodUtilMinute()] + airtime_ms;
+    this->recentUtilization.add(airtime_ms);
+}
+
+void AirTime::logAirtime(reportTypes reportType, uint32_t airtime_ms, NodeNum from)
+{
+    logAirtime(reportType, airtime_ms);
+    TOP_TALKERS_GUARD();
+    topSenders.add(from, airtime_ms);
+}
+
+void AirTime::logPacketAirtime(NodeNum from, PacketId id, uint32_t airtime_ms)
+{
+    TOP_TALKERS_GUARD();
+    packetPorts.logAirtime(from, id, airtime_ms);
+}
+
+void AirTime::setPacketPort(NodeNum from, PacketId id, meshtastic_PortNum port)
+{
+    TOP_TALKERS_GUARD();
+    packetPorts.setPort(from, id, port);
+}
+
+std::string AirTime::topTalkersToJson() const
+{
+    TOP_TALKERS_GUARD();
+    return "{\"senders\":" + topSenders.toJson("node") + ",\"ports\":" + topPorts.toJson("port") + "}";
 }
 
 uint8_t AirTime::currentPeriodIndex()
@@ -162,6 +194,13 @@ AirTime::AirTime() : concurrency::OSThread("AirTime"), airtimes({}) {}
 int32_t AirTime::runOnce()
 {
     secSinceBoot++;
+    recentUtilization.tick();
+
+    if (secSinceBoot % AIRTIME_TOPK_HALF_LIFE_SECS == 0) {
+        TOP_TALKERS_GUARD();
+        topSenders.decay();
+        topPorts.decay();
+    }
 
     uint8_t utilPeriod = this->getPeriodUtilMinute();
     uint8_t utilPeriodTX = this->getPeriodUtilHour();
@@ -3,8 +3,14 @@
 #include "MeshRadio.h"
 #include "concurrency/OSThread.h"
 #include "configuration.h"
+#include "mesh/AirtimeTopK.h"
+#include "mesh/ChannelUtilWindow.h"
 #include <Arduino.h>
 #include <functional>
+#include <string>
+#ifdef ARCH_PORTDUINO
+#include <mutex>
+#endif
 
 /*
   TX_LOG      - Time on air this device has transmitted
@@ -33,6 +39,11 @@
 #define MS_IN_MINUTE (SECONDS_IN_MINUTE * 1000)
 #define MS_IN_HOUR (MINUTES_IN_HOUR * SECONDS_IN_MINUTE * 1000)
 
+// The top senders and ports forget half of what they heard this often, so they show who is busy on the channel now
+#ifndef AIRTIME_TOPK_HALF_LIFE_SECS
+#define AIRTIME_TOPK_HALF_LIFE_SECS 60
+#endif
+
 enum reportTypes { TX_LOG, RX_LOG, RX_ALL_LOG };
 
 void logAirtime(reportTypes reportType, uint32_t airtime_ms);
@@ -46,7 +57,16 @@ class AirTime : private concurrency::OSThread
     AirTime();
 
     void logAirtime(reportTypes reportType, uint32_t airtime_ms);
+    // Also charge the airtime to the node that sent the packet, for relays that's the original sender and not the relayer
+    void logAirtime(reportTypes reportType, uint32_t airtime_ms, NodeNum from);
+    // Charge a copy of a packet the radio sent or heard to the packet's port, once that is known
+    void logPacketAirtime(NodeNum from, PacketId id, uint32_t airtime_ms);
+    // The port of a packet, UNKNOWN_APP if it couldn't be decoded
+    void setPacketPort(NodeNum from, PacketId id, meshtastic_PortNum port);
     float channelUtilizationPercent();
+    // Like channelUtilizationPercent, but over the last CHANNEL_UTIL_WINDOW_SECS so it follows bursts within seconds. Only for
+    // sizing the contention window: on the slow presets one frame of our own fills much of it, so it must not refuse sends.
+    float channelUtilizationRecentPercent() { return recentUtilization.getPercent(); }
     float utilizationTXPercent();
 
     float UtilizationPercentTX();
@@ -62,6 +82,13 @@ class AirTime : private concurrency::OSThread
     bool isTxAllowedChannelUtil(bool polite = false);
     bool isTxAllowedAirUtil();
 
+    // The senders and ports that used the most airtime lately, heaviest first. Only for the main loop, other threads must use
+    // topTalkersToJson()
+    const AirtimeTopK &getTopSenders() const { return topSenders; }
+    const AirtimeTopK &getTopPorts() const { return topPorts; }
+    // {"senders":[{"node":..,...}],"ports":[{"port":..,...}]}, see AirtimeTopK::toJson
+    std::string topTalkersToJson() const;
+
   private:
     bool firstTime = true;
     uint8_t lastUtilPeriod = 0;
@@ -78,6 +105,15 @@ class AirTime : private concurrency::OSThread
         uint8_t lastPeriodIndex;
     } airtimes;
 
+    ChannelUtilWindow recentUtilization;
+    AirtimeTopK topSenders;
+    AirtimeTopK topPorts;
+    AirtimePortTracker packetPorts{topPorts};
+#ifdef ARCH_PORTDUINO
+    // The Linux web server reads the top senders and ports from its own threads
+    mutable std::mutex topTalkersMutex;
+#endif
+
     uint8_t getPeriodUtilMinute();
     uint8_t getPeriodUtilHour();
     uint8_t currentPeriodIndex();
@@ -0,0 +1,132 @@
+#include "I2CScanManifest.h"
+#include "FSCommon.h"
+#include "SPILock.h"
+#include "SafeFile.h"
+#include "configuration.h"
+#include <string.h>
+
+#define I2C_SCAN_MANIFEST_MAGIC 0x49324331 // "I2C1"
+
+#ifdef FSCom
+static const char *i2cScanManifestFileName = "/prefs/i2cscan.dat";
+#endif
+
+uint32_t I2CScanManifest::firmwareHash()
+{
+    // FNV-1a of the version string
+    uint32_t hash = 2166136261u;
+    for (const char *c = optstr(APP_VERSION); *c; c++)
+        hash = (hash ^ (uint8_t)*c) * 16777619u;
+    return hash;
+}
+
+bool I2CScanManifest::load()
+{
+    bool okay = false;
+#ifdef FSCom
+    Contents loaded;
+    spiLock->lock();
+    auto file = FSCom.open(i2cScanManifestFileName, FILE_O_READ);
+    if (file) {
+        okay = (size_t)file.read((uint8_t *)&loaded, sizeof(loaded)) == sizeof(loaded);
+        file.close();
+    }
+    spiLock->unlock();
+
+    if (okay && (loaded.magic != I2C_SCAN_MANIFEST_MAGIC || loaded.count > I2C_SCAN_MANIFEST_MAX_DEVICES)) {
+        LOG_WARN("Ignore invalid I2C scan manifest");
+        okay = false;
+    } else if (okay && loaded.firmwareHash != firmwareHash()) {
+        LOG_INFO("Firmware changed since the last I2C scan, rescan");
+        okay = false;
+    }
+    if (okay) {
+        contents = loaded;
+        LOG_INFO("Loaded I2C scan manifest with %u devices", contents.count);
+    }
+#endif
+    dirty = false;
+    return okay;
+}
+
+bool I2CScanManifest::save()
+{
+    if (!dirty)
+        return true;
+#ifdef FSCom
+    contents.magic = I2C_SCAN_MANIFEST_MAGIC;
+    contents.firmwareHash = firmwareHash();
+    auto file = SafeFile(i2cScanManifestFileName);
+    file.write((const uint8_t *)&contents, sizeof(contents));
+    if (!file.close()) {
+        LOG_WARN("Can't write I2C scan manifest");
+        return false;
+    }
+    LOG_INFO("Saved I2C scan manifest with %u devices", contents.count);
+#endif
+    dirty = false;
+    return true;
+}
+
+bool I2CScanManifest::hasPort(ScanI2C::I2CPort port) const
+{
+    for (uint8_t i = 0; i < contents.count; i++) {
+        if (contents.entries[i].port == port)
+            return true;
+    }
+    return false;
+}
+
+uint8_t I2CScanManifest::getAddresses(ScanI2C::I2CPort port, uint8_t *out, uint8_t max) const
+{
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < contents.count && n < max; i++) {
+        if (contents.entries[i].port == port)
+            out[n++] = contents.entries[i].address;
+    }
+    return n;
+}
+
+bool I2CScanManifest::matches(ScanI2C::I2CPort port, const ScanI2C::FoundDevice *found, size_t count) const
+{
+    size_t known = 0;
+    for (uint8_t i = 0; i < contents.count; i++) {
+        const Entry &e = contents.entries[i];
+        if (e.port != port)
+            continue;
+        known++;
+        bool present = false;
+        for (size_t j = 0; j < count && !present; j++)
+            present = found[j].address.address == e.address && found[j].type == e.type;
+        if (!present)
+            return false;
+    }
+    return known == count;
+}
+
+void I2CScanManifest::setPort(ScanI2C::I2CPort port, const ScanI2C::FoundDevice *found, size_t count)
+{
+    if (hasPort(port) && matches(port, found, count))
+        return;
+
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < contents.count; i++) {
+        if (contents.entries[i].port != port)
+            contents.entries[kept++] = contents.entries[i];
+    }
+    bool fits = kept + count <= I2C_SCAN_MANIFEST_MAX_DEVICES;
+    for (size_t j = 0; fits && j < count; j++)
+        contents.entries[kept++] = {(uint8_t)port, found[j].address.address, (uint8_t)found[j].type};
+    dirty = dirty || kept != contents.count || (fits && count > 0);
+    contents.count = kept;
+}
+
+void I2CScanManifest::record(const ScanI2C &scanner)
+{
+    static const ScanI2C::I2CPort ports[] = {ScanI2C::I2CPort::WIRE, ScanI2C::I2CPort::WIRE1};
+    ScanI2C::FoundDevice found[I2C_SCAN_MANIFEST_MAX_DEVICES + 1];
+    for (ScanI2C::I2CPort port : ports) {
+        size_t count = scanner.getDevices(port, found, I2C_SCAN_MANIFEST_MAX_DEVICES + 1);
+        setPort(port, found, count);
+    }
+}
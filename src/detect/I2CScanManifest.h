@@ -0,0 +1,68 @@
+#pragma once
+
+#include "ScanI2C.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/// Remember what the I2C scan found and only verify those devices on the next boot, see I2CScanManifest
+#ifndef I2C_SCAN_CACHE
+#define I2C_SCAN_CACHE 0
+#endif
+
+/// Most devices a manifest remembers per boot, a port with more is always scanned in full
+#ifndef I2C_SCAN_MANIFEST_MAX_DEVICES
+#define I2C_SCAN_MANIFEST_MAX_DEVICES 24
+#endif
+
+/**
+ * The I2C devices a previous boot found, so that the next one can probe just those addresses instead of all 112 on every port.
+ *
+ * Only ports that had devices on them are remembered: a port that was empty, or that has a device missing or changed since,
+ * gets a full scan. A device added at a new address on a port that already had others is not noticed until the manifest is
+ * cleared, which a factory reset does along with the rest of /prefs. The manifest is also ignored after a firmware update, as
+ * detection may have changed.
+ */
+class I2CScanManifest
+{
+  public:
+    /// Read the manifest a previous boot saved, false if there is none or it is not usable
+    bool load();
+
+    /// Write the manifest if record() changed it
+    bool save();
+
+    /// Whether devices on `port` are known, so that only their addresses need probing
+    bool hasPort(ScanI2C::I2CPort port) const;
+
+    /// The addresses known on `port`, returns how many were copied to `out`
+    uint8_t getAddresses(ScanI2C::I2CPort port, uint8_t *out, uint8_t max) const;
+
+    /// Whether `found` is exactly the set of devices known on `port`
+    bool matches(ScanI2C::I2CPort port, const ScanI2C::FoundDevice *found, size_t count) const;
+
+    /// Remember what `scanner` found on every port
+    void record(const ScanI2C &scanner);
+
+    bool isDirty() const { return dirty; }
+
+  private:
+    struct Entry {
+        uint8_t port;
+        uint8_t address;
+        uint8_t type;
+    };
+
+    struct Contents {
+        uint32_t magic;
+        uint32_t firmwareHash;
+        uint8_t count;
+        Entry entries[I2C_SCAN_MANIFEST_MAX_DEVICES];
+    };
+
+    Contents contents = {};
+    bool dirty = false;
+
+    void setPort(ScanI2C::I2CPort port, const ScanI2C::FoundDevice *found, size_t count);
+
+    static uint32_t firmwareHash();
+};
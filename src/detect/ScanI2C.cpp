@@ -1,4 +1,6 @@
 #include "ScanI2C.h"
+#include "I2CScanManifest.h"
+#include "configuration.h"
 
 const ScanI2C::DeviceAddress ScanI2C::ADDRESS_NONE = ScanI2C::DeviceAddress();
 const ScanI2C::FoundDevice ScanI2C::DEVICE_NONE = ScanI2C::FoundDevice(ScanI2C::DeviceType::NONE, ADDRESS_NONE);
@@ -8,6 +10,23 @@ ScanI2C::ScanI2C() = default;
 void ScanI2C::scanPort(ScanI2C::I2CPort port) {}
 void ScanI2C::scanPort(ScanI2C::I2CPort port, uint8_t *address, uint8_t asize) {}
 
+void ScanI2C::scanPortCached(ScanI2C::I2CPort port, const I2CScanManifest &manifest)
+{
+    if (manifest.hasPort(port)) {
+        uint8_t addresses[I2C_SCAN_MANIFEST_MAX_DEVICES];
+        uint8_t count = manifest.getAddresses(port, addresses, I2C_SCAN_MANIFEST_MAX_DEVICES);
+        LOG_INFO("Verify %u known I2C devices on port %d", count, port);
+        scanPort(port, addresses, count);
+
+        FoundDevice found[I2C_SCAN_MANIFEST_MAX_DEVICES];
+        if (manifest.matches(port, found, getDevices(port, found, I2C_SCAN_MANIFEST_MAX_DEVICES)))
+            return;
+        LOG_INFO("I2C devices on port %d changed since the last scan, rescan", port);
+        forgetPort(port);
+    }
+    scanPort(port);
+}
+
 void ScanI2C::setSuppressScreen()
 {
     shouldSuppressScreen = true;
@@ -73,6 +92,13 @@ size_t ScanI2C::countDevices() const
     return 0;
 }
 
+size_t ScanI2C::getDevices(ScanI2C::I2CPort port, ScanI2C::FoundDevice *out, size_t max) const
+{
+    return 0;
+}
+
+void ScanI2C::forgetPort(ScanI2C::I2CPort port) {}
+
 ScanI2C::DeviceAddress::DeviceAddress(ScanI2C::I2CPort port, uint8_t address) : port(port), address(address) {}
 
 ScanI2C::DeviceAddress::DeviceAddress() : DeviceAddress(I2CPort::NO_I2C, 0) {}
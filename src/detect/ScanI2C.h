@@ -3,6 +3,8 @@
 #include <stddef.h>
 #include <stdint.h>
 
+class I2CScanManifest;
+
 class ScanI2C
 {
   public:
@@ -119,6 +121,12 @@ class ScanI2C
     virtual void scanPort(ScanI2C::I2CPort);
     virtual void scanPort(ScanI2C::I2CPort, uint8_t *, uint8_t);
 
+    /*
+     * Scan a port, probing only the addresses the manifest knows there if it knows the port. Falls back to a full scan if the
+     * devices found are not the ones it remembers.
+     */
+    void scanPortCached(ScanI2C::I2CPort, const I2CScanManifest &);
+
     /*
      * A bit of a hack, this tells the scanner not to tell later systems there is a screen to avoid enabling it.
      */
@@ -142,9 +150,15 @@ class ScanI2C
 
     virtual size_t countDevices() const;
 
+    // Copies the devices found on a port to the given array, returns how many there are
+    virtual size_t getDevices(ScanI2C::I2CPort, FoundDevice *, size_t) const;
+
   protected:
     virtual FoundDevice firstOfOrNONE(size_t, DeviceType[]) const;
 
+    // Forget what was found on a port, before scanning it again
+    virtual void forgetPort(ScanI2C::I2CPort);
+
   private:
     bool shouldSuppressScreen = false;
 };
@@ -9,6 +9,10 @@
 #if !defined(ARCH_PORTDUINO) && !defined(ARCH_STM32WL)
 #include "meshUtils.h" // vformat
 #endif
+#if I2C_PARALLEL_SCAN
+#include <esp_pthread.h>
+#include <thread>
+#endif
 
 bool in_array(uint8_t *array, int size, uint8_t lookfor)
 {
@@ -117,8 +121,6 @@ uint16_t ScanI2CTwoWire::getRegisterValue(const ScanI2CTwoWire::RegisterLocation
 
 void ScanI2CTwoWire::scanPort(I2CPort port, uint8_t *address, uint8_t asize)
 {
-    concurrency::LockGuard guard((concurrency::Lock *)&lock);
-
     LOG_DEBUG("Scan for I2C devices on port %d", port);
 
     uint8_t err;
@@ -548,6 +550,8 @@ void ScanI2CTwoWire::scanPort(I2CPort port, uint8_t *address, uint8_t asize)
 
         // Check if a type was found for the enumerated device - save, if so
         if (type != NONE) {
+            // Only the results are shared, so that the two ports can be scanned at the same time
+            concurrency::LockGuard guard((concurrency::Lock *)&lock);
             deviceAddresses[type] = addr;
             foundDevices[addr] = type;
         }
@@ -559,6 +563,25 @@ void ScanI2CTwoWire::scanPort(I2CPort port)
     scanPort(port, nullptr, 0);
 }
 
+#if I2C_PARALLEL_SCAN
+void ScanI2CTwoWire::scanBothPortsCached(const I2CScanManifest &manifest)
+{
+    // The scan logs and may initialise an RTC, more than the default pthread stack allows for. The config applies to every
+    // later thread this task starts, so put back whatever was there before.
+    esp_pthread_cfg_t previous;
+    if (esp_pthread_get_cfg(&previous) != ESP_OK)
+        previous = esp_pthread_get_default_config();
+    esp_pthread_cfg_t cfg = previous;
+    cfg.stack_size = 8192;
+    esp_pthread_set_cfg(&cfg);
+
+    std::thread wire1([this, &manifest]() { scanPortCached(I2CPort::WIRE1, manifest); });
+    esp_pthread_set_cfg(&previous);
+    scanPortCached(I2CPort::WIRE, manifest);
+    wire1.join();
+}
+#endif
+
 TwoWire *ScanI2CTwoWire::fetchI2CBus(ScanI2C::DeviceAddress address) const
 {
     if (address.port == ScanI2C::I2CPort::WIRE) {
@@ -577,6 +600,35 @@ size_t ScanI2CTwoWire::countDevices() const
     return foundDevices.size();
 }
 
+size_t ScanI2CTwoWire::getDevices(ScanI2C::I2CPort port, ScanI2C::FoundDevice *out, size_t max) const
+{
+    concurrency::LockGuard guard((concurrency::Lock *)&lock);
+
+    size_t n = 0;
+    for (const auto &found : foundDevices) {
+        if (found.first.port == port && n < max)
+            out[n++] = ScanI2C::FoundDevice(found.second, found.first);
+    }
+    return n;
+}
+
+void ScanI2CTwoWire::forgetPort(ScanI2C::I2CPort port)
+{
+    concurrency::LockGuard guard((concurrency::Lock *)&lock);
+
+    for (auto it = foundDevices.begin(); it != foundDevices.end();) {
+        if (it->first.port == port) {
+            // Only forget the type's address if it still points at this port
+            auto type = deviceAddresses.find(it->second);
+            if (type != deviceAddresses.end() && type->second.port == port)
+                deviceAddresses.erase(type);
+            it = foundDevices.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
 void ScanI2CTwoWire::logFoundDevice(const char *device, uint8_t address)
 {
     LOG_INFO("%s found at address 0x%x", device, address);
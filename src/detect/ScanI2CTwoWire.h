@@ -10,10 +10,17 @@
 
 #include <Wire.h>
 
+#include "I2CScanManifest.h"
 #include "ScanI2C.h"
 
 #include "../concurrency/Lock.h"
 
+// Scan both ports at once on platforms with two independent I2C controllers
+#if !defined(I2C_PARALLEL_SCAN) || !defined(ARCH_ESP32) || WIRE_INTERFACES_COUNT != 2
+#undef I2C_PARALLEL_SCAN
+#define I2C_PARALLEL_SCAN 0
+#endif
+
 class ScanI2CTwoWire : public ScanI2C
 {
   public:
@@ -29,9 +36,18 @@ class ScanI2CTwoWire : public ScanI2C
 
     size_t countDevices() const override;
 
+    size_t getDevices(ScanI2C::I2CPort, FoundDevice *, size_t) const override;
+
+#if I2C_PARALLEL_SCAN
+    // Scan WIRE1 on a second task while this one scans WIRE
+    void scanBothPortsCached(const I2CScanManifest &);
+#endif
+
   protected:
     FoundDevice firstOfOrNONE(size_t, DeviceType[]) const override;
 
+    void forgetPort(ScanI2C::I2CPort) override;
+
   private:
     typedef struct RegisterLocation {
         DeviceAddress i2cAddress;
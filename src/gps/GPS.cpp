@@ -4,8 +4,10 @@
 
 #include "configuration.h"
 #if !MESHTASTIC_EXCLUDE_GPS
+#include "BootTrace.h"
 #include "Default.h"
 #include "GPS.h"
+#include "GPSProbeCache.h"
 #include "GpioLogic.h"
 #include "NodeDB.h"
 #include "PowerMon.h"
@@ -55,6 +57,8 @@ GPS *gps = nullptr;
 
 static GPSUpdateScheduling scheduling;
 
+static GPSProbeCache probeCache;
+
 /// Multiple GPS instances might use the same serial port (in sequence), but we can
 /// only init that port once.
 static bool didSerialInit;
@@ -506,9 +510,17 @@ bool GPS::setup()
             digitalWrite(PIN_GPS_EN, HIGH);
             delay(1000);
 #endif
-            if (probeTries < GPS_PROBETRIES) {
+            if (!probeCacheChecked) {
+                probeCacheChecked = true;
+                uint32_t probeStartUs = micros();
+                gnssModel = verifyCachedModel();
+                bootTrace.span("gps verify", probeStartUs);
+            }
+            if (gnssModel == GNSS_MODEL_UNKNOWN && probeTries < GPS_PROBETRIES) {
                 LOG_DEBUG("Probe for GPS at %d", serialSpeeds[speedSelect]);
+                uint32_t probeStartUs = micros();
                 gnssModel = probe(serialSpeeds[speedSelect]);
+                bootTrace.span("gps probe", probeStartUs);
                 if (gnssModel == GNSS_MODEL_UNKNOWN) {
                     if (++speedSelect == array_count(serialSpeeds)) {
                         speedSelect = 0;
@@ -517,9 +529,11 @@ bool GPS::setup()
                 }
             }
             // Rare Serial Speeds
-            if (probeTries == GPS_PROBETRIES) {
+            if (gnssModel == GNSS_MODEL_UNKNOWN && probeTries == GPS_PROBETRIES) {
                 LOG_DEBUG("Probe for GPS at %d", rareSerialSpeeds[speedSelect]);
+                uint32_t probeStartUs = micros();
                 gnssModel = probe(rareSerialSpeeds[speedSelect]);
+                bootTrace.span("gps probe", probeStartUs);
                 if (gnssModel == GNSS_MODEL_UNKNOWN) {
                     if (++speedSelect == array_count(rareSerialSpeeds)) {
                         LOG_WARN("Give up on GPS probe and set to %d", GPS_BAUDRATE);
@@ -531,6 +545,7 @@ bool GPS::setup()
 
         if (gnssModel != GNSS_MODEL_UNKNOWN) {
             setConnected();
+            probeCache.save(gnssModel, probeSpeed, ublox_info.protocol_version);
         } else {
             return false;
         }
@@ -1204,8 +1219,9 @@ static const char *DETECTED_MESSAGE = "%s detected";
         }                                                                                                                        \
     } while (0)
 
-GnssModel_t GPS::probe(int serialSpeed)
+void GPS::setSerialSpeed(int serialSpeed)
 {
+    probeSpeed = serialSpeed;
 #if defined(ARCH_NRF52) || defined(ARCH_PORTDUINO) || defined(ARCH_STM32WL)
     _serial_gps->end();
     _serial_gps->begin(serialSpeed);
@@ -1219,6 +1235,31 @@ GnssModel_t GPS::probe(int serialSpeed)
         _serial_gps->updateBaudRate(serialSpeed);
     }
 #endif
+}
+
+GnssModel_t GPS::verifyCachedModel()
+{
+    if (!probeCache.load())
+        return GNSS_MODEL_UNKNOWN;
+
+    GnssModel_t model = probeCache.getModel();
+    LOG_DEBUG("Verify GPS model %d at %u baud", model, probeCache.getBaud());
+    setSerialSpeed(probeCache.getBaud());
+    delay(100);
+    clearBuffer();
+    if (!GPSProbeCache::verify(*_serial_gps, model)) {
+        LOG_INFO("GPS model %d not found at %u baud, probe for it", model, probeCache.getBaud());
+        return GNSS_MODEL_UNKNOWN;
+    }
+    memset(&ublox_info, 0, sizeof(ublox_info));
+    ublox_info.protocol_version = probeCache.getUbloxProtocolVersion();
+    LOG_INFO("GPS model %d verified at %u baud", model, probeCache.getBaud());
+    return model;
+}
+
+GnssModel_t GPS::probe(int serialSpeed)
+{
+    setSerialSpeed(serialSpeed);
 
     memset(&ublox_info, 0, sizeof(ublox_info));
     uint8_t buffer[768] = {0};
@@ -1588,10 +1629,10 @@ bool GPS::lookForLocation()
     fixQual = reader.fixQuality();
 
 #ifndef TINYGPS_OPTION_NO_STATISTICS
-    if (reader.failedChecksum() > lastChecksumFailCount) {
-        LOG_WARN("%u new GPS checksum failures, for a total of %u", reader.failedChecksum() - lastChecksumFailCount,
-                 reader.failedChecksum());
-        lastChecksumFailCount = reader.failedChecksum();
+    if (framer.getFailedChecksums() > lastChecksumFailCount) {
+        LOG_WARN("%u new GPS checksum failures, for a total of %u", framer.getFailedChecksums() - lastChecksumFailCount,
+                 framer.getFailedChecksums());
+        lastChecksumFailCount = framer.getFailedChecksums();
     }
 #endif
 
@@ -1730,11 +1771,7 @@ bool GPS::hasFlow()
 
 bool GPS::whileActive()
 {
-    unsigned int charsInBuf = 0;
     bool isValid = false;
-#ifdef GPS_DEBUG
-    std::string debugmsg = "";
-#endif
     if (powerState != GPS_ACTIVE) {
         clearBuffer();
         return false;
@@ -1745,28 +1782,36 @@ bool GPS::whileActive()
         clearBuffer();
     }
 #endif
-    // First consume any chars that have piled up at the receiver
-    while (_serial_gps->available() > 0) {
-        int c = _serial_gps->read();
-        UBXscratch[charsInBuf] = c;
+    // First consume any chars that have piled up at the receiver, a block at a time. Only the sentences lookForTime() and
+    // lookForLocation() read are parsed, the rest (GSV, VTG, GLL...) are dropped whole once framed
+    uint8_t block[64];
+    int waiting;
+    while ((waiting = _serial_gps->available()) > 0) {
+        size_t len = _serial_gps->readBytes(block, (size_t)waiting < sizeof(block) ? waiting : sizeof(block));
+        if (!len)
+            break;
 #ifdef GPS_DEBUG
-        debugmsg += vformat("%c", (c >= 32 && c <= 126) ? c : '.');
+        std::string debugmsg = "";
+        for (size_t i = 0; i < len; i++)
+            debugmsg += vformat("%c", (block[i] >= 32 && block[i] <= 126) ? block[i] : '.');
+        LOG_DEBUG(debugmsg.c_str());
 #endif
-        isValid |= reader.encode(c);
-        if (charsInBuf > sizeof(UBXscratch) - 10 || c == '\r') {
-            if (strnstr((char *)UBXscratch, "$GPTXT,01,01,02,u-blox ag - www.u-blox.com*50", charsInBuf)) {
-                rebootsSeen++;
+        framer.feed(block, len, [&](const char *sentence, size_t sentenceLen) {
+            if (NMEAFramer::isType(sentence, sentenceLen, "TXT")) {
+                static const char ubloxBoot[] = "$GPTXT,01,01,02,u-blox ag - www.u-blox.com*50";
+                if (sentenceLen == sizeof(ubloxBoot) - 1 && memcmp(sentence, ubloxBoot, sentenceLen) == 0)
+                    rebootsSeen++;
+                return;
             }
-            charsInBuf = 0;
-        } else {
-            charsInBuf++;
-        }
-    }
-#ifdef GPS_DEBUG
-    if (debugmsg != "") {
-        LOG_DEBUG(debugmsg.c_str());
+            if (!NMEAFramer::isType(sentence, sentenceLen, "GGA") && !NMEAFramer::isType(sentence, sentenceLen, "RMC") &&
+                !NMEAFramer::isType(sentence, sentenceLen, "GSA"))
+                return;
+            for (size_t i = 0; i < sentenceLen; i++)
+                isValid |= reader.encode(sentence[i]);
+            isValid |= reader.encode('\r');
+            isValid |= reader.encode('\n');
+        });
     }
-#endif
     return isValid;
 }
 void GPS::enable()
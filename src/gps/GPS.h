@@ -4,6 +4,7 @@
 
 #include "GPSStatus.h"
 #include "GpioLogic.h"
+#include "NMEAFramer.h"
 #include "Observer.h"
 #include "TinyGPS++.h"
 #include "concurrency/OSThread.h"
@@ -147,6 +148,7 @@ class GPS : private concurrency::OSThread
 
     GnssModel_t gnssModel = GNSS_MODEL_UNKNOWN;
 
+    NMEAFramer framer; // Hands reader only the sentences it uses, already checksummed
     TinyGPSPlus reader;
     uint8_t fixQual = 0; // fix quality from GPGGA
     uint32_t lastChecksumFailCount = 0;
@@ -165,6 +167,8 @@ class GPS : private concurrency::OSThread
 
     uint8_t speedSelect = 0;
     uint8_t probeTries = 0;
+    int probeSpeed = 0; // Baud rate of the last probe
+    bool probeCacheChecked = false;
 
     /**
      * hasValidLocation - indicates that the position variables contain a complete
@@ -241,6 +245,11 @@ class GPS : private concurrency::OSThread
     // Get GNSS model
     GnssModel_t probe(int serialSpeed);
 
+    // Check for the chip a previous boot found with a single probe, GNSS_MODEL_UNKNOWN if it doesn't answer
+    GnssModel_t verifyCachedModel();
+
+    void setSerialSpeed(int serialSpeed);
+
     // delay counter to allow more sats before fixed position stops GPS thread
     uint8_t fixeddelayCtr = 0;
 };
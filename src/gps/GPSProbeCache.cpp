@@ -0,0 +1,131 @@
+#include "GPSProbeCache.h"
+#if !MESHTASTIC_EXCLUDE_GPS
+#include "FSCommon.h"
+#include "SPILock.h"
+#include "SafeFile.h"
+#include "Throttle.h"
+#include <string.h>
+
+#define GPS_PROBE_CACHE_MAGIC 0x47505331 // "GPS1"
+
+#ifdef FSCom
+static const char *gpsProbeCacheFileName = "/prefs/gps.dat";
+#endif
+
+struct VerifyProbe {
+    GnssModel_t model;
+    const char *command;
+    uint8_t commandLen;
+    const char *response; // Any of a model's rows with the same command is a match
+    uint8_t responseLen;
+    uint16_t timeoutMs;
+};
+
+#define VERIFY_PROBE(MODEL, COMMAND, RESPONSE, TIMEOUT)                                                                       \
+    {MODEL, COMMAND, sizeof(COMMAND) - 1, RESPONSE, sizeof(RESPONSE) - 1, TIMEOUT}
+
+// The same commands and answers GPS::probe() uses, one family per model. u-blox chips are told apart by UBX-MON-VER, but
+// only being a u-blox at this baud rate needs checking: an ACK for a CFG-RATE poll
+static const VerifyProbe verifyProbes[] = {
+    VERIFY_PROBE(GNSS_MODEL_UC6580, "$PDTINFO\r\n", "UC6580", 500),
+    VERIFY_PROBE(GNSS_MODEL_UC6580, "$PDTINFO\r\n", "UM600", 500),
+    VERIFY_PROBE(GNSS_MODEL_ATGM336H, "$PCAS06,1*1A\r\n", "$GPTXT,01,01,02,HW=ATGM33", 500),
+    VERIFY_PROBE(GNSS_MODEL_AG3335, "$PAIR021*39\r\n", "$PAIR021,AG3335", 1000),
+    VERIFY_PROBE(GNSS_MODEL_AG3352, "$PAIR021*39\r\n", "$PAIR021,AG3352", 1000),
+    VERIFY_PROBE(GNSS_MODEL_AG3352, "$PAIR021*39\r\n", "$PAIR021,REYAX_RYS3520_V2", 1000),
+    VERIFY_PROBE(GNSS_MODEL_MTK, "$PCAS06,0*1B\r\n", "$GPTXT,01,01,02,SW=", 500),
+    VERIFY_PROBE(GNSS_MODEL_MTK_L76B, "$PMTK605*31\r\n", "Quectel-L76B", 500),
+    VERIFY_PROBE(GNSS_MODEL_MTK_L76B, "$PMTK605*31\r\n", "MC-1513", 500),
+    VERIFY_PROBE(GNSS_MODEL_MTK_L76B, "$PMTK605*31\r\n", "Quectel-L96", 500),
+    VERIFY_PROBE(GNSS_MODEL_MTK_L76B, "$PMTK605*31\r\n", "_3337_", 500),
+    VERIFY_PROBE(GNSS_MODEL_MTK_L76B, "$PMTK605*31\r\n", "_3339_", 500),
+    VERIFY_PROBE(GNSS_MODEL_MTK_PA1010D, "$PMTK605*31\r\n", "1010D", 500),
+    VERIFY_PROBE(GNSS_MODEL_MTK_PA1616S, "$PMTK605*31\r\n", "1616S", 500),
+    VERIFY_PROBE(GNSS_MODEL_UBLOX6, "\xB5\x62\x06\x08\x00\x00\x0E\x30", "\xB5\x62\x05\x01\x02\x00\x06\x08", 750),
+    VERIFY_PROBE(GNSS_MODEL_UBLOX7, "\xB5\x62\x06\x08\x00\x00\x0E\x30", "\xB5\x62\x05\x01\x02\x00\x06\x08", 750),
+    VERIFY_PROBE(GNSS_MODEL_UBLOX8, "\xB5\x62\x06\x08\x00\x00\x0E\x30", "\xB5\x62\x05\x01\x02\x00\x06\x08", 750),
+    VERIFY_PROBE(GNSS_MODEL_UBLOX9, "\xB5\x62\x06\x08\x00\x00\x0E\x30", "\xB5\x62\x05\x01\x02\x00\x06\x08", 750),
+    VERIFY_PROBE(GNSS_MODEL_UBLOX10, "\xB5\x62\x06\x08\x00\x00\x0E\x30", "\xB5\x62\x05\x01\x02\x00\x06\x08", 750),
+};
+
+bool GPSProbeCache::load()
+{
+    bool okay = false;
+#ifdef FSCom
+    Contents loaded;
+    spiLock->lock();
+    auto file = FSCom.open(gpsProbeCacheFileName, FILE_O_READ);
+    if (file) {
+        okay = (size_t)file.read((uint8_t *)&loaded, sizeof(loaded)) == sizeof(loaded);
+        file.close();
+    }
+    spiLock->unlock();
+
+    bool knownModel = loaded.model != GNSS_MODEL_UNKNOWN && loaded.model <= GNSS_MODEL_LS20031;
+    if (okay && (loaded.magic != GPS_PROBE_CACHE_MAGIC || !knownModel)) {
+        LOG_WARN("Ignore invalid GPS probe cache");
+        okay = false;
+    }
+    if (okay)
+        contents = loaded;
+#endif
+    return okay;
+}
+
+bool GPSProbeCache::save(GnssModel_t model, uint32_t baud, uint8_t ubloxProtocolVersion)
+{
+    if (contents.magic == GPS_PROBE_CACHE_MAGIC && contents.model == model && contents.baud == baud &&
+        contents.ubloxProtocolVersion == ubloxProtocolVersion)
+        return true;
+    contents = {GPS_PROBE_CACHE_MAGIC, baud, (uint8_t)model, ubloxProtocolVersion};
+#ifdef FSCom
+    auto file = SafeFile(gpsProbeCacheFileName);
+    file.write((const uint8_t *)&contents, sizeof(contents));
+    if (!file.close()) {
+        LOG_WARN("Can't write GPS probe cache");
+        return false;
+    }
+    LOG_INFO("Saved GPS probe cache, model %d at %u baud", model, baud);
+#endif
+    return true;
+}
+
+bool GPSProbeCache::verify(Stream &serial, GnssModel_t model)
+{
+    const VerifyProbe *probe = nullptr;
+    for (const VerifyProbe &p : verifyProbes) {
+        if (p.model == model) {
+            probe = &p;
+            break;
+        }
+    }
+    if (!probe)
+        return false;
+
+    serial.write((const uint8_t *)probe->command, probe->commandLen);
+
+    // The answer may come amid NMEA output, so look for it at the end of the last few bytes received
+    char window[64];
+    size_t used = 0;
+    uint32_t start = millis();
+    while (Throttle::isWithinTimespanMs(start, probe->timeoutMs)) {
+        if (!serial.available()) {
+            delay(1);
+            continue;
+        }
+        if (used == sizeof(window)) {
+            memmove(window, window + sizeof(window) / 2, sizeof(window) / 2);
+            used = sizeof(window) / 2;
+        }
+        window[used++] = serial.read();
+        for (const VerifyProbe &p : verifyProbes) {
+            if (p.model == model && p.commandLen == probe->commandLen &&
+                memcmp(p.command, probe->command, p.commandLen) == 0 && p.responseLen <= used &&
+                memcmp(window + used - p.responseLen, p.response, p.responseLen) == 0)
+                return true;
+        }
+    }
+    return false;
+}
+
+#endif // Exclude GPS
@@ -0,0 +1,49 @@
+#pragma once
+#include "configuration.h"
+#if !MESHTASTIC_EXCLUDE_GPS
+
+#include "GPS.h"
+#include <Stream.h>
+#include <stdint.h>
+
+/**
+ * The GNSS chip and baud rate a previous boot detected, so that the next one can check for that chip with a single probe
+ * instead of cycling through every baud rate and chip family.
+ *
+ * Verification sends the one command that identifies the remembered chip and looks for its answer. If it doesn't come the
+ * GPS falls back to the full probe, and what that finds replaces the remembered chip.
+ */
+class GPSProbeCache
+{
+  public:
+    /// Read what a previous boot saved, false if there is nothing usable
+    bool load();
+
+    /// Remember a detected chip, only writes to flash if it differs from what was loaded or saved before
+    bool save(GnssModel_t model, uint32_t baud, uint8_t ubloxProtocolVersion);
+
+    GnssModel_t getModel() const { return (GnssModel_t)contents.model; }
+
+    uint32_t getBaud() const { return contents.baud; }
+
+    /// u-blox protocol version from UBX-MON-VER, which the verification probe doesn't ask for again
+    uint8_t getUbloxProtocolVersion() const { return contents.ubloxProtocolVersion; }
+
+    /**
+     * Send `serial` the probe that identifies `model` and wait up to that probe's timeout for the expected answer.
+     * The port must already be at the right baud rate. Returns false for models that have no verification probe.
+     */
+    static bool verify(Stream &serial, GnssModel_t model);
+
+  private:
+    struct Contents {
+        uint32_t magic;
+        uint32_t baud;
+        uint8_t model;
+        uint8_t ubloxProtocolVersion;
+    };
+
+    Contents contents = {0, 0, GNSS_MODEL_UNKNOWN, 0};
+};
+
+#endif // Exclude GPS
@@ -0,0 +1,58 @@
+#include "NMEAFramer.h"
+
+static int hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+void NMEAFramer::append(const char *data, size_t len)
+{
+    if (discarding)
+        return;
+    if (used + len > sizeof(line)) {
+        overflows++;
+        discarding = true;
+        used = 0;
+        return;
+    }
+    memcpy(line + used, data, len);
+    used += len;
+}
+
+const char *NMEAFramer::validate(const char *sentence, size_t &len)
+{
+    if (len && sentence[len - 1] == '\r')
+        len--;
+
+    // A sentence the chip started again before finishing, only the last one can be whole
+    for (size_t i = len; i-- > 1;) {
+        if (sentence[i] == '$') {
+            failed++;
+            sentence += i;
+            len -= i;
+            break;
+        }
+    }
+
+    if (len < 5 || sentence[len - 3] != '*') {
+        failed++;
+        return nullptr;
+    }
+    int high = hexValue(sentence[len - 2]);
+    int low = hexValue(sentence[len - 1]);
+    uint8_t checksum = 0;
+    for (size_t i = 1; i < len - 3; i++)
+        checksum ^= (uint8_t)sentence[i];
+    if (high < 0 || low < 0 || checksum != ((high << 4) | low)) {
+        failed++;
+        return nullptr;
+    }
+    passed++;
+    return sentence;
+}
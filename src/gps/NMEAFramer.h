@@ -0,0 +1,95 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/// Longest sentence kept, NMEA 0183 allows 82 characters but proprietary version strings ($PAIR021, $PMTK705) run longer
+#ifndef NMEA_FRAMER_MAX_SENTENCE
+#define NMEA_FRAMER_MAX_SENTENCE 128
+#endif
+
+/**
+ * Splits a GPS byte stream into whole NMEA sentences and checks their checksums, so that a parser only sees the sentences
+ * it consumes instead of every character the chip sends.
+ *
+ * Data is fed in blocks as read from the UART. A sentence that lies entirely within a block is handed over where it is,
+ * only one that straddles two reads is copied to assemble it. Binary UBX frames and anything else outside "$...\n" is
+ * skipped.
+ */
+class NMEAFramer
+{
+  public:
+    /**
+     * Find the sentences in `data`, calling onSentence(const char *sentence, size_t len) for each one whose checksum is
+     * good. The sentence runs from '$' to the checksum digits, without the line ending, and is only valid during the call.
+     * Returns how many sentences were delivered.
+     */
+    template <typename F> size_t feed(const uint8_t *data, size_t len, F &&onSentence)
+    {
+        size_t delivered = 0;
+        const char *p = (const char *)data;
+        const char *end = p + len;
+        while (p < end) {
+            const char *start = p;
+            if (!used && !discarding) {
+                // Between sentences, skip to the start of the next one
+                start = (const char *)memchr(p, '$', end - p);
+                if (!start)
+                    break;
+            }
+            const char *newline = (const char *)memchr(start, '\n', end - start);
+            if (newline && !used && !discarding) {
+                delivered += deliver(start, newline - start, onSentence);
+            } else {
+                append(start, (newline ? newline : end) - start);
+                if (newline && !discarding)
+                    delivered += deliver(line, used, onSentence);
+                if (newline) {
+                    used = 0;
+                    discarding = false;
+                }
+            }
+            if (!newline)
+                break;
+            p = newline + 1;
+        }
+        return delivered;
+    }
+
+    /// Whether `sentence` is of `type` ("GGA", "RMC"...) from any talker ($GP, $GN, $GL...)
+    static bool isType(const char *sentence, size_t len, const char *type)
+    {
+        return len > 6 && sentence[6] == ',' && memcmp(sentence + 3, type, 3) == 0;
+    }
+
+    uint32_t getPassedChecksums() const { return passed; }
+
+    /// Sentences with a bad or missing checksum, or that were cut short by another starting
+    uint32_t getFailedChecksums() const { return failed; }
+
+    /// Sentences too long to keep
+    uint32_t getOverflows() const { return overflows; }
+
+  private:
+    char line[NMEA_FRAMER_MAX_SENTENCE];
+    size_t used = 0;
+    bool discarding = false;
+    uint32_t passed = 0;
+    uint32_t failed = 0;
+    uint32_t overflows = 0;
+
+    void append(const char *data, size_t len);
+
+    /// Returns `sentence` with its line ending removed and a cut short sentence before it skipped, or null if bad
+    const char *validate(const char *sentence, size_t &len);
+
+    template <typename F> size_t deliver(const char *sentence, size_t len, F &&onSentence)
+    {
+        sentence = validate(sentence, len);
+        if (!sentence)
+            return 0;
+        onSentence(sentence, len);
+        return 1;
+    }
+};
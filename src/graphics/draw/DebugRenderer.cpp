@@ -480,6 +480,22 @@ void drawLoRaFocused(OLEDDisplay *display, OLEDDisplayUiState *state, int16_t x,
 
     display->drawString(starting_position + chUtil_x + chutil_bar_width + extraoffset, getTextPositions(display)[4],
                         chUtilPercentage);
+
+    // === Fifth Row: Who used the most airtime lately ===
+    AirtimeTopK::Entry top;
+    uint32_t totalMs = airTime->getTopSenders().getTotalAirtimeMs();
+    if (totalMs && airTime->getTopSenders().getTop(&top, 1)) {
+        char topSender[32];
+        uint32_t share = (uint64_t)top.airtimeMs * 100 / totalMs;
+        meshtastic_NodeInfoLite *node = nodeDB->getMeshNode(top.key);
+        if (node && node->has_user && node->user.short_name[0])
+            snprintf(topSender, sizeof(topSender), "Top: %s %u%%", node->user.short_name, share);
+        else
+            snprintf(topSender, sizeof(topSender), "Top: !%08x %u%%", top.key, share);
+        textWidth = display->getStringWidth(topSender);
+        nameX = (SCREEN_WIDTH - textWidth) / 2;
+        display->drawString(nameX, getTextPositions(display)[line++], topSender);
+    }
 }
 
 // ****************************
@@ -1104,6 +1104,7 @@ void menuHandler::keyVerificationFinalPrompt()
             if (selected == 1) {
                 auto remoteNodePtr = nodeDB->getMeshNode(keyVerificationModule->getCurrentRemoteNode());
                 remoteNodePtr->bitfield |= NODEINFO_BITFIELD_IS_KEY_MANUALLY_VERIFIED_MASK;
+                nodeDB->markNodeChanged(remoteNodePtr->num);
             }
         };
         screen->showOverlayBanner(options);
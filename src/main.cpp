@@ -5,12 +5,15 @@
 #include "MeshRadio.h"
 #include "MeshService.h"
 #include "NodeDB.h"
+#include "PacketAggregator.h"
 #include "PowerFSM.h"
 #include "PowerMon.h"
 #include "ReliableRouter.h"
+#include "SaveScheduler.h"
 #include "airtime.h"
 #include "buzz.h"
 
+#include "BootTrace.h"
 #include "FSCommon.h"
 #include "Led.h"
 #include "RTC.h"
@@ -92,6 +95,7 @@ NRF52Bluetooth *nrf52Bluetooth = nullptr;
 
 #ifdef ARCH_PORTDUINO
 #include "linux/LinuxHardwareI2C.h"
+#include "mesh/MetricsCollector.h"
 #include "mesh/raspihttp/PiWebServer.h"
 #include "platform/portduino/PortduinoGlue.h"
 #include "platform/portduino/USBHal.h"
@@ -294,6 +298,7 @@ void printInfo()
 #ifndef PIO_UNIT_TESTING
 void setup()
 {
+    bootTrace.phase("init");
 
 #if defined(PIN_POWER_EN)
     pinMode(PIN_POWER_EN, OUTPUT);
@@ -475,8 +480,10 @@ void setup()
     ledPeriodic = new Periodic("Blink", ledBlinker);
 #endif
 
+    bootTrace.phase("fs");
     fsInit();
 
+    bootTrace.phase("i2c");
 #if !MESHTASTIC_EXCLUDE_I2C
 #if defined(I2C_SDA1) && defined(ARCH_RP2040)
     Wire1.setSDA(I2C_SDA1);
@@ -532,23 +539,39 @@ void setup()
     // We need to scan here to decide if we have a screen for nodeDB.init() and because power has been applied to
     // accessories
     auto i2cScanner = std::unique_ptr<ScanI2CTwoWire>(new ScanI2CTwoWire());
+    // Without a saved manifest (the default unless I2C_SCAN_CACHE) every port gets a full scan
+    I2CScanManifest i2cManifest;
+#if I2C_SCAN_CACHE
+    i2cManifest.load();
+#endif
+    uint32_t i2cScanStart = millis();
 #if HAS_WIRE
     LOG_INFO("Scan for i2c devices");
 #endif
 
+#if I2C_PARALLEL_SCAN && defined(I2C_SDA1) && defined(I2C_SDA)
+    i2cScanner->scanBothPortsCached(i2cManifest);
+#else
 #if defined(I2C_SDA1) || (defined(NRF52840_XXAA) && (WIRE_INTERFACES_COUNT == 2))
-    i2cScanner->scanPort(ScanI2C::I2CPort::WIRE1);
+    i2cScanner->scanPortCached(ScanI2C::I2CPort::WIRE1, i2cManifest);
 #endif
 
 #if defined(I2C_SDA)
-    i2cScanner->scanPort(ScanI2C::I2CPort::WIRE);
+    i2cScanner->scanPortCached(ScanI2C::I2CPort::WIRE, i2cManifest);
 #elif defined(ARCH_PORTDUINO)
     if (settingsStrings[i2cdev] != "") {
         LOG_INFO("Scan for i2c devices");
-        i2cScanner->scanPort(ScanI2C::I2CPort::WIRE);
+        i2cScanner->scanPortCached(ScanI2C::I2CPort::WIRE, i2cManifest);
     }
 #elif HAS_WIRE
-    i2cScanner->scanPort(ScanI2C::I2CPort::WIRE);
+    i2cScanner->scanPortCached(ScanI2C::I2CPort::WIRE, i2cManifest);
+#endif
+#endif
+    LOG_DEBUG("I2C scan took %u ms", millis() - i2cScanStart);
+
+#if I2C_SCAN_CACHE
+    i2cManifest.record(*i2cScanner);
+    i2cManifest.save();
 #endif
 
     auto i2cCount = i2cScanner->countDevices();
@@ -724,6 +747,7 @@ void setup()
     LOG_INFO("Build timestamp: %ld", BUILD_EPOCH);
 #endif
 
+    bootTrace.phase("platform");
 #ifdef ARCH_ESP32
     esp32Setup();
 #endif
@@ -738,7 +762,12 @@ void setup()
 
     // We do this as early as possible because this loads preferences from flash
     // but we need to do this after main cpu init (esp32setup), because we need the random seed set
+    bootTrace.phase("nodedb");
     nodeDB = new NodeDB;
+    saveScheduler = new SaveScheduler();
+#ifdef ARCH_PORTDUINO
+    std::atexit([] { delete saveScheduler; }); // Writes what is still pending
+#endif
 
 #if HAS_TFT
     if (config.display.displaymode == meshtastic_Config_DisplayConfig_DisplayMode_COLOR) {
@@ -755,6 +784,10 @@ void setup()
     } else
         router = new ReliableRouter();
 
+#if USERPREFS_PACKET_AGGREGATION
+    packetAggregator = new PacketAggregator();
+#endif
+
     // only play start melody when role is not tracker or sensor
     if (config.power.is_power_saving == true &&
         IS_ONE_OF(config.device.role, meshtastic_Config_DeviceConfig_Role_TRACKER,
@@ -872,6 +905,7 @@ void setup()
 
     readFromRTC(); // read the main CPU RTC at first (in case we can't get GPS time)
 
+    bootTrace.phase("gps");
 #if !MESHTASTIC_EXCLUDE_GPS
     // If we're taking on the repeater role, ignore GPS
 #ifdef SENSOR_GPS_CONFLICT
@@ -912,6 +946,7 @@ void setup()
     }
 #endif
 #endif
+    bootTrace.phase("modules");
     service = new MeshService();
     service->init();
 
@@ -1097,6 +1132,7 @@ void setup()
         RECORD_CRITICALERROR(meshtastic_CriticalErrorCode_NO_AXP192); // Record a hardware fault for missing hardware
 #endif
 
+    bootTrace.phase("screen");
 #if !MESHTASTIC_EXCLUDE_I2C
 // Don't call screen setup until after nodedb is setup (because we need
 // the current region name)
@@ -1115,6 +1151,7 @@ void setup()
 #endif
 #endif
 
+    bootTrace.phase("radio");
 #ifdef PIN_PWR_DELAY_MS
     // This may be required to give the peripherals time to power up.
     delay(PIN_PWR_DELAY_MS);
@@ -1383,6 +1420,7 @@ void setup()
         }
     }
 
+    bootTrace.phase("network");
     lateInitVariant(); // Do board specific init (see extra_variants/README.md for documentation)
 
 #if !MESHTASTIC_EXCLUDE_MQTT
@@ -1419,6 +1457,7 @@ void setup()
     if (settingsMap[webserverport] != -1) {
         piwebServerThread = new PiWebServerThread();
         std::atexit([] { delete piwebServerThread; });
+        metricsCollector = new MetricsCollector();
     }
 #endif
     initApiServer(TCPPort);
@@ -1438,6 +1477,7 @@ void setup()
                                                        1000);
     }
 
+    bootTrace.phase("power");
     // This must be _after_ service.init because we need our preferences loaded from flash to have proper timeout values
     PowerFSM_setup(); // we will transition to ON in a couple of seconds, FIXME, only do this for cold boots, not waking from SDS
     powerFSMthread = new PowerFSMThread();
@@ -1453,6 +1493,8 @@ void setup()
 
     // We manually run this to update the NodeStatus
     nodeDB->notifyObservers(true);
+
+    bootTrace.finish();
 }
 
 #endif
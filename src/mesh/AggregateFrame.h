@@ -0,0 +1,97 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/// Set to 1 (e.g. in userPrefs.jsonc) to send our small, delay-tolerant packets together in one LoRa frame
+#ifndef USERPREFS_PACKET_AGGREGATION
+#define USERPREFS_PACKET_AGGREGATION 0
+#endif
+
+/// How long the first packet of a batch waits for others to join it
+#ifndef USERPREFS_PACKET_AGGREGATION_WINDOW_MS
+#define USERPREFS_PACKET_AGGREGATION_WINDOW_MS 500
+#endif
+
+/// Encrypted packets larger than this are sent on their own, they would leave little room for others anyway
+#define AGGREGATE_MAX_PACKET_LEN 96
+
+/// MAX_LORA_PAYLOAD_LEN less the PacketHeader and the container's own Data fields (portnum, payload length, bitfield)
+#define AGGREGATE_MAX_FRAME_LEN (255 - 16 - 8)
+
+/**
+ * The portnum containers are sent on. It is below PRIVATE_APP, in the range kept for the firmware's own apps, and unassigned
+ * in portnums.proto, so no private app can be using it. Only builds that aggregate unpack containers; others, and firmware
+ * that predates aggregation, relay them like any other packet they can't handle.
+ */
+#define AGGREGATE_PORTNUM 254
+
+/// One packet inside a container, still encrypted as it would have been sent on its own
+struct AggregateRecord {
+    uint32_t to;
+    uint32_t id;
+    uint8_t nextHop;
+    uint8_t channelHash;
+    uint8_t size;
+    const uint8_t *bytes;
+};
+
+/**
+ * The payload of a container: a run of records, each a length byte, then to, id (both little endian), next hop and channel
+ * hash, then the encrypted bytes. Everything else in the header (from, hop limit, hop start, relay node) is shared by all
+ * the packets of a container and comes from the container's own header.
+ */
+class AggregateFrame
+{
+  public:
+    static const size_t RECORD_HEADER_LEN = 11;
+
+    /// Append r to the frame if it fits in capacity, advancing len
+    static bool append(uint8_t *frame, size_t &len, size_t capacity, const AggregateRecord &r)
+    {
+        if (!r.size || len + RECORD_HEADER_LEN + r.size > capacity)
+            return false;
+        uint8_t *out = frame + len;
+        out[0] = r.size;
+        putLe32(out + 1, r.to);
+        putLe32(out + 5, r.id);
+        out[9] = r.nextHop;
+        out[10] = r.channelHash;
+        memcpy(out + RECORD_HEADER_LEN, r.bytes, r.size);
+        len += RECORD_HEADER_LEN + r.size;
+        return true;
+    }
+
+    /**
+     * Read the record at offset and advance past it. r.bytes points into frame.
+     * @return false at the end of the frame, or if the rest of it is truncated
+     */
+    static bool next(const uint8_t *frame, size_t len, size_t &offset, AggregateRecord &r)
+    {
+        if (offset + RECORD_HEADER_LEN > len)
+            return false;
+        const uint8_t *in = frame + offset;
+        r.size = in[0];
+        if (!r.size || offset + RECORD_HEADER_LEN + r.size > len)
+            return false;
+        r.to = getLe32(in + 1);
+        r.id = getLe32(in + 5);
+        r.nextHop = in[9];
+        r.channelHash = in[10];
+        r.bytes = in + RECORD_HEADER_LEN;
+        offset += RECORD_HEADER_LEN + r.size;
+        return true;
+    }
+
+  private:
+    static void putLe32(uint8_t *out, uint32_t v)
+    {
+        for (int i = 0; i < 4; i++)
+            out[i] = v >> (8 * i);
+    }
+
+    static uint32_t getLe32(const uint8_t *in)
+    {
+        return in[0] | (in[1] << 8) | (in[2] << 16) | ((uint32_t)in[3] << 24);
+    }
+};
@@ -0,0 +1,114 @@
+#include "AirtimeTopK.h"
+#include <stdio.h>
+
+void AirtimeTopK::add(uint32_t key, uint32_t airtimeMs, uint32_t packets)
+{
+    totalAirtimeMs += airtimeMs;
+    totalPackets += packets;
+
+    uint8_t lightest = 0;
+    for (uint8_t i = 0; i < numEntries; i++) {
+        if (entries[i].key == key) {
+            entries[i].airtimeMs += airtimeMs;
+            entries[i].packets += packets;
+            return;
+        }
+        if (entries[i].airtimeMs < entries[lightest].airtimeMs)
+            lightest = i;
+    }
+
+    if (numEntries < AIRTIME_TOPK_SLOTS) {
+        entries[numEntries++] = {key, airtimeMs, packets, 0};
+    } else {
+        Entry &e = entries[lightest];
+        e = {key, e.airtimeMs + airtimeMs, e.packets + packets, e.airtimeMs};
+    }
+}
+
+void AirtimeTopK::decay()
+{
+    totalAirtimeMs /= 2;
+    totalPackets /= 2;
+
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < numEntries; i++) {
+        Entry e = entries[i];
+        e.airtimeMs /= 2;
+        e.packets /= 2;
+        e.errorMs /= 2;
+        if (e.airtimeMs || e.packets) // Let keys that went quiet free their slot
+            entries[kept++] = e;
+    }
+    numEntries = kept;
+}
+
+size_t AirtimeTopK::getTop(Entry *out, size_t max) const
+{
+    size_t n = 0;
+    for (uint8_t i = 0; i < numEntries; i++) {
+        // Insertion sort, there are only a few
+        size_t j = n < max ? n++ : max;
+        while (j > 0 && out[j - 1].airtimeMs < entries[i].airtimeMs) {
+            if (j < max)
+                out[j] = out[j - 1];
+            j--;
+        }
+        if (j < max)
+            out[j] = entries[i];
+    }
+    return n;
+}
+
+std::string AirtimeTopK::toJson(const char *keyName) const
+{
+    Entry top[AIRTIME_TOPK_SLOTS];
+    size_t n = getTop(top, AIRTIME_TOPK_SLOTS);
+
+    std::string json = "[";
+    char buf[112];
+    for (size_t i = 0; i < n; i++) {
+        snprintf(buf, sizeof(buf), "%s{\"%s\":%u,\"airtime_ms\":%u,\"packets\":%u,\"error_ms\":%u}", i ? "," : "", keyName,
+                 top[i].key, top[i].airtimeMs, top[i].packets, top[i].errorMs);
+        json += buf;
+    }
+    json += "]";
+    return json;
+}
+
+AirtimePortTracker::Packet &AirtimePortTracker::find(uint32_t from, uint32_t id)
+{
+    for (uint8_t i = 0; i < numPackets; i++) {
+        if (packets[i].from == from && packets[i].id == id)
+            return packets[i];
+    }
+
+    uint8_t slot = numPackets < AIRTIME_PACKET_PORTS ? numPackets++ : nextSlot;
+    nextSlot = (slot + 1) % AIRTIME_PACKET_PORTS;
+    Packet &p = packets[slot];
+    if (!p.portKnown && p.pendingCopies)
+        ports.add(0, p.pendingMs, p.pendingCopies); // Never decoded
+    p = {from, id, 0, false, 0, 0};
+    return p;
+}
+
+void AirtimePortTracker::logAirtime(uint32_t from, uint32_t id, uint32_t airtimeMs)
+{
+    Packet &p = find(from, id);
+    if (p.portKnown) {
+        ports.add(p.port, airtimeMs);
+    } else {
+        p.pendingCopies++;
+        p.pendingMs += airtimeMs;
+    }
+}
+
+void AirtimePortTracker::setPort(uint32_t from, uint32_t id, uint32_t port)
+{
+    Packet &p = find(from, id);
+    if (p.pendingCopies)
+        ports.add(port, p.pendingMs, p.pendingCopies);
+    p.port = port;
+    p.portKnown = true;
+    p.pendingCopies = 0;
+    p.pendingMs = 0;
+}
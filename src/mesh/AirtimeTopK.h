@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+/// How many senders, and how many ports, are tracked for their share of the airtime
+#ifndef AIRTIME_TOPK_SLOTS
+#define AIRTIME_TOPK_SLOTS 8
+#endif
+
+/// How many recent packets remember their port, long enough for the copies relayed back to us to find it
+#ifndef AIRTIME_PACKET_PORTS
+#define AIRTIME_PACKET_PORTS 32
+#endif
+
+/**
+ * The heaviest users of the channel by some key (a sender's NodeNum or a portnum), using the Space-Saving algorithm of
+ * Metwally et al. Any key with more than 1/AIRTIME_TOPK_SLOTS of the airtime is guaranteed to be tracked. A key that takes
+ * over the slot of the lightest one inherits its airtime, which is then remembered as that key's possible overestimate.
+ *
+ * Adding is a scan of the few slots with no allocation, so it costs the same for every packet however many keys there are.
+ */
+class AirtimeTopK
+{
+  public:
+    struct Entry {
+        uint32_t key;
+        uint32_t airtimeMs;
+        uint32_t packets;
+        uint32_t errorMs; // airtimeMs may be this much more than the key really used
+    };
+
+    /// Charge `packets` packets that took airtimeMs between them to key
+    void add(uint32_t key, uint32_t airtimeMs, uint32_t packets = 1);
+
+    /// Halve everything, so that what is tracked leans towards what was heard lately
+    void decay();
+
+    /// Fill out with the heaviest entries first, returns how many were filled in
+    size_t getTop(Entry *out, size_t max) const;
+
+    uint32_t getTotalAirtimeMs() const { return totalAirtimeMs; }
+    uint32_t getTotalPackets() const { return totalPackets; }
+
+    /// [{"<keyName>":..,"airtime_ms":..,"packets":..,"error_ms":..}], heaviest first
+    std::string toJson(const char *keyName) const;
+
+  private:
+    Entry entries[AIRTIME_TOPK_SLOTS] = {};
+    uint8_t numEntries = 0;
+    uint32_t totalAirtimeMs = 0;
+    uint32_t totalPackets = 0;
+};
+
+/**
+ * Charges each copy of a packet the radio sent or heard to the packet's port, though the radio only knows a packet by sender
+ * and id and the port is only known once it was decoded. Copies of a packet whose port is known, like the duplicates we hear
+ * and our own sends, are charged as soon as the radio is done with them. Airtime heard before the port is known is held until
+ * it is, or charged to port 0 (UNKNOWN_APP) if the packet is pushed out of the recent ones first.
+ */
+class AirtimePortTracker
+{
+  public:
+    explicit AirtimePortTracker(AirtimeTopK &ports) : ports(ports) {}
+
+    /// The radio finished sending or receiving a copy of packet (from, id)
+    void logAirtime(uint32_t from, uint32_t id, uint32_t airtimeMs);
+
+    /// Packet (from, id) carries `port`, 0 if it couldn't be decoded
+    void setPort(uint32_t from, uint32_t id, uint32_t port);
+
+  private:
+    struct Packet {
+        uint32_t from;
+        uint32_t id;
+        uint32_t port;
+        bool portKnown;
+        uint16_t pendingCopies; // Heard before the port was known
+        uint32_t pendingMs;
+    };
+
+    AirtimeTopK &ports;
+    Packet packets[AIRTIME_PACKET_PORTS] = {};
+    uint8_t numPackets = 0;
+    uint8_t nextSlot = 0; // Oldest packet once all slots are used
+
+    Packet &find(uint32_t from, uint32_t id);
+};
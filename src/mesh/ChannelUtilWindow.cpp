@@ -0,0 +1,32 @@
+#include "ChannelUtilWindow.h"
+
+void ChannelUtilWindow::add(uint32_t airtimeMs)
+{
+    uint8_t i = current;
+    for (uint8_t n = 0; n < CHANNEL_UTIL_WINDOW_SECS && airtimeMs; n++) {
+        uint32_t room = buckets[i] < 1000 ? 1000 - buckets[i] : 0;
+        uint32_t ms = airtimeMs < room ? airtimeMs : room;
+        if (n == CHANNEL_UTIL_WINDOW_SECS - 1)
+            ms = airtimeMs; // Longer than the whole window, so more than full anyway
+        uint32_t space = UINT16_MAX - buckets[i];
+        buckets[i] += ms < space ? ms : space;
+        airtimeMs -= ms;
+        i = i ? i - 1 : CHANNEL_UTIL_WINDOW_SECS - 1;
+    }
+}
+
+void ChannelUtilWindow::tick()
+{
+    current = (current + 1) % CHANNEL_UTIL_WINDOW_SECS;
+    buckets[current] = 0;
+}
+
+float ChannelUtilWindow::getPercent() const
+{
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < CHANNEL_UTIL_WINDOW_SECS; i++)
+        sum += buckets[i];
+    if (sum >= CHANNEL_UTIL_WINDOW_SECS * 1000)
+        return 100;
+    return float(sum) * 100 / (CHANNEL_UTIL_WINDOW_SECS * 1000);
+}
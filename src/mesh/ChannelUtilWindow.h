@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdint.h>
+
+/// How many seconds the recent channel utilization looks back over
+#ifndef CHANNEL_UTIL_WINDOW_SECS
+#define CHANNEL_UTIL_WINDOW_SECS 10
+#endif
+
+/**
+ * How busy the channel was over the last few seconds, in one bucket per second, so that a burst shows within a second
+ * and is forgotten CHANNEL_UTIL_WINDOW_SECS after it ended. Airtime longer than a second is spread back over the seconds
+ * it took, rather than all landing in the second the packet ended in.
+ */
+class ChannelUtilWindow
+{
+  public:
+    /// Airtime that just ended
+    void add(uint32_t airtimeMs);
+
+    /// Start the next second, dropping the oldest one
+    void tick();
+
+    /// Share of the window the channel was busy, at most 100, counting the second in progress as a whole one like AirTime does
+    float getPercent() const;
+
+  private:
+    uint16_t buckets[CHANNEL_UTIL_WINDOW_SECS] = {};
+    uint8_t current = 0;
+};
@@ -0,0 +1,207 @@
+#include "ConfigSnapshot.h"
+#include "Channels.h"
+#include "Default.h"
+#include "NodeDB.h"
+#include "configuration.h"
+#include <ErriezCRC32.h>
+#include <string.h>
+
+static std::shared_ptr<const ConfigSnapshot> currentSnapshot;
+
+uint8_t ConfigSnapshot::firstIndex(ConfigFrameKind kind)
+{
+    switch (kind) {
+    case CONFIG_FRAME_CONFIG:
+        return _meshtastic_AdminMessage_ConfigType_MIN + 1;
+    case CONFIG_FRAME_MODULECONFIG:
+        return _meshtastic_AdminMessage_ModuleConfigType_MIN + 1;
+    default:
+        return 0;
+    }
+}
+
+uint8_t ConfigSnapshot::numFrames(ConfigFrameKind kind)
+{
+    switch (kind) {
+    case CONFIG_FRAME_CHANNEL:
+        return MAX_NUM_CHANNELS;
+    case CONFIG_FRAME_CONFIG:
+        return _meshtastic_AdminMessage_ConfigType_MAX - _meshtastic_AdminMessage_ConfigType_MIN + 1;
+    case CONFIG_FRAME_MODULECONFIG:
+        return _meshtastic_AdminMessage_ModuleConfigType_MAX - _meshtastic_AdminMessage_ModuleConfigType_MIN + 1;
+    default:
+        return 0;
+    }
+}
+
+uint32_t ConfigSnapshot::configCrc()
+{
+    uint32_t crc = crc32Buffer(&channelFile, sizeof(channelFile));
+    crc ^= crc32Buffer(&config, sizeof(config)) * 31;
+    crc ^= crc32Buffer(&moduleConfig, sizeof(moduleConfig)) * 961;
+    return crc;
+}
+
+std::shared_ptr<const ConfigSnapshot> ConfigSnapshot::acquire(meshtastic_FromRadio &scratch)
+{
+    uint32_t crc = configCrc();
+    if (currentSnapshot && currentSnapshot->crc == crc)
+        return currentSnapshot;
+
+    auto snapshot = std::make_shared<ConfigSnapshot>();
+    snapshot->generation = currentSnapshot ? currentSnapshot->generation + 1 : 1;
+    snapshot->crc = crc;
+
+    uint8_t frame[meshtastic_FromRadio_size];
+    for (uint8_t k = 0; k < CONFIG_FRAME_KINDS; k++) {
+        ConfigFrameKind kind = (ConfigFrameKind)k;
+        uint8_t first = firstIndex(kind), count = numFrames(kind);
+        for (uint8_t i = 0; i < count && i < MAX_FRAMES; i++) {
+            memset(&scratch, 0, sizeof(scratch));
+            fillFrame(kind, first + i, scratch);
+            size_t len = pb_encode_to_bytes(frame, sizeof(frame), &meshtastic_FromRadio_msg, &scratch);
+            snapshot->offsets[k][i] = snapshot->bytes.size();
+            snapshot->bytes.insert(snapshot->bytes.end(), frame, frame + len);
+            snapshot->offsets[k][i + 1] = snapshot->bytes.size();
+        }
+    }
+    snapshot->bytes.shrink_to_fit();
+    LOG_DEBUG("Rebuilt config snapshot %u, %u bytes", snapshot->generation, (unsigned)snapshot->bytes.size());
+
+    currentSnapshot = snapshot;
+    return snapshot;
+}
+
+size_t ConfigSnapshot::copyFrame(ConfigFrameKind kind, uint8_t index, uint8_t *buf) const
+{
+    uint8_t first = firstIndex(kind);
+    if (kind >= CONFIG_FRAME_KINDS || index < first || index - first >= numFrames(kind) || index - first >= MAX_FRAMES)
+        return 0;
+    uint8_t i = index - first;
+    size_t len = offsets[kind][i + 1] - offsets[kind][i];
+    memcpy(buf, bytes.data() + offsets[kind][i], len);
+    return len;
+}
+
+void ConfigSnapshot::fillFrame(ConfigFrameKind kind, uint8_t index, meshtastic_FromRadio &f)
+{
+    switch (kind) {
+    case CONFIG_FRAME_CHANNEL:
+        f.which_payload_variant = meshtastic_FromRadio_channel_tag;
+        f.channel = channels.getByIndex(index);
+        break;
+
+    case CONFIG_FRAME_CONFIG:
+        f.which_payload_variant = meshtastic_FromRadio_config_tag;
+        switch (index) {
+        case meshtastic_Config_device_tag:
+            f.config.which_payload_variant = meshtastic_Config_device_tag;
+            f.config.payload_variant.device = config.device;
+            break;
+        case meshtastic_Config_position_tag:
+            f.config.which_payload_variant = meshtastic_Config_position_tag;
+            f.config.payload_variant.position = config.position;
+            break;
+        case meshtastic_Config_power_tag:
+            f.config.which_payload_variant = meshtastic_Config_power_tag;
+            f.config.payload_variant.power = config.power;
+            // NOTE: The phone app needs to know the ls_secs value so it can properly expect sleep behavior.
+            // So even if we internally use 0 to represent 'use default' we still need to send the value we are
+            // using to the app (so that even old phone apps work with new device loads).
+            f.config.payload_variant.power.ls_secs = default_ls_secs;
+            break;
+        case meshtastic_Config_network_tag:
+            f.config.which_payload_variant = meshtastic_Config_network_tag;
+            f.config.payload_variant.network = config.network;
+            break;
+        case meshtastic_Config_display_tag:
+            f.config.which_payload_variant = meshtastic_Config_display_tag;
+            f.config.payload_variant.display = config.display;
+            break;
+        case meshtastic_Config_lora_tag:
+            f.config.which_payload_variant = meshtastic_Config_lora_tag;
+            f.config.payload_variant.lora = config.lora;
+            break;
+        case meshtastic_Config_bluetooth_tag:
+            f.config.which_payload_variant = meshtastic_Config_bluetooth_tag;
+            f.config.payload_variant.bluetooth = config.bluetooth;
+            break;
+        case meshtastic_Config_security_tag:
+            f.config.which_payload_variant = meshtastic_Config_security_tag;
+            f.config.payload_variant.security = config.security;
+            break;
+        case meshtastic_Config_sessionkey_tag:
+            f.config.which_payload_variant = meshtastic_Config_sessionkey_tag;
+            break;
+        case meshtastic_Config_device_ui_tag: // NOOP!
+            f.config.which_payload_variant = meshtastic_Config_device_ui_tag;
+            break;
+        default:
+            LOG_ERROR("Unknown config type %d", index);
+        }
+        break;
+
+    case CONFIG_FRAME_MODULECONFIG:
+        f.which_payload_variant = meshtastic_FromRadio_moduleConfig_tag;
+        switch (index) {
+        case meshtastic_ModuleConfig_mqtt_tag:
+            f.moduleConfig.which_payload_variant = meshtastic_ModuleConfig_mqtt_tag;
+            f.moduleConfig.payload_variant.mqtt = moduleConfig.mqtt;
+            break;
+        case meshtastic_ModuleConfig_serial_tag:
+            f.moduleConfig.which_payload_variant = meshtastic_ModuleConfig_serial_tag;
+            f.moduleConfig.payload_variant.serial = moduleConfig.serial;
+            break;
+        case meshtastic_ModuleConfig_external_notification_tag:
+            f.moduleConfig.which_payload_variant = meshtastic_ModuleConfig_external_notification_tag;
+            f.moduleConfig.payload_variant.external_notification = moduleConfig.external_notification;
+            break;
+        case meshtastic_ModuleConfig_store_forward_tag:
+            f.moduleConfig.which_payload_variant = meshtastic_ModuleConfig_store_forward_tag;
+            f.moduleConfig.payload_variant.store_forward = moduleConfig.store_forward;
+            break;
+        case meshtastic_ModuleConfig_range_test_tag:
+            f.moduleConfig.which_payload_variant = meshtastic_ModuleConfig_range_test_tag;
+            f.moduleConfig.payload_variant.range_test = moduleConfig.range_test;
+            break;
+        case meshtastic_ModuleConfig_telemetry_tag:
+            f.moduleConfig.which_payload_variant = meshtastic_ModuleConfig_telemetry_tag;
+            f.moduleConfig.payload_variant.telemetry = moduleConfig.telemetry;
+            break;
+        case meshtastic_ModuleConfig_canned_message_tag:
+            f.moduleConfig.which_payload_variant = meshtastic_ModuleConfig_canned_message_tag;
+            f.moduleConfig.payload_variant.canned_message = moduleConfig.canned_message;
+            break;
+        case meshtastic_ModuleConfig_audio_tag:
+            f.moduleConfig.which_payload_variant = meshtastic_ModuleConfig_audio_tag;
+            f.moduleConfig.payload_variant.audio = moduleConfig.audio;
+            break;
+        case meshtastic_ModuleConfig_remote_hardware_tag:
+            f.moduleConfig.which_payload_variant = meshtastic_ModuleConfig_remote_hardware_tag;
+            f.moduleConfig.payload_variant.remote_hardware = moduleConfig.remote_hardware;
+            break;
+        case meshtastic_ModuleConfig_neighbor_info_tag:
+            f.moduleConfig.which_payload_variant = meshtastic_ModuleConfig_neighbor_info_tag;
+            f.moduleConfig.payload_variant.neighbor_info = moduleConfig.neighbor_info;
+            break;
+        case meshtastic_ModuleConfig_detection_sensor_tag:
+            f.moduleConfig.which_payload_variant = meshtastic_ModuleConfig_detection_sensor_tag;
+            f.moduleConfig.payload_variant.detection_sensor = moduleConfig.detection_sensor;
+            break;
+        case meshtastic_ModuleConfig_ambient_lighting_tag:
+            f.moduleConfig.which_payload_variant = meshtastic_ModuleConfig_ambient_lighting_tag;
+            f.moduleConfig.payload_variant.ambient_lighting = moduleConfig.ambient_lighting;
+            break;
+        case meshtastic_ModuleConfig_paxcounter_tag:
+            f.moduleConfig.which_payload_variant = meshtastic_ModuleConfig_paxcounter_tag;
+            f.moduleConfig.payload_variant.paxcounter = moduleConfig.paxcounter;
+            break;
+        default:
+            LOG_ERROR("Unknown module config type %d", index);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "mesh-pb-constants.h"
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/// The groups of FromRadio frames a client is sent while it downloads our config
+enum ConfigFrameKind : uint8_t { CONFIG_FRAME_CHANNEL, CONFIG_FRAME_CONFIG, CONFIG_FRAME_MODULECONFIG, CONFIG_FRAME_KINDS };
+
+/**
+ * Immutable set of pre-encoded FromRadio frames for our channels, config and module config.
+ *
+ * Every client that connects is sent the same frames, so instead of encoding them again for each client they are encoded
+ * once into a snapshot that is shared by all clients. The snapshot is versioned by a CRC over the channel file, config and
+ * module config: acquire() rebuilds it on first use after any of them changed, whichever way they were changed. A client
+ * keeps the snapshot it acquired until it has finished downloading, so it never sees a mix of old and new frames.
+ */
+class ConfigSnapshot
+{
+  public:
+    /**
+     * Get the current snapshot, rebuilding it if the config changed since it was built.
+     * @param scratch a FromRadio the frames can be assembled in while building, its contents are undefined afterwards
+     */
+    static std::shared_ptr<const ConfigSnapshot> acquire(meshtastic_FromRadio &scratch);
+
+    /**
+     * Fill `f` with frame `index` of `kind`: the channel index for channels, the Config/ModuleConfig payload tag for configs.
+     */
+    static void fillFrame(ConfigFrameKind kind, uint8_t index, meshtastic_FromRadio &f);
+
+    /// Number of frames of `kind` a client is sent, indexes run from firstIndex(kind)
+    static uint8_t firstIndex(ConfigFrameKind kind);
+    static uint8_t numFrames(ConfigFrameKind kind);
+
+    /**
+     * Copy an encoded frame into `buf`, which must hold meshtastic_FromRadio_size bytes.
+     * @return the length of the frame, 0 if there is no such frame
+     */
+    size_t copyFrame(ConfigFrameKind kind, uint8_t index, uint8_t *buf) const;
+
+    /// Increments every time the snapshot is rebuilt
+    uint32_t getGeneration() const { return generation; }
+
+  private:
+    static constexpr uint8_t MAX_FRAMES = 32;
+
+    uint32_t generation = 0;
+    uint32_t crc = 0;
+    std::vector<uint8_t> bytes;
+    // Frame i of a kind is bytes[offsets[kind][i] .. offsets[kind][i + 1])
+    uint16_t offsets[CONFIG_FRAME_KINDS][MAX_FRAMES + 1] = {};
+
+    static uint32_t configCrc();
+};
@@ -1,4 +1,6 @@
 #include "FloodingRouter.h"
+#include "RebroadcastSuppression.h"
+#include "airtime.h"
 
 #include "configuration.h"
 #include "mesh-pb-constants.h"
@@ -45,6 +47,23 @@ bool FloodingRouter::shouldFilterReceived(const meshtastic_MeshPacket *p)
 
 void FloodingRouter::perhapsCancelDupe(const meshtastic_MeshPacket *p)
 {
+#if USERPREFS_FLOOD_SUPPRESSION
+    // Only LoRa copies tell us how well others cover the area, and without a relay_node we can't tell relayers apart.
+    // Directed packets, which NextHopRouter may have asked a particular node to relay, keep the old behaviour.
+    if (isBroadcast(p->to) && p->next_hop == NO_NEXT_HOP_PREFERENCE && p->relay_node != NO_RELAY_NODE &&
+        config.device.role != meshtastic_Config_DeviceConfig_Role_ROUTER_LATE &&
+        p->transport_mechanism == meshtastic_MeshPacket_TransportMechanism_TRANSPORT_LORA) {
+        bool isRouter = config.device.role == meshtastic_Config_DeviceConfig_Role_ROUTER ||
+                        config.device.role == meshtastic_Config_DeviceConfig_Role_REPEATER;
+        uint8_t threshold = RebroadcastSuppression::getThreshold(airTime ? airTime->channelUtilizationPercent() : 0, isRouter);
+        uint8_t heard = getNumRelayers(p->id, getFrom(p));
+        if (threshold && heard >= threshold && Router::cancelSending(p->from, p->id)) {
+            LOG_DEBUG("Heard %d relayers of 0x%x, cancel our rebroadcast", heard, p->id);
+            txRelayCanceled++;
+        }
+        return;
+    }
+#endif
     if (config.device.role != meshtastic_Config_DeviceConfig_Role_ROUTER &&
         config.device.role != meshtastic_Config_DeviceConfig_Role_REPEATER &&
         config.device.role != meshtastic_Config_DeviceConfig_Role_ROUTER_LATE &&
@@ -70,7 +89,7 @@ void FloodingRouter::perhapsRebroadcast(const meshtastic_MeshPacket *p)
     if (!isToUs(p) && (p->hop_limit > 0) && !isFromUs(p)) {
         if (p->id != 0) {
             if (isRebroadcaster()) {
-                meshtastic_MeshPacket *tosend = packetPool.allocCopy(*p); // keep a copy because we will be sending it
+                meshtastic_MeshPacket *tosend = allocRelayCopy(p); // keep a copy because we will be sending it
 
                 tosend->hop_limit--; // bump down the hop count
 #if USERPREFS_EVENT_MODE
@@ -0,0 +1,120 @@
+#include "LatencyTrace.h"
+#include <Arduino.h>
+#include <stdio.h>
+
+#if USERPREFS_LATENCY_TRACE
+LatencyTrace latencyTrace;
+#endif
+
+volatile uint32_t LatencyTrace::isrUs;
+
+uint8_t LatencyHistogram::bucketOf(uint32_t us)
+{
+    if (us < 4)
+        return us;
+    uint8_t octave = 31 - __builtin_clz(us); // At least 2
+    uint32_t bucket = 4 * (octave - 1) + ((us >> (octave - 2)) & 3);
+    return bucket < NUM_BUCKETS ? bucket : NUM_BUCKETS - 1;
+}
+
+uint32_t LatencyHistogram::bucketStart(uint8_t bucket)
+{
+    if (bucket < 4)
+        return bucket;
+    return (4 + bucket % 4) << (bucket / 4 - 1);
+}
+
+void LatencyHistogram::record(uint32_t us)
+{
+    std::atomic<uint32_t> &b = buckets[bucketOf(us)];
+    b.store(b.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (us > max.load(std::memory_order_relaxed))
+        max.store(us, std::memory_order_relaxed);
+}
+
+uint32_t LatencyHistogram::getPercentile(float percentile) const
+{
+    uint32_t total = getCount();
+    if (!total)
+        return 0;
+    uint32_t rank = total * percentile / 100, seen = 0;
+    for (uint8_t i = 0; i < NUM_BUCKETS; i++) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen > rank) {
+            uint32_t highest = i + 1 < NUM_BUCKETS ? bucketStart(i + 1) - 1 : UINT32_MAX;
+            return highest < getMax() ? highest : getMax();
+        }
+    }
+    return getMax();
+}
+
+const char *LatencyTrace::getStageName(Stage stage)
+{
+    static const char *names[NUM_STAGES] = {"rx_radio",      "rx_queued", "rx_decoded", "rx_modules",  "rx_to_phone",
+                                            "rx_from_radio", "tx_queued", "tx_started", "tx_completed"};
+    return names[stage];
+}
+
+LatencyTrace::Trace *LatencyTrace::find(NodeNum from, PacketId id, bool tx)
+{
+    // Newest first, a duplicate heard again is most likely the copy still in flight
+    for (uint8_t i = 1; i <= LATENCY_TRACE_SLOTS; i++) {
+        Trace &t = traces[(nextTrace + LATENCY_TRACE_SLOTS - i) % LATENCY_TRACE_SLOTS];
+        if (t.active && t.id == id && t.from == from && t.tx == tx)
+            return &t;
+    }
+    return NULL;
+}
+
+void LatencyTrace::mark(Stage stage, const meshtastic_MeshPacket *p)
+{
+    mark(stage, p->from, p->id, micros());
+}
+
+void LatencyTrace::mark(Stage stage, NodeNum from, PacketId id, uint32_t nowUs)
+{
+    bool tx = stage >= TX_QUEUED;
+    if (stage == RX_RADIO || stage == TX_QUEUED) {
+        uint32_t startUs = nowUs;
+        if (stage == RX_RADIO) {
+            uint32_t isr = isrUs;
+            isrUs = 0;
+            if (isr)
+                startUs = isr;
+            stages[RX_RADIO].record(nowUs - startUs);
+        }
+        traces[nextTrace] = {from, id, startUs, nowUs, tx, true};
+        nextTrace = (nextTrace + 1) % LATENCY_TRACE_SLOTS;
+        return;
+    }
+
+    Trace *t = find(from, id, tx);
+    if (!t)
+        return; // Not one we saw start, or pushed out by newer ones
+    stages[stage].record(nowUs - t->lastUs);
+    t->lastUs = nowUs;
+    if (stage == RX_FROM_RADIO || stage == TX_COMPLETED) {
+        (tx ? txTotal : rxTotal).record(nowUs - t->startUs);
+        t->active = false;
+    }
+}
+
+std::string LatencyTrace::toJson() const
+{
+    std::string out = "{\"stages\":[";
+    char line[128];
+    auto add = [&](const char *name, const LatencyHistogram &h) {
+        snprintf(line, sizeof(line), "%s{\"name\":\"%s\",\"count\":%u,\"p50\":%u,\"p90\":%u,\"p99\":%u,\"max\":%u}",
+                 out.back() == '[' ? "" : ",", name, h.getCount(), h.getPercentile(50), h.getPercentile(90),
+                 h.getPercentile(99), h.getMax());
+        out += line;
+    };
+    for (uint8_t s = 0; s < NUM_STAGES; s++)
+        if (s != TX_QUEUED)
+            add(getStageName((Stage)s), stages[s]);
+    add("rx_total", rxTotal);
+    add("tx_total", txTotal);
+    out += "]}";
+    return out;
+}
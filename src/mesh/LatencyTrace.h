@@ -0,0 +1,116 @@
+#pragma once
+
+#include "MeshTypes.h"
+#include <atomic>
+#include <string>
+
+/// Set to 1 (e.g. in userPrefs.jsonc) to time each packet's way from the radio to the phone and from the TX queue to the air
+#ifndef USERPREFS_LATENCY_TRACE
+#define USERPREFS_LATENCY_TRACE 0
+#endif
+
+/// How many packets can be on their way at once before the oldest one stops being traced
+#ifndef LATENCY_TRACE_SLOTS
+#define LATENCY_TRACE_SLOTS 16
+#endif
+
+#if USERPREFS_LATENCY_TRACE
+#define LATENCY_MARK(stage, p) latencyTrace.mark(LatencyTrace::stage, p)
+#define LATENCY_MARK_ISR() LatencyTrace::markIsr(micros())
+#else
+#define LATENCY_MARK(stage, p)
+#define LATENCY_MARK_ISR()
+#endif
+
+/**
+ * Log-linear histogram of microsecond values, four buckets per power of two as HdrHistogram does with two significant
+ * bits, so any value is off by at most 25%. Values from 2^24 us (16.7 s) on share the last bucket.
+ *
+ * Counters are updated with plain atomic loads and stores, no read-modify-write (which Cortex-M0 parts don't have), so
+ * recording never blocks. Two threads recording at the same instant may lose one count, which statistics can afford.
+ */
+class LatencyHistogram
+{
+  public:
+    static const uint8_t NUM_BUCKETS = 92;
+
+    void record(uint32_t us);
+
+    uint32_t getCount() const { return count.load(std::memory_order_relaxed); }
+    uint32_t getMax() const { return max.load(std::memory_order_relaxed); }
+    uint32_t getBucket(uint8_t bucket) const { return buckets[bucket].load(std::memory_order_relaxed); }
+
+    /// The highest value in the bucket holding the given percentile, 0 if nothing was recorded
+    uint32_t getPercentile(float percentile) const;
+
+    static uint8_t bucketOf(uint32_t us);
+    static uint32_t bucketStart(uint8_t bucket);
+
+  private:
+    std::atomic<uint32_t> buckets[NUM_BUCKETS] = {};
+    std::atomic<uint32_t> count{0};
+    std::atomic<uint32_t> max{0};
+};
+
+/**
+ * Where time goes on a packet's way through us. Each stage is timed from the stage before it that the same packet
+ * (known by from and id, so copies count as the same packet) reached, and the last stage of each direction also records
+ * the total.
+ *
+ * RX: radio interrupt, handleReceiveInterrupt, enqueueReceivedMessage, perhapsDecode, callModules, sendToPhone and a
+ * client taking it in getFromRadio. TX: RadioLibInterface::send enqueueing it, startSend and completeSending.
+ */
+class LatencyTrace
+{
+  public:
+    enum Stage : uint8_t {
+        RX_RADIO,      // From the interrupt to handleReceiveInterrupt having read it
+        RX_QUEUED,     // Handed to the router
+        RX_DECODED,    // Taken off the router's queue and decrypted
+        RX_MODULES,    // Done with by all modules
+        RX_TO_PHONE,   // Queued for the phone
+        RX_FROM_RADIO, // Taken by a client, ends the trace
+        TX_QUEUED,     // Starts the trace, so it has no time of its own
+        TX_STARTED,    // Out of the TX queue and onto the radio
+        TX_COMPLETED,  // On the air, ends the trace
+        NUM_STAGES
+    };
+
+    /// Called from the RX interrupt, the next packet read from the radio is timed from this
+    static void markIsr(uint32_t nowUs) { isrUs = nowUs ? nowUs : 1; }
+
+    void mark(Stage stage, const meshtastic_MeshPacket *p);
+    void mark(Stage stage, NodeNum from, PacketId id, uint32_t nowUs);
+
+    const LatencyHistogram &getStage(Stage stage) const { return stages[stage]; }
+    const LatencyHistogram &getRxTotal() const { return rxTotal; }
+    const LatencyHistogram &getTxTotal() const { return txTotal; }
+
+    /// {"stages":[{"name":..,"count":..,"p50":..,"p90":..,"p99":..,"max":..}]} in microseconds, totals included
+    std::string toJson() const;
+
+    static const char *getStageName(Stage stage);
+
+  private:
+    struct Trace {
+        NodeNum from;
+        PacketId id;
+        uint32_t startUs;
+        uint32_t lastUs;
+        bool tx;
+        bool active;
+    };
+    Trace traces[LATENCY_TRACE_SLOTS] = {};
+    uint8_t nextTrace = 0;
+
+    LatencyHistogram stages[NUM_STAGES];
+    LatencyHistogram rxTotal, txTotal;
+
+    static volatile uint32_t isrUs;
+
+    Trace *find(NodeNum from, PacketId id, bool tx);
+};
+
+#if USERPREFS_LATENCY_TRACE
+extern LatencyTrace latencyTrace;
+#endif
@@ -1,4 +1,5 @@
 #include "MeshModule.h"
+#include "BootTrace.h"
 #include "Channels.h"
 #include "MeshService.h"
 #include "NodeDB.h"
@@ -9,6 +10,10 @@
 
 std::vector<MeshModule *> *MeshModule::modules;
 
+ModuleDispatchIndex<MeshModule> *MeshModule::dispatchIndex;
+bool MeshModule::dispatchIndexDirty;
+uint8_t MeshModule::callModulesDepth;
+
 const meshtastic_MeshPacket *MeshModule::currentRequest;
 uint8_t MeshModule::numPeriodicModules = 0;
 
@@ -25,6 +30,8 @@ MeshModule::MeshModule(const char *_name) : name(_name)
         modules = new std::vector<MeshModule *>();
 
     modules->push_back(this);
+    dispatchIndexDirty = true;
+    bootTrace.module(name);
 }
 
 void MeshModule::setup() {}
@@ -34,6 +41,7 @@ MeshModule::~MeshModule()
     auto it = std::find(modules->begin(), modules->end(), this);
     assert(it != modules->end());
     modules->erase(it);
+    dispatchIndexDirty = true;
 }
 
 // ⚠️ **Only call once** to set the initial delay before a module starts broadcasting periodically
@@ -85,6 +93,21 @@ meshtastic_MeshPacket *MeshModule::allocErrorResponse(meshtastic_Routing_Error e
     return r;
 }
 
+const std::vector<MeshModule *> &MeshModule::getDispatchCandidates(const meshtastic_MeshPacket &mp, bool isDecoded)
+{
+    if (dispatchIndexDirty) {
+        // A module handling a packet may have sent one to us, don't pull the index out from under the outer call
+        if (callModulesDepth > 1)
+            return *modules;
+        delete dispatchIndex;
+        dispatchIndex = new ModuleDispatchIndex<MeshModule>();
+        for (MeshModule *m : *modules)
+            dispatchIndex->add(m, m->getDispatchPort(), m->encryptedOk);
+        dispatchIndexDirty = false;
+    }
+    return dispatchIndex->getCandidates(isDecoded, mp.decoded.portnum);
+}
+
 void MeshModule::callModules(meshtastic_MeshPacket &mp, RxSource src)
 {
     // LOG_DEBUG("In call modules");
@@ -101,7 +124,11 @@ void MeshModule::callModules(meshtastic_MeshPacket &mp, RxSource src)
     auto ourNodeNum = nodeDB->getNodeNum();
     bool toUs = isBroadcast(mp.to) || isToUs(&mp);
 
-    for (auto i = modules->begin(); i != modules->end(); ++i) {
+    // Only the modules that can want this portnum, in the order they registered
+    callModulesDepth++;
+    const std::vector<MeshModule *> &candidates = getDispatchCandidates(mp, isDecoded);
+
+    for (auto i = candidates.begin(); i != candidates.end(); ++i) {
         auto &pi = **i;
 
         pi.currentRequest = &mp;
@@ -178,6 +205,7 @@ void MeshModule::callModules(meshtastic_MeshPacket &mp, RxSource src)
 
         pi.currentRequest = NULL;
     }
+    callModulesDepth--;
 
     if (isDecoded && mp.decoded.want_response && toUs) {
         if (currentReply) {
@@ -2,6 +2,7 @@
 
 #include "mesh/Channels.h"
 #include "mesh/MeshTypes.h"
+#include "mesh/ModuleDispatchIndex.h"
 #include <vector>
 
 #if HAS_SCREEN
@@ -63,6 +64,13 @@ class MeshModule
 {
     static std::vector<MeshModule *> *modules;
 
+    /// The modules callModules() asks about each portnum, rebuilt on the first packet after modules come or go
+    static ModuleDispatchIndex<MeshModule> *dispatchIndex;
+    static bool dispatchIndexDirty;
+    static uint8_t callModulesDepth;
+
+    static const std::vector<MeshModule *> &getDispatchCandidates(const meshtastic_MeshPacket &mp, bool isDecoded);
+
   public:
     /** Constructor
      * name is for debugging output
@@ -144,6 +152,13 @@ class MeshModule
      */
     virtual bool wantPacket(const meshtastic_MeshPacket *p) = 0;
 
+    /**
+     * The only portnum wantPacket() can accept, so that callModules() doesn't have to ask about packets for other ports.
+     * Override wantPacket() to accept more than one port, or to look at every packet, and this must return anyPort.
+     * Read when callModules() rebuilds its index, after modules have registered.
+     */
+    virtual int32_t getDispatchPort() const { return ModuleDispatchIndex<MeshModule>::anyPort; }
+
     /** Called to handle a particular incoming message
 
     @return ProcessMessage::STOP if you've guaranteed you've handled this message and no other handlers should be considered for
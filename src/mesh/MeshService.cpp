@@ -6,10 +6,12 @@
 
 #include "../concurrency/Periodic.h"
 #include "BluetoothCommon.h" // needed for updateBatteryLevel, FIXME, eventually when we pull mesh out into a lib we shouldn't be whacking bluetooth from here
+#include "LatencyTrace.h"
 #include "MeshService.h"
 #include "NodeDB.h"
 #include "PowerFSM.h"
 #include "RTC.h"
+#include "Throttle.h"
 #include "TypeConversions.h"
 #include "main.h"
 #include "mesh-pb-constants.h"
@@ -118,6 +120,7 @@ void MeshService::loop()
         if (qs.free != lastQueueStatus.free)
             (void)sendQueueStatusToPhone(qs, 0, 0);
     }
+    reportPhoneQueueDrops();
     if (oldFromNum != fromNum) { // We don't want to generate extra notifies for multiple new packets
         int result = fromNumChanged.notifyObservers(fromNum);
         if (result == 0) // If any observer returns non-zero, we will try again
@@ -153,17 +156,7 @@ void MeshService::reloadOwner(bool shouldSave)
 // search the queue for a request id and return the matching nodenum
 NodeNum MeshService::getNodenumFromRequestId(uint32_t request_id)
 {
-    NodeNum nodenum = 0;
-    for (int i = 0; i < toPhoneQueue.numUsed(); i++) {
-        meshtastic_MeshPacket *p = toPhoneQueue.dequeuePtr(0);
-        if (p->id == request_id) {
-            nodenum = p->to;
-            // make sure to continue this to make one full loop
-        }
-        // put it right back on the queue
-        toPhoneQueue.enqueue(p, 0);
-    }
-    return nodenum;
+    return toPhoneQueue.findDestination(request_id);
 }
 
 /**
@@ -282,6 +275,7 @@ bool MeshService::trySendPosition(NodeNum dest, bool wantReplies)
 
 void MeshService::sendToPhone(meshtastic_MeshPacket *p)
 {
+    LATENCY_MARK(RX_TO_PHONE, p);
     perhapsDecode(p);
 
 #ifdef ARCH_ESP32
@@ -295,28 +289,38 @@ void MeshService::sendToPhone(meshtastic_MeshPacket *p)
 #endif
 #endif
 
-    if (toPhoneQueue.numFree() == 0) {
-        if (p->decoded.portnum == meshtastic_PortNum_TEXT_MESSAGE_APP ||
-            p->decoded.portnum == meshtastic_PortNum_RANGE_TEST_APP) {
-            LOG_WARN("ToPhone queue is full, discard oldest");
-            meshtastic_MeshPacket *d = toPhoneQueue.dequeuePtr(0);
-            if (d)
-                releaseToPool(d);
-        } else {
-            LOG_WARN("ToPhone queue is full, drop packet");
-            releaseToPool(p);
-            fromNum++; // Make sure to notify observers in case they are reconnected so they can get the packets
-            return;
-        }
-    }
-
-    if (toPhoneQueue.enqueue(p, 0) == false) {
-        LOG_CRIT("Failed to queue a packet into toPhoneQueue!");
-        abort();
-    }
+    // Dropped, evicted or replaced, we still notify observers in case they are reconnected so they can get the packets
+    meshtastic_MeshPacket *d = toPhoneQueue.enqueue(p);
+    if (d)
+        releaseToPool(d);
     fromNum++;
 }
 
+void MeshService::reportPhoneQueueDrops()
+{
+    uint32_t dropped = toPhoneQueue.getTotalDropped();
+    if (dropped == reportedPhoneDrops || (lastPhoneDropReport && Throttle::isWithinTimespanMs(lastPhoneDropReport, 60 * 1000)))
+        return;
+
+    PhoneQueue::PortStats stats[PHONE_QUEUE_STAT_PORTS];
+    size_t n = toPhoneQueue.getStats(stats, PHONE_QUEUE_STAT_PORTS);
+    meshtastic_ClientNotification *cn = clientNotificationPool.allocZeroed();
+    if (!cn)
+        return;
+    cn->level = meshtastic_LogRecord_Level_WARNING;
+    cn->time = getValidTime(RTCQualityFromNet);
+    int len = snprintf(cn->message, sizeof(cn->message), "Phone queue dropped %u packets (port:dropped/replaced)",
+                       (unsigned)(dropped - reportedPhoneDrops));
+    for (size_t i = 0; i < n && len > 0 && (size_t)len < sizeof(cn->message); i++)
+        len += snprintf(cn->message + len, sizeof(cn->message) - len, " %u:%u/%u", stats[i].port, (unsigned)stats[i].dropped,
+                        (unsigned)stats[i].coalesced);
+    LOG_WARN("%s", cn->message);
+    sendClientNotification(cn);
+
+    reportedPhoneDrops = dropped;
+    lastPhoneDropReport = millis();
+}
+
 void MeshService::sendMqttMessageToClientProxy(meshtastic_MqttClientProxyMessage *m)
 {
     LOG_DEBUG("Send mqtt message on topic '%s' to client for proxy", m->topic);
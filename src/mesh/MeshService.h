@@ -2,6 +2,7 @@
 
 #include <Arduino.h>
 #include <assert.h>
+#include <atomic>
 #include <string>
 
 #include "GPSStatus.h"
@@ -9,6 +10,7 @@
 #include "MeshRadio.h"
 #include "MeshTypes.h"
 #include "Observer.h"
+#include "PhoneQueue.h"
 #include "PointerQueue.h"
 #if defined(ARCH_PORTDUINO)
 #include "../platform/portduino/SimRadio.h"
@@ -33,11 +35,14 @@ class MeshService
     CallbackObserver<MeshService, const meshtastic::GPSStatus *> gpsObserver =
         CallbackObserver<MeshService, const meshtastic::GPSStatus *>(this, &MeshService::onGPSChanged);
 #endif
-    /// received packets waiting for the phone to process them
-    /// FIXME, change to a DropOldestQueue and keep a count of the number of dropped packets to ensure
-    /// we never hang because android hasn't been there in a while
+    /// received packets waiting for the phone to process them, bounded with a drop policy per port so we never hang
+    /// because android hasn't been there in a while
     /// FIXME - save this to flash on deep sleep
-    PointerQueue<meshtastic_MeshPacket> toPhoneQueue;
+    PhoneQueue toPhoneQueue;
+
+    /// toPhoneQueue drops the client has been told about, and when
+    uint32_t reportedPhoneDrops = 0;
+    uint32_t lastPhoneDropReport = 0;
 
     // keep list of QueueStatus packets to be send to the phone
     PointerQueue<meshtastic_QueueStatus> toPhoneQueueStatusQueue;
@@ -57,6 +62,9 @@ class MeshService
     /// Updated in loop() to detect when fromNum changes
     uint32_t oldFromNum = 0;
 
+    /// API clients (BLE, serial, TCP, ...) that have asked for the config and not closed since
+    std::atomic<int> numClientsConnected{0};
+
   public:
     static bool isTextPayload(const meshtastic_MeshPacket *p)
     {
@@ -82,7 +90,18 @@ class MeshService
 
     /// Return the next packet destined to the phone.  FIXME, somehow use fromNum to allow the phone to retry the
     /// last few packets if needs to.
-    meshtastic_MeshPacket *getForPhone() { return toPhoneQueue.dequeuePtr(0); }
+    meshtastic_MeshPacket *getForPhone() { return toPhoneQueue.dequeue(); }
+
+    /// Per port counts of packets the phone queue dropped or coalesced, returns how many ports were filled in
+    size_t getPhoneQueueStats(PhoneQueue::PortStats *out, size_t max) { return toPhoneQueue.getStats(out, max); }
+
+    /// Packets waiting for the phone, and those dropped since boot
+    size_t getPhoneQueueDepth() { return toPhoneQueue.numUsed(); }
+    uint32_t getPhoneQueueDropped() { return toPhoneQueue.getTotalDropped(); }
+
+    /// PhoneAPI reports its clients coming and going
+    void setClientConnected(bool connected) { numClientsConnected += connected ? 1 : -1; }
+    bool isClientConnected() { return numClientsConnected > 0; }
 
     /// Allows the bluetooth handler to free packets after they have been sent
     void releaseToPool(meshtastic_MeshPacket *p) { packetPool.release(p); }
@@ -166,6 +185,9 @@ class MeshService
     /// Handle a packet that just arrived from the radio.  This method does _not_ free the provided packet.  If it
     /// needs to keep the packet around it makes a copy
     int handleFromRadio(const meshtastic_MeshPacket *p);
+
+    /// Tell the client which packets the phone queue had to drop since we last told it, at most once a minute
+    void reportPhoneQueueDrops();
     friend class RoutingModule;
 };
 
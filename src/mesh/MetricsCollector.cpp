@@ -0,0 +1,107 @@
+#include "MetricsCollector.h"
+#include "MeshService.h"
+#include "NodeDB.h"
+#include "RadioLibInterface.h"
+#include "Router.h"
+#include "TopologyGraph.h"
+#include "airtime.h"
+#include "configuration.h"
+#if !MESHTASTIC_EXCLUDE_MQTT
+#include "mqtt/MQTT.h"
+#endif
+
+MetricsCollector *metricsCollector = NULL;
+
+#if USERPREFS_LATENCY_TRACE
+static char stageLabels[LatencyTrace::NUM_STAGES][32];
+#endif
+
+static void setMetric(MetricsRegistry::Metric *m, double v)
+{
+    if (m) // NULL if the registry was full
+        m->set(v);
+}
+
+MetricsCollector::MetricsCollector() : concurrency::OSThread("MetricsCollector")
+{
+    MetricsRegistry &r = registry;
+    rxGood = r.add(MetricsRegistry::COUNTER, "meshtastic_rx_good_total", "Packets received from the radio intact");
+    rxBad = r.add(MetricsRegistry::COUNTER, "meshtastic_rx_bad_total", "Packets received from the radio with errors");
+    txGood = r.add(MetricsRegistry::COUNTER, "meshtastic_tx_good_total", "Packets transmitted");
+    txRelay = r.add(MetricsRegistry::COUNTER, "meshtastic_tx_relay_total", "Packets transmitted for other nodes");
+    rxDupe = r.add(MetricsRegistry::COUNTER, "meshtastic_rx_dupe_total", "Packets ignored as already seen");
+    txRelayCanceled =
+        r.add(MetricsRegistry::COUNTER, "meshtastic_tx_relay_canceled_total", "Relays canceled because others relayed first");
+    rxQueueOverflows = r.add(MetricsRegistry::COUNTER, "meshtastic_rx_queue_overflows_total",
+                             "Packets from the radio dropped because the router fell behind");
+    rxQueueHighWater =
+        r.add(MetricsRegistry::GAUGE, "meshtastic_rx_queue_high_water", "Most packets ever waiting for the router at once");
+    txQueueFree = r.add(MetricsRegistry::GAUGE, "meshtastic_tx_queue_free", "Free slots in the radio TX queue");
+    txQueueSize = r.add(MetricsRegistry::GAUGE, "meshtastic_tx_queue_size", "Slots in the radio TX queue");
+    phoneQueueDepth = r.add(MetricsRegistry::GAUGE, "meshtastic_phone_queue_depth", "Packets waiting for the client");
+    phoneQueueDropped = r.add(MetricsRegistry::COUNTER, "meshtastic_phone_queue_dropped_total",
+                              "Packets for the client dropped for lack of room");
+#if !MESHTASTIC_EXCLUDE_MQTT
+    mqttQueueDepth = r.add(MetricsRegistry::GAUGE, "meshtastic_mqtt_queue_depth", "Envelopes waiting for the MQTT broker");
+#else
+    mqttQueueDepth = NULL;
+#endif
+    channelUtilization = r.add(MetricsRegistry::GAUGE, "meshtastic_channel_utilization_percent",
+                               "Share of the last minute the channel was busy");
+    recentChannelUtilization = r.add(MetricsRegistry::GAUGE, "meshtastic_channel_utilization_recent_percent",
+                                     "Share of the last seconds the channel was busy");
+    txUtilization =
+        r.add(MetricsRegistry::GAUGE, "meshtastic_tx_utilization_percent", "Share of the last hour spent transmitting");
+    nodes = r.add(MetricsRegistry::GAUGE, "meshtastic_nodes", "Nodes in the NodeDB");
+    topologyEdges = r.add(MetricsRegistry::GAUGE, "meshtastic_topology_edges", "Links in the topology graph");
+    uptime = r.add(MetricsRegistry::COUNTER, "meshtastic_uptime_seconds_total", "Seconds since boot");
+
+#if USERPREFS_LATENCY_TRACE
+    for (uint8_t s = 0; s < LatencyTrace::NUM_STAGES; s++) {
+        if (s == LatencyTrace::TX_QUEUED)
+            continue; // Starts the trace, has no time of its own
+        snprintf(stageLabels[s], sizeof(stageLabels[s]), "stage=\"%s\"", LatencyTrace::getStageName((LatencyTrace::Stage)s));
+        r.addHistogram("meshtastic_packet_stage_seconds", "Time packets spend reaching each stage from the one before",
+                       &latencyTrace.getStage((LatencyTrace::Stage)s), stageLabels[s]);
+    }
+    r.addHistogram("meshtastic_packet_latency_seconds", "Time from the radio to a client, and from the TX queue to the air",
+                   &latencyTrace.getRxTotal(), "direction=\"rx\"");
+    r.addHistogram("meshtastic_packet_latency_seconds", "Time from the radio to a client, and from the TX queue to the air",
+                   &latencyTrace.getTxTotal(), "direction=\"tx\"");
+#endif
+}
+
+int32_t MetricsCollector::runOnce()
+{
+    if (RadioLibInterface::instance) {
+        setMetric(rxGood, RadioLibInterface::instance->rxGood);
+        setMetric(rxBad, RadioLibInterface::instance->rxBad);
+        setMetric(txGood, RadioLibInterface::instance->txGood);
+        setMetric(txRelay, RadioLibInterface::instance->txRelay);
+    }
+    if (router) {
+        setMetric(rxDupe, router->rxDupe);
+        setMetric(txRelayCanceled, router->txRelayCanceled);
+        setMetric(rxQueueOverflows, router->getRxQueueOverflows());
+        setMetric(rxQueueHighWater, router->getRxQueueHighWater());
+        meshtastic_QueueStatus qs = router->getQueueStatus();
+        setMetric(txQueueFree, qs.free);
+        setMetric(txQueueSize, qs.maxlen);
+    }
+    if (service) {
+        setMetric(phoneQueueDepth, service->getPhoneQueueDepth());
+        setMetric(phoneQueueDropped, service->getPhoneQueueDropped());
+    }
+#if !MESHTASTIC_EXCLUDE_MQTT
+    setMetric(mqttQueueDepth, mqtt ? mqtt->getQueueDepth() : 0);
+#endif
+    if (airTime) {
+        setMetric(channelUtilization, airTime->channelUtilizationPercent());
+        setMetric(recentChannelUtilization, airTime->channelUtilizationRecentPercent());
+        setMetric(txUtilization, airTime->utilizationTXPercent());
+    }
+    setMetric(nodes, nodeDB->getNumMeshNodes());
+    setMetric(topologyEdges, topologyGraph.getNumEdges());
+    setMetric(uptime, millis() / 1000);
+    return METRICS_SAMPLE_INTERVAL_MS;
+}
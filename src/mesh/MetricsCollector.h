@@ -0,0 +1,33 @@
+#pragma once
+
+#include "MetricsRegistry.h"
+#include "concurrency/OSThread.h"
+
+/// How often the counters of the router, radio and queues are copied into the registry
+#ifndef METRICS_SAMPLE_INTERVAL_MS
+#define METRICS_SAMPLE_INTERVAL_MS 2000
+#endif
+
+/**
+ * Copies the counters and queue levels that only the main loop may read into a MetricsRegistry, so that web server
+ * threads can render them at any time without touching the router, radio or queues themselves. Histograms of the
+ * LatencyTrace, when it is enabled, are read directly since they are kept lock-free anyway.
+ */
+class MetricsCollector : private concurrency::OSThread
+{
+  public:
+    MetricsCollector();
+
+    MetricsRegistry registry;
+
+  protected:
+    virtual int32_t runOnce() override;
+
+  private:
+    MetricsRegistry::Metric *rxGood, *rxBad, *txGood, *txRelay, *rxDupe, *txRelayCanceled;
+    MetricsRegistry::Metric *rxQueueOverflows, *rxQueueHighWater, *txQueueFree, *txQueueSize;
+    MetricsRegistry::Metric *phoneQueueDepth, *phoneQueueDropped, *mqttQueueDepth;
+    MetricsRegistry::Metric *channelUtilization, *recentChannelUtilization, *txUtilization, *nodes, *topologyEdges, *uptime;
+};
+
+extern MetricsCollector *metricsCollector;
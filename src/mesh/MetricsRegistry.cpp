@@ -0,0 +1,81 @@
+#include "MetricsRegistry.h"
+#include <stdio.h>
+#include <string.h>
+
+MetricsRegistry::Metric *MetricsRegistry::add(Type type, const char *name, const char *help, const char *labels)
+{
+    return registerMetric(type, name, help, labels, NULL);
+}
+
+MetricsRegistry::Metric *MetricsRegistry::addHistogram(const char *name, const char *help, const LatencyHistogram *h,
+                                                       const char *labels)
+{
+    return registerMetric(HISTOGRAM, name, help, labels, h);
+}
+
+MetricsRegistry::Metric *MetricsRegistry::registerMetric(Type type, const char *name, const char *help, const char *labels,
+                                                         const LatencyHistogram *h)
+{
+    size_t n = numMetrics.load(std::memory_order_relaxed);
+    if (n >= METRICS_MAX)
+        return NULL;
+    Metric &m = metrics[n];
+    m.name = name;
+    m.labels = labels;
+    m.help = help;
+    m.type = type;
+    m.histogram = h;
+    numMetrics.store(n + 1, std::memory_order_release); // Only now may render() see it
+    return &m;
+}
+
+void MetricsRegistry::renderHistogram(std::string &out, const Metric &m) const
+{
+    const LatencyHistogram &h = *m.histogram;
+    std::string labels = m.labels ? std::string(m.labels) + "," : "";
+    std::string braced = m.labels ? "{" + std::string(m.labels) + "}" : "";
+    char line[160];
+
+    // One bucket per power of two is plenty for a dashboard, the sum is estimated from the middle of each bucket
+    uint32_t cumulative = 0;
+    double sumUs = 0;
+    for (uint8_t i = 0; i < LatencyHistogram::NUM_BUCKETS; i++) {
+        if (i && i % 4 == 0) {
+            snprintf(line, sizeof(line), "%s_bucket{%sle=\"%.9g\"} %u\n", m.name, labels.c_str(),
+                     LatencyHistogram::bucketStart(i) / 1e6, cumulative);
+            out += line;
+        }
+        uint32_t count = h.getBucket(i);
+        uint32_t end = i + 1 < LatencyHistogram::NUM_BUCKETS ? LatencyHistogram::bucketStart(i + 1) : h.getMax() + 1;
+        cumulative += count;
+        sumUs += count * (LatencyHistogram::bucketStart(i) + end) / 2.0;
+    }
+    snprintf(line, sizeof(line), "%s_bucket{%sle=\"+Inf\"} %u\n", m.name, labels.c_str(), cumulative);
+    out += line;
+    snprintf(line, sizeof(line), "%s_sum%s %.6g\n%s_count%s %u\n", m.name, braced.c_str(), sumUs / 1e6, m.name,
+             braced.c_str(), cumulative);
+    out += line;
+}
+
+std::string MetricsRegistry::render() const
+{
+    static const char *typeNames[] = {"counter", "gauge", "histogram"};
+    std::string out;
+    char line[256];
+    size_t n = getNumMetrics();
+    for (size_t i = 0; i < n; i++) {
+        const Metric &m = metrics[i];
+        if (i == 0 || strcmp(metrics[i - 1].name, m.name) != 0) {
+            snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s %s\n", m.name, m.help, m.name, typeNames[m.type]);
+            out += line;
+        }
+        if (m.type == HISTOGRAM) {
+            renderHistogram(out, m);
+        } else {
+            snprintf(line, sizeof(line), "%s%s%s%s %.10g\n", m.name, m.labels ? "{" : "", m.labels ? m.labels : "",
+                     m.labels ? "}" : "", m.get());
+            out += line;
+        }
+    }
+    return out;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "LatencyTrace.h"
+#include <atomic>
+#include <stdint.h>
+#include <string>
+
+/// How many metrics (each label set counts as one) the registry can hold
+#ifndef METRICS_MAX
+#define METRICS_MAX 64
+#endif
+
+/**
+ * Metrics for monitoring, rendered in the Prometheus text exposition format (which OpenMetrics parsers accept).
+ *
+ * Metrics are registered once, from one thread, and never removed. After that, setting a value and rendering are plain
+ * atomic loads and stores, so a scrape from a web server thread never waits for whoever updates the values and never
+ * makes them wait. A registered metric is only made visible to render() once it is fully filled in.
+ */
+class MetricsRegistry
+{
+  public:
+    enum Type : uint8_t { COUNTER, GAUGE, HISTOGRAM };
+
+    class Metric
+    {
+      public:
+        void set(double v) { value.store(v, std::memory_order_relaxed); }
+        double get() const { return value.load(std::memory_order_relaxed); }
+
+      private:
+        friend class MetricsRegistry;
+        const char *name;
+        const char *labels; // Like stage="rx_radio", or NULL
+        const char *help;
+        Type type;
+        std::atomic<double> value{0};
+        const LatencyHistogram *histogram; // Microseconds, exposed in seconds
+    };
+
+    /**
+     * Register a counter or gauge. Metrics sharing a name but not labels must be registered one after the other, with the
+     * same help and type, so they render as one family.
+     * @return NULL if the registry is full
+     */
+    Metric *add(Type type, const char *name, const char *help, const char *labels = NULL);
+
+    /// Register a histogram backed by h, which is read as it is at each scrape
+    Metric *addHistogram(const char *name, const char *help, const LatencyHistogram *h, const char *labels = NULL);
+
+    size_t getNumMetrics() const { return numMetrics.load(std::memory_order_acquire); }
+
+    std::string render() const;
+
+  private:
+    Metric metrics[METRICS_MAX];
+    std::atomic<size_t> numMetrics{0};
+
+    Metric *registerMetric(Type type, const char *name, const char *help, const char *labels, const LatencyHistogram *h);
+    void renderHistogram(std::string &out, const Metric &m) const;
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * Which modules MeshModule::callModules() has to ask about a packet, so that it doesn't ask every module about every packet.
+ *
+ * Modules are added in registration order, each with the one portnum its wantPacket() can accept or anyPort if it has to
+ * see every packet. The candidates for a portnum are the modules bound to it plus every any-port module, kept in
+ * registration order so that modules are still called in the same order as before. Candidates are only a superset: each
+ * one's wantPacket() is still asked.
+ */
+template <class T> class ModuleDispatchIndex
+{
+  public:
+    static const int32_t anyPort = -1;
+
+    void add(T *module, int32_t port, bool encryptedOk)
+    {
+        if (port == anyPort) {
+            for (auto &list : lists)
+                list.push_back(module);
+        } else {
+            if ((size_t)port >= listForPort.size())
+                listForPort.resize(port + 1, 0);
+            if (!listForPort[port]) {
+                listForPort[port] = lists.size();
+                lists.push_back(lists[0]); // The any-port modules registered so far come first
+            }
+            lists[listForPort[port]].push_back(module);
+        }
+        if (encryptedOk)
+            encryptedModules.push_back(module);
+    }
+
+    /// The modules to ask about a packet, encrypted ones only go to modules that accept them whatever their port
+    const std::vector<T *> &getCandidates(bool isDecoded, uint32_t port) const
+    {
+        if (!isDecoded)
+            return encryptedModules;
+        return lists[port < listForPort.size() ? listForPort[port] : 0];
+    }
+
+  private:
+    /// lists[0] is the any-port modules, the rest are one per bound portnum with the any-port modules merged in
+    std::vector<std::vector<T *>> lists = std::vector<std::vector<T *>>(1);
+    /// Portnums are small, so look their list up directly, 0 for one no module is bound to
+    std::vector<uint16_t> listForPort;
+    std::vector<T *> encryptedModules;
+};
@@ -1,4 +1,5 @@
 #include "NextHopRouter.h"
+#include "TopologyGraph.h"
 
 NextHopRouter::NextHopRouter() {}
 
@@ -89,6 +90,18 @@ void NextHopRouter::sniffReceived(const meshtastic_MeshPacket *p, const meshtast
         }
     }
 
+    // Whoever we heard this from directly is a neighbour: the sender if no hops were used, otherwise the relayer if we can
+    // tell which node it was from its last byte
+    if (p->transport_mechanism == meshtastic_MeshPacket_TransportMechanism_TRANSPORT_LORA && !isFromUs(p)) {
+        NodeNum heardFrom = 0;
+        if (p->hop_start != 0 && p->hop_start == p->hop_limit)
+            heardFrom = getFrom(p);
+        else if (p->relay_node != NO_RELAY_NODE)
+            heardFrom = topologyGraph.findNeighborByRelayByte(ourNodeNum, p->relay_node, millis());
+        if (heardFrom)
+            topologyGraph.addEdge(heardFrom, ourNodeNum, TopologyGraph::toQuarterDb(p->rx_snr), TopologyGraph::HEARD, millis());
+    }
+
     perhapsRelay(p);
 
     // handle the packet as normal
@@ -101,7 +114,7 @@ bool NextHopRouter::perhapsRelay(const meshtastic_MeshPacket *p)
     if (!isToUs(p) && !isFromUs(p) && p->hop_limit > 0) {
         if (p->next_hop == NO_NEXT_HOP_PREFERENCE || p->next_hop == nodeDB->getLastByteOfNodeNum(getNodeNum())) {
             if (isRebroadcaster()) {
-                meshtastic_MeshPacket *tosend = packetPool.allocCopy(*p); // keep a copy because we will be sending it
+                meshtastic_MeshPacket *tosend = allocRelayCopy(p); // keep a copy because we will be sending it
                 LOG_INFO("Relaying received message coming from %x", p->relay_node);
 
                 tosend->hop_limit--; // bump down the hop count
@@ -135,7 +148,28 @@ uint8_t NextHopRouter::getNextHop(NodeNum to, uint8_t relay_node)
             return node->next_hop;
         } else
             LOG_WARN("Next hop for 0x%x is 0x%x, same as relayer; set no pref", to, node->next_hop);
+        return NO_NEXT_HOP_PREFERENCE;
+    }
+
+#if USERPREFS_TOPOLOGY_NEXT_HOP
+    // Nothing learned from ACKs yet, so try the cheapest path the topology graph knows of, as long as it starts with a
+    // neighbour we heard ourselves, that can be told apart from the others by its last byte and that relays
+    NodeNum ourNodeNum = getNodeNum();
+    NodeNum firstHop = topologyGraph.getFirstHop(ourNodeNum, to, millis());
+    if (firstHop) {
+        meshtastic_NodeInfoLite *hopNode = nodeDB->getMeshNode(firstHop);
+        if (firstHop != to && hopNode && hopNode->has_user &&
+            hopNode->user.role == meshtastic_Config_DeviceConfig_Role_CLIENT_MUTE) {
+            LOG_DEBUG("Topology graph next hop 0x%x for 0x%x doesn't relay", firstHop, to);
+            return NO_NEXT_HOP_PREFERENCE;
+        }
+        uint8_t hop = nodeDB->getLastByteOfNodeNum(firstHop);
+        if (hop != relay_node && topologyGraph.findNeighborByRelayByte(ourNodeNum, hop, millis()) == firstHop) {
+            LOG_DEBUG("Next hop for 0x%x is 0x%x from the topology graph", to, hop);
+            return hop;
+        }
     }
+#endif
     return NO_NEXT_HOP_PREFERENCE;
 }
 
@@ -232,6 +266,12 @@ int32_t NextHopRouter::doRetransmissions()
                 if (!isBroadcast(p.packet->to)) {
                     if (p.numRetransmissions == 1) {
                         // Last retransmission, reset next_hop (fallback to FloodingRouter)
+#if USERPREFS_TOPOLOGY_NEXT_HOP
+                        // The link to the next hop we tried failed us, so don't route over it again until we hear it anew
+                        NodeNum triedHop = topologyGraph.findNeighborByRelayByte(getNodeNum(), p.packet->next_hop, millis());
+                        if (p.packet->next_hop != NO_NEXT_HOP_PREFERENCE && triedHop)
+                            topologyGraph.removeLink(getNodeNum(), triedHop);
+#endif
                         p.packet->next_hop = NO_NEXT_HOP_PREFERENCE;
                         // Also reset it in the nodeDB
                         meshtastic_NodeInfoLite *sentTo = nodeDB->getMeshNode(p.packet->to);
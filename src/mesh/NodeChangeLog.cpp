@@ -0,0 +1,55 @@
+#include "NodeChangeLog.h"
+
+NodeChangeLog::NodeChangeLog(uint32_t base) : current(base), floor(base) {}
+
+uint32_t NodeChangeLog::bump()
+{
+    // Only reachable after billions of changes, start over rather than wrap so that versions keep increasing for clients
+    if (current == UINT32_MAX)
+        reset();
+    return ++current;
+}
+
+void NodeChangeLog::touch(NodeNum num)
+{
+    versions[num] = bump();
+}
+
+void NodeChangeLog::remove(NodeNum num)
+{
+    versions.erase(num);
+    Tombstone &t = tombstones[numTombstones % NODE_TOMBSTONES];
+    if (numTombstones >= NODE_TOMBSTONES)
+        floor = t.version; // Clients that synced before this removal can no longer be told about it
+    t.num = num;
+    t.version = bump();
+    numTombstones++;
+}
+
+void NodeChangeLog::reset()
+{
+    versions.clear();
+    numTombstones = 0;
+    if (current == UINT32_MAX)
+        current = 0;
+    floor = ++current;
+}
+
+bool NodeChangeLog::changedSince(NodeNum num, uint32_t since) const
+{
+    auto it = versions.find(num);
+    return (it == versions.end() ? floor : it->second) > since;
+}
+
+bool NodeChangeLog::readNextTombstone(uint32_t &readIndex, uint32_t since, NodeNum &num) const
+{
+    uint32_t kept = numTombstones < NODE_TOMBSTONES ? numTombstones : NODE_TOMBSTONES;
+    while (readIndex < kept) {
+        const Tombstone &t = tombstones[(numTombstones - kept + readIndex++) % NODE_TOMBSTONES];
+        if (t.version > since) {
+            num = t.num;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "MeshTypes.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <unordered_map>
+
+/// Number of removed nodes remembered for clients syncing incrementally
+#ifndef NODE_TOMBSTONES
+#define NODE_TOMBSTONES 32
+#endif
+
+/**
+ * Change versions for the nodes in the NodeDB, so an API client that already holds our node list can be sent just the nodes
+ * that changed since it last synced.
+ *
+ * A single counter is bumped on every change and the node that changed is stamped with it. Nodes we have not stamped are
+ * treated as changed at the start of the log (floor), so nothing needs doing for the nodes loaded at boot. Removed nodes are
+ * remembered as tombstones in a small ring; when a tombstone falls off the ring, or the whole DB is reset, the floor moves up
+ * and clients that synced before it have to fetch the whole list again.
+ *
+ * The counter starts at a random value so that a version a client kept from before a reboot is very unlikely to fall inside
+ * the range of this boot.
+ */
+class NodeChangeLog
+{
+  public:
+    explicit NodeChangeLog(uint32_t base = 1);
+
+    /// Version of the most recent change
+    uint32_t version() const { return current; }
+
+    /// Stamp a node that was added or changed
+    void touch(NodeNum num);
+
+    /// Forget a node and leave a tombstone for it
+    void remove(NodeNum num);
+
+    /// Forget everything, used when the whole DB is replaced
+    void reset();
+
+    /// True if a client that saw everything up to `since` can be brought up to date from this log
+    bool canSyncSince(uint32_t since) const { return since >= floor && since <= current; }
+
+    /// True if `num` changed after `since`
+    bool changedSince(NodeNum num, uint32_t since) const;
+
+    /**
+     * Get the next node removed after `since`, oldest first. Start with readIndex = 0.
+     * @return false when there are no more
+     */
+    bool readNextTombstone(uint32_t &readIndex, uint32_t since, NodeNum &num) const;
+
+  private:
+    struct Tombstone {
+        NodeNum num;
+        uint32_t version;
+    };
+
+    uint32_t current;
+    uint32_t floor;
+    std::unordered_map<NodeNum, uint32_t> versions;
+    Tombstone tombstones[NODE_TOMBSTONES] = {};
+    uint32_t numTombstones = 0; // Total ever added since the last reset, the ring holds the newest NODE_TOMBSTONES
+
+    uint32_t bump();
+};
@@ -24,6 +24,7 @@
 #include "Router.h"
 #include "SPILock.h"
 #include "SafeFile.h"
+#include "SaveScheduler.h"
 #include "TypeConversions.h"
 #include "error.h"
 #include "main.h"
@@ -210,6 +211,9 @@ NodeDB::NodeDB() {
   LOG_INFO("Init NodeDB");
   loadFromDisk();
   cleanupMeshDB();
+  rebuildSpatialIndex();
+  // Start change versions at a random point, so versions clients kept from a previous boot are not mistaken for ours
+  changeLog = NodeChangeLog(random(1, INT32_MAX));
 
   uint32_t devicestateCRC  = crc32Buffer(&devicestate, sizeof(devicestate));
   uint32_t nodeDatabaseCRC = crc32Buffer(&nodeDatabase, sizeof(nodeDatabase));
@@ -534,6 +538,8 @@ void NodeDB::installDefaultNodeDatabase() {
   nodeDatabase.nodes   = std::vector<meshtastic_NodeInfoLite>(MAX_NUM_NODES);
   numMeshNodes         = 0;
   meshNodes            = &nodeDatabase.nodes;
+  spatialIndex.clear();
+  changeLog.reset();
 }
 
 void NodeDB::installDefaultConfig(bool preserveKey = false) {
@@ -1060,6 +1066,8 @@ void NodeDB::resetNodes() {
     clearLocalPosition();
   numMeshNodes = 1;
   std::fill(nodeDatabase.nodes.begin() + 1, nodeDatabase.nodes.end(), meshtastic_NodeInfoLite());
+  rebuildSpatialIndex();
+  changeLog.reset();
   devicestate.has_rx_text_message = false;
   devicestate.has_rx_waypoint     = false;
   saveNodeDatabaseToDisk();
@@ -1080,8 +1088,11 @@ void NodeDB::removeNodeByNum(NodeNum nodeNum) {
   std::fill(nodeDatabase.nodes.begin() + numMeshNodes,
             nodeDatabase.nodes.begin() + numMeshNodes + 1,
             meshtastic_NodeInfoLite());
+  spatialIndex.remove(nodeNum);
+  if (removed)
+    changeLog.remove(nodeNum);
   LOG_DEBUG("NodeDB::removeNodeByNum purged %d entries. Save changes", removed);
-  saveNodeDatabaseToDisk();
+  saveToDiskSoon(SEGMENT_NODEDATABASE);
 }
 
 void NodeDB::clearLocalPosition() {
@@ -1091,6 +1102,9 @@ void NodeDB::clearLocalPosition() {
   node->position.altitude       = 0;
   node->position.time           = 0;
   setLocalPosition(meshtastic_Position_init_default);
+  spatialIndex.remove(node->num);
+  spatialIndex.clearOrigin();
+  changeLog.touch(node->num);
 }
 
 void NodeDB::cleanupMeshDB() {
@@ -1187,6 +1201,7 @@ void NodeDB::pickNewNodeNum() {
   LOG_DEBUG("Use nodenum 0x%x ", nodeNum);
 
   myNodeInfo.my_node_num = nodeNum;
+  spatialIndex.remove(nodeNum);  // Indexed while our nodenum was still unknown
 }
 
 /** Load a protobuf from a file, return LoadFileResult */
@@ -1518,6 +1533,32 @@ bool NodeDB::saveNodeDatabaseToDisk() {
       nodeDatabaseFileName, nodeDatabaseSize, &meshtastic_NodeDatabase_msg, &nodeDatabase, false);
 }
 
+void NodeDB::setConfigPresent() {
+  config.has_device    = true;
+  config.has_display   = true;
+  config.has_lora      = true;
+  config.has_position  = true;
+  config.has_power     = true;
+  config.has_network   = true;
+  config.has_bluetooth = true;
+  config.has_security  = true;
+}
+
+void NodeDB::setModuleConfigPresent() {
+  moduleConfig.has_canned_message        = true;
+  moduleConfig.has_external_notification = true;
+  moduleConfig.has_mqtt                  = true;
+  moduleConfig.has_range_test            = true;
+  moduleConfig.has_serial                = true;
+  moduleConfig.has_store_forward         = true;
+  moduleConfig.has_telemetry             = true;
+  moduleConfig.has_neighbor_info         = true;
+  moduleConfig.has_detection_sensor      = true;
+  moduleConfig.has_ambient_lighting      = true;
+  moduleConfig.has_audio                 = true;
+  moduleConfig.has_paxcounter            = true;
+}
+
 bool NodeDB::saveToDiskNoRetry(int saveWhat) {
   bool success = true;
 #ifdef FSCom
@@ -1526,32 +1567,14 @@ bool NodeDB::saveToDiskNoRetry(int saveWhat) {
   spiLock->unlock();
 #endif
   if (saveWhat & SEGMENT_CONFIG) {
-    config.has_device    = true;
-    config.has_display   = true;
-    config.has_lora      = true;
-    config.has_position  = true;
-    config.has_power     = true;
-    config.has_network   = true;
-    config.has_bluetooth = true;
-    config.has_security  = true;
+    setConfigPresent();
 
     success &= saveProto(
         configFileName, meshtastic_LocalConfig_size, &meshtastic_LocalConfig_msg, &config);
   }
 
   if (saveWhat & SEGMENT_MODULECONFIG) {
-    moduleConfig.has_canned_message        = true;
-    moduleConfig.has_external_notification = true;
-    moduleConfig.has_mqtt                  = true;
-    moduleConfig.has_range_test            = true;
-    moduleConfig.has_serial                = true;
-    moduleConfig.has_store_forward         = true;
-    moduleConfig.has_telemetry             = true;
-    moduleConfig.has_neighbor_info         = true;
-    moduleConfig.has_detection_sensor      = true;
-    moduleConfig.has_ambient_lighting      = true;
-    moduleConfig.has_audio                 = true;
-    moduleConfig.has_paxcounter            = true;
+    setModuleConfigPresent();
 
     success &= saveProto(moduleConfigFileName,
                          meshtastic_LocalModuleConfig_size,
@@ -1576,6 +1599,8 @@ bool NodeDB::saveToDiskNoRetry(int saveWhat) {
 
 bool NodeDB::saveToDisk(int saveWhat) {
   LOG_DEBUG("Save to disk %d", saveWhat);
+  if (saveScheduler)
+    saveScheduler->superseded(saveWhat);
   bool success = saveToDiskNoRetry(saveWhat);
 
   if (!success) {
@@ -1596,6 +1621,89 @@ bool NodeDB::saveToDisk(int saveWhat) {
   return success;
 }
 
+void NodeDB::saveToDiskSoon(int saveWhat) {
+  if (saveScheduler)
+    saveScheduler->markDirty(saveWhat);
+  else
+    saveToDisk(saveWhat);
+}
+
+bool NodeDB::encodeSegment(int         segment,
+                           const char*& filename,
+                           std::string& bytes,
+                           bool&        fullAtomic) {
+  size_t              size;
+  const pb_msgdesc_t* fields;
+  const void*         src;
+  fullAtomic = true;
+  switch (segment) {
+    case SEGMENT_CONFIG:
+      setConfigPresent();
+      filename = configFileName;
+      size     = meshtastic_LocalConfig_size;
+      fields   = &meshtastic_LocalConfig_msg;
+      src      = &config;
+      break;
+    case SEGMENT_MODULECONFIG:
+      setModuleConfigPresent();
+      filename = moduleConfigFileName;
+      size     = meshtastic_LocalModuleConfig_size;
+      fields   = &meshtastic_LocalModuleConfig_msg;
+      src      = &moduleConfig;
+      break;
+    case SEGMENT_CHANNELS:
+      filename = channelFileName;
+      size     = meshtastic_ChannelFile_size;
+      fields   = &meshtastic_ChannelFile_msg;
+      src      = &channelFile;
+      break;
+    case SEGMENT_DEVICESTATE:
+      filename = deviceStateFileName;
+      size     = meshtastic_DeviceState_size;
+      fields   = &meshtastic_DeviceState_msg;
+      src      = &devicestate;
+      break;
+    case SEGMENT_NODEDATABASE:
+      filename   = nodeDatabaseFileName;
+      fields     = &meshtastic_NodeDatabase_msg;
+      src        = &nodeDatabase;
+      fullAtomic = false;  // See saveNodeDatabaseToDisk
+      pb_get_encoded_size(&size, meshtastic_NodeDatabase_fields, &nodeDatabase);
+      break;
+    default:
+      return false;
+  }
+
+  bytes.resize(size);
+  pb_ostream_t stream = pb_ostream_from_buffer(reinterpret_cast<uint8_t*>(&bytes[0]), size);
+  if (!pb_encode(&stream, fields, src)) {
+    LOG_ERROR("Error: can't encode protobuf %s", PB_GET_ERROR(&stream));
+    return false;
+  }
+  bytes.resize(stream.bytes_written);
+  return true;
+}
+
+bool NodeDB::writeEncoded(const char* filename, const std::string& bytes, bool fullAtomic) {
+  bool okay = false;
+#ifdef FSCom
+  spiLock->lock();
+  FSCom.mkdir("/prefs");
+  spiLock->unlock();
+
+  auto f = SafeFile(filename, fullAtomic);
+  LOG_INFO("Save %s", filename);
+  okay = f.write(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size()) == bytes.size();
+  okay &= f.close();
+  if (!okay) {
+    LOG_ERROR("Can't write prefs!");
+  }
+#else
+  LOG_ERROR("ERROR: Filesystem not implemented");
+#endif
+  return okay;
+}
+
 const meshtastic_NodeInfoLite* NodeDB::readNextMeshNode(uint32_t& readIndex) {
   if (readIndex < numMeshNodes)
     return &meshNodes->at(readIndex++);
@@ -1603,6 +1711,13 @@ const meshtastic_NodeInfoLite* NodeDB::readNextMeshNode(uint32_t& readIndex) {
     return NULL;
 }
 
+const meshtastic_NodeInfoLite* NodeDB::readNextChangedMeshNode(uint32_t& readIndex, uint32_t since) {
+  const meshtastic_NodeInfoLite* n;
+  while ((n = readNextMeshNode(readIndex)) && !changeLog.changedSince(n->num, since))
+    ;
+  return n;
+}
+
 /// Given a node, return how many seconds in the past (vs now) that we last heard from it
 uint32_t sinceLastSeen(const meshtastic_NodeInfoLite* n) {
   uint32_t now = getTime();
@@ -1692,6 +1807,8 @@ void NodeDB::updatePosition(uint32_t nodeId, const meshtastic_Position& p, RxSou
   }
   info->has_position = true;
   updateGUIforNode   = info;
+  indexPosition(info);
+  changeLog.touch(nodeId);
   notifyObservers(true);  // Force an update whether or not our node counts have changed
 }
 
@@ -1714,6 +1831,7 @@ void NodeDB::updateTelemetry(uint32_t nodeId, const meshtastic_Telemetry& t, RxS
   info->device_metrics     = t.variant.device_metrics;
   info->has_device_metrics = true;
   updateGUIforNode         = info;
+  changeLog.touch(nodeId);
   notifyObservers(true);  // Force an update whether or not our node counts have changed
 }
 
@@ -1736,12 +1854,14 @@ void NodeDB::addFromContact(meshtastic_SharedContact contact) {
     info->has_position             = false;
     info->user.public_key.size     = 0;
     info->user.public_key.bytes[0] = 0;
+    changeLog.touch(contact.node_num);
   } else {
     info->last_heard  = getValidTime(RTCQualityNTP);
     info->is_favorite = true;
     info->bitfield |= NODEINFO_BITFIELD_IS_KEY_MANUALLY_VERIFIED_MASK;
     // Mark the node's key as manually verified to indicate trustworthiness.
     updateGUIforNode = info;
+    changeLog.touch(contact.node_num);
     // powerFSM.trigger(EVENT_NODEDB_UPDATED); This event has been retired
     sortMeshDB();
     notifyObservers(true);  // Force an update whether or not our node counts have changed
@@ -1808,6 +1928,7 @@ bool NodeDB::updateUser(uint32_t nodeId, meshtastic_User& p, uint8_t channelInde
 
   if (changed) {
     updateGUIforNode = info;
+    changeLog.touch(nodeId);
     notifyObservers(true);  // Force an update whether or not our node counts have changed
 
     // We just changed something about a User,
@@ -1853,6 +1974,7 @@ void NodeDB::updateFrom(const meshtastic_MeshPacket& mp) {
       info->has_hops_away = true;
       info->hops_away     = mp.hop_start - mp.hop_limit;
     }
+    changeLog.touch(info->num);
     sortMeshDB();
   }
 }
@@ -1861,8 +1983,9 @@ void NodeDB::set_favorite(bool is_favorite, uint32_t nodeId) {
   meshtastic_NodeInfoLite* lite = getMeshNode(nodeId);
   if (lite && lite->is_favorite != is_favorite) {
     lite->is_favorite = is_favorite;
+    changeLog.touch(nodeId);
     sortMeshDB();
-    saveNodeDatabaseToDisk();
+    saveToDiskSoon(SEGMENT_NODEDATABASE);
   }
 }
 
@@ -1958,6 +2081,8 @@ meshtastic_NodeInfoLite* NodeDB::getOrCreateMeshNode(NodeNum n) {
       }
 
       if (oldestIndex != -1) {
+        spatialIndex.remove(meshNodes->at(oldestIndex).num);
+        changeLog.remove(meshNodes->at(oldestIndex).num);
         // Shove the remaining nodes down the chain
         for (int i = oldestIndex; i < numMeshNodes - 1; i++) {
           meshNodes->at(i) = meshNodes->at(i + 1);
@@ -1971,6 +2096,7 @@ meshtastic_NodeInfoLite* NodeDB::getOrCreateMeshNode(NodeNum n) {
     // everything is missing except the nodenum
     memset(lite, 0, sizeof(*lite));
     lite->num = n;
+    changeLog.touch(n);
     LOG_INFO("Adding node to database with %i nodes and %u bytes free!",
              numMeshNodes,
              memGet.getFreeHeap());
@@ -1985,6 +2111,55 @@ bool NodeDB::hasValidPosition(const meshtastic_NodeInfoLite* n) {
   return n->has_position && (n->position.latitude_i != 0 || n->position.longitude_i != 0);
 }
 
+void NodeDB::indexPosition(const meshtastic_NodeInfoLite* n) {
+  // Our own position is where the queries start from, not one of their results
+  if (hasValidPosition(n) && n->num != getNodeNum())
+    spatialIndex.update(n->num, n->position.latitude_i, n->position.longitude_i);
+  else
+    spatialIndex.remove(n->num);
+}
+
+void NodeDB::rebuildSpatialIndex() {
+  spatialIndex.clear();
+  spatialIndex.clearOrigin();
+  for (int i = 0; i < numMeshNodes; i++)
+    indexPosition(&meshNodes->at(i));
+}
+
+bool NodeDB::updateSpatialOrigin() {
+  // Our own position is also set directly (fixed position, GPS), so re-read it on every query
+  const meshtastic_NodeInfoLite* ourNode = getMeshNode(getNodeNum());
+  if (!ourNode || !hasValidPosition(ourNode)) {
+    spatialIndex.clearOrigin();
+    return false;
+  }
+  spatialIndex.setOrigin(ourNode->position.latitude_i, ourNode->position.longitude_i);
+  return true;
+}
+
+bool NodeDB::getDistanceTo(const meshtastic_NodeInfoLite* n, float& meters, float* bearingRadians) {
+  if (!n || !hasValidPosition(n) || !updateSpatialOrigin())
+    return false;
+  indexPosition(n);  // No-op unless the position was changed outside of updatePosition()
+  return spatialIndex.distanceFromOrigin(n->num, meters, bearingRadians);
+}
+
+void NodeDB::getNodesWithin(float radiusMeters, std::vector<NodeSpatialIndex::Hit>& out) {
+  out.clear();
+  const meshtastic_NodeInfoLite* ourNode = getMeshNode(getNodeNum());
+  if (updateSpatialOrigin())
+    spatialIndex.queryRange(
+        ourNode->position.latitude_i, ourNode->position.longitude_i, radiusMeters, out);
+}
+
+void NodeDB::getNearestNodes(size_t k, std::vector<NodeSpatialIndex::Hit>& out) {
+  out.clear();
+  const meshtastic_NodeInfoLite* ourNode = getMeshNode(getNodeNum());
+  if (updateSpatialOrigin())
+    spatialIndex.queryNearest(
+        ourNode->position.latitude_i, ourNode->position.longitude_i, k, out);
+}
+
 /// If we have a node / user and they report is_licensed = true
 /// we consider them licensed
 UserLicenseStatus NodeDB::getLicenseStatus(uint32_t nodeNum) {
@@ -5,9 +5,12 @@
 #include <algorithm>
 #include <assert.h>
 #include <pb_encode.h>
+#include <string>
 #include <vector>
 
 #include "MeshTypes.h"
+#include "NodeChangeLog.h"
+#include "NodeSpatialIndex.h"
 #include "NodeStatus.h"
 #include "configuration.h"
 #include "mesh-pb-constants.h"
@@ -152,6 +155,15 @@ class NodeDB
     bool saveToDisk(int saveWhat = SEGMENT_CONFIG | SEGMENT_MODULECONFIG | SEGMENT_DEVICESTATE | SEGMENT_CHANNELS |
                                    SEGMENT_NODEDATABASE);
 
+    /// write to flash once changes settle down, see SaveScheduler. Saves right away if there is no scheduler yet.
+    void saveToDiskSoon(int saveWhat);
+
+    /// Encode one segment as saveToDisk would write it, so it can be written later, on another thread
+    bool encodeSegment(int segment, const char *&filename, std::string &bytes, bool &fullAtomic);
+
+    /// Write what encodeSegment encoded. Touches nothing but the file, so any thread may call it.
+    bool writeEncoded(const char *filename, const std::string &bytes, bool fullAtomic);
+
     /** Reinit radio config if needed, because either:
      * a) sometimes a buggy android app might send us bogus settings or
      * b) the client set factory_reset
@@ -228,6 +240,24 @@ class NodeDB
 
     const meshtastic_NodeInfoLite *readNextMeshNode(uint32_t &readIndex);
 
+    /// Like readNextMeshNode(), but skips nodes that did not change after change version `since`
+    const meshtastic_NodeInfoLite *readNextChangedMeshNode(uint32_t &readIndex, uint32_t since);
+
+    /// Version of the most recent change to any node, see NodeChangeLog
+    uint32_t getChangeVersion() const { return changeLog.version(); }
+
+    /// True if a client that has our nodes as of change version `since` can be sent just what changed after it
+    bool canSyncSince(uint32_t since) const { return changeLog.canSyncSince(since); }
+
+    /// Get the next node removed after change version `since`, start with readIndex = 0
+    bool readNextRemovedNode(uint32_t &readIndex, uint32_t since, NodeNum &num) const
+    {
+        return changeLog.readNextTombstone(readIndex, since, num);
+    }
+
+    /// Record that a node was changed in place, for code that modifies a NodeInfoLite directly
+    void markNodeChanged(NodeNum n) { changeLog.touch(n); }
+
     meshtastic_NodeInfoLite *getMeshNodeByIndex(size_t x)
     {
         assert(x < numMeshNodes);
@@ -268,6 +298,18 @@ class NodeDB
 
     bool hasValidPosition(const meshtastic_NodeInfoLite *n);
 
+    /**
+     * Distance in meters (and optionally bearing in radians) from our own position to a node. Cached until either of us
+     * moves. Returns false if either position is unknown, or for our own node.
+     */
+    bool getDistanceTo(const meshtastic_NodeInfoLite *n, float &meters, float *bearingRadians = nullptr);
+
+    /// Nodes other than us with a known position within `radiusMeters` of ours, in no particular order
+    void getNodesWithin(float radiusMeters, std::vector<NodeSpatialIndex::Hit> &out);
+
+    /// The `k` nodes other than us with a known position nearest to ours, nearest first
+    void getNearestNodes(size_t k, std::vector<NodeSpatialIndex::Hit> &out);
+
     bool checkLowEntropyPublicKey(const meshtastic_Config_SecurityConfig_public_key_t &keyToTest);
 
     bool backupPreferences(meshtastic_AdminMessage_BackupLocation location);
@@ -304,6 +346,20 @@ class NodeDB
     /// purge db entries without user info
     void cleanupMeshDB();
 
+    /// Change versions of our nodes, for clients that sync incrementally
+    NodeChangeLog changeLog;
+
+    /// Index of node positions for distance, range and nearest node queries
+    NodeSpatialIndex spatialIndex;
+
+    /// Add, move or drop a node in the spatial index according to its current position
+    void indexPosition(const meshtastic_NodeInfoLite *n);
+
+    /// Refresh the spatial index origin from our own node, returns false if we have no position
+    bool updateSpatialOrigin();
+
+    void rebuildSpatialIndex();
+
     /// Reinit device state from scratch (not loading from disk)
     void installDefaultDeviceState(), installDefaultNodeDatabase(), installDefaultChannels(),
         installDefaultConfig(bool preserveKey), installDefaultModuleConfig();
@@ -315,6 +371,9 @@ class NodeDB
     bool saveChannelsToDisk();
     bool saveDeviceStateToDisk();
     bool saveNodeDatabaseToDisk();
+
+    /// Mark every sub-config present, so that defaults are written out too
+    void setConfigPresent(), setModuleConfigPresent();
     void sortMeshDB();
 };
 
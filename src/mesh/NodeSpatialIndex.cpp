@@ -0,0 +1,209 @@
+#include "NodeSpatialIndex.h"
+#include "gps/GeoCoord.h"
+#include <algorithm>
+#include <math.h>
+
+#define EARTH_RADIUS_METERS 6371000.0
+#define UNITS_PER_DEGREE 10000000LL
+#define LAT_CELLS (180 * UNITS_PER_DEGREE / NodeSpatialIndex::CELL_SIZE)
+#define LON_CELLS (360 * UNITS_PER_DEGREE / NodeSpatialIndex::CELL_SIZE)
+
+static_assert(LON_CELLS <= (1 << 12), "Longitude cell must fit in the low 12 bits of the cell key");
+
+// Ordering of entries within the index, and of an entry against a bare cell key
+struct EntryLess {
+    template <typename E> bool operator()(const E &a, const E &b) const
+    {
+        return a.key < b.key || (a.key == b.key && a.num < b.num);
+    }
+    template <typename E> bool operator()(const E &a, uint32_t key) const { return a.key < key; }
+};
+
+uint32_t NodeSpatialIndex::latCell(int32_t latitude_i)
+{
+    int64_t c = ((int64_t)latitude_i + 90 * UNITS_PER_DEGREE) / CELL_SIZE;
+    return (uint32_t)std::max<int64_t>(0, std::min<int64_t>(c, LAT_CELLS - 1));
+}
+
+uint32_t NodeSpatialIndex::lonCell(int32_t longitude_i)
+{
+    int64_t c = ((int64_t)longitude_i + 180 * UNITS_PER_DEGREE) / CELL_SIZE;
+    return (uint32_t)std::max<int64_t>(0, std::min<int64_t>(c, LON_CELLS - 1));
+}
+
+float NodeSpatialIndex::distanceMeters(int32_t lat1, int32_t lon1, int32_t lat2, int32_t lon2)
+{
+    if (lat1 == lat2 && lon1 == lon2)
+        return 0;
+    double phi1 = lat1 * 1e-7 * DEG_TO_RAD;
+    double phi2 = lat2 * 1e-7 * DEG_TO_RAD;
+    double dPhi = (lat2 - lat1) * 1e-7 * DEG_TO_RAD;
+    double dLambda = ((int64_t)lon2 - lon1) * 1e-7 * DEG_TO_RAD;
+    double a = sin(dPhi / 2) * sin(dPhi / 2) + cos(phi1) * cos(phi2) * sin(dLambda / 2) * sin(dLambda / 2);
+    return (float)(EARTH_RADIUS_METERS * 2 * atan2(sqrt(a), sqrt(1 - a)));
+}
+
+std::vector<NodeSpatialIndex::Entry>::iterator NodeSpatialIndex::find(NodeNum num, uint32_t key)
+{
+    Entry probe = {key, num, 0, 0, 0, 0, 0};
+    auto it = std::lower_bound(entries.begin(), entries.end(), probe, EntryLess());
+    return (it != entries.end() && it->num == num && it->key == key) ? it : entries.end();
+}
+
+void NodeSpatialIndex::update(NodeNum num, int32_t latitude_i, int32_t longitude_i)
+{
+    uint32_t key = cellKey(latCell(latitude_i), lonCell(longitude_i));
+    auto known = keys.find(num);
+    if (known != keys.end()) {
+        auto it = find(num, known->second);
+        if (known->second == key && it != entries.end()) {
+            if (it->latitude_i != latitude_i || it->longitude_i != longitude_i) {
+                it->latitude_i = latitude_i;
+                it->longitude_i = longitude_i;
+                it->epoch = 0;
+            }
+            return;
+        }
+        // Moved to another cell
+        if (it != entries.end())
+            entries.erase(it);
+    }
+
+    Entry e = {key, num, latitude_i, longitude_i, 0, 0, 0};
+    entries.insert(std::upper_bound(entries.begin(), entries.end(), e, EntryLess()), e);
+    keys[num] = key;
+}
+
+void NodeSpatialIndex::remove(NodeNum num)
+{
+    auto known = keys.find(num);
+    if (known == keys.end())
+        return;
+    auto it = find(num, known->second);
+    if (it != entries.end())
+        entries.erase(it);
+    keys.erase(known);
+}
+
+void NodeSpatialIndex::clear()
+{
+    entries.clear();
+    keys.clear();
+}
+
+void NodeSpatialIndex::setOrigin(int32_t latitude_i, int32_t longitude_i)
+{
+    if (hasOrigin && originLat == latitude_i && originLon == longitude_i)
+        return;
+    hasOrigin = true;
+    originLat = latitude_i;
+    originLon = longitude_i;
+    if (++originEpoch == 0) // 0 marks an entry without cached values
+        originEpoch = 1;
+}
+
+float NodeSpatialIndex::distanceTo(Entry &e, int32_t latitude_i, int32_t longitude_i)
+{
+    if (!hasOrigin || latitude_i != originLat || longitude_i != originLon)
+        return distanceMeters(latitude_i, longitude_i, e.latitude_i, e.longitude_i);
+
+    if (e.epoch != originEpoch) {
+        e.distance = distanceMeters(originLat, originLon, e.latitude_i, e.longitude_i);
+        e.bearing = GeoCoord::bearing(originLat * 1e-7, originLon * 1e-7, e.latitude_i * 1e-7, e.longitude_i * 1e-7);
+        e.epoch = originEpoch;
+    }
+    return e.distance;
+}
+
+bool NodeSpatialIndex::distanceFromOrigin(NodeNum num, float &distanceMeters, float *bearingRadians)
+{
+    auto known = keys.find(num);
+    if (!hasOrigin || known == keys.end())
+        return false;
+    auto it = find(num, known->second);
+    if (it == entries.end())
+        return false;
+
+    distanceMeters = distanceTo(*it, originLat, originLon);
+    if (bearingRadians)
+        *bearingRadians = it->bearing;
+    return true;
+}
+
+void NodeSpatialIndex::scanRow(uint32_t row, uint32_t fromLonCell, uint32_t toLonCell, int32_t latitude_i,
+                               int32_t longitude_i, float radiusMeters, std::vector<Hit> &out)
+{
+    uint32_t lastKey = cellKey(row, toLonCell);
+    for (auto it = std::lower_bound(entries.begin(), entries.end(), cellKey(row, fromLonCell), EntryLess());
+         it != entries.end() && it->key <= lastKey; ++it) {
+        float d = distanceTo(*it, latitude_i, longitude_i);
+        if (d <= radiusMeters)
+            out.push_back({it->num, d});
+    }
+}
+
+void NodeSpatialIndex::queryRange(int32_t latitude_i, int32_t longitude_i, float radiusMeters, std::vector<Hit> &out)
+{
+    double radiusRad = radiusMeters / EARTH_RADIUS_METERS;
+    if (radiusRad >= PI) {
+        for (auto &e : entries)
+            out.push_back({e.num, distanceTo(e, latitude_i, longitude_i)});
+        return;
+    }
+
+    int64_t dLat = (int64_t)(radiusRad * RAD_TO_DEG * UNITS_PER_DEGREE) + 1;
+    uint32_t firstRow = latCell(std::max<int64_t>(latitude_i - dLat, -90 * UNITS_PER_DEGREE));
+    uint32_t lastRow = latCell(std::min<int64_t>(latitude_i + dLat, 90 * UNITS_PER_DEGREE));
+
+    // Widest longitude offset of the circle; it covers a pole if sin(r) >= cos(lat)
+    double cosLat = cos(latitude_i * 1e-7 * DEG_TO_RAD);
+    bool allLongitudes = sin(radiusRad) >= cosLat;
+    int64_t lonLow = 0, lonHigh = 0;
+    if (!allLongitudes) {
+        int64_t dLon = (int64_t)(asin(sin(radiusRad) / cosLat) * RAD_TO_DEG * UNITS_PER_DEGREE) + 1;
+        lonLow = longitude_i - dLon;
+        lonHigh = longitude_i + dLon;
+        allLongitudes = lonHigh - lonLow >= 360 * UNITS_PER_DEGREE;
+    }
+
+    for (uint32_t row = firstRow; row <= lastRow; row++) {
+        if (allLongitudes) {
+            scanRow(row, 0, LON_CELLS - 1, latitude_i, longitude_i, radiusMeters, out);
+        } else if (lonLow < -180 * UNITS_PER_DEGREE) {
+            // Crosses the antimeridian westwards
+            scanRow(row, 0, lonCell(lonHigh), latitude_i, longitude_i, radiusMeters, out);
+            scanRow(row, lonCell(lonLow + 360 * UNITS_PER_DEGREE), LON_CELLS - 1, latitude_i, longitude_i, radiusMeters, out);
+        } else if (lonHigh > 180 * UNITS_PER_DEGREE) {
+            // Crosses the antimeridian eastwards
+            scanRow(row, lonCell(lonLow), LON_CELLS - 1, latitude_i, longitude_i, radiusMeters, out);
+            scanRow(row, 0, lonCell(lonHigh - 360 * UNITS_PER_DEGREE), latitude_i, longitude_i, radiusMeters, out);
+        } else {
+            scanRow(row, lonCell(lonLow), lonCell(lonHigh), latitude_i, longitude_i, radiusMeters, out);
+        }
+    }
+}
+
+void NodeSpatialIndex::queryNearest(int32_t latitude_i, int32_t longitude_i, size_t k, std::vector<Hit> &out)
+{
+    out.clear();
+    if (k == 0 || entries.empty())
+        return;
+
+    // Grow the search radius until it holds k nodes: the k nearest are then all inside it
+    float radius = 2 * CELL_SIZE * 1e-7 * DEG_TO_RAD * EARTH_RADIUS_METERS;
+    while (true) {
+        queryRange(latitude_i, longitude_i, radius, out);
+        if (out.size() >= k || out.size() == entries.size() || radius >= PI * EARTH_RADIUS_METERS)
+            break;
+        out.clear();
+        radius *= 4;
+    }
+
+    auto nearer = [](const Hit &a, const Hit &b) { return a.distanceMeters < b.distanceMeters; };
+    if (out.size() > k) {
+        std::partial_sort(out.begin(), out.begin() + k, out.end(), nearer);
+        out.resize(k);
+    } else {
+        std::sort(out.begin(), out.end(), nearer);
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "MeshTypes.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Grid index over node positions, so that "nodes within R meters" and "K nearest nodes" don't need a scan and a haversine
+ * over the whole NodeDB.
+ *
+ * Positions are bucketed into cells of CELL_SIZE (in latitude_i/longitude_i units, 1e-7 degrees). Entries are kept sorted by
+ * cell key, with all cells of one latitude row adjacent, so a range query is one binary search per row it touches followed by
+ * an exact distance check. Distance and bearing from our own position (the origin) are cached per entry until either end
+ * moves.
+ */
+class NodeSpatialIndex
+{
+  public:
+    /// A node returned by a query, with its distance to the query center
+    struct Hit {
+        NodeNum num;
+        float distanceMeters;
+    };
+
+    /// Cell size, 0.1 degree (about 11 km of latitude)
+    static constexpr int32_t CELL_SIZE = 1000000;
+
+    /// Add or move a node. Cheap when the position did not change.
+    void update(NodeNum num, int32_t latitude_i, int32_t longitude_i);
+
+    void remove(NodeNum num);
+
+    void clear();
+
+    size_t size() const { return entries.size(); }
+
+    /// Set our own position, which invalidates the cached distances and bearings if it moved
+    void setOrigin(int32_t latitude_i, int32_t longitude_i);
+
+    void clearOrigin() { hasOrigin = false; }
+
+    /**
+     * Distance in meters and bearing in radians from our own position to a node, from the cache when possible.
+     * @return false if the node is not in the index or we don't have a position
+     */
+    bool distanceFromOrigin(NodeNum num, float &distanceMeters, float *bearingRadians = nullptr);
+
+    /// Append all nodes within `radiusMeters` of the given point to `out`, in no particular order
+    void queryRange(int32_t latitude_i, int32_t longitude_i, float radiusMeters, std::vector<Hit> &out);
+
+    /// Fill `out` with the `k` nodes nearest to the given point, nearest first
+    void queryNearest(int32_t latitude_i, int32_t longitude_i, size_t k, std::vector<Hit> &out);
+
+    /// Haversine distance in meters between two positions in latitude_i/longitude_i units
+    static float distanceMeters(int32_t lat1, int32_t lon1, int32_t lat2, int32_t lon2);
+
+  private:
+    struct Entry {
+        uint32_t key;
+        NodeNum num;
+        int32_t latitude_i;
+        int32_t longitude_i;
+        uint32_t epoch; // originEpoch the cached values below were computed for, 0 if none
+        float distance;
+        float bearing;
+    };
+
+    std::vector<Entry> entries;                 // Sorted by key, then num
+    std::unordered_map<NodeNum, uint32_t> keys; // Cell key of each indexed node
+
+    bool hasOrigin = false;
+    int32_t originLat = 0, originLon = 0;
+    uint32_t originEpoch = 1;
+
+    static uint32_t latCell(int32_t latitude_i);
+    static uint32_t lonCell(int32_t longitude_i);
+    static uint32_t cellKey(uint32_t latCell, uint32_t lonCell) { return (latCell << 12) | lonCell; }
+
+    std::vector<Entry>::iterator find(NodeNum num, uint32_t key);
+
+    /// Distance from the query center to an entry, using the origin cache when the center is our own position
+    float distanceTo(Entry &e, int32_t latitude_i, int32_t longitude_i);
+
+    /// Check the entries of one latitude row between two longitude cells (inclusive)
+    void scanRow(uint32_t row, uint32_t fromLonCell, uint32_t toLonCell, int32_t latitude_i, int32_t longitude_i,
+                 float radiusMeters, std::vector<Hit> &out);
+};
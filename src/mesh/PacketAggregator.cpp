@@ -0,0 +1,106 @@
+#include "PacketAggregator.h"
+#include "RadioInterface.h"
+#include "Router.h"
+#include "configuration.h"
+#include "meshUtils.h"
+#include <algorithm>
+
+static_assert(AGGREGATE_MAX_FRAME_LEN + MESHTASTIC_HEADER_LENGTH + 8 <= MAX_LORA_PAYLOAD_LEN, "Containers must fit a frame");
+static_assert(AGGREGATE_MAX_FRAME_LEN <= sizeof(meshtastic_Data_payload_t::bytes), "Containers must fit a Data payload");
+
+PacketAggregator *packetAggregator = NULL;
+
+PacketAggregator::PacketAggregator() : concurrency::OSThread("PacketAggregator")
+{
+    disable(); // Until there is something to send
+}
+
+bool PacketAggregator::isAggregatable(const meshtastic_MeshPacket *p)
+{
+    // Packets wanting an ack are tracked by id in the TX queue for retransmission, so they go out as they are
+    return p->which_payload_variant == meshtastic_MeshPacket_decoded_tag && isFromUs(p) && !p->want_ack &&
+           IS_ONE_OF(p->decoded.portnum, meshtastic_PortNum_TELEMETRY_APP, meshtastic_PortNum_POSITION_APP,
+                     meshtastic_PortNum_NODEINFO_APP, meshtastic_PortNum_ROUTING_APP);
+}
+
+bool PacketAggregator::add(meshtastic_MeshPacket *p, ChannelIndex chIndex)
+{
+    // PKI packets have no channel hash a receiver could decrypt them with
+    if (p->pki_encrypted || p->encrypted.size > AGGREGATE_MAX_PACKET_LEN)
+        return false;
+
+    size_t recordLen = AggregateFrame::RECORD_HEADER_LEN + p->encrypted.size;
+    auto b = std::find_if(batches.begin(), batches.end(),
+                          [&](const Batch &b) { return b.channel == chIndex && b.hopLimit == p->hop_limit; });
+    if (b != batches.end() && b->frameLen + recordLen > AGGREGATE_MAX_FRAME_LEN) {
+        flush(*b);
+        batches.erase(b);
+        b = batches.end();
+    }
+    if (b == batches.end()) {
+        batches.push_back({chIndex, p->hop_limit, millis(), 0, {}});
+        b = batches.end() - 1;
+        if (batches.size() == 1) {
+            enabled = true;
+            setIntervalFromNow(USERPREFS_PACKET_AGGREGATION_WINDOW_MS);
+        }
+    }
+    b->packets.push_back(p);
+    b->frameLen += recordLen;
+    LOG_DEBUG("Hold packet id=0x%08x for aggregation, %u in batch", p->id, b->packets.size());
+    return true;
+}
+
+bool PacketAggregator::cancel(NodeNum from, PacketId id)
+{
+    for (auto b = batches.begin(); b != batches.end(); ++b) {
+        auto held = std::find_if(b->packets.begin(), b->packets.end(),
+                                 [&](const meshtastic_MeshPacket *p) { return p->from == from && p->id == id; });
+        if (held == b->packets.end())
+            continue;
+        b->frameLen -= AggregateFrame::RECORD_HEADER_LEN + (*held)->encrypted.size;
+        packetPool.release(*held);
+        b->packets.erase(held);
+        if (b->packets.empty())
+            batches.erase(b); // runOnce() disables us once there are none
+        LOG_DEBUG("Cancel held packet id=0x%08x", id);
+        return true;
+    }
+    return false;
+}
+
+int32_t PacketAggregator::runOnce()
+{
+    // Batches are kept in the order they started, and all wait the same time
+    while (!batches.empty() && millis() - batches.front().startedMs >= USERPREFS_PACKET_AGGREGATION_WINDOW_MS) {
+        flush(batches.front());
+        batches.erase(batches.begin());
+    }
+    if (batches.empty())
+        return disable();
+    return USERPREFS_PACKET_AGGREGATION_WINDOW_MS - (millis() - batches.front().startedMs);
+}
+
+void PacketAggregator::flush(Batch &b)
+{
+    if (b.packets.size() == 1) {
+        router->rawSend(b.packets.front());
+        return;
+    }
+
+    meshtastic_MeshPacket *container = router->allocForSending();
+    container->channel = b.channel;
+    container->hop_limit = b.hopLimit;
+    container->decoded.portnum = (meshtastic_PortNum)AGGREGATE_PORTNUM;
+
+    size_t len = 0;
+    for (meshtastic_MeshPacket *p : b.packets) {
+        AggregateRecord r = {p->to, p->id, p->next_hop, p->channel, (uint8_t)p->encrypted.size, p->encrypted.bytes};
+        AggregateFrame::append(container->decoded.payload.bytes, len, AGGREGATE_MAX_FRAME_LEN, r);
+        container->priority = std::max(container->priority, p->priority); // As urgent as the most urgent packet in it
+        packetPool.release(p);
+    }
+    container->decoded.payload.size = len;
+    LOG_INFO("Send %u packets in container id=0x%08x, %u bytes", b.packets.size(), container->id, len);
+    router->send(container);
+}
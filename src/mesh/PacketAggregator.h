@@ -0,0 +1,47 @@
+#pragma once
+
+#include "AggregateFrame.h"
+#include "MeshTypes.h"
+#include "concurrency/OSThread.h"
+#include <vector>
+
+/**
+ * Holds our small, delay-tolerant packets for up to USERPREFS_PACKET_AGGREGATION_WINDOW_MS once they are encrypted, so
+ * that those sharing a channel and hop limit go out as one LoRa frame: one preamble, one PacketHeader and one contention
+ * delay instead of one each. Receivers split the frame back into the original packets in Router::handleReceived().
+ */
+class PacketAggregator : private concurrency::OSThread
+{
+  public:
+    PacketAggregator();
+
+    /// Whether p, still decoded, may wait to be sent together with others
+    static bool isAggregatable(const meshtastic_MeshPacket *p);
+
+    /**
+     * Take an encrypted packet that was aggregatable before encryption, chIndex is the channel it was encrypted for
+     * @return false if it has to be sent on its own after all, the caller keeps it then
+     */
+    bool add(meshtastic_MeshPacket *p, ChannelIndex chIndex);
+
+    /// Drop a packet still waiting for its batch, returns true if it was held here
+    bool cancel(NodeNum from, PacketId id);
+
+  protected:
+    virtual int32_t runOnce() override;
+
+  private:
+    struct Batch {
+        ChannelIndex channel;
+        uint8_t hopLimit;
+        uint32_t startedMs;
+        size_t frameLen; // What the packets take up in a container
+        std::vector<meshtastic_MeshPacket *> packets;
+    };
+    std::vector<Batch> batches;
+
+    /// Send the batch's packets, in one container if there is more than one
+    void flush(Batch &b);
+};
+
+extern PacketAggregator *packetAggregator;
@@ -126,10 +126,11 @@ bool PacketHistory::wasSeenRecently(const meshtastic_MeshPacket *p, bool withUpd
                       millis() - found->rxTimeMsec);
 #endif
 
-            // Add the existing relayed_by to the new record
-            for (uint8_t i = 0; i < (NUM_RELAYERS - 1); i++) {
-                if (found->relayed_by[i] != 0)
-                    r.relayed_by[i + 1] = found->relayed_by[i];
+            // Add the existing relayed_by to the new record, once each so a relayer heard twice doesn't push out another
+            uint8_t j = 1;
+            for (uint8_t i = 0; i < NUM_RELAYERS && j < NUM_RELAYERS; i++) {
+                if (found->relayed_by[i] != 0 && found->relayed_by[i] != r.relayed_by[0])
+                    r.relayed_by[j++] = found->relayed_by[i];
             }
             r.next_hop = found->next_hop; // keep the original next_hop (such that we check whether we were originally asked)
 #if VERBOSE_PACKET_HISTORY
@@ -345,6 +346,36 @@ bool PacketHistory::wasRelayer(const uint8_t relayer, const PacketRecord &r)
     return false;
 }
 
+/* Count the distinct nodes other than us recorded as relayers of a packet in the history given an ID and sender
+ * @return 0 if the packet is not in the history */
+uint8_t PacketHistory::getNumRelayers(const uint32_t id, const NodeNum sender)
+{
+    if (!initOk()) {
+        LOG_ERROR("Packet History - getNumRelayers: NOT INITIALIZED!");
+        return 0;
+    }
+
+    const PacketRecord *found = find(sender, id);
+    if (found == NULL)
+        return 0;
+
+    uint8_t ourRelayID = nodeDB->getLastByteOfNodeNum(nodeDB->getNodeNum());
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < NUM_RELAYERS; i++) {
+        uint8_t relayer = found->relayed_by[i];
+        bool counted = false;
+        for (uint8_t k = 0; k < i; k++)
+            counted = counted || found->relayed_by[k] == relayer;
+        if (relayer != NO_RELAY_NODE && relayer != ourRelayID && !counted)
+            count++;
+    }
+#if VERBOSE_PACKET_HISTORY
+    LOG_DEBUG("Packet History - getNumRelayers: s=%08x id=%08x rby=%02x %02x %02x -> %d", sender, id, found->relayed_by[0],
+              found->relayed_by[1], found->relayed_by[2], count);
+#endif
+    return count;
+}
+
 // Remove a relayer from the list of relayers of a packet in the history given an ID and sender
 void PacketHistory::removeRelayer(const uint8_t relayer, const uint32_t id, const NodeNum sender)
 {
@@ -57,6 +57,11 @@ class PacketHistory
      * @return true if node was indeed a relayer, false if not */
     bool wasRelayer(const uint8_t relayer, const uint32_t id, const NodeNum sender);
 
+    /* Count the distinct nodes other than us recorded as relayers of a packet in the history given an ID and sender. Only
+     * the NUM_RELAYERS most recent relayers are kept, so it never exceeds that and can miss an early one.
+     * @return 0 if the packet is not in the history */
+    uint8_t getNumRelayers(const uint32_t id, const NodeNum sender);
+
     // Remove a relayer from the list of relayers of a packet in the history given an ID and sender
     void removeRelayer(const uint8_t relayer, const uint32_t id, const NodeNum sender);
 
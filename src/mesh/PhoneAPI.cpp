@@ -4,8 +4,10 @@
 #endif
 
 #include "Channels.h"
+#include "ConfigSnapshot.h"
 #include "Default.h"
 #include "FSCommon.h"
+#include "LatencyTrace.h"
 #include "MeshService.h"
 #include "NodeDB.h"
 #include "PacketHistory.h"
@@ -50,14 +52,30 @@ void PhoneAPI::handleStartConfig()
     // Must be before setting state (because state is how we know !connected)
     if (!isConnected()) {
         onConnectionChanged(true);
+        service->setClientConnected(true);
         observe(&service->fromNumChanged);
 #ifdef FSCom
         observe(&xModem.packetReady);
 #endif
     }
 
+    // The node list sent from here on is at least as new as this, ONLY_CONFIG clients are not sent one
+    syncVersion = config_nonce == SPECIAL_NONCE_ONLY_CONFIG ? 0 : nodeDB->getChangeVersion();
+    syncIncremental = false;
+    removedReadIndex = 0;
+    if (config_nonce == SPECIAL_NONCE_NODES_SINCE) {
+        syncSince = toRadioScratch.node_sync_since;
+        syncIncremental = nodeDB->canSyncSince(syncSince);
+        if (syncIncremental) {
+            LOG_INFO("Client wants nodes changed since version %u, now at %u", syncSince, syncVersion);
+        } else {
+            LOG_INFO("Client node version %u is unknown or too old, send all nodes", syncSince);
+            config_nonce = SPECIAL_NONCE_ONLY_NODES;
+        }
+    }
+
     // even if we were already connected - restart our state machine
-    if (config_nonce == SPECIAL_NONCE_ONLY_NODES) {
+    if (wantsOnlyNodes()) {
         // If client only wants node info, jump directly to sending nodes
         state = STATE_SEND_OWN_NODEINFO;
         LOG_INFO("Client only wants node info, skipping other config");
@@ -73,6 +91,7 @@ void PhoneAPI::handleStartConfig()
     LOG_INFO("Start API client config");
     nodeInfoForPhone.num = 0; // Don't keep returning old nodeinfos
     resetReadIndex();
+    configSnapshot.reset(); // Pick up any config changes since the last time
 }
 
 void PhoneAPI::close()
@@ -91,14 +110,17 @@ void PhoneAPI::close()
         releaseMqttClientProxyPhonePacket();
         releaseClientNotification();
         onConnectionChanged(false);
+        service->setClientConnected(false);
         fromRadioScratch = {};
         toRadioScratch = {};
         nodeInfoForPhone = {};
         packetForPhone = NULL;
+        configSnapshot.reset();
         filesManifest.clear();
         fromRadioNum = 0;
         config_nonce = 0;
         config_state = 0;
+        syncIncremental = false;
         pauseBluetoothLogging = false;
     }
 }
@@ -195,8 +217,9 @@ size_t PhoneAPI::getFromRadio(uint8_t *buf)
     if (!available()) {
         return 0;
     }
-    // In case we send a FromRadio packet
-    memset(&fromRadioScratch, 0, sizeof(fromRadioScratch));
+    // In case we send a FromRadio packet. Channels and config are copied pre-encoded from the snapshot instead.
+    if (state != STATE_SEND_CHANNELS && state != STATE_SEND_CONFIG && state != STATE_SEND_MODULECONFIG)
+        memset(&fromRadioScratch, 0, sizeof(fromRadioScratch));
 
     // Respond to heartbeat by sending queue status
     if (heartbeatReceived) {
@@ -237,22 +260,21 @@ size_t PhoneAPI::getFromRadio(uint8_t *buf)
     case STATE_SEND_OWN_NODEINFO: {
         LOG_DEBUG("Send My NodeInfo");
         auto us = nodeDB->readNextMeshNode(readIndex);
+        size_t numbytes = 0;
         if (us) {
-            nodeInfoForPhone = TypeConversions::ConvertToNodeInfo(us);
+            nodeInfoForPhone = *us;
             nodeInfoForPhone.has_hops_away = false;
             nodeInfoForPhone.is_favorite = true;
-            fromRadioScratch.which_payload_variant = meshtastic_FromRadio_node_info_tag;
-            fromRadioScratch.node_info = nodeInfoForPhone;
-            // Should allow us to resume sending NodeInfo in STATE_SEND_OTHER_NODEINFOS
-            nodeInfoForPhone.num = 0;
+            // Also clears it, should allow us to resume sending NodeInfo in STATE_SEND_OTHER_NODEINFOS
+            numbytes = encodeNodeInfoForPhone(buf);
         }
-        if (config_nonce == SPECIAL_NONCE_ONLY_NODES) {
+        if (wantsOnlyNodes()) {
             // If client only wants node info, jump directly to sending nodes
             state = STATE_SEND_OTHER_NODEINFOS;
         } else {
             state = STATE_SEND_METADATA;
         }
-        break;
+        return numbytes;
     }
 
     case STATE_SEND_METADATA:
@@ -262,9 +284,8 @@ size_t PhoneAPI::getFromRadio(uint8_t *buf)
         state = STATE_SEND_CHANNELS;
         break;
 
-    case STATE_SEND_CHANNELS:
-        fromRadioScratch.which_payload_variant = meshtastic_FromRadio_channel_tag;
-        fromRadioScratch.channel = channels.getByIndex(config_state);
+    case STATE_SEND_CHANNELS: {
+        size_t numbytes = copyConfigFrame(CONFIG_FRAME_CHANNEL, buf);
         config_state++;
         // Advance when we have sent all of our Channels
         if (config_state >= MAX_NUM_CHANNELS) {
@@ -272,146 +293,24 @@ size_t PhoneAPI::getFromRadio(uint8_t *buf)
             state = STATE_SEND_CONFIG;
             config_state = _meshtastic_AdminMessage_ConfigType_MIN + 1;
         }
-        break;
-
-    case STATE_SEND_CONFIG:
-        fromRadioScratch.which_payload_variant = meshtastic_FromRadio_config_tag;
-        switch (config_state) {
-        case meshtastic_Config_device_tag:
-            LOG_DEBUG("Send config: device");
-            fromRadioScratch.config.which_payload_variant = meshtastic_Config_device_tag;
-            fromRadioScratch.config.payload_variant.device = config.device;
-            break;
-        case meshtastic_Config_position_tag:
-            LOG_DEBUG("Send config: position");
-            fromRadioScratch.config.which_payload_variant = meshtastic_Config_position_tag;
-            fromRadioScratch.config.payload_variant.position = config.position;
-            break;
-        case meshtastic_Config_power_tag:
-            LOG_DEBUG("Send config: power");
-            fromRadioScratch.config.which_payload_variant = meshtastic_Config_power_tag;
-            fromRadioScratch.config.payload_variant.power = config.power;
-            fromRadioScratch.config.payload_variant.power.ls_secs = default_ls_secs;
-            break;
-        case meshtastic_Config_network_tag:
-            LOG_DEBUG("Send config: network");
-            fromRadioScratch.config.which_payload_variant = meshtastic_Config_network_tag;
-            fromRadioScratch.config.payload_variant.network = config.network;
-            break;
-        case meshtastic_Config_display_tag:
-            LOG_DEBUG("Send config: display");
-            fromRadioScratch.config.which_payload_variant = meshtastic_Config_display_tag;
-            fromRadioScratch.config.payload_variant.display = config.display;
-            break;
-        case meshtastic_Config_lora_tag:
-            LOG_DEBUG("Send config: lora");
-            fromRadioScratch.config.which_payload_variant = meshtastic_Config_lora_tag;
-            fromRadioScratch.config.payload_variant.lora = config.lora;
-            break;
-        case meshtastic_Config_bluetooth_tag:
-            LOG_DEBUG("Send config: bluetooth");
-            fromRadioScratch.config.which_payload_variant = meshtastic_Config_bluetooth_tag;
-            fromRadioScratch.config.payload_variant.bluetooth = config.bluetooth;
-            break;
-        case meshtastic_Config_security_tag:
-            LOG_DEBUG("Send config: security");
-            fromRadioScratch.config.which_payload_variant = meshtastic_Config_security_tag;
-            fromRadioScratch.config.payload_variant.security = config.security;
-            break;
-        case meshtastic_Config_sessionkey_tag:
-            LOG_DEBUG("Send config: sessionkey");
-            fromRadioScratch.config.which_payload_variant = meshtastic_Config_sessionkey_tag;
-            break;
-        case meshtastic_Config_device_ui_tag: // NOOP!
-            fromRadioScratch.config.which_payload_variant = meshtastic_Config_device_ui_tag;
-            break;
-        default:
-            LOG_ERROR("Unknown config type %d", config_state);
-        }
-        // NOTE: The phone app needs to know the ls_secs value so it can properly expect sleep behavior.
-        // So even if we internally use 0 to represent 'use default' we still need to send the value we are
-        // using to the app (so that even old phone apps work with new device loads).
+        return numbytes;
+    }
 
+    case STATE_SEND_CONFIG: {
+        LOG_DEBUG("Send config %d", config_state);
+        size_t numbytes = copyConfigFrame(CONFIG_FRAME_CONFIG, buf);
         config_state++;
         // Advance when we have sent all of our config objects
         if (config_state > (_meshtastic_AdminMessage_ConfigType_MAX + 1)) {
             state = STATE_SEND_MODULECONFIG;
             config_state = _meshtastic_AdminMessage_ModuleConfigType_MIN + 1;
         }
-        break;
-
-    case STATE_SEND_MODULECONFIG:
-        fromRadioScratch.which_payload_variant = meshtastic_FromRadio_moduleConfig_tag;
-        switch (config_state) {
-        case meshtastic_ModuleConfig_mqtt_tag:
-            LOG_DEBUG("Send module config: mqtt");
-            fromRadioScratch.moduleConfig.which_payload_variant = meshtastic_ModuleConfig_mqtt_tag;
-            fromRadioScratch.moduleConfig.payload_variant.mqtt = moduleConfig.mqtt;
-            break;
-        case meshtastic_ModuleConfig_serial_tag:
-            LOG_DEBUG("Send module config: serial");
-            fromRadioScratch.moduleConfig.which_payload_variant = meshtastic_ModuleConfig_serial_tag;
-            fromRadioScratch.moduleConfig.payload_variant.serial = moduleConfig.serial;
-            break;
-        case meshtastic_ModuleConfig_external_notification_tag:
-            LOG_DEBUG("Send module config: ext notification");
-            fromRadioScratch.moduleConfig.which_payload_variant = meshtastic_ModuleConfig_external_notification_tag;
-            fromRadioScratch.moduleConfig.payload_variant.external_notification = moduleConfig.external_notification;
-            break;
-        case meshtastic_ModuleConfig_store_forward_tag:
-            LOG_DEBUG("Send module config: store forward");
-            fromRadioScratch.moduleConfig.which_payload_variant = meshtastic_ModuleConfig_store_forward_tag;
-            fromRadioScratch.moduleConfig.payload_variant.store_forward = moduleConfig.store_forward;
-            break;
-        case meshtastic_ModuleConfig_range_test_tag:
-            LOG_DEBUG("Send module config: range test");
-            fromRadioScratch.moduleConfig.which_payload_variant = meshtastic_ModuleConfig_range_test_tag;
-            fromRadioScratch.moduleConfig.payload_variant.range_test = moduleConfig.range_test;
-            break;
-        case meshtastic_ModuleConfig_telemetry_tag:
-            LOG_DEBUG("Send module config: telemetry");
-            fromRadioScratch.moduleConfig.which_payload_variant = meshtastic_ModuleConfig_telemetry_tag;
-            fromRadioScratch.moduleConfig.payload_variant.telemetry = moduleConfig.telemetry;
-            break;
-        case meshtastic_ModuleConfig_canned_message_tag:
-            LOG_DEBUG("Send module config: canned message");
-            fromRadioScratch.moduleConfig.which_payload_variant = meshtastic_ModuleConfig_canned_message_tag;
-            fromRadioScratch.moduleConfig.payload_variant.canned_message = moduleConfig.canned_message;
-            break;
-        case meshtastic_ModuleConfig_audio_tag:
-            LOG_DEBUG("Send module config: audio");
-            fromRadioScratch.moduleConfig.which_payload_variant = meshtastic_ModuleConfig_audio_tag;
-            fromRadioScratch.moduleConfig.payload_variant.audio = moduleConfig.audio;
-            break;
-        case meshtastic_ModuleConfig_remote_hardware_tag:
-            LOG_DEBUG("Send module config: remote hardware");
-            fromRadioScratch.moduleConfig.which_payload_variant = meshtastic_ModuleConfig_remote_hardware_tag;
-            fromRadioScratch.moduleConfig.payload_variant.remote_hardware = moduleConfig.remote_hardware;
-            break;
-        case meshtastic_ModuleConfig_neighbor_info_tag:
-            LOG_DEBUG("Send module config: neighbor info");
-            fromRadioScratch.moduleConfig.which_payload_variant = meshtastic_ModuleConfig_neighbor_info_tag;
-            fromRadioScratch.moduleConfig.payload_variant.neighbor_info = moduleConfig.neighbor_info;
-            break;
-        case meshtastic_ModuleConfig_detection_sensor_tag:
-            LOG_DEBUG("Send module config: detection sensor");
-            fromRadioScratch.moduleConfig.which_payload_variant = meshtastic_ModuleConfig_detection_sensor_tag;
-            fromRadioScratch.moduleConfig.payload_variant.detection_sensor = moduleConfig.detection_sensor;
-            break;
-        case meshtastic_ModuleConfig_ambient_lighting_tag:
-            LOG_DEBUG("Send module config: ambient lighting");
-            fromRadioScratch.moduleConfig.which_payload_variant = meshtastic_ModuleConfig_ambient_lighting_tag;
-            fromRadioScratch.moduleConfig.payload_variant.ambient_lighting = moduleConfig.ambient_lighting;
-            break;
-        case meshtastic_ModuleConfig_paxcounter_tag:
-            LOG_DEBUG("Send module config: paxcounter");
-            fromRadioScratch.moduleConfig.which_payload_variant = meshtastic_ModuleConfig_paxcounter_tag;
-            fromRadioScratch.moduleConfig.payload_variant.paxcounter = moduleConfig.paxcounter;
-            break;
-        default:
-            LOG_ERROR("Unknown module config type %d", config_state);
-        }
+        return numbytes;
+    }
 
+    case STATE_SEND_MODULECONFIG: {
+        LOG_DEBUG("Send module config %d", config_state);
+        size_t numbytes = copyConfigFrame(CONFIG_FRAME_MODULECONFIG, buf);
         config_state++;
         // Advance when we have sent all of our ModuleConfig objects
         if (config_state > (_meshtastic_AdminMessage_ModuleConfigType_MAX + 1)) {
@@ -424,18 +323,18 @@ size_t PhoneAPI::getFromRadio(uint8_t *buf)
                 state = STATE_SEND_OTHER_NODEINFOS;
             }
             config_state = 0;
+            configSnapshot.reset(); // Done with it, let a newer one replace it
         }
-        break;
+        return numbytes;
+    }
 
     case STATE_SEND_OTHER_NODEINFOS: {
         LOG_DEBUG("Send known nodes");
         if (nodeInfoForPhone.num != 0) {
-            LOG_INFO("nodeinfo: num=0x%x, lastseen=%u, id=%s, name=%s", nodeInfoForPhone.num, nodeInfoForPhone.last_heard,
-                     nodeInfoForPhone.user.id, nodeInfoForPhone.user.long_name);
-            fromRadioScratch.which_payload_variant = meshtastic_FromRadio_node_info_tag;
-            fromRadioScratch.node_info = nodeInfoForPhone;
+            LOG_INFO("nodeinfo: num=0x%x, lastseen=%u, id=!%08x, name=%s", nodeInfoForPhone.num, nodeInfoForPhone.last_heard,
+                     nodeInfoForPhone.num, nodeInfoForPhone.user.long_name);
             // Stay in current state until done sending nodeinfos
-            nodeInfoForPhone.num = 0; // We just consumed a nodeinfo, will need a new one next time
+            return encodeNodeInfoForPhone(buf); // We just consumed a nodeinfo, will need a new one next time
         } else {
             LOG_DEBUG("Done sending nodeinfo");
             state = STATE_SEND_FILEMANIFEST;
@@ -449,11 +348,18 @@ size_t PhoneAPI::getFromRadio(uint8_t *buf)
         LOG_DEBUG("FromRadio=STATE_SEND_FILEMANIFEST");
         // last element
         if (config_state == filesManifest.size() ||
-            config_nonce == SPECIAL_NONCE_ONLY_NODES) { // also handles an empty filesManifest
+            wantsOnlyNodes()) { // also handles an empty filesManifest
             config_state = 0;
             filesManifest.clear();
-            // Skip to complete packet
-            sendConfigComplete();
+            if (syncVersion) {
+                // Tell the client which node DB version the node list it just got is up to date with
+                fromRadioScratch.which_payload_variant = meshtastic_FromRadio_node_db_version_tag;
+                fromRadioScratch.node_db_version = syncVersion;
+                state = STATE_SEND_COMPLETE_ID;
+            } else {
+                // Skip to complete packet
+                sendConfigComplete();
+            }
         } else {
             fromRadioScratch.which_payload_variant = meshtastic_FromRadio_fileInfo_tag;
             fromRadioScratch.fileInfo = filesManifest.at(config_state);
@@ -488,6 +394,7 @@ size_t PhoneAPI::getFromRadio(uint8_t *buf)
             fromRadioScratch.clientNotification = *clientNotification;
             releaseClientNotification();
         } else if (packetForPhone) {
+            LATENCY_MARK(RX_FROM_RADIO, packetForPhone);
             printPacket("phone downloaded packet", packetForPhone);
 
             // Encapsulate as a FromRadio packet
@@ -515,12 +422,38 @@ size_t PhoneAPI::getFromRadio(uint8_t *buf)
     return 0;
 }
 
+size_t PhoneAPI::copyConfigFrame(ConfigFrameKind kind, uint8_t *buf)
+{
+    if (!configSnapshot)
+        configSnapshot = ConfigSnapshot::acquire(fromRadioScratch);
+    size_t numbytes = configSnapshot->copyFrame(kind, config_state, buf);
+
+    if (needsFromRadioScratch) {
+        memset(&fromRadioScratch, 0, sizeof(fromRadioScratch));
+        ConfigSnapshot::fillFrame(kind, config_state, fromRadioScratch);
+    }
+    return numbytes;
+}
+
+size_t PhoneAPI::encodeNodeInfoForPhone(uint8_t *buf)
+{
+    size_t numbytes = TypeConversions::EncodeFromRadioNodeInfo(buf, meshtastic_FromRadio_size, &nodeInfoForPhone);
+
+    if (needsFromRadioScratch) {
+        fromRadioScratch.which_payload_variant = meshtastic_FromRadio_node_info_tag;
+        fromRadioScratch.node_info = TypeConversions::ConvertToNodeInfo(&nodeInfoForPhone);
+    }
+    nodeInfoForPhone.num = 0;
+    return numbytes;
+}
+
 void PhoneAPI::sendConfigComplete()
 {
     LOG_INFO("Config Send Complete");
     fromRadioScratch.which_payload_variant = meshtastic_FromRadio_config_complete_id_tag;
     fromRadioScratch.config_complete_id = config_nonce;
     config_nonce = 0;
+    syncIncremental = false;
     state = STATE_SEND_PACKETS;
     pauseBluetoothLogging = false;
 }
@@ -578,9 +511,16 @@ bool PhoneAPI::available()
 
     case STATE_SEND_OTHER_NODEINFOS:
         if (nodeInfoForPhone.num == 0) {
-            auto nextNode = nodeDB->readNextMeshNode(readIndex);
+            NodeNum removed;
+            if (syncIncremental && nodeDB->readNextRemovedNode(removedReadIndex, syncSince, removed)) {
+                nodeInfoForPhone = meshtastic_NodeInfoLite_init_default;
+                nodeInfoForPhone.num = removed;
+                return true;
+            }
+            auto nextNode =
+                syncIncremental ? nodeDB->readNextChangedMeshNode(readIndex, syncSince) : nodeDB->readNextMeshNode(readIndex);
             if (nextNode) {
-                nodeInfoForPhone = TypeConversions::ConvertToNodeInfo(nextNode);
+                nodeInfoForPhone = *nextNode;
                 bool isUs = nodeInfoForPhone.num == nodeDB->getNodeNum();
                 nodeInfoForPhone.hops_away = isUs ? 0 : nodeInfoForPhone.hops_away;
                 nodeInfoForPhone.last_heard = isUs ? getValidTime(RTCQualityFromNet) : nodeInfoForPhone.last_heard;
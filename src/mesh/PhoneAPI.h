@@ -1,9 +1,11 @@
 #pragma once
 
+#include "ConfigSnapshot.h"
 #include "Observer.h"
 #include "mesh-pb-constants.h"
 #include "meshtastic/portnums.pb.h"
 #include <iterator>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -20,6 +22,15 @@
 
 #define SPECIAL_NONCE_ONLY_CONFIG 69420
 #define SPECIAL_NONCE_ONLY_NODES 69421 // ( ͡° ͜ʖ ͡°)
+/**
+ * Like SPECIAL_NONCE_ONLY_NODES, but only send the nodes that changed since the node DB change version the client last saw,
+ * which it gives in ToRadio.node_sync_since along with want_config_id. Every node list ends with a FromRadio.node_db_version
+ * frame, just before config_complete_id, holding the version the client is then up to date with. Removed nodes are sent
+ * first, as NodeInfos with nothing but their num set. If we can't tell what changed since that version the whole node list is
+ * sent instead, and the config_complete_id is SPECIAL_NONCE_ONLY_NODES so the client knows to replace its list rather than
+ * merge into it.
+ */
+#define SPECIAL_NONCE_NODES_SINCE 69422
 
 /**
  * Provides our protobuf based API which phone/PC clients can use to talk to our device
@@ -77,8 +88,8 @@ class PhoneAPI
     // Keep ClientNotification packet just as packetForPhone
     meshtastic_ClientNotification *clientNotification = NULL;
 
-    /// We temporarily keep the nodeInfo here between the call to available and getFromRadio
-    meshtastic_NodeInfo nodeInfoForPhone = meshtastic_NodeInfo_init_default;
+    /// We temporarily keep the node here between the call to available and getFromRadio, as the client is to see it
+    meshtastic_NodeInfoLite nodeInfoForPhone = meshtastic_NodeInfoLite_init_default;
 
     meshtastic_ToRadio toRadioScratch = {
         0}; // this is a static scratch object, any data must be copied elsewhere before returning
@@ -87,8 +98,17 @@ class PhoneAPI
     uint32_t config_nonce = 0;
     uint32_t readIndex = 0;
 
+    /// Node DB change versions the node list we are sending covers
+    uint32_t syncSince = 0;
+    uint32_t syncVersion = 0;
+    bool syncIncremental = false;
+    uint32_t removedReadIndex = 0;
+
     std::vector<meshtastic_FileInfo> filesManifest = {};
 
+    /// Pre-encoded channels and config this client is being sent, kept until it has them all
+    std::shared_ptr<const ConfigSnapshot> configSnapshot;
+
     void resetReadIndex() { readIndex = 0; }
 
   public:
@@ -153,7 +173,18 @@ class PhoneAPI
     /// begin a new connection
     void handleStartConfig();
 
+    /// Set by transports that send fromRadioScratch itself rather than the bytes getFromRadio() encoded
+    bool needsFromRadioScratch = false;
+
   private:
+    bool wantsOnlyNodes() const { return config_nonce == SPECIAL_NONCE_ONLY_NODES || config_nonce == SPECIAL_NONCE_NODES_SINCE; }
+
+    /// Copy the pre-encoded channel or config frame for config_state into buf
+    size_t copyConfigFrame(ConfigFrameKind kind, uint8_t *buf);
+
+    /// Encode nodeInfoForPhone into buf straight from the NodeInfoLite, then clear it
+    size_t encodeNodeInfoForPhone(uint8_t *buf);
+
     void releasePhonePacket();
 
     void releaseQueueStatusPhonePacket();
@@ -0,0 +1,192 @@
+#include "PhoneQueue.h"
+#include "concurrency/LockGuard.h"
+#include "configuration.h"
+#include "mesh-pb-constants.h"
+
+PhoneQueue::PhoneQueue(size_t capacity) : capacity(capacity)
+{
+    packets.reserve(capacity);
+}
+
+PhoneQueue::PortClass PhoneQueue::classify(const meshtastic_MeshPacket *p)
+{
+    if (p->which_payload_variant != meshtastic_MeshPacket_decoded_tag)
+        return CLASS_OTHER;
+
+    switch (p->decoded.portnum) {
+    case meshtastic_PortNum_TEXT_MESSAGE_APP:
+    case meshtastic_PortNum_TEXT_MESSAGE_COMPRESSED_APP:
+    case meshtastic_PortNum_ALERT_APP:
+    case meshtastic_PortNum_DETECTION_SENSOR_APP:
+    case meshtastic_PortNum_RANGE_TEST_APP:
+    case meshtastic_PortNum_WAYPOINT_APP:
+    case meshtastic_PortNum_ADMIN_APP:
+    case meshtastic_PortNum_ROUTING_APP:
+        return CLASS_CRITICAL;
+    case meshtastic_PortNum_POSITION_APP:
+    case meshtastic_PortNum_TELEMETRY_APP:
+    case meshtastic_PortNum_NODEINFO_APP:
+    case meshtastic_PortNum_NEIGHBORINFO_APP:
+        return CLASS_STATE;
+    default:
+        return CLASS_OTHER;
+    }
+}
+
+size_t PhoneQueue::budget(PortClass c) const
+{
+    switch (c) {
+    case CLASS_STATE:
+        return capacity / 2;
+    case CLASS_OTHER:
+        return capacity / 4 ? capacity / 4 : 1;
+    default:
+        return capacity;
+    }
+}
+
+int PhoneQueue::findOldest(PortClass c) const
+{
+    for (size_t i = 0; i < packets.size(); i++) {
+        if (classify(packets[i].packet) == c)
+            return i;
+    }
+    return -1;
+}
+
+// Telemetry packets of different variants (device, environment...) from the same node don't replace each other
+static pb_size_t telemetryVariant(const meshtastic_MeshPacket *p)
+{
+    if (p->which_payload_variant != meshtastic_MeshPacket_decoded_tag || p->decoded.portnum != meshtastic_PortNum_TELEMETRY_APP)
+        return 0;
+    meshtastic_Telemetry t = meshtastic_Telemetry_init_zero;
+    if (!pb_decode_from_bytes(p->decoded.payload.bytes, p->decoded.payload.size, &meshtastic_Telemetry_msg, &t))
+        return 0;
+    return t.which_variant;
+}
+
+int PhoneQueue::findSuperseded(const meshtastic_MeshPacket *p, pb_size_t telemetryVariant) const
+{
+    // Responses to something the client asked for are never replaced
+    if (classify(p) != CLASS_STATE || p->decoded.request_id)
+        return -1;
+    if (p->decoded.portnum == meshtastic_PortNum_TELEMETRY_APP && !telemetryVariant)
+        return -1;
+
+    for (size_t i = 0; i < packets.size(); i++) {
+        const meshtastic_MeshPacket *q = packets[i].packet;
+        if (q->from != p->from || classify(q) != CLASS_STATE || q->decoded.portnum != p->decoded.portnum ||
+            q->decoded.request_id || packets[i].telemetryVariant != telemetryVariant)
+            continue;
+        return i;
+    }
+    return -1;
+}
+
+meshtastic_MeshPacket *PhoneQueue::removeAt(size_t i)
+{
+    meshtastic_MeshPacket *p = packets[i].packet;
+    packets.erase(packets.begin() + i);
+    classCount[classify(p)]--;
+    return p;
+}
+
+void PhoneQueue::countDrop(const meshtastic_MeshPacket *p, bool coalesced)
+{
+    if (coalesced)
+        totalCoalesced++;
+    else
+        totalDropped++;
+    uint16_t port = p->which_payload_variant == meshtastic_MeshPacket_decoded_tag ? p->decoded.portnum : 0;
+    for (PortStats &s : stats) {
+        if (s.port == port || (s.dropped == 0 && s.coalesced == 0)) {
+            s.port = port;
+            if (coalesced)
+                s.coalesced++;
+            else
+                s.dropped++;
+            return;
+        }
+    }
+}
+
+meshtastic_MeshPacket *PhoneQueue::enqueue(meshtastic_MeshPacket *p)
+{
+    concurrency::LockGuard guard(&lock);
+    PortClass c = classify(p);
+    pb_size_t variant = c == CLASS_STATE ? telemetryVariant(p) : 0; // Decoded once here, not for every packet it is compared to
+
+    int superseded = findSuperseded(p, variant);
+    if (superseded >= 0) {
+        // Keep the old one's place in the queue, the client gets the newest data just as soon
+        meshtastic_MeshPacket *old = packets[superseded].packet;
+        packets[superseded].packet = p;
+        countDrop(old, true);
+        return old;
+    }
+
+    meshtastic_MeshPacket *evicted = nullptr;
+    if (classCount[c] >= budget(c)) {
+        evicted = removeAt(findOldest(c));
+    } else if (packets.size() >= capacity) {
+        int victim = findOldest(CLASS_OTHER);
+        if (victim < 0)
+            victim = findOldest(CLASS_STATE);
+        if (victim < 0 && c == CLASS_CRITICAL)
+            victim = findOldest(CLASS_CRITICAL);
+        if (victim < 0) {
+            LOG_WARN("ToPhone queue is full, drop packet on port %d", p->decoded.portnum);
+            countDrop(p, false);
+            return p;
+        }
+        evicted = removeAt(victim);
+    }
+    if (evicted) {
+        LOG_WARN("ToPhone queue has no room, discard oldest packet on port %d", evicted->decoded.portnum);
+        countDrop(evicted, false);
+    }
+
+    packets.push_back({p, variant});
+    classCount[c]++;
+    return evicted;
+}
+
+meshtastic_MeshPacket *PhoneQueue::dequeue()
+{
+    concurrency::LockGuard guard(&lock);
+    return packets.empty() ? nullptr : removeAt(0);
+}
+
+bool PhoneQueue::isEmpty()
+{
+    concurrency::LockGuard guard(&lock);
+    return packets.empty();
+}
+
+size_t PhoneQueue::numUsed()
+{
+    concurrency::LockGuard guard(&lock);
+    return packets.size();
+}
+
+NodeNum PhoneQueue::findDestination(PacketId id)
+{
+    concurrency::LockGuard guard(&lock);
+    NodeNum to = 0;
+    for (const Queued &q : packets) {
+        if (q.packet->id == id)
+            to = q.packet->to; // The newest match wins, as it did when this was a FIFO we cycled through
+    }
+    return to;
+}
+
+size_t PhoneQueue::getStats(PortStats *out, size_t max)
+{
+    concurrency::LockGuard guard(&lock);
+    size_t n = 0;
+    for (const PortStats &s : stats) {
+        if (n < max && (s.dropped || s.coalesced))
+            out[n++] = s;
+    }
+    return n;
+}
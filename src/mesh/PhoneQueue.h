@@ -0,0 +1,90 @@
+#pragma once
+
+#include "MeshTypes.h"
+#include "concurrency/Lock.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/// Number of ports we keep separate drop counters for, drops on any further ports are only counted in total
+#ifndef PHONE_QUEUE_STAT_PORTS
+#define PHONE_QUEUE_STAT_PORTS 8
+#endif
+
+/**
+ * Bounded queue of packets waiting for the phone, with a drop policy per class of port.
+ *
+ * - Critical packets (text, alerts, admin, routing, waypoints) may use the whole queue and are only evicted, oldest first, when
+ *   the queue holds nothing else.
+ * - State packets (position, telemetry, nodeinfo, neighborinfo) are only worth having in their latest version. A newer one from
+ *   the same node replaces the queued one in place, and they may use at most half of the queue.
+ * - Everything else may use at most a quarter of the queue and is evicted first.
+ *
+ * Packets are fixed size pool allocations, so a budget in packets is a budget in memory. Drops are counted per port.
+ */
+class PhoneQueue
+{
+  public:
+    enum PortClass : uint8_t { CLASS_CRITICAL, CLASS_STATE, CLASS_OTHER, CLASS_COUNT };
+
+    struct PortStats {
+        uint16_t port;
+        uint32_t dropped;   // Packets evicted or refused for lack of space
+        uint32_t coalesced; // Packets replaced by a newer one from the same node
+    };
+
+    explicit PhoneQueue(size_t capacity);
+
+    /**
+     * Queue a packet, evicting or replacing others as the policy says.
+     * @return a packet the caller must release: the one evicted or replaced, or `p` itself if it was refused. nullptr if
+     * nothing needs releasing.
+     */
+    meshtastic_MeshPacket *enqueue(meshtastic_MeshPacket *p);
+
+    /// Oldest packet, or nullptr if empty
+    meshtastic_MeshPacket *dequeue();
+
+    bool isEmpty();
+    size_t numUsed();
+
+    /// The `to` of a queued packet with the given id, 0 if there is none
+    NodeNum findDestination(PacketId id);
+
+    /// Copy the per port counters into `out`, returns how many there are
+    size_t getStats(PortStats *out, size_t max);
+
+    /// Packets thrown away since boot, evicted or refused for lack of space
+    uint32_t getTotalDropped() { return totalDropped; }
+
+    /// Packets replaced by a newer one from the same node since boot, the client still got the newest data
+    uint32_t getTotalCoalesced() { return totalCoalesced; }
+
+    static PortClass classify(const meshtastic_MeshPacket *p);
+
+  private:
+    struct Queued {
+        meshtastic_MeshPacket *packet;
+        pb_size_t telemetryVariant; // which_variant of a telemetry packet, 0 for other ports or if it didn't decode
+    };
+
+    concurrency::Lock lock;
+    size_t capacity;
+    std::vector<Queued> packets; // Oldest first
+    size_t classCount[CLASS_COUNT] = {}; // MAX_RX_TOPHONE can be set well beyond 255 on Linux
+    PortStats stats[PHONE_QUEUE_STAT_PORTS] = {};
+    uint32_t totalDropped = 0;
+    uint32_t totalCoalesced = 0;
+
+    size_t budget(PortClass c) const;
+
+    /// Index of the oldest packet of class `c`, -1 if none
+    int findOldest(PortClass c) const;
+
+    /// Index of a queued packet that `p`, with the given telemetry variant, supersedes, -1 if none
+    int findSuperseded(const meshtastic_MeshPacket *p, pb_size_t telemetryVariant) const;
+
+    meshtastic_MeshPacket *removeAt(size_t i);
+
+    void countDrop(const meshtastic_MeshPacket *p, bool coalesced);
+};
@@ -55,9 +55,11 @@ template <class T> class ProtobufModule : protected SinglePortModule
      * Gets the short name from the sender of the mesh packet
      * Returns "???" if unknown sender
      */
-    const char *getSenderShortName(const meshtastic_MeshPacket &mp)
+    const char *getSenderShortName(const meshtastic_MeshPacket &mp) { return getSenderShortName(getFrom(&mp)); }
+
+    const char *getSenderShortName(NodeNum from)
     {
-        auto node = nodeDB->getMeshNode(getFrom(&mp));
+        auto node = nodeDB->getMeshNode(from);
         const char *sender = (node) ? node->user.short_name : "???";
         return sender;
     }
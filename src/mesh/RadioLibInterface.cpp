@@ -1,4 +1,5 @@
 #include "RadioLibInterface.h"
+#include "LatencyTrace.h"
 #include "MeshTypes.h"
 #include "NodeDB.h"
 #include "PowerMon.h"
@@ -56,6 +57,8 @@ RadioLibInterface::RadioLibInterface(LockingArduinoHal *hal, RADIOLIB_PIN_TYPE c
 void INTERRUPT_ATTR RadioLibInterface::isrLevel0Common(PendingISR cause)
 {
     instance->disableInterrupt();
+    if (cause == ISR_RX)
+        LATENCY_MARK_ISR();
 
     BaseType_t xHigherPriorityTaskWoken;
     instance->notifyFromISR(&xHigherPriorityTaskWoken, cause, true);
@@ -172,6 +175,7 @@ ErrorCode RadioLibInterface::send(meshtastic_MeshPacket *p)
     printPacket("enqueue for send", p);
 
     LOG_DEBUG("txGood=%d,txRelay=%d,rxGood=%d,rxBad=%d", txGood, txRelay, rxGood, rxBad);
+    LATENCY_MARK(TX_QUEUED, p);
     ErrorCode res = txQueue.enqueue(p) ? ERRNO_OK : ERRNO_UNKNOWN;
 
     if (res != ERRNO_OK) { // we weren't able to queue it, so we must drop it to prevent leaks
@@ -283,7 +287,8 @@ void RadioLibInterface::onNotify(uint32_t notification)
                         if (sent) {
                             // Packet has been sent, count it toward our TX airtime utilization.
                             uint32_t xmitMsec = getPacketTime(txp);
-                            airTime->logAirtime(TX_LOG, xmitMsec);
+                            airTime->logAirtime(TX_LOG, xmitMsec, txp->from);
+                            airTime->logPacketAirtime(txp->from, txp->id, xmitMsec);
                         }
                         LOG_DEBUG("%d packets remain in the TX queue", txQueue.getMaxLen() - txQueue.getFree());
                     }
@@ -379,6 +384,7 @@ void RadioLibInterface::completeSending()
     sendingPacket = NULL;
 
     if (p) {
+        LATENCY_MARK(TX_COMPLETED, p);
         txGood++;
         if (!isFromUs(p))
             txRelay++;
@@ -473,8 +479,10 @@ void RadioLibInterface::handleReceiveInterrupt()
 
             printPacket("Lora RX", mp);
 
-            airTime->logAirtime(RX_LOG, xmitMsec);
+            airTime->logAirtime(RX_LOG, xmitMsec, mp->from);
+            airTime->logPacketAirtime(mp->from, mp->id, xmitMsec);
 
+            LATENCY_MARK(RX_RADIO, mp);
             deliverToReceiver(mp);
         }
     }
@@ -508,6 +516,7 @@ bool RadioLibInterface::startSend(meshtastic_MeshPacket *txp)
         packetPool.release(txp);
         return false;
     } else {
+        LATENCY_MARK(TX_STARTED, txp);
         configHardwareForSend(); // must be after setStandby
 
         size_t numbytes = beginSending(txp);
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+
+/// Set to 1 (e.g. in userPrefs.jsonc) to cancel rebroadcasts by counting relayers instead of on the first duplicate
+#ifndef USERPREFS_FLOOD_SUPPRESSION
+#define USERPREFS_FLOOD_SUPPRESSION 0
+#endif
+
+/// Channel utilization (percent) below which we still want the extra coverage of an additional relayer
+#define FLOOD_SUPPRESSION_QUIET_PERCENT 10
+/// Channel utilization (percent) from which routers and repeaters stop relaying floods enough others relay too
+#define FLOOD_SUPPRESSION_BUSY_PERCENT 25
+
+/**
+ * Counter-based rebroadcast suppression: while our rebroadcast of a flood waits out its SNR-weighted delay, we count the
+ * distinct nodes heard relaying it (PacketHistory keeps up to NUM_RELAYERS of them) and cancel ours once enough of them
+ * did. The fewer neighbours we have, the less likely that is, so sparse parts of the mesh keep relaying while dense ones
+ * go quiet. How many is enough shrinks as the channel gets busier.
+ */
+class RebroadcastSuppression
+{
+  public:
+    /**
+     * How many distinct relayers of a flood, counting the one we first heard it from, must be heard before we cancel our
+     * own rebroadcast of it.
+     * @return 0 to always rebroadcast
+     */
+    static uint8_t getThreshold(float channelUtilPercent, bool isRouter)
+    {
+        if (isRouter) // Placed to relay, so only hold back when the channel is busy and three others already did
+            return channelUtilPercent < FLOOD_SUPPRESSION_BUSY_PERCENT ? 0 : 3;
+        return channelUtilPercent < FLOOD_SUPPRESSION_QUIET_PERCENT ? 3 : 2;
+    }
+};
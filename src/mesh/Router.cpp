@@ -2,13 +2,17 @@
 #include "Channels.h"
 #include "CryptoEngine.h"
 #include "MeshRadio.h"
+#include "LatencyTrace.h"
 #include "MeshService.h"
 #include "NodeDB.h"
+#include "PacketAggregator.h"
 #include "RTC.h"
+#include "concurrency/LockGuard.h"
 #include "configuration.h"
 #include "detect/LoRaRadioType.h"
 #include "main.h"
 #include "mesh-pb-constants.h"
+#include "mesh/compression/PayloadCompressor.h"
 #include "meshUtils.h"
 #include "modules/RoutingModule.h"
 #if !MESHTASTIC_EXCLUDE_MQTT
@@ -22,9 +26,6 @@
 #include "serialization/MeshPacketSerializer.h"
 #endif
 
-#define MAX_RX_FROMRADIO                                                                                                         \
-    4 // max number of packets destined to our queue, we dispatch packets quickly so it doesn't need to be big
-
 // I think this is right, one packet for each of the three fifos + one packet being currently assembled for TX or RX
 // And every TX packet might have a retransmission packet or an ack alive at any moment
 #define MAX_PACKETS                                                                                                              \
@@ -43,7 +44,7 @@ static uint8_t bytes[MAX_LORA_PAYLOAD_LEN + 1] __attribute__((__aligned__));
  *
  * Currently we only allow one interface, that may change in the future
  */
-Router::Router() : concurrency::OSThread("Router"), fromRadioQueue(MAX_RX_FROMRADIO)
+Router::Router() : concurrency::OSThread("Router")
 {
     // This is called pre main(), don't touch anything here, the following code is not safe
 
@@ -65,7 +66,7 @@ Router::Router() : concurrency::OSThread("Router"), fromRadioQueue(MAX_RX_FROMRA
 int32_t Router::runOnce()
 {
     meshtastic_MeshPacket *mp;
-    while ((mp = fromRadioQueue.dequeuePtr(0)) != NULL) {
+    while (fromRadioQueue.dequeue(&mp)) {
         mp->transport_mechanism = meshtastic_MeshPacket_TransportMechanism_TRANSPORT_LORA;
         // printPacket("handle fromRadioQ", mp);
         perhapsHandleReceived(mp);
@@ -76,19 +77,27 @@ int32_t Router::runOnce()
 }
 
 /**
- * RadioInterface calls this to queue up packets that have been received from the radio.  The router is now responsible for
- * freeing the packet
+ * RadioInterface, UDP, MQTT and sendLocal call this, from whatever thread they run on, to queue up packets that have been
+ * received.  The router is now responsible for freeing the packet
  */
 void Router::enqueueReceivedMessage(meshtastic_MeshPacket *p)
 {
-    // Try enqueue until successful
-    while (!fromRadioQueue.enqueue(p, 0)) {
-        meshtastic_MeshPacket *old_p;
-        old_p = fromRadioQueue.dequeuePtr(0); // Dequeue and discard the oldest packet
-        if (old_p) {
-            printPacket("fromRadioQ full, drop oldest!", old_p);
-            packetPool.release(old_p);
-        }
+    LATENCY_MARK(RX_QUEUED, p);
+    bool queued;
+    {
+        // The ring takes one producer at a time
+#if ARCH_PORTDUINO
+        std::lock_guard<std::mutex> guard(fromRadioLock);
+#else
+        concurrency::LockGuard guard(&fromRadioLock);
+#endif
+        queued = fromRadioQueue.enqueue(p);
+    }
+    // Only the router may dequeue, so when it has fallen this far behind the newest packet is the one to go
+    if (!queued) {
+        printPacket("fromRadioQ full, drop newest!", p);
+        packetPool.release(p);
+        return;
     }
     // Nasty hack because our threading is primitive.  interfaces shouldn't need to know about routers FIXME
     setReceivedMessage();
@@ -273,9 +282,20 @@ ErrorCode Router::send(meshtastic_MeshPacket *p)
 
     fixPriority(p); // Before encryption, fix the priority if it's unset
 
+    ChannelIndex chIndex = p->channel; // keep as a local because we are about to change it
+#if USERPREFS_PACKET_AGGREGATION
+    // Containers only repeat packets that already went to MQTT and UDP on their own
+    bool isContainer = p->which_payload_variant == meshtastic_MeshPacket_decoded_tag && p->decoded.portnum == AGGREGATE_PORTNUM;
+    bool aggregate = packetAggregator && PacketAggregator::isAggregatable(p);
+#else
+    bool isContainer = false;
+#endif
+    // Relays we couldn't decode were given their port when we heard them
+    bool portKnown = p->which_payload_variant == meshtastic_MeshPacket_decoded_tag;
+    meshtastic_PortNum port = portKnown ? p->decoded.portnum : meshtastic_PortNum_UNKNOWN_APP;
+
     // If the packet is not yet encrypted, do so now
     if (p->which_payload_variant == meshtastic_MeshPacket_decoded_tag) {
-        ChannelIndex chIndex = p->channel; // keep as a local because we are about to change it
         meshtastic_MeshPacket *p_decoded = packetPool.allocCopy(*p);
 
         auto encodeResult = perhapsEncode(p);
@@ -287,7 +307,7 @@ ErrorCode Router::send(meshtastic_MeshPacket *p)
         }
 #if !MESHTASTIC_EXCLUDE_MQTT
         // Only publish to MQTT if we're the original transmitter of the packet
-        if (moduleConfig.mqtt.enabled && isFromUs(p) && mqtt) {
+        if (moduleConfig.mqtt.enabled && isFromUs(p) && mqtt && !isContainer) {
             mqtt->onSend(*p, *p_decoded, chIndex);
         }
 #endif
@@ -295,24 +315,52 @@ ErrorCode Router::send(meshtastic_MeshPacket *p)
     }
 
 #if HAS_UDP_MULTICAST
-    if (udpHandler && config.network.enabled_protocols & meshtastic_Config_NetworkConfig_ProtocolFlags_UDP_BROADCAST) {
+    if (udpHandler && config.network.enabled_protocols & meshtastic_Config_NetworkConfig_ProtocolFlags_UDP_BROADCAST &&
+        !isContainer) {
         udpHandler->onSend(const_cast<meshtastic_MeshPacket *>(p));
     }
 #endif
 
+    if (portKnown)
+        airTime->setPacketPort(p->from, p->id, port); // Charged once the radio has sent it, a canceled relay costs nothing
+
+#if USERPREFS_PACKET_AGGREGATION
+    if (aggregate && packetAggregator->add(p, chIndex))
+        return ERRNO_OK; // Sent with the others of its batch once the batching window closes
+#endif
+
     assert(iface); // This should have been detected already in sendLocal (or we just received a packet from outside)
     return iface->send(p);
 }
 
+meshtastic_MeshPacket *Router::allocRelayCopy(const meshtastic_MeshPacket *p)
+{
+    meshtastic_MeshPacket *copy = packetPool.allocCopy(*p);
+    if (rxUndecompressed && rxUndecompressed->from == p->from && rxUndecompressed->id == p->id) {
+        // The channel goes with the payload: a hash next to encrypted bytes, an index next to decoded ones
+        copy->channel = rxUndecompressed->channel;
+        copy->which_payload_variant = rxUndecompressed->which_payload_variant;
+        if (copy->which_payload_variant == meshtastic_MeshPacket_encrypted_tag)
+            copy->encrypted = rxUndecompressed->encrypted;
+        else
+            copy->decoded = rxUndecompressed->decoded;
+    }
+    return copy;
+}
+
 /** Attempt to cancel a previously sent packet.  Returns true if a packet was found we could cancel */
 bool Router::cancelSending(NodeNum from, PacketId id)
 {
-    if (iface && iface->cancelSending(from, id)) {
+    bool canceled = iface && iface->cancelSending(from, id);
+#if USERPREFS_PACKET_AGGREGATION
+    // It may not have reached the TX queue yet, still waiting for others to share its frame
+    canceled = canceled || (packetAggregator && packetAggregator->cancel(from, id));
+#endif
+    if (canceled) {
         // We are not a relayer of this packet anymore
         removeRelayer(nodeDB->getLastByteOfNodeNum(nodeDB->getNodeNum()), id, from);
-        return true;
     }
-    return false;
+    return canceled;
 }
 
 /** Attempt to find a packet in the TxQueue. Returns true if the packet was found. */
@@ -423,26 +471,6 @@ DecodeState perhapsDecode(meshtastic_MeshPacket *p)
         if (p->decoded.has_bitfield)
             p->decoded.want_response |= p->decoded.bitfield & BITFIELD_WANT_RESPONSE_MASK;
 
-        /* Not actually ever used.
-        // Decompress if needed. jm
-        if (p->decoded.portnum == meshtastic_PortNum_TEXT_MESSAGE_COMPRESSED_APP) {
-            // Decompress the payload
-            char compressed_in[meshtastic_Constants_DATA_PAYLOAD_LEN] = {};
-            char decompressed_out[meshtastic_Constants_DATA_PAYLOAD_LEN] = {};
-            int decompressed_len;
-
-            memcpy(compressed_in, p->decoded.payload.bytes, p->decoded.payload.size);
-
-            decompressed_len = unishox2_decompress_simple(compressed_in, p->decoded.payload.size, decompressed_out);
-
-            // LOG_DEBUG("**Decompressed length - %d ", decompressed_len);
-
-            memcpy(p->decoded.payload.bytes, decompressed_out, decompressed_len);
-
-            // Switch the port from PortNum_TEXT_MESSAGE_COMPRESSED_APP to PortNum_TEXT_MESSAGE_APP
-            p->decoded.portnum = meshtastic_PortNum_TEXT_MESSAGE_APP;
-        } */
-
         printPacket("decoded message", p);
 #if ENABLE_JSON_LOGGING
         LOG_TRACE("%s", MeshPacketSerializer::JsonSerialize(p, false).c_str());
@@ -474,42 +502,14 @@ meshtastic_Routing_Error perhapsEncode(meshtastic_MeshPacket *p)
             p->decoded.bitfield |= (p->decoded.want_response << BITFIELD_WANT_RESPONSE_SHIFT);
         }
 
-        size_t numbytes = pb_encode_to_bytes(bytes, sizeof(bytes), &meshtastic_Data_msg, &p->decoded);
-
-        /* Not actually used, so save the cycles
-        //  TODO: Allow modules to opt into compression.
-        if (p->decoded.portnum == meshtastic_PortNum_TEXT_MESSAGE_APP) {
-
-            char original_payload[meshtastic_Constants_DATA_PAYLOAD_LEN];
-            memcpy(original_payload, p->decoded.payload.bytes, p->decoded.payload.size);
-
-            char compressed_out[meshtastic_Constants_DATA_PAYLOAD_LEN] = {0};
-
-            int compressed_len;
-            compressed_len = unishox2_compress_simple(original_payload, p->decoded.payload.size, compressed_out);
-
-            LOG_DEBUG("Original length - %d ", p->decoded.payload.size);
-            LOG_DEBUG("Compressed length - %d ", compressed_len);
-            LOG_DEBUG("Original message - %s ", p->decoded.payload.bytes);
-
-            // If the compressed length is greater than or equal to the original size, don't use the compressed form
-            if (compressed_len >= p->decoded.payload.size) {
-
-                LOG_DEBUG("Not using compressing message");
-                // Set the uncompressed payload variant anyway. Shouldn't hurt?
-                // p->decoded.which_payloadVariant = Data_payload_tag;
-
-                // Otherwise we use the compressor
-            } else {
-                LOG_DEBUG("Use compressed message");
-                // Copy the compressed data into the meshpacket
-
-                p->decoded.payload.size = compressed_len;
-                memcpy(p->decoded.payload.bytes, compressed_out, compressed_len);
-
-                p->decoded.portnum = meshtastic_PortNum_TEXT_MESSAGE_COMPRESSED_APP;
-            }
-        } */
+        const meshtastic_Data *data = &p->decoded;
+#if MESHTASTIC_PAYLOAD_COMPRESSION
+        // Compress into a copy, p->decoded stays as is in case encoding fails. Only our own packets, relays go out as they came.
+        meshtastic_Data compressed;
+        if (isFromUs(p) && PayloadCompressor::compress(p->decoded, compressed))
+            data = &compressed;
+#endif
+        size_t numbytes = pb_encode_to_bytes(bytes, sizeof(bytes), &meshtastic_Data_msg, data);
 
         if (numbytes + MESHTASTIC_HEADER_LENGTH > MAX_LORA_PAYLOAD_LEN)
             return meshtastic_Routing_Error_TOO_LARGE;
@@ -610,12 +610,22 @@ void Router::handleReceived(meshtastic_MeshPacket *p, RxSource src)
 
     // Take those raw bytes and convert them back into a well structured protobuf we can understand
     auto decodedState = perhapsDecode(p);
+    bool decompressed = false;
+    LATENCY_MARK(RX_DECODED, p);
     if (decodedState == DecodeState::DECODE_FATAL) {
         // Fatal decoding error, we can't do anything with this packet
         LOG_WARN("Fatal decode error, dropping packet");
         cancelSending(p->from, p->id);
         skipHandle = true;
     } else if (decodedState == DecodeState::DECODE_SUCCESS) {
+        // Modules and the phone get the text, relays keep what the sender compressed
+        if (PayloadCompressor::isCompressed(p->decoded.portnum)) {
+            if (PayloadCompressor::decompress(p->decoded))
+                decompressed = true;
+            else
+                LOG_WARN("Passing on compressed payload of packet id=0x%08x as is", p->id);
+        }
+
         // parsing was successful, queue for our recipient
         if (src == RX_SRC_LOCAL)
             printPacket("handleReceived(LOCAL)", p);
@@ -638,23 +648,48 @@ void Router::handleReceived(meshtastic_MeshPacket *p, RxSource src)
 #if USERPREFS_EVENT_MODE
         shouldIgnoreNonstandardPorts = true;
 #endif
-        if (shouldIgnoreNonstandardPorts && p->which_payload_variant == meshtastic_MeshPacket_decoded_tag &&
-            !IS_ONE_OF(p->decoded.portnum, meshtastic_PortNum_TEXT_MESSAGE_APP, meshtastic_PortNum_TEXT_MESSAGE_COMPRESSED_APP,
-                       meshtastic_PortNum_POSITION_APP, meshtastic_PortNum_NODEINFO_APP, meshtastic_PortNum_ROUTING_APP,
-                       meshtastic_PortNum_TELEMETRY_APP, meshtastic_PortNum_ADMIN_APP, meshtastic_PortNum_ALERT_APP,
-                       meshtastic_PortNum_KEY_VERIFICATION_APP, meshtastic_PortNum_WAYPOINT_APP,
-                       meshtastic_PortNum_STORE_FORWARD_APP, meshtastic_PortNum_TRACEROUTE_APP)) {
+        bool isCorePort =
+            IS_ONE_OF(p->decoded.portnum, meshtastic_PortNum_TEXT_MESSAGE_APP, meshtastic_PortNum_TEXT_MESSAGE_COMPRESSED_APP,
+                      meshtastic_PortNum_POSITION_APP, meshtastic_PortNum_NODEINFO_APP, meshtastic_PortNum_ROUTING_APP,
+                      meshtastic_PortNum_TELEMETRY_APP, meshtastic_PortNum_ADMIN_APP, meshtastic_PortNum_ALERT_APP,
+                      meshtastic_PortNum_KEY_VERIFICATION_APP, meshtastic_PortNum_WAYPOINT_APP,
+                      meshtastic_PortNum_STORE_FORWARD_APP, meshtastic_PortNum_TRACEROUTE_APP, TEXT_MESSAGE_CODEC_PORTNUM);
+#if USERPREFS_PACKET_AGGREGATION
+        isCorePort = isCorePort || p->decoded.portnum == AGGREGATE_PORTNUM;
+#endif
+        if (shouldIgnoreNonstandardPorts && p->which_payload_variant == meshtastic_MeshPacket_decoded_tag && !isCorePort) {
             LOG_DEBUG("Ignore packet on non-standard portnum for CORE_PORTNUMS_ONLY");
             cancelSending(p->from, p->id);
             skipHandle = true;
         }
+
+#if USERPREFS_PACKET_AGGREGATION
+        // The container itself is neither delivered nor relayed, the packets in it are
+        if (p->which_payload_variant == meshtastic_MeshPacket_decoded_tag && p->decoded.portnum == AGGREGATE_PORTNUM) {
+            unpackAggregate(p);
+            skipHandle = true;
+        }
+#endif
     } else {
         printPacket("packet decoding failed or skipped (no PSK?)", p);
     }
 
+    // The radio only knew the sender, now the copies it heard can be charged to the port. Packets out of a container were paid
+    // for by the container.
+    if (src == RX_SRC_RADIO && !unpackingAggregate) {
+        bool decoded =
+            decodedState == DecodeState::DECODE_SUCCESS && p->which_payload_variant == meshtastic_MeshPacket_decoded_tag;
+        airTime->setPacketPort(p->from, p->id, decoded ? p->decoded.portnum : meshtastic_PortNum_UNKNOWN_APP);
+    }
+
     // call modules here
     if (!skipHandle) {
+        const meshtastic_MeshPacket *outerUndecompressed = rxUndecompressed;
+        if (decompressed)
+            rxUndecompressed = p_encrypted;
         MeshModule::callModules(*p, src);
+        rxUndecompressed = outerUndecompressed;
+        LATENCY_MARK(RX_MODULES, p);
 
 #if !MESHTASTIC_EXCLUDE_MQTT
         // Mark as pki_encrypted if it is not yet decoded and MQTT encryption is also enabled, hash matches and it's a DM not to
@@ -672,6 +707,37 @@ void Router::handleReceived(meshtastic_MeshPacket *p, RxSource src)
     packetPool.release(p_encrypted); // Release the encrypted packet
 }
 
+#if USERPREFS_PACKET_AGGREGATION
+void Router::unpackAggregate(const meshtastic_MeshPacket *p)
+{
+    if (unpackingAggregate) {
+        LOG_WARN("Ignore container nested in container id=0x%08x", p->id);
+        return;
+    }
+    unpackingAggregate = true;
+
+    // Each packet gets the container's header, then its own destination, id and encrypted payload, as if heard on its own
+    AggregateRecord r;
+    size_t offset = 0;
+    while (AggregateFrame::next(p->decoded.payload.bytes, p->decoded.payload.size, offset, r)) {
+        meshtastic_MeshPacket *inner = packetPool.allocCopy(*p);
+        inner->to = r.to;
+        inner->id = r.id;
+        inner->next_hop = r.nextHop;
+        inner->channel = r.channelHash;
+        inner->want_ack = false;
+        inner->which_payload_variant = meshtastic_MeshPacket_encrypted_tag;
+        memcpy(inner->encrypted.bytes, r.bytes, r.size);
+        inner->encrypted.size = r.size;
+        perhapsHandleReceived(inner);
+    }
+    if (offset != p->decoded.payload.size)
+        LOG_WARN("Container id=0x%08x truncated after %u of %u bytes", p->id, offset, p->decoded.payload.size);
+
+    unpackingAggregate = false;
+}
+#endif
+
 void Router::perhapsHandleReceived(meshtastic_MeshPacket *p)
 {
 #if ENABLE_JSON_LOGGING
@@ -7,7 +7,17 @@
 #include "PacketHistory.h"
 #include "PointerQueue.h"
 #include "RadioInterface.h"
+#include "SPSCQueue.h"
+#include "concurrency/Lock.h"
 #include "concurrency/OSThread.h"
+#if ARCH_PORTDUINO
+#include <mutex>
+#endif
+
+/// Max number of received packets waiting for the router, a power of two. A burst beyond this drops the newest packets
+#ifndef MAX_RX_FROMRADIO
+#define MAX_RX_FROMRADIO 16
+#endif
 
 /**
  * A mesh aware router that supports multiple interfaces.
@@ -15,9 +25,15 @@
 class Router : protected concurrency::OSThread, protected PacketHistory
 {
   private:
-    /// Packets which have just arrived from the radio, ready to be processed by this service and possibly
-    /// forwarded to the phone.
-    PointerQueue<meshtastic_MeshPacket> fromRadioQueue;
+    /// Packets which have just arrived from the radio, UDP, MQTT or our own sendLocal, ready to be processed by this
+    /// service and possibly forwarded to the phone. This thread is the only consumer, but those producers run on
+    /// threads of their own, so they take turns through fromRadioLock.
+    SPSCQueue<meshtastic_MeshPacket *, MAX_RX_FROMRADIO> fromRadioQueue;
+#if ARCH_PORTDUINO
+    std::mutex fromRadioLock; // concurrency::Lock does nothing without FreeRTOS, and the web server has its own thread
+#else
+    concurrency::Lock fromRadioLock;
+#endif
 
   protected:
     RadioInterface *iface = NULL;
@@ -91,6 +107,10 @@ class Router : protected concurrency::OSThread, protected PacketHistory
         before us */
     uint32_t rxDupe = 0, txRelayCanceled = 0;
 
+    /// Packets from the radio dropped because the router fell behind, and the most that were ever waiting for it
+    uint32_t getRxQueueOverflows() const { return fromRadioQueue.getOverflows(); }
+    uint32_t getRxQueueHighWater() const { return fromRadioQueue.getHighWater(); }
+
   protected:
     friend class RoutingModule;
 
@@ -115,7 +135,16 @@ class Router : protected concurrency::OSThread, protected PacketHistory
      */
     void sendAckNak(meshtastic_Routing_Error err, NodeNum to, PacketId idFrom, ChannelIndex chIndex, uint8_t hopLimit = 0);
 
+    /**
+     * Copy a received packet for relaying. If we decompressed it for the modules and the phone, the copy gets the payload
+     * the sender put on the air instead, so relays neither grow it nor depend on how we would compress it.
+     */
+    meshtastic_MeshPacket *allocRelayCopy(const meshtastic_MeshPacket *p);
+
   private:
+    /// While the modules handle a packet that was decompressed, the packet as it was received
+    const meshtastic_MeshPacket *rxUndecompressed = nullptr;
+
     /**
      * Called from loop()
      * Handle any packet that is received by an interface on this node.
@@ -136,6 +165,17 @@ class Router : protected concurrency::OSThread, protected PacketHistory
      */
     void handleReceived(meshtastic_MeshPacket *p, RxSource src = RX_SRC_RADIO);
 
+#if USERPREFS_PACKET_AGGREGATION
+    /**
+     * Hand each packet of a container from PacketAggregator to perhapsHandleReceived(), so that dedupe, relaying and
+     * delivery see them as if they had arrived in frames of their own.
+     */
+    void unpackAggregate(const meshtastic_MeshPacket *p);
+#endif
+
+    /// Set while unpacking, containers don't nest
+    bool unpackingAggregate = false;
+
     /** Frees the provided packet, and generates a NAK indicating the specifed error while sending */
     void abortSendAndNak(meshtastic_Routing_Error err, meshtastic_MeshPacket *p);
 };
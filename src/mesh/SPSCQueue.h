@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "concurrency/OSThread.h"
+#include "freertosinc.h"
+
+/**
+ * A fixed-size lock-free queue for handing small POD items (usually pointers) from exactly one producer to exactly one
+ * consumer, which may run in different threads or the producer in an interrupt.
+ *
+ * The producer only writes tail and the consumer only writes head, so plain atomic loads and stores are enough: no
+ * read-modify-write, which Cortex-M0 parts don't have. When the queue is full enqueue() fails and counts an overflow,
+ * dropping an item is up to the producer, it must never dequeue to make room.
+ *
+ * Producers on more than one thread must hold a lock of their own around enqueue(), the consumer needs none.
+ */
+template <class T, size_t N> class SPSCQueue
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "N must be a power of two");
+
+    T items[N];
+    std::atomic<uint32_t> head{0}; // Next item to dequeue
+    std::atomic<uint32_t> tail{0}; // Next free slot
+    std::atomic<uint32_t> overflows{0};
+    std::atomic<uint32_t> highWater{0};
+    concurrency::OSThread *reader = NULL;
+
+    bool push(T x)
+    {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        uint32_t used = t - head.load(std::memory_order_acquire);
+        if (used >= N) {
+            overflows.store(overflows.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        items[t % N] = x;
+        tail.store(t + 1, std::memory_order_release);
+        if (used + 1 > highWater.load(std::memory_order_relaxed))
+            highWater.store(used + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+  public:
+    /// Producer only. Returns false, and counts an overflow, if the queue is full
+    bool enqueue(T x)
+    {
+        if (!push(x))
+            return false;
+        if (reader) {
+            reader->setInterval(0);
+            concurrency::mainDelay.interrupt();
+        }
+        return true;
+    }
+
+#ifdef HAS_FREE_RTOS
+    bool enqueueFromISR(T x, BaseType_t *higherPriWoken)
+    {
+        if (!push(x))
+            return false;
+        if (reader) {
+            reader->setInterval(0);
+            concurrency::mainDelay.interruptFromISR(higherPriWoken);
+        }
+        return true;
+    }
+#endif
+
+    /// Consumer only. Returns false if the queue is empty
+    bool dequeue(T *p)
+    {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+            return false;
+        *p = items[h % N];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    int numUsed() const { return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire); }
+
+    int numFree() const { return N - numUsed(); }
+
+    bool isEmpty() const { return numUsed() == 0; }
+
+    /// Items refused because the queue was full
+    uint32_t getOverflows() const { return overflows.load(std::memory_order_relaxed); }
+
+    /// Most items ever waiting at once
+    uint32_t getHighWater() const { return highWater.load(std::memory_order_relaxed); }
+
+    /**
+     * Set a thread that is reading from this queue
+     * If a message is pushed to this queue that thread will be scheduled to run ASAP.
+     *
+     * Note: thread will not be automatically enabled, just have its interval set to 0
+     */
+    void setReader(concurrency::OSThread *t) { reader = t; }
+};
@@ -0,0 +1,44 @@
+#include "SaveDebouncer.h"
+
+void SaveDebouncer::mark(int segments, uint32_t nowMs)
+{
+    if (!segments)
+        return;
+    if (!pending)
+        firstMs = nowMs;
+    lastMs = nowMs;
+    pending |= segments;
+}
+
+int SaveDebouncer::takeDue(uint32_t nowMs)
+{
+    if (getDelay(nowMs) != 0)
+        return 0;
+    return takeAll();
+}
+
+int SaveDebouncer::takeAll()
+{
+    int segments = pending;
+    pending = 0;
+    return segments;
+}
+
+void SaveDebouncer::clear(int segments)
+{
+    pending &= ~segments;
+}
+
+int32_t SaveDebouncer::getDelay(uint32_t nowMs) const
+{
+    if (!pending)
+        return -1;
+    // Elapsed times rather than deadlines, so that millis() wrapping around doesn't matter
+    uint32_t sinceLast = nowMs - lastMs;
+    uint32_t sinceFirst = nowMs - firstMs;
+    if (sinceLast >= SAVE_DEBOUNCE_MS || sinceFirst >= SAVE_MAX_DELAY_MS)
+        return 0;
+    uint32_t untilQuiet = SAVE_DEBOUNCE_MS - sinceLast;
+    uint32_t untilMax = SAVE_MAX_DELAY_MS - sinceFirst;
+    return untilQuiet < untilMax ? untilQuiet : untilMax;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdint.h>
+
+/// A save waits this long after the last change, so a burst of changes is written once
+#ifndef SAVE_DEBOUNCE_MS
+#define SAVE_DEBOUNCE_MS 3000
+#endif
+
+/// ...but never longer than this after the first change, however long the burst goes on
+#ifndef SAVE_MAX_DELAY_MS
+#define SAVE_MAX_DELAY_MS 30000
+#endif
+
+/**
+ * Which NodeDB segments (SEGMENT_CONFIG etc.) need saving and when. Segments marked while others are waiting are saved
+ * with them.
+ */
+class SaveDebouncer
+{
+  public:
+    void mark(int segments, uint32_t nowMs);
+
+    /// The segments that are due, which are no longer pending after this
+    int takeDue(uint32_t nowMs);
+
+    /// All pending segments, due or not
+    int takeAll();
+
+    /// Forget about segments that were saved some other way
+    void clear(int segments);
+
+    int getPending() const { return pending; }
+
+    /// How long until the pending segments are due, 0 if they are, -1 if nothing is pending
+    int32_t getDelay(uint32_t nowMs) const;
+
+  private:
+    int pending = 0;
+    uint32_t firstMs = 0; // When the oldest pending change was marked
+    uint32_t lastMs = 0;  // When the newest was
+};
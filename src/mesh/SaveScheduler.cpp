@@ -0,0 +1,168 @@
+#include "SaveScheduler.h"
+#include "NodeDB.h"
+#include "Throttle.h"
+#include "sleep.h"
+
+SaveScheduler *saveScheduler = NULL;
+
+#if ARCH_PORTDUINO
+static const int ALL_SEGMENTS[] = {SEGMENT_CONFIG, SEGMENT_MODULECONFIG, SEGMENT_DEVICESTATE, SEGMENT_CHANNELS,
+                                   SEGMENT_NODEDATABASE};
+#endif
+
+SaveScheduler::SaveScheduler() : concurrency::OSThread("SaveScheduler")
+{
+    notifyRebootObserver.observe(&notifyReboot);
+    notifyDeepSleepObserver.observe(&notifyDeepSleep);
+#if ARCH_PORTDUINO
+    worker = std::thread(&SaveScheduler::runWorker, this);
+#endif
+    disable(); // Until something needs saving
+}
+
+SaveScheduler::~SaveScheduler()
+{
+    flush();
+#if ARCH_PORTDUINO
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    changed.notify_all();
+    worker.join();
+#endif
+}
+
+void SaveScheduler::markDirty(int segments)
+{
+    debouncer.mark(segments, millis());
+    enabled = true;
+    setIntervalFromNow(getNextDelay());
+}
+
+void SaveScheduler::setHeld(bool held)
+{
+    this->held = held;
+    heldSinceMs = millis();
+    if (!held && debouncer.getPending()) {
+        enabled = true;
+        setIntervalFromNow(getNextDelay());
+    }
+}
+
+void SaveScheduler::flush()
+{
+    int segments = debouncer.takeAll();
+    if (segments) {
+        LOG_INFO("Save pending changes %d now", segments);
+        save(segments);
+    }
+#if ARCH_PORTDUINO
+    std::unique_lock<std::mutex> guard(lock);
+    changed.wait(guard, [this] { return jobs.empty() && !writing; });
+#endif
+}
+
+void SaveScheduler::superseded(int segments)
+{
+    debouncer.clear(segments);
+#if ARCH_PORTDUINO
+    std::unique_lock<std::mutex> guard(lock);
+    for (auto it = jobs.begin(); it != jobs.end();)
+        it = (it->segment & segments) ? jobs.erase(it) : it + 1;
+    failed &= ~segments;
+    changed.wait(guard, [this] { return !writing; }); // What's being written may be older than what the caller has
+#endif
+}
+
+int32_t SaveScheduler::runOnce()
+{
+#if ARCH_PORTDUINO
+    int retry;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        retry = failed;
+        failed = 0;
+    }
+    if (retry)
+        nodeDB->saveToDisk(retry); // With its retries and error reporting
+#endif
+
+    if (held && !Throttle::isWithinTimespanMs(heldSinceMs, SAVE_HOLD_MAX_MS)) {
+        LOG_WARN("Edit transaction open too long, save pending changes anyway");
+        held = false;
+    }
+    if (!held) {
+        int due = debouncer.takeDue(millis());
+        if (due)
+            save(due);
+    }
+    return getNextDelay();
+}
+
+int32_t SaveScheduler::getNextDelay()
+{
+    int32_t delay = held ? -1 : debouncer.getDelay(millis());
+#if ARCH_PORTDUINO
+    // Look again soon for what the worker couldn't write
+    std::lock_guard<std::mutex> guard(lock);
+    if (!jobs.empty() || writing || failed)
+        delay = (delay < 0 || delay > SAVE_DEBOUNCE_MS) ? SAVE_DEBOUNCE_MS : delay;
+#endif
+    if (held && delay < 0 && debouncer.getPending())
+        delay = SAVE_DEBOUNCE_MS; // To notice a transaction nobody commits
+    return delay < 0 ? disable() : delay;
+}
+
+void SaveScheduler::save(int segments)
+{
+#if ARCH_PORTDUINO
+    for (int segment : ALL_SEGMENTS) {
+        if (!(segments & segment))
+            continue;
+        Job job;
+        job.segment = segment;
+        if (!nodeDB->encodeSegment(segment, job.filename, job.bytes, job.fullAtomic)) {
+            nodeDB->saveToDisk(segment); // Leave it to NodeDB to report and retry
+            continue;
+        }
+        std::lock_guard<std::mutex> guard(lock);
+        for (auto it = jobs.begin(); it != jobs.end();)
+            it = (it->segment == segment) ? jobs.erase(it) : it + 1; // Not written yet and already out of date
+        jobs.push_back(std::move(job));
+    }
+    changed.notify_all();
+#else
+    nodeDB->saveToDisk(segments);
+#endif
+}
+
+int SaveScheduler::beforeSleep(void *unused)
+{
+    flush();
+    return 0;
+}
+
+#if ARCH_PORTDUINO
+void SaveScheduler::runWorker()
+{
+    std::unique_lock<std::mutex> guard(lock);
+    while (true) {
+        changed.wait(guard, [this] { return stopping || !jobs.empty(); });
+        if (jobs.empty())
+            return; // Stopping, and everything has been written
+        Job job = std::move(jobs.front());
+        jobs.pop_front();
+        writing = true;
+
+        guard.unlock();
+        bool okay = nodeDB->writeEncoded(job.filename, job.bytes, job.fullAtomic);
+        guard.lock();
+
+        if (!okay)
+            failed |= job.segment;
+        writing = false;
+        changed.notify_all();
+    }
+}
+#endif
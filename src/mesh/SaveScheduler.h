@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Observer.h"
+#include "SaveDebouncer.h"
+#include "concurrency/OSThread.h"
+#include "configuration.h"
+
+#if ARCH_PORTDUINO
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#endif
+
+/// An edit transaction left open longer than this (a client that went away) stops holding saves back
+#ifndef SAVE_HOLD_MAX_MS
+#define SAVE_HOLD_MAX_MS (5 * 60 * 1000)
+#endif
+
+/**
+ * Saves NodeDB segments a little after they change instead of right away, so that a client toggling fifty favourites
+ * causes one write of the node database rather than fifty. Whatever is pending is written before a reboot or deep sleep.
+ *
+ * On Linux the segments are encoded on the main loop, so they are consistent, and written to disk on a worker thread so
+ * that a slow SD card doesn't stall the mesh. Elsewhere they are written from this thread as NodeDB::saveToDisk does.
+ */
+class SaveScheduler : private concurrency::OSThread
+{
+  public:
+    SaveScheduler();
+    ~SaveScheduler();
+
+    /// Save these segments (SEGMENT_CONFIG etc.) soon, together with whatever else changes in the meantime
+    void markDirty(int segments);
+
+    /// While an edit transaction is open nothing is saved, so none of a half made set of changes reaches the disk
+    void setHeld(bool held);
+
+    /// Save all pending segments now and wait until they are on disk
+    void flush();
+
+    /**
+     * Called by NodeDB::saveToDisk before it writes segments itself. They need no saving any more, and no older copy of
+     * them may be written over what it is about to write.
+     */
+    void superseded(int segments);
+
+  protected:
+    virtual int32_t runOnce() override;
+
+  private:
+    SaveDebouncer debouncer;
+    bool held = false;
+    uint32_t heldSinceMs = 0;
+
+    void save(int segments);
+    int32_t getNextDelay();
+
+    int beforeSleep(void *unused);
+    CallbackObserver<SaveScheduler, void *> notifyRebootObserver =
+        CallbackObserver<SaveScheduler, void *>(this, &SaveScheduler::beforeSleep);
+    CallbackObserver<SaveScheduler, void *> notifyDeepSleepObserver =
+        CallbackObserver<SaveScheduler, void *>(this, &SaveScheduler::beforeSleep);
+
+#if ARCH_PORTDUINO
+    struct Job {
+        int segment;
+        const char *filename;
+        std::string bytes;
+        bool fullAtomic;
+    };
+
+    void runWorker();
+
+    std::thread worker;
+    std::mutex lock;
+    std::condition_variable changed;
+    std::deque<Job> jobs;
+    bool writing = false;
+    bool stopping = false;
+    int failed = 0; // Segments the worker couldn't write, saved again with NodeDB's retries
+#endif
+};
+
+extern SaveScheduler *saveScheduler;
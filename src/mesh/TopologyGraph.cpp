@@ -0,0 +1,217 @@
+#include "TopologyGraph.h"
+#include <algorithm>
+#include <queue>
+#include <stdio.h>
+
+#ifdef ARCH_PORTDUINO
+#define TOPOLOGY_GUARD() std::lock_guard<std::recursive_mutex> guard(mutex)
+#else
+#define TOPOLOGY_GUARD()
+#endif
+
+/// Extra cost of using a link in the direction nobody reported hearing
+#define TOPOLOGY_REVERSE_COST 1
+
+TopologyGraph topologyGraph;
+
+uint8_t TopologyGraph::linkCost(int8_t snr)
+{
+    if (snr == TOPOLOGY_SNR_UNKNOWN)
+        return 3;
+    if (snr >= 5 * 4)
+        return 1;
+    if (snr >= 0)
+        return 2;
+    if (snr >= -8 * 4)
+        return 3;
+    return 5; // Close to the demodulation floor, a path over two good links is better
+}
+
+void TopologyGraph::addEdge(NodeNum from, NodeNum to, int8_t snr, Source source, uint32_t nowMs)
+{
+    TOPOLOGY_GUARD();
+    if (!from || !to || from == to || from == NODENUM_BROADCAST || to == NODENUM_BROADCAST)
+        return;
+
+    Edge *oldest = nullptr;
+    for (Edge &e : edges) {
+        if (e.from == from && e.to == to) {
+            // A report without an SNR doesn't make the one we have any less true
+            if (snr != TOPOLOGY_SNR_UNKNOWN) {
+                if (linkCost(e.snr) != linkCost(snr))
+                    version++;
+                e.snr = snr;
+            }
+            e.lastHeardMs = nowMs;
+            e.sources |= source;
+            return;
+        }
+        if (!oldest || nowMs - e.lastHeardMs > nowMs - oldest->lastHeardMs)
+            oldest = &e;
+    }
+
+    Edge added = {from, to, nowMs, snr, (uint8_t)source};
+    if (edges.size() < TOPOLOGY_MAX_EDGES)
+        edges.push_back(added);
+    else
+        *oldest = added;
+    version++;
+}
+
+void TopologyGraph::addRoute(NodeNum origin, const uint32_t *route, size_t routeCount, NodeNum dest, const int8_t *snr,
+                             size_t snrCount, uint32_t nowMs)
+{
+    TOPOLOGY_GUARD();
+    NodeNum prev = origin;
+    for (size_t i = 0; i < snrCount && i <= routeCount; i++) {
+        NodeNum next = i < routeCount ? route[i] : dest;
+        addEdge(prev, next, snr[i], TRACEROUTE, nowMs); // Ignores the unknown hops
+        prev = next;
+    }
+}
+
+void TopologyGraph::removeLink(NodeNum a, NodeNum b)
+{
+    TOPOLOGY_GUARD();
+    size_t before = edges.size();
+    edges.erase(std::remove_if(edges.begin(), edges.end(),
+                               [a, b](const Edge &e) { return (e.from == a && e.to == b) || (e.from == b && e.to == a); }),
+                edges.end());
+    if (edges.size() != before)
+        version++;
+}
+
+NodeNum TopologyGraph::findNeighborByRelayByte(NodeNum us, uint8_t relayByte, uint32_t nowMs)
+{
+    TOPOLOGY_GUARD();
+    NodeNum found = 0;
+    for (const Edge &e : edges) {
+        uint8_t lastByte = (e.from & 0xFF) ? (e.from & 0xFF) : 0xFF; // As NodeDB::getLastByteOfNodeNum()
+        if (e.to == us && (e.sources & HEARD) && lastByte == relayByte && e.from != found &&
+            nowMs - e.lastHeardMs < TOPOLOGY_EDGE_MAX_AGE_MS) {
+            if (found)
+                return 0; // Ambiguous
+            found = e.from;
+        }
+    }
+    return found;
+}
+
+void TopologyGraph::expire(uint32_t nowMs)
+{
+    TOPOLOGY_GUARD();
+    size_t before = edges.size();
+    edges.erase(std::remove_if(edges.begin(), edges.end(),
+                               [nowMs](const Edge &e) { return nowMs - e.lastHeardMs >= TOPOLOGY_EDGE_MAX_AGE_MS; }),
+                edges.end());
+    if (edges.size() != before)
+        version++;
+}
+
+int TopologyGraph::indexOf(NodeNum n) const
+{
+    auto it = std::lower_bound(pathNodes.begin(), pathNodes.end(), n);
+    return (it != pathNodes.end() && *it == n) ? it - pathNodes.begin() : -1;
+}
+
+void TopologyGraph::updatePaths(NodeNum from, uint32_t nowMs)
+{
+    expire(nowMs);
+    if (pathsVersion == version && pathsFrom == from)
+        return;
+    pathsFrom = from;
+    pathsVersion = version;
+
+    pathNodes.clear();
+    for (const Edge &e : edges) {
+        pathNodes.push_back(e.from);
+        pathNodes.push_back(e.to);
+    }
+    std::sort(pathNodes.begin(), pathNodes.end());
+    pathNodes.erase(std::unique(pathNodes.begin(), pathNodes.end()), pathNodes.end());
+    size_t n = pathNodes.size();
+
+    // Both directions of every edge, grouped by the node they leave
+    struct Link {
+        uint16_t from, to;
+        uint8_t cost;
+    };
+    std::vector<Link> links;
+    links.reserve(edges.size() * 2);
+    for (const Edge &e : edges) {
+        uint16_t a = indexOf(e.from), b = indexOf(e.to);
+        uint8_t cost = linkCost(e.snr);
+        links.push_back({a, b, cost});
+        links.push_back({b, a, (uint8_t)(cost + TOPOLOGY_REVERSE_COST)});
+    }
+    std::sort(links.begin(), links.end(), [](const Link &x, const Link &y) { return x.from < y.from; });
+    std::vector<uint32_t> firstLink(n + 1, 0);
+    for (const Link &l : links)
+        firstLink[l.from + 1]++;
+    for (size_t i = 0; i < n; i++)
+        firstLink[i + 1] += firstLink[i];
+
+    firstHops.assign(n, 0);
+    hopCounts.assign(n, 0);
+    int source = indexOf(from);
+    if (source < 0)
+        return;
+
+    // Dijkstra, remembering which of our neighbours each path starts with
+    std::vector<uint32_t> cost(n, UINT32_MAX);
+    typedef std::pair<uint32_t, uint16_t> Reached;
+    std::priority_queue<Reached, std::vector<Reached>, std::greater<Reached>> frontier;
+    cost[source] = 0;
+    frontier.push({0, (uint16_t)source});
+    while (!frontier.empty()) {
+        Reached r = frontier.top();
+        frontier.pop();
+        if (r.first != cost[r.second])
+            continue; // Already reached more cheaply
+        for (uint32_t i = firstLink[r.second]; i < firstLink[r.second + 1]; i++) {
+            const Link &l = links[i];
+            uint32_t c = r.first + l.cost;
+            if (c < cost[l.to]) {
+                cost[l.to] = c;
+                firstHops[l.to] = (int)r.second == source ? pathNodes[l.to] : firstHops[r.second];
+                hopCounts[l.to] = hopCounts[r.second] + 1;
+                frontier.push({c, l.to});
+            }
+        }
+    }
+}
+
+NodeNum TopologyGraph::getFirstHop(NodeNum from, NodeNum to, uint32_t nowMs)
+{
+    TOPOLOGY_GUARD();
+    updatePaths(from, nowMs);
+    int i = indexOf(to);
+    return i < 0 ? 0 : firstHops[i];
+}
+
+uint8_t TopologyGraph::getHopCount(NodeNum from, NodeNum to, uint32_t nowMs)
+{
+    TOPOLOGY_GUARD();
+    updatePaths(from, nowMs);
+    int i = indexOf(to);
+    return i < 0 ? 0 : hopCounts[i];
+}
+
+std::string TopologyGraph::toJson(uint32_t nowMs) const
+{
+    TOPOLOGY_GUARD();
+    std::string out = "{\"edges\":[";
+    char line[128];
+    for (size_t i = 0; i < edges.size(); i++) {
+        const Edge &e = edges[i];
+        if (e.snr == TOPOLOGY_SNR_UNKNOWN)
+            snprintf(line, sizeof(line), "%s{\"from\":%u,\"to\":%u,\"snr\":null,\"age\":%u,\"sources\":%u}", i ? "," : "",
+                     e.from, e.to, (nowMs - e.lastHeardMs) / 1000, e.sources);
+        else
+            snprintf(line, sizeof(line), "%s{\"from\":%u,\"to\":%u,\"snr\":%.2f,\"age\":%u,\"sources\":%u}", i ? "," : "",
+                     e.from, e.to, e.snr / 4.0, (nowMs - e.lastHeardMs) / 1000, e.sources);
+        out += line;
+    }
+    out += "]}";
+    return out;
+}
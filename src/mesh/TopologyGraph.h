@@ -0,0 +1,116 @@
+#pragma once
+
+#include "MeshTypes.h"
+#include <string>
+#include <vector>
+#ifdef ARCH_PORTDUINO
+#include <mutex>
+#endif
+
+/// How many links we remember, the least recently heard one makes room for a new one
+#ifndef TOPOLOGY_MAX_EDGES
+#if defined(ARCH_PORTDUINO)
+#define TOPOLOGY_MAX_EDGES 1024
+#elif defined(ARCH_ESP32)
+#define TOPOLOGY_MAX_EDGES 256
+#else
+#define TOPOLOGY_MAX_EDGES 96
+#endif
+#endif
+
+/// Links not heard of for this long are forgotten
+#ifndef TOPOLOGY_EDGE_MAX_AGE_MS
+#define TOPOLOGY_EDGE_MAX_AGE_MS (2 * 60 * 60 * 1000UL)
+#endif
+
+/// Set to 1 (e.g. in userPrefs.jsonc) to route unicasts along the topology graph when no next hop was learned from ACKs
+#ifndef USERPREFS_TOPOLOGY_NEXT_HOP
+#define USERPREFS_TOPOLOGY_NEXT_HOP 0
+#endif
+
+/// The SNR of a link we know exists but not how good it is, in the quarter dB of RouteDiscovery
+#define TOPOLOGY_SNR_UNKNOWN INT8_MIN
+
+/**
+ * What we know of the mesh's links, gathered from NeighborInfo packets, traceroutes passing through us and the nodes we
+ * hear directly or as relayers.
+ *
+ * An edge from A to B means B heard A, with the SNR B heard it at. Paths may also use an edge backwards, at a cost, since
+ * LoRa links are mostly symmetric but usually only one direction gets reported. Shortest paths from one node are kept
+ * until a link appears, goes or changes quality, so asking for many destinations costs one search.
+ */
+class TopologyGraph
+{
+  public:
+    enum Source : uint8_t { HEARD = 1, NEIGHBORINFO = 2, TRACEROUTE = 4 };
+
+    struct Edge {
+        NodeNum from;
+        NodeNum to;
+        uint32_t lastHeardMs;
+        int8_t snr; // Quarter dB, TOPOLOGY_SNR_UNKNOWN if we only know the link exists
+        uint8_t sources;
+    };
+
+    /// Record that `to` heard `from`, snr in quarter dB
+    void addEdge(NodeNum from, NodeNum to, int8_t snr, Source source, uint32_t nowMs);
+
+    /**
+     * Record the links along a traceroute: origin, then route[], then dest if snr[] reaches it. snr[i] is how well the
+     * i-th node after origin heard the one before it. Unknown hops break the chain.
+     */
+    void addRoute(NodeNum origin, const uint32_t *route, size_t routeCount, NodeNum dest, const int8_t *snr, size_t snrCount,
+                  uint32_t nowMs);
+
+    /// Forget the link between a and b, in both directions, e.g. once a packet sent over it went unacknowledged
+    void removeLink(NodeNum a, NodeNum b);
+
+    /// The node we heard directly whose NodeNum ends in relayByte, or 0 if none or more than one does
+    NodeNum findNeighborByRelayByte(NodeNum us, uint8_t relayByte, uint32_t nowMs);
+
+    /**
+     * The first node on the cheapest path from `from` to `to`
+     * @return 0 if no path is known
+     */
+    NodeNum getFirstHop(NodeNum from, NodeNum to, uint32_t nowMs);
+
+    /// Hops on the cheapest path from `from` to `to`, 0 if no path is known
+    uint8_t getHopCount(NodeNum from, NodeNum to, uint32_t nowMs);
+
+    /// Forget links not heard of in TOPOLOGY_EDGE_MAX_AGE_MS
+    void expire(uint32_t nowMs);
+
+    size_t getNumEdges() const { return edges.size(); }
+
+    /// The graph as {"edges":[{"from":..,"to":..,"snr":..,"age":..,"sources":..}]}, age in seconds
+    std::string toJson(uint32_t nowMs) const;
+
+    /// Path cost of an edge used in the direction it was heard
+    static uint8_t linkCost(int8_t snr);
+
+    /// An SNR in dB as the quarter dB edges keep
+    static int8_t toQuarterDb(float snr) { return snr <= -32 ? -127 : (snr >= 31.75f ? 127 : (int8_t)(snr * 4)); }
+
+  private:
+    std::vector<Edge> edges;
+
+#ifdef ARCH_PORTDUINO
+    // The Linux web server answers requests from its own threads
+    mutable std::recursive_mutex mutex;
+#endif
+
+    /// Bumped whenever shortest paths may have changed
+    uint32_t version = 1;
+
+    // The shortest path tree from pathsFrom, valid while pathsVersion == version
+    NodeNum pathsFrom = 0;
+    uint32_t pathsVersion = 0;
+    std::vector<NodeNum> pathNodes; // Sorted, to look up a node's index
+    std::vector<NodeNum> firstHops;
+    std::vector<uint8_t> hopCounts;
+
+    void updatePaths(NodeNum from, uint32_t nowMs);
+    int indexOf(NodeNum n) const;
+};
+
+extern TopologyGraph topologyGraph;
@@ -109,4 +109,150 @@ meshtastic_User TypeConversions::ConvertToUser(uint32_t nodeNum, meshtastic_User
     user.is_unmessagable = lite.is_unmessagable;
 
     return user;
-}
\ No newline at end of file
+}
+// The field numbers of meshtastic_NodeInfo and the messages in it are the _tag defines in mesh.pb.h. Like nanopb, fields
+// that hold their default value are left out, except those with a has_ flag, which go in whenever that is set.
+
+typedef bool (*NodeInfoPartEncoder)(pb_ostream_t *stream, const meshtastic_NodeInfoLite *lite);
+
+static bool encodeVarintField(pb_ostream_t *stream, uint32_t tag, uint64_t value)
+{
+    return pb_encode_tag(stream, PB_WT_VARINT, tag) && pb_encode_varint(stream, value);
+}
+
+static bool encodeFixed32Field(pb_ostream_t *stream, uint32_t tag, const void *value)
+{
+    return pb_encode_tag(stream, PB_WT_32BIT, tag) && pb_encode_fixed32(stream, value);
+}
+
+// A string must end within its array, as nanopb requires of static strings
+static bool encodeStringField(pb_ostream_t *stream, uint32_t tag, const char *str, size_t arraySize)
+{
+    size_t len = 0;
+    while (len < arraySize - 1 && str[len] != '\0')
+        len++;
+    if (str[len] != '\0')
+        PB_RETURN_ERROR(stream, "unterminated string");
+    return pb_encode_tag(stream, PB_WT_STRING, tag) && pb_encode_string(stream, (const pb_byte_t *)str, len);
+}
+
+// Sized on a first pass like pb_encode_submessage does, so nothing has to be buffered
+static bool encodeSubmessage(pb_ostream_t *stream, uint32_t tag, NodeInfoPartEncoder encode, const meshtastic_NodeInfoLite *lite)
+{
+    pb_ostream_t sizing = PB_OSTREAM_SIZING;
+    if (!encode(&sizing, lite))
+        PB_RETURN_ERROR(stream, PB_GET_ERROR(&sizing));
+    size_t size = sizing.bytes_written;
+
+    if (!pb_encode_tag(stream, PB_WT_STRING, tag) || !pb_encode_varint(stream, size))
+        return false;
+    if (stream->callback == NULL)
+        return pb_write(stream, NULL, size); // Only sizing
+    if (stream->bytes_written + size > stream->max_size)
+        PB_RETURN_ERROR(stream, "stream full");
+
+    size_t start = stream->bytes_written;
+    if (!encode(stream, lite))
+        return false;
+    if (stream->bytes_written - start != size)
+        PB_RETURN_ERROR(stream, "submsg size changed");
+    return true;
+}
+
+static bool encodeUser(pb_ostream_t *stream, const meshtastic_NodeInfoLite *lite)
+{
+    const meshtastic_UserLite &user = lite->user;
+    char id[sizeof(meshtastic_User::id)];
+    snprintf(id, sizeof(id), "!%08x", lite->num);
+
+    if (!encodeStringField(stream, meshtastic_User_id_tag, id, sizeof(id)))
+        return false;
+    if (user.long_name[0] && !encodeStringField(stream, meshtastic_User_long_name_tag, user.long_name, sizeof(user.long_name)))
+        return false;
+    if (user.short_name[0] &&
+        !encodeStringField(stream, meshtastic_User_short_name_tag, user.short_name, sizeof(user.short_name)))
+        return false;
+    // Fixed length bytes have no default to leave out
+    if (!pb_encode_tag(stream, PB_WT_STRING, meshtastic_User_macaddr_tag) ||
+        !pb_encode_string(stream, user.macaddr, sizeof(user.macaddr)))
+        return false;
+    if (user.hw_model && !encodeVarintField(stream, meshtastic_User_hw_model_tag, (uint32_t)user.hw_model))
+        return false;
+    if (user.is_licensed && !encodeVarintField(stream, meshtastic_User_is_licensed_tag, 1))
+        return false;
+    if (user.role && !encodeVarintField(stream, meshtastic_User_role_tag, (uint32_t)user.role))
+        return false;
+    if (user.public_key.size) {
+        if (user.public_key.size > sizeof(user.public_key.bytes))
+            PB_RETURN_ERROR(stream, "bytes size exceeded");
+        if (!pb_encode_tag(stream, PB_WT_STRING, meshtastic_User_public_key_tag) ||
+            !pb_encode_string(stream, user.public_key.bytes, user.public_key.size))
+            return false;
+    }
+    if (user.has_is_unmessagable && !encodeVarintField(stream, meshtastic_User_is_unmessagable_tag, user.is_unmessagable))
+        return false;
+    return true;
+}
+
+// ConvertToPosition only sets has_ on the coordinates that aren't zero
+static bool encodePosition(pb_ostream_t *stream, const meshtastic_NodeInfoLite *lite)
+{
+    const meshtastic_PositionLite &pos = lite->position;
+    if (pos.latitude_i && !encodeFixed32Field(stream, meshtastic_Position_latitude_i_tag, &pos.latitude_i))
+        return false;
+    if (pos.longitude_i && !encodeFixed32Field(stream, meshtastic_Position_longitude_i_tag, &pos.longitude_i))
+        return false;
+    if (pos.altitude && !encodeVarintField(stream, meshtastic_Position_altitude_tag, (uint64_t)(int64_t)pos.altitude))
+        return false;
+    if (pos.time && !encodeFixed32Field(stream, meshtastic_Position_time_tag, &pos.time))
+        return false;
+    if (pos.location_source &&
+        !encodeVarintField(stream, meshtastic_Position_location_source_tag, (uint32_t)pos.location_source))
+        return false;
+    return true;
+}
+
+bool TypeConversions::EncodeNodeInfo(pb_ostream_t *stream, const meshtastic_NodeInfoLite *lite)
+{
+    uint32_t snrBits; // -0.0 isn't the default either, nanopb compares the bytes
+    memcpy(&snrBits, &lite->snr, sizeof(snrBits));
+    bool keyVerified = lite->bitfield & NODEINFO_BITFIELD_IS_KEY_MANUALLY_VERIFIED_MASK;
+
+    if (lite->num && !encodeVarintField(stream, meshtastic_NodeInfo_num_tag, lite->num))
+        return false;
+    if (lite->has_user && !encodeSubmessage(stream, meshtastic_NodeInfo_user_tag, encodeUser, lite))
+        return false;
+    if (lite->has_position && !encodeSubmessage(stream, meshtastic_NodeInfo_position_tag, encodePosition, lite))
+        return false;
+    if (snrBits && !encodeFixed32Field(stream, meshtastic_NodeInfo_snr_tag, &lite->snr))
+        return false;
+    if (lite->last_heard && !encodeFixed32Field(stream, meshtastic_NodeInfo_last_heard_tag, &lite->last_heard))
+        return false;
+    // The same struct in both, so nanopb can encode it where it is
+    if (lite->has_device_metrics && (!pb_encode_tag(stream, PB_WT_STRING, meshtastic_NodeInfo_device_metrics_tag) ||
+                                     !pb_encode_submessage(stream, meshtastic_DeviceMetrics_fields, &lite->device_metrics)))
+        return false;
+    if (lite->channel && !encodeVarintField(stream, meshtastic_NodeInfo_channel_tag, lite->channel))
+        return false;
+    if (lite->via_mqtt && !encodeVarintField(stream, meshtastic_NodeInfo_via_mqtt_tag, 1))
+        return false;
+    if (lite->has_hops_away && !encodeVarintField(stream, meshtastic_NodeInfo_hops_away_tag, lite->hops_away))
+        return false;
+    if (lite->is_favorite && !encodeVarintField(stream, meshtastic_NodeInfo_is_favorite_tag, 1))
+        return false;
+    if (lite->is_ignored && !encodeVarintField(stream, meshtastic_NodeInfo_is_ignored_tag, 1))
+        return false;
+    if (keyVerified && !encodeVarintField(stream, meshtastic_NodeInfo_is_key_manually_verified_tag, 1))
+        return false;
+    return true;
+}
+
+size_t TypeConversions::EncodeFromRadioNodeInfo(uint8_t *buf, size_t bufSize, const meshtastic_NodeInfoLite *lite)
+{
+    pb_ostream_t stream = pb_ostream_from_buffer(buf, bufSize);
+    if (!encodeSubmessage(&stream, meshtastic_FromRadio_node_info_tag, TypeConversions::EncodeNodeInfo, lite)) {
+        LOG_ERROR("Panic: can't encode protobuf reason='%s'", PB_GET_ERROR(&stream));
+        return 0;
+    }
+    return stream.bytes_written;
+}
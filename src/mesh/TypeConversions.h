@@ -3,6 +3,7 @@
 
 #pragma once
 #include "NodeDB.h"
+#include <pb_encode.h>
 
 class TypeConversions
 {
@@ -12,4 +13,13 @@ class TypeConversions
     static meshtastic_Position ConvertToPosition(meshtastic_PositionLite lite);
     static meshtastic_UserLite ConvertToUserLite(meshtastic_User user);
     static meshtastic_User ConvertToUser(uint32_t nodeNum, meshtastic_UserLite lite);
+
+    /**
+     * Encode lite as a meshtastic_NodeInfo straight from its own fields. The bytes are the same as pb_encode gives for
+     * ConvertToNodeInfo(lite), without building the much larger NodeInfo first.
+     */
+    static bool EncodeNodeInfo(pb_ostream_t *stream, const meshtastic_NodeInfoLite *lite);
+
+    /// Encode a FromRadio with just node_info set from lite, returns its length or 0 if it couldn't be encoded
+    static size_t EncodeFromRadioNodeInfo(uint8_t *buf, size_t bufSize, const meshtastic_NodeInfoLite *lite);
 };
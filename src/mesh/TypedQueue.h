@@ -65,6 +65,9 @@ template <class T> class TypedQueue
 #else
 
 #include <queue>
+#ifdef ARCH_PORTDUINO
+#include <mutex>
+#endif
 
 /**
  * A wrapper for freertos queues.  Note: each element object should be small
@@ -75,6 +78,14 @@ template <class T> class TypedQueue
     std::queue<T> q;
     concurrency::OSThread *reader = NULL;
     int maxElements;
+#ifdef ARCH_PORTDUINO
+    // Unlike a freertos queue std::queue isn't thread safe, and on Linux the web server takes from the phone queues in its
+    // own thread
+    std::mutex mutex;
+#define TYPED_QUEUE_GUARD() std::lock_guard<std::mutex> guard(mutex)
+#else
+#define TYPED_QUEUE_GUARD()
+#endif
 
   public:
     explicit TypedQueue(int _maxElements) : maxElements(_maxElements) {}
@@ -86,21 +97,27 @@ template <class T> class TypedQueue
         return maxElements - numUsed();
     }
 
-    bool isEmpty() { return q.empty(); }
+    bool isEmpty() { return numUsed() == 0; }
 
-    int numUsed() { return q.size(); }
+    int numUsed()
+    {
+        TYPED_QUEUE_GUARD();
+        return q.size();
+    }
 
     bool enqueue(T x, TickType_t maxWait = portMAX_DELAY)
     {
-        if (numFree() <= 0)
-            return false;
+        {
+            TYPED_QUEUE_GUARD();
+            if (maxElements > 0 && (int)q.size() >= maxElements)
+                return false;
+            q.push(x);
+        }
 
         if (reader) {
             reader->setInterval(0);
             concurrency::mainDelay.interrupt();
         }
-
-        q.push(x);
         return true;
     }
 
@@ -108,17 +125,17 @@ template <class T> class TypedQueue
 
     bool dequeue(T *p, TickType_t maxWait = portMAX_DELAY)
     {
-        if (isEmpty())
+        TYPED_QUEUE_GUARD();
+        if (q.empty())
             return false;
-        else {
-            *p = q.front();
-            q.pop();
-            return true;
-        }
+        *p = q.front();
+        q.pop();
+        return true;
     }
 
     // bool dequeueFromISR(T *p, BaseType_t *higherPriWoken) { return xQueueReceiveFromISR(h, p, higherPriWoken); }
 
     void setReader(concurrency::OSThread *t) { reader = t; }
 };
-#endif
\ No newline at end of file
+#undef TYPED_QUEUE_GUARD
+#endif
@@ -19,6 +19,7 @@ PacketAPI *PacketAPI::create(PacketServer *_server)
 PacketAPI::PacketAPI(PacketServer *_server)
     : concurrency::OSThread("PacketAPI"), isConnected(false), programmingMode(false), server(_server)
 {
+    needsFromRadioScratch = true;
 }
 
 int32_t PacketAPI::runOnce()
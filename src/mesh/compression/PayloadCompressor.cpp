@@ -0,0 +1,247 @@
+#include "PayloadCompressor.h"
+#include "configuration.h"
+#include "mesh/compression/unishox2.h"
+#include <string.h>
+
+/*
+ * Static dictionary codec
+ *
+ * Bytes 0x00-0x7F are ASCII literals, 0x80-0xFD reference an entry of the dictionary below and 0xFE escapes the next byte
+ * as a literal (for UTF-8). The dictionary holds the most frequent words and n-grams of short mesh chat messages, longest
+ * match wins. The table is part of the wire format: entries may only ever be appended.
+ */
+#define DICT_FIRST_CODE 0x80
+#define DICT_ESCAPE 0xFE
+#define DICT_MAX_ENTRIES (DICT_ESCAPE - DICT_FIRST_CODE)
+
+static const char *const staticDictionary[] = {
+    // Whole words, with their leading space
+    " the", " you", " and", " to ", " is ", " for", " are", " on ", " in ", " at ", " of ", " it", " be", " we", " me", " my",
+    " can", " not", " have", " what", " with", " this", " that", " there", " from", " here", " will", " just", " know", " get",
+    " good", " now", " all", " out", " up", " how", " any", " one", " see", " back", " time", " today", " going", " still",
+    " hear", " copy", " signal", " node", " mesh", " message", " test", " thanks", " please", " working", " antenna", " range",
+    " radio", " anyone", " about", " would", " been", " like", " was", " do", " so", " no", " yes",
+    // Common starts of messages
+    "Hello", "Hi ", "hello", "OK", "ok", "Thanks", "Test", "test", "I'm ", "I ", "The ", "What", "Anyone", "Good morning",
+    "Good night", "Meshtastic", "http", "km", "lol",
+    // Frequent n-grams
+    "ing", "tion", "ent", "ight", "ould", "ere", "er ", "ed ", "es ", "s ", "e ", "t ", "d ", "y ", "n ", ". ", ", ", "? ",
+    "! ", "th", "he", "in", "er", "an", "re", "on", "en", "at", "ou", "st", "nd", "or", "te", "is", "ar", "al", "ve", "le",
+    "ll", "..."};
+
+#define DICT_NUM_ENTRIES (sizeof(staticDictionary) / sizeof(staticDictionary[0]))
+static_assert(DICT_NUM_ENTRIES <= DICT_MAX_ENTRIES, "Static dictionary has too many entries");
+
+static uint8_t dictLengths[DICT_NUM_ENTRIES];
+// Entries grouped by their first character, so a lookup only visits the candidates that can match
+static uint8_t dictByFirstChar[DICT_NUM_ENTRIES];
+static uint8_t dictFirstCharStart[129];
+static bool dictReady = false;
+
+static void initDictionary()
+{
+    uint8_t counts[128] = {0};
+    for (size_t i = 0; i < DICT_NUM_ENTRIES; i++) {
+        dictLengths[i] = strlen(staticDictionary[i]);
+        counts[(uint8_t)staticDictionary[i][0]]++;
+    }
+    dictFirstCharStart[0] = 0;
+    for (int c = 0; c < 128; c++)
+        dictFirstCharStart[c + 1] = dictFirstCharStart[c] + counts[c];
+    uint8_t fill[128];
+    memcpy(fill, dictFirstCharStart, sizeof(fill));
+    for (size_t i = 0; i < DICT_NUM_ENTRIES; i++)
+        dictByFirstChar[fill[(uint8_t)staticDictionary[i][0]]++] = i;
+    dictReady = true;
+}
+
+static size_t dictEncode(const uint8_t *in, size_t len, uint8_t *out, size_t outLen)
+{
+    if (!dictReady)
+        initDictionary();
+
+    size_t o = 0;
+    for (size_t i = 0; i < len;) {
+        uint8_t c = in[i];
+        if (c >= 0x80) {
+            if (o + 2 > outLen)
+                return 0;
+            out[o++] = DICT_ESCAPE;
+            out[o++] = c;
+            i++;
+            continue;
+        }
+
+        int best = -1;
+        uint8_t bestLen = 1;
+        for (uint8_t k = dictFirstCharStart[c]; k < dictFirstCharStart[c + 1]; k++) {
+            uint8_t e = dictByFirstChar[k];
+            uint8_t l = dictLengths[e];
+            if (l > bestLen && l <= len - i && memcmp(in + i, staticDictionary[e], l) == 0) {
+                best = e;
+                bestLen = l;
+            }
+        }
+        if (o + 1 > outLen)
+            return 0;
+        if (best >= 0) {
+            out[o++] = DICT_FIRST_CODE + best;
+            i += bestLen;
+        } else {
+            out[o++] = c;
+            i++;
+        }
+    }
+    return o;
+}
+
+static size_t dictDecode(const uint8_t *in, size_t len, uint8_t *out, size_t outLen)
+{
+    if (!dictReady)
+        initDictionary();
+
+    size_t o = 0;
+    for (size_t i = 0; i < len; i++) {
+        uint8_t c = in[i];
+        if (c < DICT_FIRST_CODE) {
+            if (o + 1 > outLen)
+                return 0;
+            out[o++] = c;
+        } else if (c == DICT_ESCAPE) {
+            if (++i >= len || o + 1 > outLen)
+                return 0;
+            out[o++] = in[i];
+        } else {
+            uint8_t e = c - DICT_FIRST_CODE;
+            if (e >= DICT_NUM_ENTRIES || o + dictLengths[e] > outLen)
+                return 0;
+            memcpy(out + o, staticDictionary[e], dictLengths[e]);
+            o += dictLengths[e];
+        }
+    }
+    return o;
+}
+
+/// Ports that may be compressed, the port number that marks their compressed form and the codecs to try
+struct CompressedPort {
+    meshtastic_PortNum port;
+    meshtastic_PortNum compressedPort;
+    PayloadCodec codecs[2];
+};
+
+static const CompressedPort compressedPorts[] = {
+    {meshtastic_PortNum_TEXT_MESSAGE_APP,
+     (meshtastic_PortNum)TEXT_MESSAGE_CODEC_PORTNUM,
+     {PAYLOAD_CODEC_STATIC_DICT, PAYLOAD_CODEC_UNISHOX2}},
+};
+
+size_t PayloadCompressor::encode(PayloadCodec codec, const uint8_t *in, size_t len, uint8_t *out, size_t outLen)
+{
+    switch (codec) {
+    case PAYLOAD_CODEC_UNISHOX2: {
+        int l = unishox2_compress((const char *)in, len, (char *)out, outLen, USX_PSET_DFLT);
+        return (l > 0 && (size_t)l <= outLen) ? l : 0;
+    }
+    case PAYLOAD_CODEC_STATIC_DICT:
+        return dictEncode(in, len, out, outLen);
+    default:
+        return 0;
+    }
+}
+
+size_t PayloadCompressor::decode(PayloadCodec codec, const uint8_t *in, size_t len, uint8_t *out, size_t outLen)
+{
+    switch (codec) {
+    case PAYLOAD_CODEC_UNISHOX2: {
+        int l = unishox2_decompress((const char *)in, len, (char *)out, outLen, USX_PSET_DFLT);
+        return (l > 0 && (size_t)l <= outLen) ? l : 0;
+    }
+    case PAYLOAD_CODEC_STATIC_DICT:
+        return dictDecode(in, len, out, outLen);
+    default:
+        return 0;
+    }
+}
+
+bool PayloadCompressor::compress(const meshtastic_Data &in, meshtastic_Data &out)
+{
+    const CompressedPort *entry = nullptr;
+    for (const auto &cp : compressedPorts) {
+        if (cp.port == in.portnum)
+            entry = &cp;
+    }
+    if (!entry || in.payload.size < 2)
+        return false;
+
+    uint8_t scratch[meshtastic_Constants_DATA_PAYLOAD_LEN];
+    size_t bestLen = 0;
+    for (PayloadCodec codec : entry->codecs) {
+        if (codec == PAYLOAD_CODEC_NONE)
+            continue;
+        // Leave room for the codec id, and only bother with results that are strictly smaller than the original
+        size_t l = encode(codec, in.payload.bytes, in.payload.size, scratch, in.payload.size - 2);
+        if (l && (!bestLen || l < bestLen)) {
+            bestLen = l;
+            out = in;
+            out.payload.bytes[0] = codec;
+            memcpy(out.payload.bytes + 1, scratch, l);
+        }
+    }
+    if (!bestLen)
+        return false;
+
+    out.payload.size = bestLen + 1;
+    out.portnum = entry->compressedPort;
+    LOG_DEBUG("Compressed portnum %d payload from %u to %u bytes with codec %u", in.portnum, in.payload.size, out.payload.size,
+              out.payload.bytes[0]);
+    return true;
+}
+
+bool PayloadCompressor::isCompressed(meshtastic_PortNum port)
+{
+    if (port == meshtastic_PortNum_TEXT_MESSAGE_COMPRESSED_APP)
+        return true;
+    for (const auto &cp : compressedPorts) {
+        if (cp.compressedPort == port)
+            return true;
+    }
+    return false;
+}
+
+bool PayloadCompressor::decompress(meshtastic_Data &d)
+{
+    uint8_t scratch[meshtastic_Constants_DATA_PAYLOAD_LEN];
+
+    // What other senders put on the old compressed text port: unishox2 without a codec id
+    if (d.portnum == meshtastic_PortNum_TEXT_MESSAGE_COMPRESSED_APP) {
+        size_t l = decode(PAYLOAD_CODEC_UNISHOX2, d.payload.bytes, d.payload.size, scratch, sizeof(scratch));
+        if (!l) {
+            LOG_WARN("Could not decompress unishox2 text");
+            return false;
+        }
+        memcpy(d.payload.bytes, scratch, l);
+        d.payload.size = l;
+        d.portnum = meshtastic_PortNum_TEXT_MESSAGE_APP;
+        return true;
+    }
+
+    const CompressedPort *entry = nullptr;
+    for (const auto &cp : compressedPorts) {
+        if (cp.compressedPort == d.portnum)
+            entry = &cp;
+    }
+    if (!entry)
+        return true; // Nothing to do
+    if (d.payload.size < 2)
+        return false;
+
+    size_t l = decode((PayloadCodec)d.payload.bytes[0], d.payload.bytes + 1, d.payload.size - 1, scratch, sizeof(scratch));
+    if (!l) {
+        LOG_WARN("Could not decompress portnum %d payload with codec %u", d.portnum, d.payload.bytes[0]);
+        return false;
+    }
+    memcpy(d.payload.bytes, scratch, l);
+    d.payload.size = l;
+    d.portnum = entry->port;
+    return true;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "mesh/generated/meshtastic/mesh.pb.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/// Turn on compressing our own outgoing payloads. Decompression of received payloads is always available.
+#ifndef MESHTASTIC_PAYLOAD_COMPRESSION
+#define MESHTASTIC_PAYLOAD_COMPRESSION 0
+#endif
+
+/**
+ * The portnum compressed text is sent on, with the codec id as the first payload byte. TEXT_MESSAGE_COMPRESSED_APP can't carry
+ * that byte, existing senders put raw unishox2 there, so like AGGREGATE_PORTNUM this takes an unassigned portnum below
+ * PRIVATE_APP.
+ */
+#define TEXT_MESSAGE_CODEC_PORTNUM 253
+
+/// Codec used for a compressed payload. Its id is sent as the first byte of the compressed payload.
+enum PayloadCodec : uint8_t {
+    PAYLOAD_CODEC_NONE = 0,
+    PAYLOAD_CODEC_UNISHOX2 = 1,
+    PAYLOAD_CODEC_STATIC_DICT = 2,
+};
+
+/**
+ * Optional compression stage for the encode path.
+ *
+ * Compression is negotiated per port: a port can only be compressed if it has a compressed twin port number that tells the
+ * receiver to run the payload through decompress() first (e.g. TEXT_MESSAGE_APP -> TEXT_MESSAGE_CODEC_PORTNUM). Raw unishox2 on
+ * TEXT_MESSAGE_COMPRESSED_APP is decompressed too, but never sent.
+ */
+class PayloadCompressor
+{
+  public:
+    /**
+     * Compress `in` into `out` if its port supports it and the result is strictly smaller than the original payload.
+     * @return true if `out` holds a compressed copy that should be sent instead of `in`
+     */
+    static bool compress(const meshtastic_Data &in, meshtastic_Data &out);
+
+    /**
+     * Decompress a payload received on a compressed port in place, restoring the original port number.
+     * @return false if the payload was on a compressed port but could not be decompressed
+     */
+    static bool decompress(meshtastic_Data &d);
+
+    /// True if payloads on `port` have to go through decompress() before anyone can read them
+    static bool isCompressed(meshtastic_PortNum port);
+
+    /// Compress with a specific codec, without the codec id byte. Returns the compressed length, or 0 if it did not fit.
+    static size_t encode(PayloadCodec codec, const uint8_t *in, size_t len, uint8_t *out, size_t outLen);
+
+    /// Decompress with a specific codec, without the codec id byte. Returns the decompressed length, or 0 on error.
+    static size_t decode(PayloadCodec codec, const uint8_t *in, size_t len, uint8_t *out, size_t outLen);
+};
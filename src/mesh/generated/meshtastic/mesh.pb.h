@@ -1165,6 +1165,9 @@ typedef struct _meshtastic_FromRadio {
         meshtastic_ClientNotification clientNotification;
         /* Persistent data for device-ui */
         meshtastic_DeviceUIConfig deviceuiConfig;
+        /* Sent just before config_complete_id when a node list was sent: the node DB change version the client is then
+     up to date with. Give it as ToRadio.node_sync_since on the next connection to be sent only what changed since. */
+        uint32_t node_db_version;
     };
 } meshtastic_FromRadio;
 
@@ -1201,6 +1204,9 @@ typedef struct _meshtastic_ToRadio {
         /* Heartbeat message (used to keep the device connection awake on serial) */
         meshtastic_Heartbeat heartbeat;
     };
+    /* Sent along with want_config_id = 69422: the FromRadio.node_db_version the client last received.
+     Only the nodes that changed since then are sent. */
+    uint32_t node_sync_since;
 } meshtastic_ToRadio;
 
 /* RemoteHardwarePins associated with a node */
@@ -1367,7 +1373,7 @@ extern "C" {
 #define meshtastic_DuplicatedPublicKey_init_default {0}
 #define meshtastic_LowEntropyKey_init_default    {0}
 #define meshtastic_FileInfo_init_default         {"", 0}
-#define meshtastic_ToRadio_init_default          {0, {meshtastic_MeshPacket_init_default}}
+#define meshtastic_ToRadio_init_default          {0, {meshtastic_MeshPacket_init_default}, 0}
 #define meshtastic_Compressed_init_default       {_meshtastic_PortNum_MIN, {0, {0}}}
 #define meshtastic_NeighborInfo_init_default     {0, 0, 0, 0, {meshtastic_Neighbor_init_default, meshtastic_Neighbor_init_default, meshtastic_Neighbor_init_default, meshtastic_Neighbor_init_default, meshtastic_Neighbor_init_default, meshtastic_Neighbor_init_default, meshtastic_Neighbor_init_default, meshtastic_Neighbor_init_default, meshtastic_Neighbor_init_default, meshtastic_Neighbor_init_default}}
 #define meshtastic_Neighbor_init_default         {0, 0, 0, 0}
@@ -1398,7 +1404,7 @@ extern "C" {
 #define meshtastic_DuplicatedPublicKey_init_zero {0}
 #define meshtastic_LowEntropyKey_init_zero       {0}
 #define meshtastic_FileInfo_init_zero            {"", 0}
-#define meshtastic_ToRadio_init_zero             {0, {meshtastic_MeshPacket_init_zero}}
+#define meshtastic_ToRadio_init_zero             {0, {meshtastic_MeshPacket_init_zero}, 0}
 #define meshtastic_Compressed_init_zero          {_meshtastic_PortNum_MIN, {0, {0}}}
 #define meshtastic_NeighborInfo_init_zero        {0, 0, 0, 0, {meshtastic_Neighbor_init_zero, meshtastic_Neighbor_init_zero, meshtastic_Neighbor_init_zero, meshtastic_Neighbor_init_zero, meshtastic_Neighbor_init_zero, meshtastic_Neighbor_init_zero, meshtastic_Neighbor_init_zero, meshtastic_Neighbor_init_zero, meshtastic_Neighbor_init_zero, meshtastic_Neighbor_init_zero}}
 #define meshtastic_Neighbor_init_zero            {0, 0, 0, 0}
@@ -1580,6 +1586,7 @@ extern "C" {
 #define meshtastic_FromRadio_fileInfo_tag        15
 #define meshtastic_FromRadio_clientNotification_tag 16
 #define meshtastic_FromRadio_deviceuiConfig_tag  17
+#define meshtastic_FromRadio_node_db_version_tag 18
 #define meshtastic_Heartbeat_nonce_tag           1
 #define meshtastic_ToRadio_packet_tag            1
 #define meshtastic_ToRadio_want_config_id_tag    3
@@ -1587,6 +1594,7 @@ extern "C" {
 #define meshtastic_ToRadio_xmodemPacket_tag      5
 #define meshtastic_ToRadio_mqttClientProxyMessage_tag 6
 #define meshtastic_ToRadio_heartbeat_tag         7
+#define meshtastic_ToRadio_node_sync_since_tag   8
 #define meshtastic_NodeRemoteHardwarePin_node_num_tag 1
 #define meshtastic_NodeRemoteHardwarePin_pin_tag 2
 #define meshtastic_ChunkedPayload_payload_id_tag 1
@@ -1786,7 +1794,8 @@ X(a, STATIC,   ONEOF,    MESSAGE,  (payload_variant,metadata,metadata),  13) \
 X(a, STATIC,   ONEOF,    MESSAGE,  (payload_variant,mqttClientProxyMessage,mqttClientProxyMessage),  14) \
 X(a, STATIC,   ONEOF,    MESSAGE,  (payload_variant,fileInfo,fileInfo),  15) \
 X(a, STATIC,   ONEOF,    MESSAGE,  (payload_variant,clientNotification,clientNotification),  16) \
-X(a, STATIC,   ONEOF,    MESSAGE,  (payload_variant,deviceuiConfig,deviceuiConfig),  17)
+X(a, STATIC,   ONEOF,    MESSAGE,  (payload_variant,deviceuiConfig,deviceuiConfig),  17) \
+X(a, STATIC,   ONEOF,    UINT32,   (payload_variant,node_db_version,node_db_version),  18)
 #define meshtastic_FromRadio_CALLBACK NULL
 #define meshtastic_FromRadio_DEFAULT NULL
 #define meshtastic_FromRadio_payload_variant_packet_MSGTYPE meshtastic_MeshPacket
@@ -1865,7 +1874,8 @@ X(a, STATIC,   ONEOF,    UINT32,   (payload_variant,want_config_id,want_config_i
 X(a, STATIC,   ONEOF,    BOOL,     (payload_variant,disconnect,disconnect),   4) \
 X(a, STATIC,   ONEOF,    MESSAGE,  (payload_variant,xmodemPacket,xmodemPacket),   5) \
 X(a, STATIC,   ONEOF,    MESSAGE,  (payload_variant,mqttClientProxyMessage,mqttClientProxyMessage),   6) \
-X(a, STATIC,   ONEOF,    MESSAGE,  (payload_variant,heartbeat,heartbeat),   7)
+X(a, STATIC,   ONEOF,    MESSAGE,  (payload_variant,heartbeat,heartbeat),   7) \
+X(a, STATIC,   SINGULAR, UINT32,   node_sync_since,   8)
 #define meshtastic_ToRadio_CALLBACK NULL
 #define meshtastic_ToRadio_DEFAULT NULL
 #define meshtastic_ToRadio_payload_variant_packet_MSGTYPE meshtastic_MeshPacket
@@ -2041,7 +2051,7 @@ extern const pb_msgdesc_t meshtastic_ChunkedPayloadResponse_msg;
 #define meshtastic_QueueStatus_size              23
 #define meshtastic_RouteDiscovery_size           256
 #define meshtastic_Routing_size                  259
-#define meshtastic_ToRadio_size                  504
+#define meshtastic_ToRadio_size                  510
 #define meshtastic_User_size                     115
 #define meshtastic_Waypoint_size                 165
 
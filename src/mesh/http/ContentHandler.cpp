@@ -1,11 +1,16 @@
 #if !MESHTASTIC_EXCLUDE_WEBSERVER
+#include "BootTrace.h"
 #include "NodeDB.h"
 #include "PowerFSM.h"
+#include "RTC.h"
 #include "RadioLibInterface.h"
 #include "airtime.h"
 #include "main.h"
+#include "mesh/LatencyTrace.h"
+#include "mesh/TopologyGraph.h"
 #include "mesh/http/ContentHelper.h"
 #include "mesh/http/WebServer.h"
+#include "modules/Telemetry/TelemetryHistory.h"
 #if HAS_WIFI
 #include "mesh/wifi/WiFiAPClient.h"
 #endif
@@ -95,6 +100,15 @@ void registerHandlers(HTTPServer *insecureServer, HTTPSServer *secureServer)
     ResourceNode *nodeJsonBlinkLED = new ResourceNode("/json/blink", "POST", &handleBlinkLED);
     ResourceNode *nodeJsonReport = new ResourceNode("/json/report", "GET", &handleReport);
     ResourceNode *nodeJsonNodes = new ResourceNode("/json/nodes", "GET", &handleNodes);
+    ResourceNode *nodeJsonBootTrace = new ResourceNode("/json/boottrace", "GET", &handleBootTrace);
+    ResourceNode *nodeJsonTopology = new ResourceNode("/json/topology", "GET", &handleTopology);
+    ResourceNode *nodeJsonAirtime = new ResourceNode("/json/airtime", "GET", &handleAirtime);
+#if !MESHTASTIC_EXCLUDE_ENVIRONMENTAL_SENSOR
+    ResourceNode *nodeJsonTelemetry = new ResourceNode("/json/telemetry", "GET", &handleTelemetryHistory);
+#endif
+#if USERPREFS_LATENCY_TRACE
+    ResourceNode *nodeJsonLatency = new ResourceNode("/json/latency", "GET", &handleLatency);
+#endif
     ResourceNode *nodeJsonFsBrowseStatic = new ResourceNode("/json/fs/browse/static", "GET", &handleFsBrowseStatic);
     ResourceNode *nodeJsonDelete = new ResourceNode("/json/fs/delete/static", "DELETE", &handleFsDeleteStatic);
 
@@ -115,6 +129,15 @@ void registerHandlers(HTTPServer *insecureServer, HTTPSServer *secureServer)
     secureServer->registerNode(nodeJsonDelete);
     secureServer->registerNode(nodeJsonReport);
     secureServer->registerNode(nodeJsonNodes);
+    secureServer->registerNode(nodeJsonBootTrace);
+    secureServer->registerNode(nodeJsonTopology);
+    secureServer->registerNode(nodeJsonAirtime);
+#if !MESHTASTIC_EXCLUDE_ENVIRONMENTAL_SENSOR
+    secureServer->registerNode(nodeJsonTelemetry);
+#endif
+#if USERPREFS_LATENCY_TRACE
+    secureServer->registerNode(nodeJsonLatency);
+#endif
     //    secureServer->registerNode(nodeUpdateFs);
     //    secureServer->registerNode(nodeDeleteFs);
     secureServer->registerNode(nodeAdmin);
@@ -767,6 +790,55 @@ void handleNodes(HTTPRequest *req, HTTPResponse *res)
     delete value;
 }
 
+// Where setup() spent its time, in the Chrome trace event format
+void handleBootTrace(HTTPRequest *req, HTTPResponse *res)
+{
+    res->setHeader("Content-Type", "application/json");
+    res->setHeader("Access-Control-Allow-Origin", "*");
+    res->setHeader("Access-Control-Allow-Methods", "GET");
+    res->print(bootTrace.toChromeTrace().c_str());
+}
+
+// The links between nodes we know of, so clients can draw the mesh without sending traceroutes
+void handleTopology(HTTPRequest *req, HTTPResponse *res)
+{
+    res->setHeader("Content-Type", "application/json");
+    res->setHeader("Access-Control-Allow-Origin", "*");
+    res->setHeader("Access-Control-Allow-Methods", "GET");
+    res->print(topologyGraph.toJson(millis()).c_str());
+}
+
+// The senders and ports that used the most airtime lately, to find who is behind a busy channel
+void handleAirtime(HTTPRequest *req, HTTPResponse *res)
+{
+    res->setHeader("Content-Type", "application/json");
+    res->setHeader("Access-Control-Allow-Origin", "*");
+    res->setHeader("Access-Control-Allow-Methods", "GET");
+    res->print(airTime->topTalkersToJson().c_str());
+}
+
+#if !MESHTASTIC_EXCLUDE_ENVIRONMENTAL_SENSOR
+// Min/max/average and a sparkline of each telemetry metric we have a history of, over the last day
+void handleTelemetryHistory(HTTPRequest *req, HTTPResponse *res)
+{
+    res->setHeader("Content-Type", "application/json");
+    res->setHeader("Access-Control-Allow-Origin", "*");
+    res->setHeader("Access-Control-Allow-Methods", "GET");
+    res->print(telemetryHistory.toJson(getTime()).c_str());
+}
+#endif
+
+#if USERPREFS_LATENCY_TRACE
+// How long packets spend in each stage between the radio and the phone, and between the TX queue and the air
+void handleLatency(HTTPRequest *req, HTTPResponse *res)
+{
+    res->setHeader("Content-Type", "application/json");
+    res->setHeader("Access-Control-Allow-Origin", "*");
+    res->setHeader("Access-Control-Allow-Methods", "GET");
+    res->print(latencyTrace.toJson().c_str());
+}
+#endif
+
 /*
     This supports the Apple Captive Network Assistant (CNA) Portal
 */
@@ -14,6 +14,11 @@ void handleFsDeleteStatic(HTTPRequest *req, HTTPResponse *res);
 void handleBlinkLED(HTTPRequest *req, HTTPResponse *res);
 void handleReport(HTTPRequest *req, HTTPResponse *res);
 void handleNodes(HTTPRequest *req, HTTPResponse *res);
+void handleBootTrace(HTTPRequest *req, HTTPResponse *res);
+void handleTopology(HTTPRequest *req, HTTPResponse *res);
+void handleAirtime(HTTPRequest *req, HTTPResponse *res);
+void handleTelemetryHistory(HTTPRequest *req, HTTPResponse *res);
+void handleLatency(HTTPRequest *req, HTTPResponse *res);
 void handleUpdateFs(HTTPRequest *req, HTTPResponse *res);
 void handleDeleteFsContent(HTTPRequest *req, HTTPResponse *res);
 void handleFs(HTTPRequest *req, HTTPResponse *res);
@@ -37,14 +37,20 @@ mail:   marchammermann@googlemail.com
 #ifdef PORTDUINO_LINUX_HARDWARE
 #if __has_include(<ulfius.h>)
 #include "PiWebServer.h"
+#include "BootTrace.h"
 #include "NodeDB.h"
 #include "PhoneAPI.h"
 #include "PowerFSM.h"
+#include "RTC.h"
 #include "RadioLibInterface.h"
 #include "airtime.h"
 #include "graphics/Screen.h"
 #include "main.h"
+#include "mesh/LatencyTrace.h"
+#include "mesh/MetricsCollector.h"
+#include "mesh/TopologyGraph.h"
 #include "mesh/wifi/WiFiAPClient.h"
+#include "modules/Telemetry/TelemetryHistory.h"
 #include "sleep.h"
 #include <openssl/bn.h>
 #include <openssl/evp.h>
@@ -56,6 +62,7 @@ mail:   marchammermann@googlemail.com
 #include <ulfius.h>
 #include <yder.h>
 
+#include <algorithm>
 #include <cstring>
 #include <string>
 
@@ -248,20 +255,101 @@ int handleAPIv1ToRadio(const struct _u_request *req, struct _u_response *res, vo
     portduinoVFS->mountpoint(configWeb.rootPath);
 
     LOG_DEBUG("Received %d bytes from PUT request", s);
-    static_cast<HttpAPI *>(user_data)->handleToRadio(buffer, s);
+    static_cast<HttpAPI *>(user_data)->handleToRadioLocked(buffer, s);
     LOG_DEBUG("end web->radio  ");
     return U_CALLBACK_COMPLETE;
 }
 
+bool HttpAPI::waitForData(uint32_t timeoutMs)
+{
+    std::unique_lock<std::mutex> guard(lock);
+    return dataReady.wait_for(guard, std::chrono::milliseconds(timeoutMs), [this] { return available(); });
+}
+
+size_t HttpAPI::getFromRadioLocked(uint8_t *buf)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return getFromRadio(buf);
+}
+
+void HttpAPI::handleToRadioLocked(const uint8_t *buf, size_t len)
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        handleToRadio(buf, len);
+    }
+    // A want_config_id makes config available right away
+    dataReady.notify_all();
+}
+
+void HttpAPI::onNowHasData(uint32_t fromRadioNum)
+{
+    // Taking the lock orders this against a request thread that is between checking available() and going to sleep
+    {
+        std::lock_guard<std::mutex> guard(lock);
+    }
+    dataReady.notify_all();
+}
+
+/// State of one /api/v1/fromradio?stream=true response, buffers at most one frame
+struct FromRadioStream {
+    HttpAPI *api;
+    uint32_t endMsec;
+    uint8_t frame[MAX_STREAM_BUF_SIZE];
+    size_t len;
+    size_t pos;
+};
+
+/**
+ * Called by the web server thread whenever the client can take more of the stream. Blocks until there is a frame to send.
+ * Frames use the same 4 byte 0x94C3 + length header as StreamAPI, so clients can reuse their serial/TCP framing code.
+ */
+static ssize_t callback_fromradio_stream(void *cls, uint64_t pos, char *buf, size_t max)
+{
+    (void)(pos);
+    FromRadioStream *stream = (FromRadioStream *)cls;
+    while (stream->pos == stream->len) {
+        if ((int32_t)(millis() - stream->endMsec) >= 0)
+            return U_STREAM_END;
+        stream->pos = stream->len = 0;
+        if (stream->api->waitForData(1000)) {
+            size_t len = stream->api->getFromRadioLocked(stream->frame + 4);
+            if (len) {
+                stream->frame[0] = 0x94;
+                stream->frame[1] = 0xc3;
+                stream->frame[2] = (len >> 8) & 0xff;
+                stream->frame[3] = len & 0xff;
+                stream->len = len + 4;
+            }
+        }
+    }
+    size_t len = std::min(max, stream->len - stream->pos);
+    memcpy(buf, stream->frame + stream->pos, len);
+    stream->pos += len;
+    return len;
+}
+
+static void callback_fromradio_stream_free(void *cls)
+{
+    FromRadioStream *stream = (FromRadioStream *)cls;
+    stream->api->streaming = false;
+    delete stream;
+}
+
 /*
  * Adapt the radioapi to the Webservice handleAPIv1FromRadio
  * Trigger : WebGui(POLL)->handleAPIv1FromRadio->phoneapi->Meshtastic(Radio) events
+ *
+ * Query parameters:
+ *   all=true     return every frame available instead of just one
+ *   wait=<ms>    hold the request until there is something to return, at most FROMRADIO_LONG_POLL_MAX_MS
+ *   stream=true  keep the response open and push frames as they become available, framed like StreamAPI
  */
 int handleAPIv1FromRadio(const struct _u_request *req, struct _u_response *res, void *user_data)
 {
 
     // LOG_DEBUG("handleAPIv1FromRadio radio -> web");
-    std::string valueAll;
+    HttpAPI *api = static_cast<HttpAPI *>(user_data);
 
     // Status code is 200 OK by default.
     ulfius_add_header_to_response(res, "Content-Type", "application/x-protobuf");
@@ -275,33 +363,109 @@ int handleAPIv1FromRadio(const struct _u_request *req, struct _u_response *res,
         return U_CALLBACK_COMPLETE;
     }
 
-    uint8_t txBuf[MAX_STREAM_BUF_SIZE];
-    uint32_t len = 1;
+    const char *valueAll = u_map_get(req->map_url, "all");
+    const char *valueWait = u_map_get(req->map_url, "wait");
+    const char *valueStream = u_map_get(req->map_url, "stream");
+
+    if (valueStream && strcmp(valueStream, "true") == 0) {
+        if (api->streaming.exchange(true)) {
+            LOG_WARN("Refuse second fromradio stream");
+            ulfius_set_response_properties(res, U_OPT_STATUS, 409);
+            return U_CALLBACK_COMPLETE;
+        }
+        FromRadioStream *stream = new FromRadioStream();
+        stream->api = api;
+        stream->endMsec = millis() + FROMRADIO_STREAM_MAX_SECS * 1000;
+        if (ulfius_set_stream_response(res, 200, callback_fromradio_stream, callback_fromradio_stream_free,
+                                       U_STREAM_SIZE_UNKNOWN, MAX_STREAM_BUF_SIZE, stream) != U_OK) {
+            LOG_ERROR("handleAPIv1FromRadio - Error ulfius_set_stream_response");
+            callback_fromradio_stream_free(stream);
+            ulfius_set_response_properties(res, U_OPT_STATUS, 500);
+        }
+        return U_CALLBACK_COMPLETE;
+    }
 
-    if (valueAll == "true") {
+    if (valueWait) {
+        long waitMs = atol(valueWait);
+        if (waitMs > 0)
+            api->waitForData(std::min(waitMs, (long)FROMRADIO_LONG_POLL_MAX_MS));
+    }
+
+    uint8_t txBuf[MAX_STREAM_BUF_SIZE];
+    size_t len = api->getFromRadioLocked(txBuf);
+    if (valueAll && strcmp(valueAll, "true") == 0) {
+        // Return all the frames available at this point in time, back to back
+        std::string body;
         while (len) {
-            len = static_cast<HttpAPI *>(user_data)->getFromRadio(txBuf);
-            ulfius_set_response_properties(res, U_OPT_STATUS, 200, U_OPT_BINARY_BODY, txBuf, len);
-            const char *tmpa = (const char *)txBuf;
-            ulfius_set_string_body_response(res, 200, tmpa);
-            // LOG_DEBUG("\n----webAPI response all:----");
-            // LOG_DEBUG(tmpa);
-            // LOG_DEBUG("");
+            body.append((const char *)txBuf, len);
+            len = api->getFromRadioLocked(txBuf);
         }
+        ulfius_set_binary_body_response(res, 200, body.data(), body.size());
         // Otherwise, just return one protobuf
     } else {
-        len = static_cast<HttpAPI *>(user_data)->getFromRadio(txBuf);
-        const char *tmpa = (const char *)txBuf;
-        ulfius_set_binary_body_response(res, 200, tmpa, len);
-        // LOG_DEBUG("\n----webAPI response:");
-        // LOG_DEBUG(tmpa);
-        // LOG_DEBUG("");
+        ulfius_set_binary_body_response(res, 200, (const char *)txBuf, len);
     }
 
     // LOG_DEBUG("end radio->web", len);
     return U_CALLBACK_COMPLETE;
 }
 
+// Where setup() spent its time, in the Chrome trace event format
+int handleBootTrace(const struct _u_request *req, struct _u_response *res, void *user_data)
+{
+    ulfius_add_header_to_response(res, "Content-Type", "application/json");
+    ulfius_set_string_body_response(res, 200, bootTrace.toChromeTrace().c_str());
+    return U_CALLBACK_COMPLETE;
+}
+
+// The links between nodes we know of, so clients can draw the mesh without sending traceroutes
+int handleTopology(const struct _u_request *req, struct _u_response *res, void *user_data)
+{
+    ulfius_add_header_to_response(res, "Content-Type", "application/json");
+    ulfius_set_string_body_response(res, 200, topologyGraph.toJson(millis()).c_str());
+    return U_CALLBACK_COMPLETE;
+}
+
+// The senders and ports that used the most airtime lately, to find who is behind a busy channel
+int handleAirtime(const struct _u_request *req, struct _u_response *res, void *user_data)
+{
+    ulfius_add_header_to_response(res, "Content-Type", "application/json");
+    ulfius_set_string_body_response(res, 200, airTime->topTalkersToJson().c_str());
+    return U_CALLBACK_COMPLETE;
+}
+
+#if !MESHTASTIC_EXCLUDE_ENVIRONMENTAL_SENSOR
+// Min/max/average and a sparkline of each telemetry metric we have a history of, over the last day
+int handleTelemetryHistory(const struct _u_request *req, struct _u_response *res, void *user_data)
+{
+    ulfius_add_header_to_response(res, "Content-Type", "application/json");
+    ulfius_set_string_body_response(res, 200, telemetryHistory.toJson(getTime()).c_str());
+    return U_CALLBACK_COMPLETE;
+}
+#endif
+
+// Router, radio and queue counters for Prometheus, rendered from what the main loop last copied out
+int handleMetrics(const struct _u_request *req, struct _u_response *res, void *user_data)
+{
+    if (!metricsCollector) {
+        ulfius_set_string_body_response(res, 503, "Metrics not collected");
+        return U_CALLBACK_COMPLETE;
+    }
+    ulfius_add_header_to_response(res, "Content-Type", "text/plain; version=0.0.4; charset=utf-8");
+    ulfius_set_string_body_response(res, 200, metricsCollector->registry.render().c_str());
+    return U_CALLBACK_COMPLETE;
+}
+
+#if USERPREFS_LATENCY_TRACE
+// How long packets spend in each stage between the radio and the phone, and between the TX queue and the air
+int handleLatency(const struct _u_request *req, struct _u_response *res, void *user_data)
+{
+    ulfius_add_header_to_response(res, "Content-Type", "application/json");
+    ulfius_set_string_body_response(res, 200, latencyTrace.toJson().c_str());
+    return U_CALLBACK_COMPLETE;
+}
+#endif
+
 /*
 OpenSSL RSA Key Gen
 */
@@ -503,6 +667,16 @@ PiWebServerThread::PiWebServerThread()
         ulfius_add_endpoint_by_val(&instanceWeb, "OPTIONS", PREFIX, "/api/v1/fromradio/*", 1, &handleAPIv1FromRadio, &webAPI);
         ulfius_add_endpoint_by_val(&instanceWeb, "PUT", PREFIX, "/api/v1/toradio/*", 1, &handleAPIv1ToRadio, &webAPI);
         ulfius_add_endpoint_by_val(&instanceWeb, "OPTIONS", PREFIX, "/api/v1/toradio/*", 1, &handleAPIv1ToRadio, &webAPI);
+        ulfius_add_endpoint_by_val(&instanceWeb, "GET", NULL, "/json/boottrace", 1, &handleBootTrace, NULL);
+        ulfius_add_endpoint_by_val(&instanceWeb, "GET", NULL, "/json/topology", 1, &handleTopology, NULL);
+        ulfius_add_endpoint_by_val(&instanceWeb, "GET", NULL, "/json/airtime", 1, &handleAirtime, NULL);
+#if !MESHTASTIC_EXCLUDE_ENVIRONMENTAL_SENSOR
+        ulfius_add_endpoint_by_val(&instanceWeb, "GET", NULL, "/json/telemetry", 1, &handleTelemetryHistory, NULL);
+#endif
+        ulfius_add_endpoint_by_val(&instanceWeb, "GET", NULL, "/metrics", 1, &handleMetrics, NULL);
+#if USERPREFS_LATENCY_TRACE
+        ulfius_add_endpoint_by_val(&instanceWeb, "GET", NULL, "/json/latency", 1, &handleLatency, NULL);
+#endif
 
         // Add callback function to all endpoints for the Web Server
         ulfius_add_endpoint_by_val(&instanceWeb, "GET", NULL, "/*", 2, &callback_static_file, &configWeb);
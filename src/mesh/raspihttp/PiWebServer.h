@@ -5,10 +5,19 @@
 #include "ulfius-cfg.h"
 #include "ulfius.h"
 #include <Arduino.h>
+#include <atomic>
+#include <condition_variable>
 #include <functional>
+#include <mutex>
 
 #define STATIC_FILE_CHUNK 256
 
+/// Longest a /api/v1/fromradio?wait=<ms> request is held waiting for something to send
+#define FROMRADIO_LONG_POLL_MAX_MS 30000
+
+/// A /api/v1/fromradio?stream=true response is ended after this long, so that dead clients are eventually noticed
+#define FROMRADIO_STREAM_MAX_SECS 300
+
 void initWebServer();
 void createSSLCert();
 int callback_static_file(const struct _u_request *request, struct _u_response *response, void *user_data);
@@ -27,14 +36,26 @@ class HttpAPI : public PhoneAPI
 {
 
   public:
-    // Nothing here yet
+    /// Wait up to timeoutMs for something to send to the client, returns true if there is
+    bool waitForData(uint32_t timeoutMs);
+
+    /// getFromRadio() and handleToRadio() for the request threads, which must not run them concurrently
+    size_t getFromRadioLocked(uint8_t *buf);
+    void handleToRadioLocked(const uint8_t *buf, size_t len);
+
+    /// Set while a client streams from us, a second stream would take frames meant for the first
+    std::atomic<bool> streaming{false};
 
   private:
-    // Nothing here yet
+    std::mutex lock;
+    std::condition_variable dataReady;
 
   protected:
     /// Check the current underlying physical link to see if the client is currently connected
     virtual bool checkIsConnected() override { return true; } // FIXME, be smarter about this
+
+    /// Called from the main thread when a new packet is queued for the client, wakes up waiting requests
+    virtual void onNowHasData(uint32_t fromRadioNum) override;
 };
 
 class PiWebServerThread
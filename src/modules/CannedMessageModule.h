@@ -104,6 +104,9 @@ class CannedMessageModule : public SinglePortModule, public Observable<const UIF
         return (p->decoded.portnum == meshtastic_PortNum_ROUTING_APP) ? waitingForAck : false;
     }
 
+    /// wantPacket() notes the signal of every packet, so it has to be asked about all of them
+    virtual int32_t getDispatchPort() const override { return ModuleDispatchIndex<MeshModule>::anyPort; }
+
   protected:
     // === Thread Entry Point ===
     virtual int32_t runOnce() override;
@@ -65,6 +65,9 @@ class ExternalNotificationModule : public SinglePortModule, private concurrency:
 
     virtual bool wantPacket(const meshtastic_MeshPacket *p) override;
 
+    // wantPacket() takes every text payload port, not just ours
+    virtual int32_t getDispatchPort() const override { return ModuleDispatchIndex<MeshModule>::anyPort; }
+
     bool isNagging = false;
 
     bool isMuted = false;
@@ -3,6 +3,7 @@
 #include "MeshService.h"
 #include "NodeDB.h"
 #include "RTC.h"
+#include "mesh/TopologyGraph.h"
 #include <Throttle.h>
 
 NeighborInfoModule *neighborInfoModule;
@@ -140,6 +141,9 @@ bool NeighborInfoModule::handleReceivedProtobuf(const meshtastic_MeshPacket &mp,
     if (np) {
         printNeighborInfo("RECEIVED", np);
         updateNeighbors(mp, np);
+        for (pb_size_t i = 0; i < np->neighbors_count; i++)
+            topologyGraph.addEdge(np->neighbors[i].node_id, np->node_id, TopologyGraph::toQuarterDb(np->neighbors[i].snr),
+                                  TopologyGraph::NEIGHBORINFO, millis());
     } else if (mp.hop_start != 0 && mp.hop_start == mp.hop_limit) {
         // If the hopLimit is the same as hopStart, then it is a neighbor
         getOrCreateNeighbor(mp.from, mp.from, 0, mp.rx_snr); // Set the broadcast interval to 0, as we don't know it
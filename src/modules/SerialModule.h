@@ -67,6 +67,8 @@ class SerialModuleRadio : public MeshModule
 
     virtual bool wantPacket(const meshtastic_MeshPacket *p) override { return p->decoded.portnum == ourPortNum; }
 
+    virtual int32_t getDispatchPort() const override { return ourPortNum; }
+
     meshtastic_MeshPacket *allocDataPacket()
     {
         // Update our local node info with our position (even if we don't decide to update anyone else)
@@ -0,0 +1,120 @@
+#include "StoreForwardHistory.h"
+#include "configuration.h"
+#include <algorithm>
+
+void StoreForwardHistory::attach(PacketHistoryStruct *ring, uint32_t records, uint32_t totalCount)
+{
+    this->ring = ring;
+    this->records = ring ? records : 0;
+    this->totalCount = this->records ? totalCount : 0;
+
+    broadcastIndex.clear();
+    directIndex.clear();
+    if (!this->totalCount)
+        return;
+    for (uint32_t seq = oldestSeq(); seq <= this->totalCount; seq++) {
+        const PacketHistoryStruct *rec = get(seq);
+        if (rec)
+            indexAdd(*rec);
+    }
+}
+
+uint32_t StoreForwardHistory::add(const PacketHistoryStruct &rec)
+{
+    if (!records)
+        return 0;
+
+    uint32_t seq = totalCount + 1;
+    PacketHistoryStruct &slot = ring[(seq - 1) % records];
+    if (slot.seq) {
+        if ((seq - 1) % records == 0)
+            LOG_WARN("S&F - PSRAM Full. Starting overwrite");
+        indexRemove(slot);
+    }
+
+    slot = rec;
+    slot.seq = seq;
+    totalCount = seq;
+    indexAdd(slot);
+    return seq;
+}
+
+const PacketHistoryStruct *StoreForwardHistory::get(uint32_t seq) const
+{
+    if (!seq || !records || seq > totalCount || seq < oldestSeq())
+        return nullptr;
+    const PacketHistoryStruct *rec = &ring[(seq - 1) % records];
+    return rec->seq == seq ? rec : nullptr;
+}
+
+/**
+ * Merges the broadcast index with the direct index of `dest`, starting after the cursor.
+ */
+uint32_t StoreForwardHistory::next(NodeNum dest, uint32_t afterSeq, uint32_t lastTime, uint32_t *count) const
+{
+    uint32_t first = 0;
+    if (count)
+        *count = 0;
+
+    auto bIt = std::upper_bound(broadcastIndex.begin(), broadcastIndex.end(), afterSeq);
+    const SeqList *direct = nullptr;
+    SeqList::const_iterator dIt;
+    auto found = directIndex.find(dest);
+    if (found != directIndex.end()) {
+        direct = &found->second;
+        dIt = std::upper_bound(direct->begin(), direct->end(), afterSeq);
+    }
+
+    while (true) {
+        uint32_t seq;
+        bool haveBroadcast = bIt != broadcastIndex.end();
+        bool haveDirect = direct && dIt != direct->end();
+        if (haveBroadcast && (!haveDirect || *bIt < *dIt))
+            seq = *bIt++;
+        else if (haveDirect)
+            seq = *dIt++;
+        else
+            return first;
+
+        const PacketHistoryStruct *rec = get(seq);
+        // Client is only interested in packets not from itself and received within the requested window.
+        if (rec && rec->time && rec->time > lastTime && rec->from != dest) {
+            if (!first)
+                first = seq;
+            if (!count)
+                return first;
+            (*count)++;
+        }
+    }
+}
+
+/**
+ * Appends a record to the index list of its destination.
+ */
+void StoreForwardHistory::indexAdd(const PacketHistoryStruct &rec)
+{
+    if (rec.to == NODENUM_BROADCAST)
+        broadcastIndex.push_back(rec.seq);
+    else
+        directIndex[rec.to].push_back(rec.seq);
+}
+
+/**
+ * Drops a record that is about to be overwritten from its index list. Records are always evicted oldest first, so it is at
+ * the front of its list.
+ */
+void StoreForwardHistory::indexRemove(const PacketHistoryStruct &rec)
+{
+    if (rec.to == NODENUM_BROADCAST) {
+        if (!broadcastIndex.empty() && broadcastIndex.front() == rec.seq)
+            broadcastIndex.pop_front();
+        return;
+    }
+    auto it = directIndex.find(rec.to);
+    if (it == directIndex.end())
+        return;
+    if (!it->second.empty() && it->second.front() == rec.seq)
+        it->second.pop_front();
+    if (it->second.empty())
+        directIndex.erase(it);
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "MeshTypes.h"
+#include "mesh/generated/meshtastic/mesh.pb.h"
+#include <deque>
+#include <functional>
+#include <new>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unordered_map>
+#ifdef ARCH_ESP32
+#include <esp_heap_caps.h>
+#endif
+
+struct PacketHistoryStruct {
+    uint32_t seq; // Monotonic sequence number of this record, 0 if the slot was never written
+    uint32_t time;
+    uint32_t to;
+    uint32_t from;
+    uint32_t id;
+    uint8_t channel;
+    uint32_t reply_id;
+    bool emoji;
+    uint8_t payload[meshtastic_Constants_DATA_PAYLOAD_LEN];
+    pb_size_t payload_size;
+    int32_t rx_rssi;
+    float rx_snr;
+};
+
+/**
+ * Allocates from PSRAM where the board has it, falling back to the heap. The history indexes grow with the number of records,
+ * which is sized from free PSRAM, so they must not live on the much smaller internal heap.
+ */
+template <typename T> struct PsramAllocator {
+    using value_type = T;
+
+    PsramAllocator() = default;
+    template <typename U> PsramAllocator(const PsramAllocator<U> &) {}
+
+    T *allocate(size_t n)
+    {
+#ifdef ARCH_ESP32
+        void *p = heap_caps_malloc_prefer(n * sizeof(T), 2, MALLOC_CAP_SPIRAM, MALLOC_CAP_DEFAULT);
+#else
+        void *p = malloc(n * sizeof(T));
+#endif
+        if (!p)
+            abort(); // Same as operator new without exceptions
+        return static_cast<T *>(p);
+    }
+    void deallocate(T *p, size_t) { free(p); }
+
+    template <typename U> bool operator==(const PsramAllocator<U> &) const { return true; }
+    template <typename U> bool operator!=(const PsramAllocator<U> &) const { return false; }
+};
+
+/**
+ * The store and forward packet history: a ring of `records` slots in which the record with sequence number `seq` lives in slot
+ * (seq - 1) % records. Sequence numbers keep growing once the ring is full, so a client cursor, the sequence number of the last
+ * record a client was sent, stays valid and simply skips the records that were overwritten.
+ *
+ * The sequence numbers of the records still held are indexed by destination, so a client only visits what it is owed.
+ */
+class StoreForwardHistory
+{
+  public:
+    /**
+     * Use `ring` as the history. A ring that already holds `totalCount` records, like one restored from a file, is re-indexed.
+     * The ring is owned by the caller.
+     */
+    void attach(PacketHistoryStruct *ring, uint32_t records, uint32_t totalCount = 0);
+
+    /**
+     * Store a copy of `rec` under the next sequence number, overwriting the oldest record once the ring is full.
+     * @return the sequence number it was stored under, 0 if there is no ring
+     */
+    uint32_t add(const PacketHistoryStruct &rec);
+
+    /// The record with the given sequence number, or nullptr if it was overwritten or never written
+    const PacketHistoryStruct *get(uint32_t seq) const;
+
+    /**
+     * Sequence number of the first record after the cursor `afterSeq` that `dest` is owed: one sent to it or broadcast, not
+     * sent by it, and received after `lastTime`.
+     * @param count If given, the scan continues to the end and stores the number of records owed to `dest`.
+     * @return the sequence number, or 0 if there is none
+     */
+    uint32_t next(NodeNum dest, uint32_t afterSeq, uint32_t lastTime, uint32_t *count = nullptr) const;
+
+    /// Number of records held, at most the number of slots
+    uint32_t size() const { return totalCount ? totalCount - oldestSeq() + 1 : 0; }
+
+    /// Number of slots in the ring
+    uint32_t capacity() const { return records; }
+
+    /// Number of records ever added, which is also the sequence number of the newest record
+    uint32_t getTotalCount() const { return totalCount; }
+
+    /// Sequence number of the oldest record still held in the ring
+    uint32_t oldestSeq() const { return totalCount > records ? totalCount - records + 1 : 1; }
+
+  private:
+    using SeqList = std::deque<uint32_t, PsramAllocator<uint32_t>>;
+    using DirectIndex = std::unordered_map<NodeNum, SeqList, std::hash<NodeNum>, std::equal_to<NodeNum>,
+                                           PsramAllocator<std::pair<const NodeNum, SeqList>>>;
+
+    PacketHistoryStruct *ring = nullptr;
+    uint32_t records = 0;
+    uint32_t totalCount = 0;
+
+    SeqList broadcastIndex;
+    DirectIndex directIndex;
+
+    void indexAdd(const PacketHistoryStruct &rec);
+    void indexRemove(const PacketHistoryStruct &rec);
+};
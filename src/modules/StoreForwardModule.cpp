@@ -25,9 +25,33 @@
 #include "mesh/generated/meshtastic/storeforward.pb.h"
 #include "modules/ModuleDev.h"
 #include <Arduino.h>
+#include <algorithm>
 #include <iterator>
 #include <map>
 
+#ifdef ARCH_PORTDUINO
+#include "PortduinoGlue.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SF_HISTORY_FILE_MAGIC 0x53464831 // "SFH1"
+#define SF_HISTORY_FILE_VERSION 1
+
+/// Layout of the start of the history file, followed by `records` PacketHistoryStruct slots
+struct PacketHistoryFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t records;
+    uint32_t recordSize;
+    uint32_t totalCount;
+};
+
+static PacketHistoryFileHeader *historyFileHeader = nullptr;
+#endif
+
 StoreForwardModule *storeForwardModule;
 
 int32_t StoreForwardModule::runOnce()
@@ -81,9 +105,13 @@ void StoreForwardModule::populatePSRAM()
     this->records = numberOfPackets;
 #if defined(ARCH_ESP32)
     this->packetHistory = static_cast<PacketHistoryStruct *>(ps_calloc(numberOfPackets, sizeof(PacketHistoryStruct)));
+    history.attach(this->packetHistory, numberOfPackets);
 #elif defined(ARCH_PORTDUINO)
-    this->packetHistory = static_cast<PacketHistoryStruct *>(calloc(numberOfPackets, sizeof(PacketHistoryStruct)));
-
+    // On meshtasticd the history lives in a memory-mapped file, so it survives restarts and is not bound by RAM size.
+    if (settingsStrings[storeforward_history_file] == "" || !mapHistoryFile(settingsStrings[storeforward_history_file].c_str())) {
+        this->packetHistory = static_cast<PacketHistoryStruct *>(calloc(numberOfPackets, sizeof(PacketHistoryStruct)));
+        history.attach(this->packetHistory, numberOfPackets);
+    }
 #endif
 
     LOG_DEBUG("After PSRAM init: heap %d/%d PSRAM %d/%d", memGet.getFreeHeap(), memGet.getHeapSize(), memGet.getFreePsram(),
@@ -91,6 +119,55 @@ void StoreForwardModule::populatePSRAM()
     LOG_DEBUG("numberOfPackets for packetHistory - %u", numberOfPackets);
 }
 
+#ifdef ARCH_PORTDUINO
+/**
+ * Maps the packet history onto a file, restoring whatever history a previous run left in it.
+ *
+ * @param path The file backing the history. It is created, or re-initialized if its layout does not match.
+ * @return True if the history is now backed by the file, false to fall back to the heap.
+ */
+bool StoreForwardModule::mapHistoryFile(const char *path)
+{
+    const size_t length = sizeof(PacketHistoryFileHeader) + (size_t)this->records * sizeof(PacketHistoryStruct);
+
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        LOG_ERROR("S&F - Can't open history file %s: %s", path, strerror(errno));
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || ((size_t)st.st_size != length && ftruncate(fd, length) != 0)) {
+        LOG_ERROR("S&F - Can't size history file %s: %s", path, strerror(errno));
+        close(fd);
+        return false;
+    }
+    void *map = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd); // The mapping keeps its own reference to the file
+    if (map == MAP_FAILED) {
+        LOG_ERROR("S&F - Can't map history file %s: %s", path, strerror(errno));
+        return false;
+    }
+
+    historyFileHeader = static_cast<PacketHistoryFileHeader *>(map);
+    this->packetHistory = reinterpret_cast<PacketHistoryStruct *>(historyFileHeader + 1);
+
+    if (historyFileHeader->magic != SF_HISTORY_FILE_MAGIC || historyFileHeader->version != SF_HISTORY_FILE_VERSION ||
+        historyFileHeader->records != this->records || historyFileHeader->recordSize != sizeof(PacketHistoryStruct)) {
+        LOG_INFO("S&F - Init history file %s with %u records", path, this->records);
+        memset(map, 0, length);
+        historyFileHeader->magic = SF_HISTORY_FILE_MAGIC;
+        historyFileHeader->version = SF_HISTORY_FILE_VERSION;
+        historyFileHeader->records = this->records;
+        historyFileHeader->recordSize = sizeof(PacketHistoryStruct);
+        history.attach(this->packetHistory, this->records);
+    } else {
+        history.attach(this->packetHistory, this->records, historyFileHeader->totalCount);
+        LOG_INFO("S&F - Restored %u records from history file %s", history.size(), path);
+    }
+    return true;
+}
+#endif
+
 /**
  * Sends messages from the message history to the specified recipient.
  *
@@ -134,15 +211,7 @@ uint32_t StoreForwardModule::getNumAvailablePackets(NodeNum dest, uint32_t last_
     if (lastRequest.find(dest) == lastRequest.end()) {
         lastRequest.emplace(dest, 0);
     }
-    for (uint32_t i = lastRequest[dest]; i < this->packetHistoryTotalCount; i++) {
-        if (this->packetHistory[i].time && (this->packetHistory[i].time > last_time)) {
-            // Client is only interested in packets not from itself and only in broadcast packets or packets towards it.
-            if (this->packetHistory[i].from != dest &&
-                (this->packetHistory[i].to == NODENUM_BROADCAST || this->packetHistory[i].to == dest)) {
-                count++;
-            }
-        }
-    }
+    history.next(dest, lastRequest[dest], last_time, &count);
     return count;
 }
 
@@ -186,27 +255,26 @@ void StoreForwardModule::historyAdd(const meshtastic_MeshPacket &mp)
 {
     const auto &p = mp.decoded;
 
-    if (this->packetHistoryTotalCount == this->records) {
-        LOG_WARN("S&F - PSRAM Full. Starting overwrite");
-        this->packetHistoryTotalCount = 0;
-        for (auto &i : lastRequest) {
-            i.second = 0; // Clear the last request index for each client device
-        }
-    }
-
-    this->packetHistory[this->packetHistoryTotalCount].time = getTime();
-    this->packetHistory[this->packetHistoryTotalCount].to = mp.to;
-    this->packetHistory[this->packetHistoryTotalCount].channel = mp.channel;
-    this->packetHistory[this->packetHistoryTotalCount].from = getFrom(&mp);
-    this->packetHistory[this->packetHistoryTotalCount].id = mp.id;
-    this->packetHistory[this->packetHistoryTotalCount].reply_id = p.reply_id;
-    this->packetHistory[this->packetHistoryTotalCount].emoji = (bool)p.emoji;
-    this->packetHistory[this->packetHistoryTotalCount].payload_size = p.payload.size;
-    this->packetHistory[this->packetHistoryTotalCount].rx_rssi = mp.rx_rssi;
-    this->packetHistory[this->packetHistoryTotalCount].rx_snr = mp.rx_snr;
-    memcpy(this->packetHistory[this->packetHistoryTotalCount].payload, p.payload.bytes, meshtastic_Constants_DATA_PAYLOAD_LEN);
-
-    this->packetHistoryTotalCount++;
+    PacketHistoryStruct rec = {};
+    rec.time = getTime();
+    rec.to = mp.to;
+    rec.channel = mp.channel;
+    rec.from = getFrom(&mp);
+    rec.id = mp.id;
+    rec.reply_id = p.reply_id;
+    rec.emoji = (bool)p.emoji;
+    rec.payload_size = p.payload.size;
+    rec.rx_rssi = mp.rx_rssi;
+    rec.rx_snr = mp.rx_snr;
+    memcpy(rec.payload, p.payload.bytes, meshtastic_Constants_DATA_PAYLOAD_LEN);
+
+    // Once the ring is full this overwrites the oldest record. Sequence numbers keep growing, so clients that have not caught
+    // up yet simply skip the records that were lost instead of starting over.
+    uint32_t seq = history.add(rec);
+#ifdef ARCH_PORTDUINO
+    if (seq && historyFileHeader)
+        historyFileHeader->totalCount = seq;
+#endif
 }
 
 /**
@@ -237,56 +305,52 @@ bool StoreForwardModule::sendPayload(NodeNum dest, uint32_t last_time)
  */
 meshtastic_MeshPacket *StoreForwardModule::preparePayload(NodeNum dest, uint32_t last_time, bool local)
 {
-    for (uint32_t i = lastRequest[dest]; i < this->packetHistoryTotalCount; i++) {
-        if (this->packetHistory[i].time && (this->packetHistory[i].time > last_time)) {
-            /*  Copy the messages that were received by the server in the last msAgo
-                to the packetHistoryTXQueue structure.
-                Client not interested in packets from itself and only in broadcast packets or packets towards it. */
-            if (this->packetHistory[i].from != dest &&
-                (this->packetHistory[i].to == NODENUM_BROADCAST || this->packetHistory[i].to == dest)) {
-
-                meshtastic_MeshPacket *p = allocDataPacket();
-
-                p->to = local ? this->packetHistory[i].to : dest; // PhoneAPI can handle original `to`
-                p->from = this->packetHistory[i].from;
-                p->id = this->packetHistory[i].id;
-                p->channel = this->packetHistory[i].channel;
-                p->decoded.reply_id = this->packetHistory[i].reply_id;
-                p->rx_time = this->packetHistory[i].time;
-                p->decoded.emoji = (uint32_t)this->packetHistory[i].emoji;
-                p->rx_rssi = this->packetHistory[i].rx_rssi;
-                p->rx_snr = this->packetHistory[i].rx_snr;
-
-                // Let's assume that if the server received the S&F request that the client is in range.
-                //   TODO: Make this configurable.
-                p->want_ack = false;
-
-                if (local) { // PhoneAPI gets normal TEXT_MESSAGE_APP
-                    p->decoded.portnum = meshtastic_PortNum_TEXT_MESSAGE_APP;
-                    memcpy(p->decoded.payload.bytes, this->packetHistory[i].payload, this->packetHistory[i].payload_size);
-                    p->decoded.payload.size = this->packetHistory[i].payload_size;
-                } else {
-                    meshtastic_StoreAndForward sf = meshtastic_StoreAndForward_init_zero;
-                    sf.which_variant = meshtastic_StoreAndForward_text_tag;
-                    sf.variant.text.size = this->packetHistory[i].payload_size;
-                    memcpy(sf.variant.text.bytes, this->packetHistory[i].payload, this->packetHistory[i].payload_size);
-                    if (this->packetHistory[i].to == NODENUM_BROADCAST) {
-                        sf.rr = meshtastic_StoreAndForward_RequestResponse_ROUTER_TEXT_BROADCAST;
-                    } else {
-                        sf.rr = meshtastic_StoreAndForward_RequestResponse_ROUTER_TEXT_DIRECT;
-                    }
-
-                    p->decoded.payload.size = pb_encode_to_bytes(p->decoded.payload.bytes, sizeof(p->decoded.payload.bytes),
-                                                                 &meshtastic_StoreAndForward_msg, &sf);
-                }
+    uint32_t seq = history.next(dest, lastRequest[dest], last_time);
+    const PacketHistoryStruct *rec = history.get(seq);
+    if (!rec)
+        return nullptr;
+
+    /*  Copy the messages that were received by the server in the last msAgo
+        to the packetHistoryTXQueue structure.
+        Client not interested in packets from itself and only in broadcast packets or packets towards it. */
+    meshtastic_MeshPacket *p = allocDataPacket();
+
+    p->to = local ? rec->to : dest; // PhoneAPI can handle original `to`
+    p->from = rec->from;
+    p->id = rec->id;
+    p->channel = rec->channel;
+    p->decoded.reply_id = rec->reply_id;
+    p->rx_time = rec->time;
+    p->decoded.emoji = (uint32_t)rec->emoji;
+    p->rx_rssi = rec->rx_rssi;
+    p->rx_snr = rec->rx_snr;
 
-                lastRequest[dest] = i + 1; // Update the last request index for the client device
+    // Let's assume that if the server received the S&F request that the client is in range.
+    //   TODO: Make this configurable.
+    p->want_ack = false;
 
-                return p;
-            }
+    if (local) { // PhoneAPI gets normal TEXT_MESSAGE_APP
+        p->decoded.portnum = meshtastic_PortNum_TEXT_MESSAGE_APP;
+        memcpy(p->decoded.payload.bytes, rec->payload, rec->payload_size);
+        p->decoded.payload.size = rec->payload_size;
+    } else {
+        meshtastic_StoreAndForward sf = meshtastic_StoreAndForward_init_zero;
+        sf.which_variant = meshtastic_StoreAndForward_text_tag;
+        sf.variant.text.size = rec->payload_size;
+        memcpy(sf.variant.text.bytes, rec->payload, rec->payload_size);
+        if (rec->to == NODENUM_BROADCAST) {
+            sf.rr = meshtastic_StoreAndForward_RequestResponse_ROUTER_TEXT_BROADCAST;
+        } else {
+            sf.rr = meshtastic_StoreAndForward_RequestResponse_ROUTER_TEXT_DIRECT;
         }
+
+        p->decoded.payload.size =
+            pb_encode_to_bytes(p->decoded.payload.bytes, sizeof(p->decoded.payload.bytes), &meshtastic_StoreAndForward_msg, &sf);
     }
-    return nullptr;
+
+    lastRequest[dest] = seq; // Update the last request sequence number for the client device
+
+    return p;
 }
 
 /**
@@ -366,7 +430,7 @@ void StoreForwardModule::statsSend(uint32_t to)
     sf.rr = meshtastic_StoreAndForward_RequestResponse_ROUTER_STATS;
     sf.which_variant = meshtastic_StoreAndForward_stats_tag;
     sf.variant.stats.messages_total = this->records;
-    sf.variant.stats.messages_saved = this->packetHistoryTotalCount;
+    sf.variant.stats.messages_saved = history.size();
     sf.variant.stats.messages_max = this->records;
     sf.variant.stats.up_time = millis() / 1000;
     sf.variant.stats.requests = this->requests;
@@ -403,7 +467,7 @@ ProcessMessage StoreForwardModule::handleReceived(const meshtastic_MeshPacket &m
                 }
             } else {
                 storeForwardModule->historyAdd(mp);
-                LOG_INFO("S&F stored. Message history contains %u records now", this->packetHistoryTotalCount);
+                LOG_INFO("S&F stored. Message history contains %u records now", history.size());
             }
         } else if (!isFromUs(&mp) && mp.decoded.portnum == meshtastic_PortNum_STORE_FORWARD_APP) {
             auto &p = mp.decoded;
@@ -600,6 +664,11 @@ StoreForwardModule::StoreForwardModule()
                     // Maximum number of records to store in memory
                     if (moduleConfig.store_forward.records)
                         this->records = moduleConfig.store_forward.records;
+#ifdef ARCH_PORTDUINO
+                    // A file-backed history is not limited by RAM, so meshtasticd may ask for more
+                    else if (settingsMap[storeforward_records] > 0)
+                        this->records = settingsMap[storeforward_records];
+#endif
 
                     // send heartbeat advertising?
                     if (moduleConfig.store_forward.heartbeat)
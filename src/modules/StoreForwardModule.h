@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ProtobufModule.h"
+#include "StoreForwardHistory.h"
 #include "concurrency/OSThread.h"
 #include "mesh/generated/meshtastic/storeforward.pb.h"
 
@@ -9,28 +10,15 @@
 #include <functional>
 #include <unordered_map>
 
-struct PacketHistoryStruct {
-    uint32_t time;
-    uint32_t to;
-    uint32_t from;
-    uint32_t id;
-    uint8_t channel;
-    uint32_t reply_id;
-    bool emoji;
-    uint8_t payload[meshtastic_Constants_DATA_PAYLOAD_LEN];
-    pb_size_t payload_size;
-    int32_t rx_rssi;
-    float rx_snr;
-};
-
 class StoreForwardModule : private concurrency::OSThread, public ProtobufModule<meshtastic_StoreAndForward>
 {
     bool busy = 0;
     uint32_t busyTo = 0;
     char routerMessage[meshtastic_Constants_DATA_PAYLOAD_LEN] = {0};
 
+    // Ring buffer of `records` slots, allocated in PSRAM or mapped from a file on meshtasticd
     PacketHistoryStruct *packetHistory = 0;
-    uint32_t packetHistoryTotalCount = 0;
+    StoreForwardHistory history;
     uint32_t last_time = 0;
     uint32_t requestCount = 0;
 
@@ -39,7 +27,7 @@ class StoreForwardModule : private concurrency::OSThread, public ProtobufModule<
     bool is_client = false;
     bool is_server = false;
 
-    // Unordered_map stores the last request for each nodeNum (`to` field)
+    // Unordered_map stores the sequence number of the last record sent to each nodeNum (`to` field)
     std::unordered_map<NodeNum, uint32_t> lastRequest;
 
   public:
@@ -83,8 +71,14 @@ class StoreForwardModule : private concurrency::OSThread, public ProtobufModule<
         }
     }
 
+    // Two ports, so it has to be asked about every packet
+    virtual int32_t getDispatchPort() const override { return ModuleDispatchIndex<MeshModule>::anyPort; }
+
   private:
     void populatePSRAM();
+#ifdef ARCH_PORTDUINO
+    bool mapHistoryFile(const char *path);
+#endif
 
     // S&F Defaults
     uint32_t historyReturnMax = 25;     // Return maximum of 25 records by default.
@@ -132,11 +132,8 @@ bool AirQualityTelemetryModule::handleReceivedProtobuf(const meshtastic_MeshPack
                  t->variant.air_quality_metrics.pm10_environmental, t->variant.air_quality_metrics.pm25_environmental,
                  t->variant.air_quality_metrics.pm100_environmental);
 #endif
-        // release previous packet before occupying a new spot
-        if (lastMeasurementPacket != nullptr)
-            packetPool.release(lastMeasurementPacket);
-
-        lastMeasurementPacket = packetPool.allocCopy(mp);
+        lastMeasurement.set(mp, *t);
+        telemetryHistory.append(mp, *t);
     }
 
     return false; // Let others look at this message also if they want
@@ -215,11 +212,8 @@ bool AirQualityTelemetryModule::sendTelemetry(NodeNum dest, bool phoneOnly)
         else
             p->priority = meshtastic_MeshPacket_Priority_BACKGROUND;
 
-        // release previous packet before occupying a new spot
-        if (lastMeasurementPacket != nullptr)
-            packetPool.release(lastMeasurementPacket);
-
-        lastMeasurementPacket = packetPool.allocCopy(*p);
+        lastMeasurement.set(*p, m);
+        telemetryHistory.append(*p, m);
         if (phoneOnly) {
             LOG_INFO("Send packet to phone");
             service->sendToPhone(p);
@@ -7,6 +7,7 @@
 #include "Adafruit_PM25AQI.h"
 #include "NodeDB.h"
 #include "ProtobufModule.h"
+#include "TelemetryHistory.h"
 
 class AirQualityTelemetryModule : private concurrency::OSThread, public ProtobufModule<meshtastic_Telemetry>
 {
@@ -19,7 +20,6 @@ class AirQualityTelemetryModule : private concurrency::OSThread, public Protobuf
         : concurrency::OSThread("AirQualityTelemetry"),
           ProtobufModule("AirQualityTelemetry", meshtastic_PortNum_TELEMETRY_APP, &meshtastic_Telemetry_msg)
     {
-        lastMeasurementPacket = nullptr;
         setIntervalFromNow(10 * 1000);
         aqi = Adafruit_PM25AQI();
         nodeStatusObserver.observe(&nodeStatus->onNewStatus);
@@ -59,7 +59,7 @@ class AirQualityTelemetryModule : private concurrency::OSThread, public Protobuf
     Adafruit_PM25AQI aqi;
     PM25_AQI_Data data = {0};
     bool firstTime = true;
-    meshtastic_MeshPacket *lastMeasurementPacket;
+    LastTelemetry lastMeasurement;
     uint32_t sendToPhoneIntervalMs = SECONDS_IN_MINUTE * 1000; // Send to phone every minute
     uint32_t lastSentToMesh = 0;
 };
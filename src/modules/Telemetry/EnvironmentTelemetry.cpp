@@ -310,11 +310,14 @@ int32_t EnvironmentTelemetryModule::runOnce()
             }
 #endif
 #endif
+            addSensorsToPipeline();
         }
         // it's possible to have this module enabled, only for displaying values on the screen.
         // therefore, we should only enable the sensor loop if measurement is also enabled
         return result == UINT32_MAX ? disable() : setStartDelay();
     } else {
+        uint32_t sendToMeshIntervalMs = Default::getConfiguredOrDefaultMsScaled(
+            moduleConfig.telemetry.environment_update_interval, default_telemetry_broadcast_interval_secs, numOnlineNodes);
         // if we somehow got to a second run of this module with measurement disabled, then just wait forever
         if (!moduleConfig.telemetry.environment_measurement_enabled && !ENVIRONMENTAL_TELEMETRY_MODULE_ENABLE) {
             return disable();
@@ -323,12 +326,15 @@ int32_t EnvironmentTelemetryModule::runOnce()
             if (bme680Sensor.hasSensor())
                 result = bme680Sensor.runTrigger();
 #endif
+            // Read at most one sensor per run, the rest of the firmware gets to run while the others convert. Only sample
+            // as often as the phone gets values while a client is there to see them, battery nodes mostly have none.
+            uint32_t sampleIntervalMs = service->isClientConnected() ? sendToPhoneIntervalMs : sendToMeshIntervalMs;
+            result = min(result, sensorPipeline.step(millis(), sampleIntervalMs));
+            if (sensorPipeline.isBusy() && !sensorPipeline.hasResult())
+                return result; // Nothing to send before the first round is in
         }
 
-        if (((lastSentToMesh == 0) ||
-             !Throttle::isWithinTimespanMs(lastSentToMesh, Default::getConfiguredOrDefaultMsScaled(
-                                                               moduleConfig.telemetry.environment_update_interval,
-                                                               default_telemetry_broadcast_interval_secs, numOnlineNodes))) &&
+        if (((lastSentToMesh == 0) || !Throttle::isWithinTimespanMs(lastSentToMesh, sendToMeshIntervalMs)) &&
             airTime->isTxAllowedChannelUtil(config.device.role != meshtastic_Config_DeviceConfig_Role_SENSOR) &&
             airTime->isTxAllowedAirUtil()) {
             sendTelemetry();
@@ -368,20 +374,12 @@ void EnvironmentTelemetryModule::drawFrame(OLEDDisplay *display, OLEDDisplayUiSt
     int currentY = graphics::getTextPositions(display)[line++];
 
     // === Show "No Telemetry" if no data available ===
-    if (!lastMeasurementPacket) {
+    if (!lastMeasurement.valid) {
         display->drawString(x, currentY, "No Telemetry");
         return;
     }
 
-    // Decode the telemetry message from the latest received packet
-    const meshtastic_Data &p = lastMeasurementPacket->decoded;
-    meshtastic_Telemetry telemetry;
-    if (!pb_decode_from_bytes(p.payload.bytes, p.payload.size, &meshtastic_Telemetry_msg, &telemetry)) {
-        display->drawString(x, currentY, "No Telemetry");
-        return;
-    }
-
-    const auto &m = telemetry.variant.environment_metrics;
+    const auto &m = lastMeasurement.telemetry.variant.environment_metrics;
 
     // Check if any telemetry field has valid data
     bool hasAny = m.has_temperature || m.has_relative_humidity || m.barometric_pressure != 0 || m.iaq != 0 || m.voltage != 0 ||
@@ -393,8 +391,8 @@ void EnvironmentTelemetryModule::drawFrame(OLEDDisplay *display, OLEDDisplayUiSt
     }
 
     // === First line: Show sender name + time since received (left), and first metric (right) ===
-    const char *sender = getSenderShortName(*lastMeasurementPacket);
-    uint32_t agoSecs = service->GetTimeSinceMeshPacket(lastMeasurementPacket);
+    const char *sender = getSenderShortName(lastMeasurement.from);
+    uint32_t agoSecs = lastMeasurement.age();
     String agoStr = (agoSecs > 864000) ? "?"
                     : (agoSecs > 3600) ? String(agoSecs / 3600) + "h"
                     : (agoSecs > 60)   ? String(agoSecs / 60) + "m"
@@ -445,7 +443,7 @@ void EnvironmentTelemetryModule::drawFrame(OLEDDisplay *display, OLEDDisplayUiSt
         static uint32_t lastAlertTime = 0;
         uint32_t now = millis();
 
-        bool isOwnTelemetry = lastMeasurementPacket->from == nodeDB->getNodeNum();
+        bool isOwnTelemetry = lastMeasurement.from == nodeDB->getNodeNum();
         bool isCooldownOver = (now - lastAlertTime > 60000);
 
         if (isOwnTelemetry && bannerMsg && isCooldownOver) {
@@ -522,172 +520,112 @@ bool EnvironmentTelemetryModule::handleReceivedProtobuf(const meshtastic_MeshPac
         LOG_INFO("(Received from %s): radiation=%fµR/h", sender, t->variant.environment_metrics.radiation);
 
 #endif
-        // release previous packet before occupying a new spot
-        if (lastMeasurementPacket != nullptr)
-            packetPool.release(lastMeasurementPacket);
-
-        lastMeasurementPacket = packetPool.allocCopy(mp);
+        lastMeasurement.set(mp, *t);
+        telemetryHistory.append(mp, *t);
     }
 
     return false; // Let others look at this message also if they want
 }
 
-bool EnvironmentTelemetryModule::getEnvironmentTelemetry(meshtastic_Telemetry *m)
+void EnvironmentTelemetryModule::addSensorsToPipeline()
 {
-    bool valid = true;
-    bool hasSensor = false;
-    m->time = getTime();
-    m->which_variant = meshtastic_Telemetry_environment_metrics_tag;
-    m->variant.environment_metrics = meshtastic_EnvironmentMetrics_init_zero;
-
 #ifdef SENSECAP_INDICATOR
-    valid = valid && indicatorSensor.getMetrics(m);
-    hasSensor = true;
+    sensorPipeline.add(&indicatorSensor);
 #endif
 #ifdef T1000X_SENSOR_EN // add by WayenWeng
-    valid = valid && t1000xSensor.getMetrics(m);
-    hasSensor = true;
+    sensorPipeline.add(&t1000xSensor);
 #else
-    if (dfRobotLarkSensor.hasSensor()) {
-        valid = valid && dfRobotLarkSensor.getMetrics(m);
-        hasSensor = true;
-    }
-    if (dfRobotGravitySensor.hasSensor()) {
-        valid = valid && dfRobotGravitySensor.getMetrics(m);
-        hasSensor = true;
-    }
-    if (sht31Sensor.hasSensor()) {
-        valid = valid && sht31Sensor.getMetrics(m);
-        hasSensor = true;
-    }
-    if (sht4xSensor.hasSensor()) {
-        valid = valid && sht4xSensor.getMetrics(m);
-        hasSensor = true;
-    }
-    if (lps22hbSensor.hasSensor()) {
-        valid = valid && lps22hbSensor.getMetrics(m);
-        hasSensor = true;
-    }
-    if (shtc3Sensor.hasSensor()) {
-        valid = valid && shtc3Sensor.getMetrics(m);
-        hasSensor = true;
-    }
-    if (bmp085Sensor.hasSensor()) {
-        valid = valid && bmp085Sensor.getMetrics(m);
-        hasSensor = true;
-    }
+    if (dfRobotLarkSensor.hasSensor())
+        sensorPipeline.add(&dfRobotLarkSensor);
+    if (dfRobotGravitySensor.hasSensor())
+        sensorPipeline.add(&dfRobotGravitySensor);
+    if (sht31Sensor.hasSensor())
+        sensorPipeline.add(&sht31Sensor);
+    if (sht4xSensor.hasSensor())
+        sensorPipeline.add(&sht4xSensor);
+    if (lps22hbSensor.hasSensor())
+        sensorPipeline.add(&lps22hbSensor);
+    if (shtc3Sensor.hasSensor())
+        sensorPipeline.add(&shtc3Sensor);
+    if (bmp085Sensor.hasSensor())
+        sensorPipeline.add(&bmp085Sensor);
 #if __has_include(<Adafruit_BME280.h>)
-    if (bmp280Sensor.hasSensor()) {
-        valid = valid && bmp280Sensor.getMetrics(m);
-        hasSensor = true;
-    }
-#endif
-    if (bme280Sensor.hasSensor()) {
-        valid = valid && bme280Sensor.getMetrics(m);
-        hasSensor = true;
-    }
-    if (ltr390uvSensor.hasSensor()) {
-        valid = valid && ltr390uvSensor.getMetrics(m);
-        hasSensor = true;
-    }
-    if (bmp3xxSensor.hasSensor()) {
-        valid = valid && bmp3xxSensor.getMetrics(m);
-        hasSensor = true;
-    }
-    if (bme680Sensor.hasSensor()) {
-        valid = valid && bme680Sensor.getMetrics(m);
-        hasSensor = true;
-    }
-    if (dps310Sensor.hasSensor()) {
-        valid = valid && dps310Sensor.getMetrics(m);
-        hasSensor = true;
-    }
-    if (mcp9808Sensor.hasSensor()) {
-        valid = valid && mcp9808Sensor.getMetrics(m);
-        hasSensor = true;
-    }
-    if (ina219Sensor.hasSensor()) {
-        valid = valid && ina219Sensor.getMetrics(m);
-        hasSensor = true;
-    }
-    if (ina260Sensor.hasSensor()) {
-        valid = valid && ina260Sensor.getMetrics(m);
-        hasSensor = true;
-    }
-    if (ina3221Sensor.hasSensor()) {
-        valid = valid && ina3221Sensor.getMetrics(m);
-        hasSensor = true;
-    }
-    if (veml7700Sensor.hasSensor()) {
-        valid = valid && veml7700Sensor.getMetrics(m);
-        hasSensor = true;
-    }
-    if (tsl2591Sensor.hasSensor()) {
-        valid = valid && tsl2591Sensor.getMetrics(m);
-        hasSensor = true;
-    }
-    if (opt3001Sensor.hasSensor()) {
-        valid = valid && opt3001Sensor.getMetrics(m);
-        hasSensor = true;
-    }
-    if (mlx90632Sensor.hasSensor()) {
-        valid = valid && mlx90632Sensor.getMetrics(m);
-        hasSensor = true;
-    }
-    if (rcwl9620Sensor.hasSensor()) {
-        valid = valid && rcwl9620Sensor.getMetrics(m);
-        hasSensor = true;
-    }
-    if (nau7802Sensor.hasSensor()) {
-        valid = valid && nau7802Sensor.getMetrics(m);
-        hasSensor = true;
-    }
+    if (bmp280Sensor.hasSensor())
+        sensorPipeline.add(&bmp280Sensor);
+#endif
+    if (bme280Sensor.hasSensor())
+        sensorPipeline.add(&bme280Sensor);
+    if (ltr390uvSensor.hasSensor())
+        sensorPipeline.add(&ltr390uvSensor);
+    if (bmp3xxSensor.hasSensor())
+        sensorPipeline.add(&bmp3xxSensor);
+    if (bme680Sensor.hasSensor())
+        sensorPipeline.add(&bme680Sensor);
+    if (dps310Sensor.hasSensor())
+        sensorPipeline.add(&dps310Sensor);
+    if (mcp9808Sensor.hasSensor())
+        sensorPipeline.add(&mcp9808Sensor);
+    if (ina219Sensor.hasSensor())
+        sensorPipeline.add(&ina219Sensor);
+    if (ina260Sensor.hasSensor())
+        sensorPipeline.add(&ina260Sensor);
+    if (ina3221Sensor.hasSensor())
+        sensorPipeline.add(&ina3221Sensor);
+    if (veml7700Sensor.hasSensor())
+        sensorPipeline.add(&veml7700Sensor);
+    if (tsl2591Sensor.hasSensor())
+        sensorPipeline.add(&tsl2591Sensor);
+    if (opt3001Sensor.hasSensor())
+        sensorPipeline.add(&opt3001Sensor);
+    if (mlx90632Sensor.hasSensor())
+        sensorPipeline.add(&mlx90632Sensor);
+    if (rcwl9620Sensor.hasSensor())
+        sensorPipeline.add(&rcwl9620Sensor);
+    if (nau7802Sensor.hasSensor())
+        sensorPipeline.add(&nau7802Sensor);
     if (aht10Sensor.hasSensor()) {
         if (!bmp280Sensor.hasSensor() && !bmp3xxSensor.hasSensor()) {
-            valid = valid && aht10Sensor.getMetrics(m);
-            hasSensor = true;
-        } else if (bmp280Sensor.hasSensor()) {
-            // prefer bmp280 temp if both sensors are present, fetch only humidity
-            meshtastic_Telemetry m_ahtx = meshtastic_Telemetry_init_zero;
-            LOG_INFO("AHTX0+BMP280 module detected: using temp from BMP280 and humy from AHTX0");
-            aht10Sensor.getMetrics(&m_ahtx);
-            m->variant.environment_metrics.relative_humidity = m_ahtx.variant.environment_metrics.relative_humidity;
-            m->variant.environment_metrics.has_relative_humidity = m_ahtx.variant.environment_metrics.has_relative_humidity;
+            sensorPipeline.add(&aht10Sensor);
         } else {
-            // prefer bmp3xx temp if both sensors are present, fetch only humidity
-            meshtastic_Telemetry m_ahtx = meshtastic_Telemetry_init_zero;
-            LOG_INFO("AHTX0+BMP3XX module detected: using temp from BMP3XX and humy from AHTX0");
-            aht10Sensor.getMetrics(&m_ahtx);
-            m->variant.environment_metrics.relative_humidity = m_ahtx.variant.environment_metrics.relative_humidity;
-            m->variant.environment_metrics.has_relative_humidity = m_ahtx.variant.environment_metrics.has_relative_humidity;
+            // prefer bmp280/bmp3xx temp if both sensors are present, fetch only humidity
+            LOG_INFO("AHTX0+%s module detected: using temp from it and humy from AHTX0",
+                     bmp280Sensor.hasSensor() ? "BMP280" : "BMP3XX");
+            sensorPipeline.add(&aht10Sensor, SensorPipeline::MERGE_HUMIDITY_ONLY);
         }
     }
-    if (max17048Sensor.hasSensor()) {
-        valid = valid && max17048Sensor.getMetrics(m);
-        hasSensor = true;
-    }
-    if (cgRadSens.hasSensor()) {
-        valid = valid && cgRadSens.getMetrics(m);
-        hasSensor = true;
-    }
-    if (pct2075Sensor.hasSensor()) {
-        valid = valid && pct2075Sensor.getMetrics(m);
-        hasSensor = true;
-    }
+    if (max17048Sensor.hasSensor())
+        sensorPipeline.add(&max17048Sensor);
+    if (cgRadSens.hasSensor())
+        sensorPipeline.add(&cgRadSens);
+    if (pct2075Sensor.hasSensor())
+        sensorPipeline.add(&pct2075Sensor);
 #ifdef HAS_RAKPROT
-    valid = valid && rak9154Sensor.getMetrics(m);
-    hasSensor = true;
+    sensorPipeline.add(&rak9154Sensor);
 #endif
 #if __has_include("RAK12035_SoilMoisture.h") && defined(RAK_4631) &&                                                             \
                   RAK_4631 ==                                                                                                    \
                       1 // Not really needed, but may as well just skip at a lower level it if no library or not a RAK_4631
-    if (rak12035Sensor.hasSensor()) {
-        valid = valid && rak12035Sensor.getMetrics(m);
-        hasSensor = true;
-    }
+    if (rak12035Sensor.hasSensor())
+        sensorPipeline.add(&rak12035Sensor);
 #endif
 #endif
-    return valid && hasSensor;
+}
+
+bool EnvironmentTelemetryModule::getEnvironmentTelemetry(meshtastic_Telemetry *m)
+{
+    if (sensorPipeline.size() == 0)
+        return false;
+
+    // Until the first round completes, e.g. right after boot or wake, read every sensor here and now like we used to
+    if (!sensorPipeline.hasResult())
+        sensorPipeline.readNow();
+    bool valid = sensorPipeline.getResult(m);
+
+    // Stamp the reading with when it was taken, not when it is sent
+    uint32_t now = getTime();
+    uint32_t ageSecs = (millis() - sensorPipeline.getResultMs()) / 1000;
+    m->time = now > ageSecs ? now - ageSecs : now;
+    return valid;
 }
 
 meshtastic_MeshPacket *EnvironmentTelemetryModule::allocReply()
@@ -752,11 +690,8 @@ bool EnvironmentTelemetryModule::sendTelemetry(NodeNum dest, bool phoneOnly)
             p->priority = meshtastic_MeshPacket_Priority_RELIABLE;
         else
             p->priority = meshtastic_MeshPacket_Priority_BACKGROUND;
-        // release previous packet before occupying a new spot
-        if (lastMeasurementPacket != nullptr)
-            packetPool.release(lastMeasurementPacket);
-
-        lastMeasurementPacket = packetPool.allocCopy(*p);
+        lastMeasurement.set(*p, m);
+        telemetryHistory.append(*p, m);
         if (phoneOnly) {
             LOG_INFO("Send packet to phone");
             service->sendToPhone(p);
@@ -11,6 +11,8 @@
 #include "../mesh/generated/meshtastic/telemetry.pb.h"
 #include "NodeDB.h"
 #include "ProtobufModule.h"
+#include "SensorPipeline.h"
+#include "TelemetryHistory.h"
 #include <OLEDDisplay.h>
 #include <OLEDDisplayUi.h>
 
@@ -25,7 +27,6 @@ class EnvironmentTelemetryModule : private concurrency::OSThread, public Protobu
         : concurrency::OSThread("EnvironmentTelemetry"),
           ProtobufModule("EnvironmentTelemetry", meshtastic_PortNum_TELEMETRY_APP, &meshtastic_Telemetry_msg)
     {
-        lastMeasurementPacket = nullptr;
         nodeStatusObserver.observe(&nodeStatus->onNewStatus);
         setIntervalFromNow(10 * 1000);
     }
@@ -42,7 +43,7 @@ class EnvironmentTelemetryModule : private concurrency::OSThread, public Protobu
     */
     virtual bool handleReceivedProtobuf(const meshtastic_MeshPacket &mp, meshtastic_Telemetry *p) override;
     virtual int32_t runOnce() override;
-    /** Called to get current Environment telemetry data
+    /** Called to get current Environment telemetry data, from the last pipeline round if there has been one
     @return true if it contains valid data
     */
     bool getEnvironmentTelemetry(meshtastic_Telemetry *m);
@@ -57,8 +58,12 @@ class EnvironmentTelemetryModule : private concurrency::OSThread, public Protobu
                                                                  meshtastic_AdminMessage *response) override;
 
   private:
+    /// Add every detected sensor to the pipeline, in the order their metrics should be merged
+    void addSensorsToPipeline();
+
     bool firstTime = 1;
-    meshtastic_MeshPacket *lastMeasurementPacket;
+    LastTelemetry lastMeasurement;
+    SensorPipeline sensorPipeline;
     uint32_t sendToPhoneIntervalMs = SECONDS_IN_MINUTE * 1000; // Send to phone every minute
     uint32_t lastSentToMesh = 0;
     uint32_t lastSentToPhone = 0;
@@ -98,24 +98,15 @@ void HealthTelemetryModule::drawFrame(OLEDDisplay *display, OLEDDisplayUiState *
     display->setTextAlignment(TEXT_ALIGN_LEFT);
     display->setFont(FONT_SMALL);
 
-    if (lastMeasurementPacket == nullptr) {
+    if (!lastMeasurement.valid) {
         // If there's no valid packet, display "Health"
         display->drawString(x, y, "Health");
         display->drawString(x, y += _fontHeight(FONT_SMALL), "No measurement");
         return;
     }
 
-    // Decode the last measurement packet
-    meshtastic_Telemetry lastMeasurement;
-    uint32_t agoSecs = service->GetTimeSinceMeshPacket(lastMeasurementPacket);
-    const char *lastSender = getSenderShortName(*lastMeasurementPacket);
-
-    const meshtastic_Data &p = lastMeasurementPacket->decoded;
-    if (!pb_decode_from_bytes(p.payload.bytes, p.payload.size, &meshtastic_Telemetry_msg, &lastMeasurement)) {
-        display->drawString(x, y, "Measurement Error");
-        LOG_ERROR("Unable to decode last packet");
-        return;
-    }
+    uint32_t agoSecs = lastMeasurement.age();
+    const char *lastSender = getSenderShortName(lastMeasurement.from);
 
     // Display "Health From: ..." on its own
     char headerStr[64];
@@ -125,23 +116,23 @@ void HealthTelemetryModule::drawFrame(OLEDDisplay *display, OLEDDisplayUiState *
     char last_temp[16];
     if (moduleConfig.telemetry.environment_display_fahrenheit) {
         snprintf(last_temp, sizeof(last_temp), "%.0f°F",
-                 UnitConversions::CelsiusToFahrenheit(lastMeasurement.variant.health_metrics.temperature));
+                 UnitConversions::CelsiusToFahrenheit(lastMeasurement.telemetry.variant.health_metrics.temperature));
     } else {
-        snprintf(last_temp, sizeof(last_temp), "%.0f°C", lastMeasurement.variant.health_metrics.temperature);
+        snprintf(last_temp, sizeof(last_temp), "%.0f°C", lastMeasurement.telemetry.variant.health_metrics.temperature);
     }
 
     // Continue with the remaining details
     char tempStr[32];
     snprintf(tempStr, sizeof(tempStr), "Temp: %s", last_temp);
     display->drawString(x, y += _fontHeight(FONT_SMALL), tempStr);
-    if (lastMeasurement.variant.health_metrics.has_heart_bpm) {
+    if (lastMeasurement.telemetry.variant.health_metrics.has_heart_bpm) {
         char heartStr[32];
-        snprintf(heartStr, sizeof(heartStr), "Heart Rate: %.0f bpm", lastMeasurement.variant.health_metrics.heart_bpm);
+        snprintf(heartStr, sizeof(heartStr), "Heart Rate: %.0f bpm", lastMeasurement.telemetry.variant.health_metrics.heart_bpm);
         display->drawString(x, y += _fontHeight(FONT_SMALL), heartStr);
     }
-    if (lastMeasurement.variant.health_metrics.has_spO2) {
+    if (lastMeasurement.telemetry.variant.health_metrics.has_spO2) {
         char spo2Str[32];
-        snprintf(spo2Str, sizeof(spo2Str), "spO2: %.0f %%", lastMeasurement.variant.health_metrics.spO2);
+        snprintf(spo2Str, sizeof(spo2Str), "spO2: %.0f %%", lastMeasurement.telemetry.variant.health_metrics.spO2);
         display->drawString(x, y += _fontHeight(FONT_SMALL), spo2Str);
     }
 }
@@ -156,11 +147,8 @@ bool HealthTelemetryModule::handleReceivedProtobuf(const meshtastic_MeshPacket &
                  t->variant.health_metrics.heart_bpm, t->variant.health_metrics.spO2);
 
 #endif
-        // release previous packet before occupying a new spot
-        if (lastMeasurementPacket != nullptr)
-            packetPool.release(lastMeasurementPacket);
-
-        lastMeasurementPacket = packetPool.allocCopy(mp);
+        lastMeasurement.set(mp, *t);
+        telemetryHistory.append(mp, *t);
     }
 
     return false; // Let others look at this message also if they want
@@ -232,11 +220,8 @@ bool HealthTelemetryModule::sendTelemetry(NodeNum dest, bool phoneOnly)
             p->priority = meshtastic_MeshPacket_Priority_RELIABLE;
         else
             p->priority = meshtastic_MeshPacket_Priority_BACKGROUND;
-        // release previous packet before occupying a new spot
-        if (lastMeasurementPacket != nullptr)
-            packetPool.release(lastMeasurementPacket);
-
-        lastMeasurementPacket = packetPool.allocCopy(*p);
+        lastMeasurement.set(*p, m);
+        telemetryHistory.append(*p, m);
         if (phoneOnly) {
             LOG_INFO("Send packet to phone");
             service->sendToPhone(p);
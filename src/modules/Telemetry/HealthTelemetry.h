@@ -6,6 +6,7 @@
 #include "../mesh/generated/meshtastic/telemetry.pb.h"
 #include "NodeDB.h"
 #include "ProtobufModule.h"
+#include "TelemetryHistory.h"
 #include <OLEDDisplay.h>
 #include <OLEDDisplayUi.h>
 
@@ -19,7 +20,6 @@ class HealthTelemetryModule : private concurrency::OSThread, public ProtobufModu
         : concurrency::OSThread("HealthTelemetry"),
           ProtobufModule("HealthTelemetry", meshtastic_PortNum_TELEMETRY_APP, &meshtastic_Telemetry_msg)
     {
-        lastMeasurementPacket = nullptr;
         nodeStatusObserver.observe(&nodeStatus->onNewStatus);
         setIntervalFromNow(10 * 1000);
     }
@@ -50,7 +50,7 @@ class HealthTelemetryModule : private concurrency::OSThread, public ProtobufModu
 
   private:
     bool firstTime = 1;
-    meshtastic_MeshPacket *lastMeasurementPacket;
+    LastTelemetry lastMeasurement;
     uint32_t sendToPhoneIntervalMs = SECONDS_IN_MINUTE * 1000; // Send to phone every minute
     uint32_t lastSentToMesh = 0;
     uint32_t lastSentToPhone = 0;
@@ -3,7 +3,6 @@
 #include "MeshService.h"
 #if ARCH_PORTDUINO
 #include "PortduinoGlue.h"
-#include <filesystem>
 #endif
 
 int32_t HostMetricsModule::runOnce()
@@ -71,52 +70,24 @@ meshtastic_MeshPacket *HostMetricsModule::allocReply()
 #if ARCH_PORTDUINO
 meshtastic_Telemetry HostMetricsModule::getHostMetrics()
 {
-    std::string file_line;
     meshtastic_Telemetry t = meshtastic_Telemetry_init_zero;
     t.which_variant = meshtastic_Telemetry_host_metrics_tag;
     t.variant.host_metrics = meshtastic_HostMetrics_init_zero;
 
-    if (access("/proc/uptime", R_OK) == 0) {
-        std::ifstream proc_uptime("/proc/uptime");
-        if (proc_uptime.is_open()) {
-            std::getline(proc_uptime, file_line, ' ');
-            proc_uptime.close();
-            t.variant.host_metrics.uptime_seconds = stoul(file_line);
-        }
-    }
+    collector.sample(lastSample);
+    t.variant.host_metrics.uptime_seconds = lastSample.uptimeSeconds;
+    t.variant.host_metrics.diskfree1_bytes = lastSample.diskfreeBytes;
+    t.variant.host_metrics.freemem_bytes = lastSample.freememBytes;
+    t.variant.host_metrics.load1 = lastSample.load1;
+    t.variant.host_metrics.load5 = lastSample.load5;
+    t.variant.host_metrics.load15 = lastSample.load15;
 
-    std::filesystem::space_info root = std::filesystem::space("/");
-    t.variant.host_metrics.diskfree1_bytes = root.available;
-
-    if (access("/proc/meminfo", R_OK) == 0) {
-        std::ifstream proc_meminfo("/proc/meminfo");
-        if (proc_meminfo.is_open()) {
-            do {
-                std::getline(proc_meminfo, file_line);
-            } while (file_line.find("MemAvailable") == std::string::npos);
-            proc_meminfo.close();
-            t.variant.host_metrics.freemem_bytes = stoull(file_line.substr(file_line.find_first_of("0123456789"))) * 1024;
-        }
-    }
-    if (access("/proc/loadavg", R_OK) == 0) {
-        std::ifstream proc_loadavg("/proc/loadavg");
-        if (proc_loadavg.is_open()) {
-            std::getline(proc_loadavg, file_line, ' ');
-            t.variant.host_metrics.load1 = stof(file_line) * 100;
-            std::getline(proc_loadavg, file_line, ' ');
-            t.variant.host_metrics.load5 = stof(file_line) * 100;
-            std::getline(proc_loadavg, file_line, ' ');
-            t.variant.host_metrics.load15 = stof(file_line) * 100;
-            proc_loadavg.close();
-        }
-    }
     if (settingsStrings[hostMetrics_user_command] != "") {
-        std::string userCommandResult = exec(settingsStrings[hostMetrics_user_command].c_str());
-        if (userCommandResult.length() > 1) {
-            strncpy(t.variant.host_metrics.user_string, userCommandResult.c_str(), sizeof(t.variant.host_metrics.user_string));
-            t.variant.host_metrics.user_string[sizeof(t.variant.host_metrics.user_string) - 1] = '\0';
+        // The command runs on a worker thread, so each report carries the output of the previous completed run
+        collector.startUserCommand(settingsStrings[hostMetrics_user_command],
+                                   settingsMap[hostMetrics_user_command_timeout] * 1000);
+        if (collector.getUserCommandResult(t.variant.host_metrics.user_string, sizeof(t.variant.host_metrics.user_string)))
             t.variant.host_metrics.has_user_string = true;
-        }
     }
     return t;
 }
@@ -130,6 +101,12 @@ bool HostMetricsModule::sendMetrics()
              static_cast<float>(telemetry.variant.host_metrics.load5) / 100,
              static_cast<float>(telemetry.variant.host_metrics.load15) / 100);
     // telemetry.variant.host_metrics.has_user_string ? telemetry.variant.host_metrics.user_string : "");
+    LOG_INFO("meshtasticd: rss=%llu, cpu user=%llums system=%llums, open fds=%u, threads=%u",
+             (unsigned long long)lastSample.rssBytes, (unsigned long long)lastSample.cpuUserMs,
+             (unsigned long long)lastSample.cpuSystemMs, (unsigned)lastSample.openFds, lastSample.numThreads);
+    for (uint8_t i = 0; i < lastSample.numThreads; i++)
+        LOG_DEBUG("  thread %d (%s): cpu=%llums", lastSample.threads[i].tid, lastSample.threads[i].name,
+                  (unsigned long long)lastSample.threads[i].cpuMs);
 
     meshtastic_MeshPacket *p = allocDataProtobuf(telemetry);
     p->to = NODENUM_BROADCAST;
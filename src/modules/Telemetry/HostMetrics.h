@@ -1,5 +1,6 @@
 #pragma once
 #include "../mesh/generated/meshtastic/telemetry.pb.h"
+#include "HostMetricsCollector.h"
 #include "ProtobufModule.h"
 
 class HostMetricsModule : private concurrency::OSThread, public ProtobufModule<meshtastic_Telemetry>
@@ -37,4 +38,8 @@ class HostMetricsModule : private concurrency::OSThread, public ProtobufModule<m
     uint32_t lastSentToMesh = 0;
     uint32_t uptimeWrapCount;
     uint32_t uptimeLastMs;
+#if ARCH_PORTDUINO
+    HostMetricsCollector collector;
+    HostSample lastSample;
+#endif
 };
\ No newline at end of file
@@ -0,0 +1,294 @@
+#include "HostMetricsCollector.h"
+
+#if ARCH_PORTDUINO
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/statvfs.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+ProcFile::ProcFile(const char *path)
+{
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+}
+
+ProcFile::~ProcFile()
+{
+    if (fd >= 0)
+        close(fd);
+}
+
+const char *ProcFile::read()
+{
+    if (fd < 0)
+        return nullptr;
+    ssize_t n = pread(fd, buf, sizeof(buf) - 1, 0);
+    if (n <= 0)
+        return nullptr;
+    buf[n] = '\0';
+    return buf;
+}
+
+static const char *skipSpaces(const char *p)
+{
+    while (*p == ' ' || *p == '\t' || *p == '\n')
+        p++;
+    return p;
+}
+
+static const char *skipField(const char *p)
+{
+    p = skipSpaces(p);
+    while (*p && *p != ' ' && *p != '\n')
+        p++;
+    return p;
+}
+
+static uint64_t parseU64(const char *&p)
+{
+    uint64_t v = 0;
+    p = skipSpaces(p);
+    while (*p >= '0' && *p <= '9')
+        v = v * 10 + (*p++ - '0');
+    return v;
+}
+
+/// Parse a decimal such as "0.52" into hundredths (52)
+static uint32_t parseHundredths(const char *&p)
+{
+    uint32_t v = parseU64(p) * 100;
+    if (*p == '.') {
+        p++;
+        if (*p >= '0' && *p <= '9')
+            v += (*p++ - '0') * 10;
+        if (*p >= '0' && *p <= '9')
+            v += (*p++ - '0');
+        while (*p >= '0' && *p <= '9')
+            p++;
+    }
+    return v;
+}
+
+/**
+ * Parse the utime and stime fields (14 and 15) of a /proc/.../stat line. The command name is in parentheses and may itself
+ * contain spaces or parentheses, so fields are counted from the last ')'. The name is copied to `name` if given.
+ */
+static bool parseStatTimes(const char *stat, uint64_t &utime, uint64_t &stime, char *name = nullptr, size_t nameLen = 0)
+{
+    const char *nameStart = strchr(stat, '(');
+    const char *nameEnd = strrchr(stat, ')');
+    if (!nameStart || !nameEnd || nameEnd < nameStart)
+        return false;
+    if (name) {
+        size_t n = nameEnd - nameStart - 1;
+        if (n >= nameLen)
+            n = nameLen - 1;
+        memcpy(name, nameStart + 1, n);
+        name[n] = '\0';
+    }
+    const char *p = nameEnd + 1;
+    for (int field = 3; field < 14; field++)
+        p = skipField(p);
+    utime = parseU64(p);
+    stime = parseU64(p);
+    return true;
+}
+
+HostMetricsCollector::HostMetricsCollector()
+{
+    fdDir = opendir("/proc/self/fd");
+    taskDir = opendir("/proc/self/task");
+    pageSize = sysconf(_SC_PAGESIZE);
+    ticksPerSecond = sysconf(_SC_CLK_TCK);
+    if (ticksPerSecond <= 0)
+        ticksPerSecond = 100;
+}
+
+HostMetricsCollector::~HostMetricsCollector()
+{
+    if (userCommandThread.joinable())
+        userCommandThread.join();
+    if (fdDir)
+        closedir(fdDir);
+    if (taskDir)
+        closedir(taskDir);
+}
+
+bool HostMetricsCollector::sample(HostSample &s)
+{
+    memset(&s, 0, sizeof(s));
+    const char *p;
+
+    if ((p = uptime.read()))
+        s.uptimeSeconds = parseU64(p);
+
+    struct statvfs root;
+    if (statvfs("/", &root) == 0)
+        s.diskfreeBytes = (uint64_t)root.f_bavail * root.f_frsize;
+
+    if ((p = meminfo.read()) && (p = strstr(p, "MemAvailable:"))) {
+        p += strlen("MemAvailable:");
+        s.freememBytes = parseU64(p) * 1024;
+    }
+
+    if ((p = loadavg.read())) {
+        s.load1 = parseHundredths(p);
+        s.load5 = parseHundredths(p);
+        s.load15 = parseHundredths(p);
+    }
+
+    if ((p = selfStatm.read())) {
+        parseU64(p); // total program size
+        s.rssBytes = parseU64(p) * pageSize;
+    }
+
+    uint64_t utime, stime;
+    if ((p = selfStat.read()) && parseStatTimes(p, utime, stime)) {
+        s.cpuUserMs = utime * 1000 / ticksPerSecond;
+        s.cpuSystemMs = stime * 1000 / ticksPerSecond;
+    }
+
+    if (fdDir) {
+        rewinddir(fdDir);
+        struct dirent *entry;
+        while ((entry = readdir(fdDir)) != nullptr) {
+            if (entry->d_name[0] != '.')
+                s.openFds++;
+        }
+        if (s.openFds)
+            s.openFds--; // Don't count the descriptor of the directory we are reading
+    }
+
+    sampleThreads(s);
+
+    return uptime.isOpen() && meminfo.isOpen() && loadavg.isOpen();
+}
+
+void HostMetricsCollector::sampleThreads(HostSample &s)
+{
+    if (!taskDir)
+        return;
+    rewinddir(taskDir);
+    struct dirent *entry;
+    char path[sizeof("/proc/self/task//stat") + sizeof(((struct dirent *)0)->d_name)];
+    char buf[512];
+    while ((entry = readdir(taskDir)) != nullptr && s.numThreads < HostSample::MAX_THREADS) {
+        if (entry->d_name[0] < '0' || entry->d_name[0] > '9')
+            continue;
+        snprintf(path, sizeof(path), "/proc/self/task/%s/stat", entry->d_name);
+        int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            continue; // The thread exited in the meantime
+        ssize_t n = pread(fd, buf, sizeof(buf) - 1, 0);
+        close(fd);
+        if (n <= 0)
+            continue;
+        buf[n] = '\0';
+
+        HostThreadSample &t = s.threads[s.numThreads];
+        uint64_t utime, stime;
+        if (!parseStatTimes(buf, utime, stime, t.name, sizeof(t.name)))
+            continue;
+        const char *tid = entry->d_name;
+        t.tid = (pid_t)parseU64(tid);
+        t.cpuMs = (utime + stime) * 1000 / ticksPerSecond;
+        s.numThreads++;
+    }
+}
+
+void HostMetricsCollector::startUserCommand(const std::string &cmd, uint32_t timeoutMs)
+{
+    if (userCommandRunning)
+        return;
+    if (userCommandThread.joinable())
+        userCommandThread.join();
+    userCommandRunning = true;
+    userCommandThread = std::thread(&HostMetricsCollector::runUserCommand, this, cmd, timeoutMs);
+}
+
+bool HostMetricsCollector::getUserCommandResult(char *out, size_t len)
+{
+    std::lock_guard<std::mutex> guard(userCommandLock);
+    if (!hasUserCommandResult || len == 0)
+        return false;
+    strncpy(out, userCommandResult.c_str(), len);
+    out[len - 1] = '\0';
+    return true;
+}
+
+/**
+ * Runs on the worker thread: executes the command through /bin/sh, collecting stdout until it exits or the timeout expires.
+ */
+void HostMetricsCollector::runUserCommand(std::string cmd, uint32_t timeoutMs)
+{
+    std::string result;
+    int pipefd[2];
+    if (pipe2(pipefd, O_CLOEXEC) != 0) {
+        userCommandRunning = false;
+        return;
+    }
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        // Child: only async-signal-safe calls from here on
+        setpgid(0, 0);
+        dup2(pipefd[1], STDOUT_FILENO);
+        execl("/bin/sh", "sh", "-c", cmd.c_str(), (char *)nullptr);
+        _exit(127);
+    }
+    close(pipefd[1]);
+    if (pid < 0) {
+        close(pipefd[0]);
+        userCommandRunning = false;
+        return;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    int64_t deadline = (int64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000 + timeoutMs;
+    bool timedOut = false, failed = false;
+    char buf[256];
+    while (true) {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        int64_t remaining = deadline - ((int64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000);
+        if (remaining <= 0) {
+            timedOut = true;
+            break;
+        }
+        struct pollfd pfd = {pipefd[0], POLLIN, 0};
+        int ready = poll(&pfd, 1, (int)remaining);
+        if (ready < 0) {
+            if (errno == EINTR)
+                continue;
+            LOG_WARN("HostMetrics user command poll failed: %s", strerror(errno));
+            failed = true;
+            break;
+        }
+        if (ready == 0)
+            continue; // Loop around to re-check the deadline
+        ssize_t n = ::read(pipefd[0], buf, sizeof(buf));
+        if (n <= 0)
+            break; // EOF, the command closed its output
+        result.append(buf, n);
+    }
+    close(pipefd[0]);
+
+    if (timedOut)
+        LOG_WARN("HostMetrics user command timed out after %u ms, killing it", timeoutMs);
+    if (timedOut || failed)
+        kill(-pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+
+    if (!timedOut && !failed && result.length() > 1) {
+        std::lock_guard<std::mutex> guard(userCommandLock);
+        userCommandResult = result;
+        hasUserCommandResult = true;
+    }
+    userCommandRunning = false;
+}
+#endif
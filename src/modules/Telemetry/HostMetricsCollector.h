@@ -0,0 +1,101 @@
+#pragma once
+#include "configuration.h"
+
+#if ARCH_PORTDUINO
+#include <atomic>
+#include <dirent.h>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <sys/types.h>
+#include <thread>
+
+/**
+ * A /proc file that stays open for the lifetime of the process and is re-read with pread() into a fixed buffer, so that
+ * sampling does not allocate or reopen anything.
+ */
+class ProcFile
+{
+  public:
+    explicit ProcFile(const char *path);
+    ~ProcFile();
+
+    /// Re-read the file from offset 0. Returns the NUL terminated contents, or nullptr if the file could not be read.
+    const char *read();
+
+    bool isOpen() const { return fd >= 0; }
+
+  private:
+    int fd = -1;
+    char buf[1024];
+};
+
+/// CPU time consumed by one thread of this process
+struct HostThreadSample {
+    pid_t tid;
+    char name[16];
+    uint64_t cpuMs;
+};
+
+/// Everything collected in one sample of the host and of meshtasticd itself
+struct HostSample {
+    uint32_t uptimeSeconds;
+    uint64_t freememBytes;
+    uint64_t diskfreeBytes;
+    uint16_t load1, load5, load15;
+
+    uint64_t rssBytes;    // Resident set size of meshtasticd
+    uint64_t cpuUserMs;   // CPU time spent by meshtasticd in user mode
+    uint64_t cpuSystemMs; // CPU time spent by meshtasticd in the kernel
+    uint32_t openFds;     // Number of file descriptors meshtasticd has open
+
+    static constexpr uint8_t MAX_THREADS = 32;
+    uint8_t numThreads;
+    HostThreadSample threads[MAX_THREADS];
+};
+
+/**
+ * Samples host and process metrics from /proc without heap allocation, and runs the optional user command on a worker
+ * thread with a timeout so that it never blocks the cooperative loop.
+ */
+class HostMetricsCollector
+{
+  public:
+    HostMetricsCollector();
+    ~HostMetricsCollector();
+
+    /// Fill `s` with the current metrics. Returns false if the core /proc files are not available.
+    bool sample(HostSample &s);
+
+    /**
+     * Start running `cmd` in the background unless a previous run is still in progress. The process is killed if it runs
+     * longer than `timeoutMs`.
+     */
+    void startUserCommand(const std::string &cmd, uint32_t timeoutMs);
+
+    /// Copy the output of the last completed user command into `out`. Returns false if there is none yet.
+    bool getUserCommandResult(char *out, size_t len);
+
+  private:
+    ProcFile uptime{"/proc/uptime"};
+    ProcFile meminfo{"/proc/meminfo"};
+    ProcFile loadavg{"/proc/loadavg"};
+    ProcFile selfStat{"/proc/self/stat"};
+    ProcFile selfStatm{"/proc/self/statm"};
+    DIR *fdDir = nullptr;
+    DIR *taskDir = nullptr;
+
+    long pageSize;
+    long ticksPerSecond;
+
+    void sampleThreads(HostSample &s);
+
+    void runUserCommand(std::string cmd, uint32_t timeoutMs);
+
+    std::thread userCommandThread;
+    std::atomic<bool> userCommandRunning{false};
+    std::mutex userCommandLock;
+    std::string userCommandResult;
+    bool hasUserCommandResult = false;
+};
+#endif
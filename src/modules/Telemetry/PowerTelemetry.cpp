@@ -120,23 +120,14 @@ void PowerTelemetryModule::drawFrame(OLEDDisplay *display, OLEDDisplayUiState *s
     // === Header ===
     graphics::drawCommonHeader(display, x, y, titleStr);
 
-    if (lastMeasurementPacket == nullptr) {
+    if (!lastMeasurement.valid) {
         // In case of no valid packet, display "Power Telemetry", "No measurement"
         display->drawString(x, graphics::getTextPositions(display)[line++], "No measurement");
         return;
     }
 
-    // Decode the last power packet
-    meshtastic_Telemetry lastMeasurement;
-    uint32_t agoSecs = service->GetTimeSinceMeshPacket(lastMeasurementPacket);
-    const char *lastSender = getSenderShortName(*lastMeasurementPacket);
-
-    const meshtastic_Data &p = lastMeasurementPacket->decoded;
-    if (!pb_decode_from_bytes(p.payload.bytes, p.payload.size, &meshtastic_Telemetry_msg, &lastMeasurement)) {
-        display->drawString(x, graphics::getTextPositions(display)[line++], "Measurement Error");
-        LOG_ERROR("Unable to decode last packet");
-        return;
-    }
+    uint32_t agoSecs = lastMeasurement.age();
+    const char *lastSender = getSenderShortName(lastMeasurement.from);
 
     // Display "Pow. From: ..."
     char fromStr[64];
@@ -144,7 +135,7 @@ void PowerTelemetryModule::drawFrame(OLEDDisplay *display, OLEDDisplayUiState *s
     display->drawString(x, graphics::getTextPositions(display)[line++], fromStr);
 
     // Display current and voltage based on ...power_metrics.has_[channel/voltage/current]... flags
-    const auto &m = lastMeasurement.variant.power_metrics;
+    const auto &m = lastMeasurement.telemetry.variant.power_metrics;
     int lineY = textSecondLine;
 
     auto drawLine = [&](const char *label, float voltage, float current) {
@@ -177,11 +168,8 @@ bool PowerTelemetryModule::handleReceivedProtobuf(const meshtastic_MeshPacket &m
                  t->variant.power_metrics.ch2_voltage, t->variant.power_metrics.ch2_current, t->variant.power_metrics.ch3_voltage,
                  t->variant.power_metrics.ch3_current);
 #endif
-        // release previous packet before occupying a new spot
-        if (lastMeasurementPacket != nullptr)
-            packetPool.release(lastMeasurementPacket);
-
-        lastMeasurementPacket = packetPool.allocCopy(mp);
+        lastMeasurement.set(mp, *t);
+        telemetryHistory.append(mp, *t);
     }
 
     return false; // Let others look at this message also if they want
@@ -259,11 +247,8 @@ bool PowerTelemetryModule::sendTelemetry(NodeNum dest, bool phoneOnly)
             p->priority = meshtastic_MeshPacket_Priority_RELIABLE;
         else
             p->priority = meshtastic_MeshPacket_Priority_BACKGROUND;
-        // release previous packet before occupying a new spot
-        if (lastMeasurementPacket != nullptr)
-            packetPool.release(lastMeasurementPacket);
-
-        lastMeasurementPacket = packetPool.allocCopy(*p);
+        lastMeasurement.set(*p, m);
+        telemetryHistory.append(*p, m);
         if (phoneOnly) {
             LOG_INFO("Send packet to phone");
             service->sendToPhone(p);
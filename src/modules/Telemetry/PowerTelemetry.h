@@ -7,6 +7,7 @@
 #include "../mesh/generated/meshtastic/telemetry.pb.h"
 #include "NodeDB.h"
 #include "ProtobufModule.h"
+#include "TelemetryHistory.h"
 #include <OLEDDisplay.h>
 #include <OLEDDisplayUi.h>
 
@@ -20,7 +21,6 @@ class PowerTelemetryModule : private concurrency::OSThread, public ProtobufModul
         : concurrency::OSThread("PowerTelemetry"),
           ProtobufModule("PowerTelemetry", meshtastic_PortNum_TELEMETRY_APP, &meshtastic_Telemetry_msg)
     {
-        lastMeasurementPacket = nullptr;
         nodeStatusObserver.observe(&nodeStatus->onNewStatus);
         setIntervalFromNow(10 * 1000);
     }
@@ -49,7 +49,7 @@ class PowerTelemetryModule : private concurrency::OSThread, public ProtobufModul
 
   private:
     bool firstTime = 1;
-    meshtastic_MeshPacket *lastMeasurementPacket;
+    LastTelemetry lastMeasurement;
     uint32_t sendToPhoneIntervalMs = SECONDS_IN_MINUTE * 1000; // Send to phone every minute
     uint32_t lastSentToMesh = 0;
     uint32_t lastSentToPhone = 0;
@@ -38,6 +38,23 @@ bool NAU7802Sensor::getMetrics(meshtastic_Telemetry *measurement)
 {
     LOG_DEBUG("NAU7802 getMetrics");
     nau7802.powerUp();
+    return readWeight(measurement);
+}
+
+uint32_t NAU7802Sensor::startMeasurement()
+{
+    nau7802.powerUp();
+    // The first conversion after power up is ready after a few samples at the default rate
+    return 100;
+}
+
+bool NAU7802Sensor::collectMetrics(meshtastic_Telemetry *measurement)
+{
+    return readWeight(measurement);
+}
+
+bool NAU7802Sensor::readWeight(meshtastic_Telemetry *measurement)
+{
     // Wait for the sensor to become ready for one second max
     uint32_t start = millis();
     while (!nau7802.available()) {
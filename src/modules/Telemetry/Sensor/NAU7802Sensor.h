@@ -17,11 +17,14 @@ class NAU7802Sensor : public TelemetrySensor
     const char *nau7802ConfigFileName = "/prefs/nau7802.dat";
     bool saveCalibrationData();
     bool loadCalibrationData();
+    bool readWeight(meshtastic_Telemetry *measurement);
 
   public:
     NAU7802Sensor();
     virtual int32_t runOnce() override;
     virtual bool getMetrics(meshtastic_Telemetry *measurement) override;
+    virtual uint32_t startMeasurement() override;
+    virtual bool collectMetrics(meshtastic_Telemetry *measurement) override;
     void tare();
     void calibrate(float weight);
     AdminMessageHandleResult handleAdminMessage(const meshtastic_MeshPacket &mp, meshtastic_AdminMessage *request,
@@ -29,6 +29,19 @@ bool RCWL9620Sensor::getMetrics(meshtastic_Telemetry *measurement)
     return true;
 }
 
+uint32_t RCWL9620Sensor::startMeasurement()
+{
+    startRanging();
+    return RCWL9620_RANGING_MS;
+}
+
+bool RCWL9620Sensor::collectMetrics(meshtastic_Telemetry *measurement)
+{
+    measurement->variant.environment_metrics.has_distance = true;
+    measurement->variant.environment_metrics.distance = readDistance();
+    return true;
+}
+
 void RCWL9620Sensor::begin(TwoWire *wire, uint8_t addr, uint8_t sda, uint8_t scl, uint32_t speed)
 {
     _wire = wire;
@@ -41,16 +54,25 @@ void RCWL9620Sensor::begin(TwoWire *wire, uint8_t addr, uint8_t sda, uint8_t scl
 
 float RCWL9620Sensor::getDistance()
 {
-    uint32_t data = 0;
-    uint8_t b1 = 0, b2 = 0, b3 = 0;
+    startRanging();
+    delay(RCWL9620_RANGING_MS); // délai pour laisser le capteur répondre
+    return readDistance();
+}
 
+void RCWL9620Sensor::startRanging()
+{
     LOG_DEBUG("[RCWL9620] Start measure command");
 
     _wire->beginTransmission(_addr);
     _wire->write(0x01); // À tester aussi sans cette ligne si besoin
     uint8_t result = _wire->endTransmission();
     LOG_DEBUG("[RCWL9620] endTransmission result = %d", result);
-    delay(100); // délai pour laisser le capteur répondre
+}
+
+float RCWL9620Sensor::readDistance()
+{
+    uint32_t data = 0;
+    uint8_t b1 = 0, b2 = 0, b3 = 0;
 
     LOG_DEBUG("[RCWL9620] Read i2c data:");
     _wire->requestFrom(_addr, (uint8_t)3);
@@ -6,6 +6,9 @@
 #include "TelemetrySensor.h"
 #include <Wire.h>
 
+// Time the sensor needs between the measure command and the result being readable
+#define RCWL9620_RANGING_MS 100
+
 class RCWL9620Sensor : public TelemetrySensor
 {
   private:
@@ -19,11 +22,15 @@ class RCWL9620Sensor : public TelemetrySensor
     virtual void setup() override;
     void begin(TwoWire *wire = &Wire, uint8_t addr = 0x57, uint8_t sda = -1, uint8_t scl = -1, uint32_t speed = 200000UL);
     float getDistance();
+    void startRanging();
+    float readDistance();
 
   public:
     RCWL9620Sensor();
     virtual int32_t runOnce() override;
     virtual bool getMetrics(meshtastic_Telemetry *measurement) override;
+    virtual uint32_t startMeasurement() override;
+    virtual bool collectMetrics(meshtastic_Telemetry *measurement) override;
 };
 
 #endif
\ No newline at end of file
@@ -58,6 +58,16 @@ class TelemetrySensor
     virtual bool isRunning() { return status > 0; }
 
     virtual bool getMetrics(meshtastic_Telemetry *measurement) = 0;
+
+    /**
+     * Start a conversion without waiting for it, for sensors that measure in the background.
+     * @return milliseconds until collectMetrics() can read the result, 0 for sensors that do all their work in
+     * collectMetrics()
+     */
+    virtual uint32_t startMeasurement() { return 0; }
+
+    /// Read the result of the conversion started by startMeasurement()
+    virtual bool collectMetrics(meshtastic_Telemetry *measurement) { return getMetrics(measurement); }
 };
 
 #endif
\ No newline at end of file
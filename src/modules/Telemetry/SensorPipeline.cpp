@@ -0,0 +1,116 @@
+#include "SensorPipeline.h"
+
+#if !MESHTASTIC_EXCLUDE_ENVIRONMENTAL_SENSOR
+
+bool SensorPipeline::add(TelemetrySensor *sensor, MergeMode mode)
+{
+    if (count >= SENSOR_PIPELINE_MAX_SENSORS)
+        return false;
+    entries[count++] = {sensor, mode, 0, false};
+    return true;
+}
+
+void SensorPipeline::startRound(uint32_t now)
+{
+    working = meshtastic_Telemetry_init_zero;
+    working.which_variant = meshtastic_Telemetry_environment_metrics_tag;
+    working.variant.environment_metrics = meshtastic_EnvironmentMetrics_init_zero;
+    roundValid = true;
+    roundStartMs = now;
+
+    // Starting a conversion is a register write, cheap enough to do for every sensor at once so that they all convert together
+    for (size_t i = 0; i < count; i++) {
+        uint32_t convertMs = entries[i].sensor->startMeasurement();
+        entries[i].readyAt = millis() + convertMs;
+        entries[i].pending = true;
+    }
+    busy = count > 0;
+}
+
+SensorPipeline::Entry *SensorPipeline::nextDue()
+{
+    Entry *next = nullptr;
+    for (size_t i = 0; i < count; i++) {
+        // Sensors due at the same time are collected in the order they were added, which is the order they merge in
+        if (entries[i].pending && (!next || (int32_t)(entries[i].readyAt - next->readyAt) < 0))
+            next = &entries[i];
+    }
+    return next;
+}
+
+void SensorPipeline::collect(Entry &e)
+{
+    e.pending = false;
+    if (e.mode == MERGE_HUMIDITY_ONLY) {
+        meshtastic_Telemetry m = meshtastic_Telemetry_init_zero;
+        e.sensor->collectMetrics(&m);
+        working.variant.environment_metrics.relative_humidity = m.variant.environment_metrics.relative_humidity;
+        working.variant.environment_metrics.has_relative_humidity = m.variant.environment_metrics.has_relative_humidity;
+        return;
+    }
+    // Read the rest even if one sensor fails, so that every conversion started this round is consumed
+    if (!e.sensor->collectMetrics(&working))
+        roundValid = false;
+}
+
+void SensorPipeline::finishRound(uint32_t now)
+{
+    busy = false;
+    result = working;
+    resultValid = roundValid;
+    resultMs = now;
+    completed = true;
+}
+
+uint32_t SensorPipeline::step(uint32_t now, uint32_t periodMs)
+{
+    if (count == 0)
+        return periodMs;
+
+    uint32_t began = millis();
+    if (!busy) {
+        if (completed && now - roundStartMs < periodMs)
+            return periodMs - (now - roundStartMs);
+        startRound(now);
+    } else {
+        Entry *next = nextDue();
+        if ((int32_t)(next->readyAt - now) > 0)
+            return next->readyAt - now;
+        collect(*next);
+        if (!nextDue())
+            finishRound(now);
+    }
+
+    uint32_t took = millis() - began;
+    if (took > maxStepMs)
+        maxStepMs = took;
+
+    if (!busy)
+        return periodMs;
+    int32_t wait = (int32_t)(nextDue()->readyAt - now);
+    return wait > 0 ? wait : 0;
+}
+
+bool SensorPipeline::readNow()
+{
+    if (count == 0)
+        return false;
+    if (!busy)
+        startRound(millis());
+    while (Entry *next = nextDue()) {
+        int32_t wait = (int32_t)(next->readyAt - millis());
+        if (wait > 0)
+            delay(wait);
+        collect(*next);
+    }
+    finishRound(millis());
+    return resultValid;
+}
+
+bool SensorPipeline::getResult(meshtastic_Telemetry *m) const
+{
+    *m = result;
+    return completed && resultValid;
+}
+
+#endif
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "configuration.h"
+
+#if !MESHTASTIC_EXCLUDE_ENVIRONMENTAL_SENSOR
+
+#include "Sensor/TelemetrySensor.h"
+#include "mesh/generated/meshtastic/telemetry.pb.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/// Most sensors one pipeline reads, more than any board has detected at once
+#ifndef SENSOR_PIPELINE_MAX_SENSORS
+#define SENSOR_PIPELINE_MAX_SENSORS 32
+#endif
+
+/**
+ * Reads a set of sensors into one environment measurement without stalling the main loop for all of them at once.
+ *
+ * A round starts the conversion on every sensor, then each step() collects just the sensor whose result is due first, so
+ * conversions overlap and other threads run between reads. The merged result of the last complete round is kept with the
+ * time it was taken, for senders and the screen to use without touching the bus.
+ */
+class SensorPipeline
+{
+  public:
+    enum MergeMode : uint8_t {
+        MERGE_ALL,          // Everything the sensor reports
+        MERGE_HUMIDITY_ONLY // Only the humidity, when another sensor has the better temperature
+    };
+
+    /// Add a detected sensor. Results are merged in the order sensors were added, later ones win.
+    bool add(TelemetrySensor *sensor, MergeMode mode = MERGE_ALL);
+
+    size_t size() const { return count; }
+
+    /**
+     * Do the next bit of work: start a round when the last one started at least `periodMs` ago, or collect one sensor whose
+     * conversion is done.
+     * @return milliseconds until step() has more to do
+     */
+    uint32_t step(uint32_t now, uint32_t periodMs);
+
+    /// Finish the current round, or do a whole new one, without yielding. For when a reading is needed before any round
+    /// has completed.
+    bool readNow();
+
+    /// True while a round is underway
+    bool isBusy() const { return busy; }
+
+    /// True once any round has completed
+    bool hasResult() const { return completed; }
+
+    /// Copy the result of the last complete round, returns whether every sensor in it read successfully
+    bool getResult(meshtastic_Telemetry *m) const;
+
+    /// millis() when the last round completed
+    uint32_t getResultMs() const { return resultMs; }
+
+    /// Longest a single step() took, i.e. the longest the pipeline kept other threads from running
+    uint32_t getMaxStepMs() const { return maxStepMs; }
+
+  private:
+    struct Entry {
+        TelemetrySensor *sensor;
+        MergeMode mode;
+        uint32_t readyAt;
+        bool pending;
+    };
+
+    Entry entries[SENSOR_PIPELINE_MAX_SENSORS];
+    size_t count = 0;
+
+    bool busy = false;
+    bool roundValid = false;
+    bool completed = false;
+    bool resultValid = false;
+    uint32_t roundStartMs = 0;
+    uint32_t resultMs = 0;
+    uint32_t maxStepMs = 0;
+    meshtastic_Telemetry working = meshtastic_Telemetry_init_zero;
+    meshtastic_Telemetry result = meshtastic_Telemetry_init_zero;
+
+    void startRound(uint32_t now);
+
+    /// The pending sensor due first, nullptr if none is left
+    Entry *nextDue();
+
+    void collect(Entry &e);
+
+    void finishRound(uint32_t now);
+};
+
+#endif
@@ -0,0 +1,344 @@
+#include "TelemetryHistory.h"
+
+#if !MESHTASTIC_EXCLUDE_ENVIRONMENTAL_SENSOR
+
+#include "RTC.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef ARCH_PORTDUINO
+#define TELEMETRY_HISTORY_GUARD() std::lock_guard<std::recursive_mutex> guard(mutex)
+#else
+#define TELEMETRY_HISTORY_GUARD()
+#endif
+
+TelemetryHistory telemetryHistory;
+
+static_assert(TELEMETRY_HISTORY_SAMPLES <= UINT8_MAX, "Sample indexes must fit in a uint8_t");
+
+// Resolution each metric is stored with, chosen so that the usual range of the metric fits in an int16_t
+static const float metricScales[TELEMETRY_METRIC_COUNT] = {
+    1,     // BATTERY_LEVEL, percent (101 means powered)
+    0.001, // DEVICE_VOLTAGE, V
+    0.01,  // CHANNEL_UTILIZATION, percent
+    0.01,  // AIR_UTIL_TX, percent
+    0.01,  // TEMPERATURE, degrees C
+    0.01,  // RELATIVE_HUMIDITY, percent
+    0.1,   // BAROMETRIC_PRESSURE, hPa
+    0.01,  // GAS_RESISTANCE, MOhm
+    1,     // IAQ
+    4,     // LUX, up to 131 klx
+    0.001, // ENV_VOLTAGE, V
+    0.1,   // ENV_CURRENT, mA
+    0.01,  // WIND_SPEED, m/s
+    0.001, // CH1_VOLTAGE, V
+    0.1,   // CH1_CURRENT, mA
+    0.001, // CH2_VOLTAGE, V
+    0.1,   // CH2_CURRENT, mA
+    0.001, // CH3_VOLTAGE, V
+    0.1,   // CH3_CURRENT, mA
+    1,     // PM10, ug/m3
+    1,     // PM25, ug/m3
+    1,     // PM100, ug/m3
+    1,     // CO2, ppm
+    1,     // HEART_BPM
+    1,     // SPO2, percent
+    0.01,  // BODY_TEMPERATURE, degrees C
+};
+
+// Names of the metrics in toJson(), in the order of TelemetryMetric
+static const char *const metricNames[TELEMETRY_METRIC_COUNT] = {
+    "battery_level",
+    "voltage",
+    "channel_utilization",
+    "air_util_tx",
+    "temperature",
+    "relative_humidity",
+    "barometric_pressure",
+    "gas_resistance",
+    "iaq",
+    "lux",
+    "env_voltage",
+    "env_current",
+    "wind_speed",
+    "ch1_voltage",
+    "ch1_current",
+    "ch2_voltage",
+    "ch2_current",
+    "ch3_voltage",
+    "ch3_current",
+    "pm10",
+    "pm25",
+    "pm100",
+    "co2",
+    "heart_bpm",
+    "spo2",
+    "body_temperature",
+};
+
+void LastTelemetry::set(const meshtastic_MeshPacket &mp, const meshtastic_Telemetry &t)
+{
+    valid = true;
+    from = getFrom(&mp);
+    rxTime = mp.rx_time;
+    telemetry = t;
+}
+
+uint32_t LastTelemetry::age() const
+{
+    int delta = (int)(getTime() - rxTime);
+    return delta < 0 ? 0 : delta; // Our clock must be slightly off still - not set from GPS yet
+}
+
+TelemetryHistory::TelemetryHistory()
+{
+    clear();
+}
+
+void TelemetryHistory::clear()
+{
+    TELEMETRY_HISTORY_GUARD();
+    memset(series, 0, sizeof(series));
+}
+
+float TelemetryHistory::metricScale(TelemetryMetric metric)
+{
+    return metric < TELEMETRY_METRIC_COUNT ? metricScales[metric] : 1;
+}
+
+const char *TelemetryHistory::metricName(TelemetryMetric metric)
+{
+    return metric < TELEMETRY_METRIC_COUNT ? metricNames[metric] : "unknown";
+}
+
+const TelemetryHistory::Series *TelemetryHistory::find(NodeNum node, TelemetryMetric metric) const
+{
+    for (const Series &s : series) {
+        if (s.count && s.node == node && s.metric == metric)
+            return &s;
+    }
+    return nullptr;
+}
+
+TelemetryHistory::Series *TelemetryHistory::findOrRecycle(NodeNum node, TelemetryMetric metric)
+{
+    Series *oldest = &series[0];
+    for (Series &s : series) {
+        if (s.count && s.node == node && s.metric == metric)
+            return &s;
+        // Free series first, otherwise the one that was updated least recently
+        if (oldest->count && (!s.count || s.lastTime < oldest->lastTime))
+            oldest = &s;
+    }
+    memset(oldest, 0, sizeof(*oldest));
+    oldest->node = node;
+    oldest->metric = metric;
+    return oldest;
+}
+
+void TelemetryHistory::append(NodeNum node, TelemetryMetric metric, uint32_t time, float value)
+{
+    if (metric >= TELEMETRY_METRIC_COUNT || !time || isnan(value))
+        return;
+
+    TELEMETRY_HISTORY_GUARD();
+    Series *s = findOrRecycle(node, metric);
+    size_t index = s - series;
+
+    // A gap that does not fit the delta, or the clock going backwards, leaves nothing worth keeping
+    if (s->count && (time < s->lastTime || time - s->lastTime > UINT16_MAX))
+        s->count = 0;
+
+    if (s->count == TELEMETRY_HISTORY_SAMPLES) {
+        // The oldest sample is in the slot we are about to overwrite, the one after it becomes the oldest
+        s->firstTime += deltas[index][(s->head + 1) % TELEMETRY_HISTORY_SAMPLES];
+        s->count--;
+    }
+
+    float q = roundf(value / metricScales[metric]);
+    values[index][s->head] = q > INT16_MAX ? INT16_MAX : q < INT16_MIN ? INT16_MIN : (int16_t)q;
+    if (s->count == 0) {
+        deltas[index][s->head] = 0;
+        s->firstTime = time;
+    } else {
+        deltas[index][s->head] = time - s->lastTime;
+    }
+    s->lastTime = time;
+    s->head = (s->head + 1) % TELEMETRY_HISTORY_SAMPLES;
+    s->count++;
+}
+
+void TelemetryHistory::append(NodeNum node, const meshtastic_Telemetry &t, uint32_t time)
+{
+#define APPEND_IF(metrics, field, metric)                                                                                        \
+    if (metrics.has_##field)                                                                                                     \
+    append(node, metric, time, metrics.field)
+
+    switch (t.which_variant) {
+    case meshtastic_Telemetry_device_metrics_tag: {
+        const auto &m = t.variant.device_metrics;
+        APPEND_IF(m, battery_level, TELEMETRY_METRIC_BATTERY_LEVEL);
+        APPEND_IF(m, voltage, TELEMETRY_METRIC_DEVICE_VOLTAGE);
+        APPEND_IF(m, channel_utilization, TELEMETRY_METRIC_CHANNEL_UTILIZATION);
+        APPEND_IF(m, air_util_tx, TELEMETRY_METRIC_AIR_UTIL_TX);
+        break;
+    }
+    case meshtastic_Telemetry_environment_metrics_tag: {
+        const auto &m = t.variant.environment_metrics;
+        APPEND_IF(m, temperature, TELEMETRY_METRIC_TEMPERATURE);
+        APPEND_IF(m, relative_humidity, TELEMETRY_METRIC_RELATIVE_HUMIDITY);
+        APPEND_IF(m, barometric_pressure, TELEMETRY_METRIC_BAROMETRIC_PRESSURE);
+        APPEND_IF(m, gas_resistance, TELEMETRY_METRIC_GAS_RESISTANCE);
+        APPEND_IF(m, iaq, TELEMETRY_METRIC_IAQ);
+        APPEND_IF(m, lux, TELEMETRY_METRIC_LUX);
+        APPEND_IF(m, voltage, TELEMETRY_METRIC_ENV_VOLTAGE);
+        APPEND_IF(m, current, TELEMETRY_METRIC_ENV_CURRENT);
+        APPEND_IF(m, wind_speed, TELEMETRY_METRIC_WIND_SPEED);
+        break;
+    }
+    case meshtastic_Telemetry_power_metrics_tag: {
+        const auto &m = t.variant.power_metrics;
+        APPEND_IF(m, ch1_voltage, TELEMETRY_METRIC_CH1_VOLTAGE);
+        APPEND_IF(m, ch1_current, TELEMETRY_METRIC_CH1_CURRENT);
+        APPEND_IF(m, ch2_voltage, TELEMETRY_METRIC_CH2_VOLTAGE);
+        APPEND_IF(m, ch2_current, TELEMETRY_METRIC_CH2_CURRENT);
+        APPEND_IF(m, ch3_voltage, TELEMETRY_METRIC_CH3_VOLTAGE);
+        APPEND_IF(m, ch3_current, TELEMETRY_METRIC_CH3_CURRENT);
+        break;
+    }
+    case meshtastic_Telemetry_air_quality_metrics_tag: {
+        const auto &m = t.variant.air_quality_metrics;
+        APPEND_IF(m, pm10_standard, TELEMETRY_METRIC_PM10);
+        APPEND_IF(m, pm25_standard, TELEMETRY_METRIC_PM25);
+        APPEND_IF(m, pm100_standard, TELEMETRY_METRIC_PM100);
+        APPEND_IF(m, co2, TELEMETRY_METRIC_CO2);
+        break;
+    }
+    case meshtastic_Telemetry_health_metrics_tag: {
+        const auto &m = t.variant.health_metrics;
+        APPEND_IF(m, heart_bpm, TELEMETRY_METRIC_HEART_BPM);
+        APPEND_IF(m, spO2, TELEMETRY_METRIC_SPO2);
+        APPEND_IF(m, temperature, TELEMETRY_METRIC_BODY_TEMPERATURE);
+        break;
+    }
+    default:
+        break;
+    }
+#undef APPEND_IF
+}
+
+void TelemetryHistory::append(const meshtastic_MeshPacket &mp, const meshtastic_Telemetry &t)
+{
+    append(getFrom(&mp), t, mp.rx_time ? mp.rx_time : getTime());
+}
+
+template <typename F> void TelemetryHistory::forEach(const Series &s, F fn) const
+{
+    size_t index = &s - series;
+    float scale = metricScales[s.metric];
+    uint8_t slot = (s.head + TELEMETRY_HISTORY_SAMPLES - s.count) % TELEMETRY_HISTORY_SAMPLES;
+    uint32_t time = s.firstTime;
+    for (uint8_t i = 0; i < s.count; i++) {
+        if (i)
+            time += deltas[index][slot];
+        fn(time, values[index][slot] * scale);
+        slot = (slot + 1) % TELEMETRY_HISTORY_SAMPLES;
+    }
+}
+
+bool TelemetryHistory::getStats(NodeNum node, TelemetryMetric metric, uint32_t since, TelemetryStats &stats) const
+{
+    TELEMETRY_HISTORY_GUARD();
+    memset(&stats, 0, sizeof(stats));
+    const Series *s = find(node, metric);
+    if (!s || s->lastTime < since)
+        return false;
+
+    float sum = 0;
+    forEach(*s, [&](uint32_t time, float value) {
+        if (time < since)
+            return;
+        if (!stats.count) {
+            stats.min = stats.max = value;
+            stats.firstTime = time;
+        }
+        stats.min = value < stats.min ? value : stats.min;
+        stats.max = value > stats.max ? value : stats.max;
+        stats.last = value;
+        stats.lastTime = time;
+        sum += value;
+        stats.count++;
+    });
+    if (stats.count)
+        stats.avg = sum / stats.count;
+    return stats.count > 0;
+}
+
+uint32_t TelemetryHistory::getSparkline(NodeNum node, TelemetryMetric metric, uint32_t since, uint32_t until, float *out,
+                                        size_t buckets) const
+{
+    if (!buckets)
+        return 0;
+    if (buckets > TELEMETRY_SPARKLINE_MAX_BUCKETS)
+        buckets = TELEMETRY_SPARKLINE_MAX_BUCKETS;
+    uint16_t counts[TELEMETRY_SPARKLINE_MAX_BUCKETS];
+    for (size_t b = 0; b < buckets; b++) {
+        out[b] = 0;
+        counts[b] = 0;
+    }
+
+    TELEMETRY_HISTORY_GUARD();
+    uint32_t used = 0;
+    const Series *s = find(node, metric);
+    if (s && until > since) {
+        uint32_t span = until - since;
+        forEach(*s, [&](uint32_t time, float value) {
+            if (time < since || time > until)
+                return;
+            size_t b = (uint64_t)(time - since) * buckets / span;
+            if (b >= buckets)
+                b = buckets - 1;
+            out[b] += value;
+            counts[b]++;
+            used++;
+        });
+    }
+    for (size_t b = 0; b < buckets; b++)
+        out[b] = counts[b] ? out[b] / counts[b] : NAN;
+    return used;
+}
+
+std::string TelemetryHistory::toJson(uint32_t now) const
+{
+    TELEMETRY_HISTORY_GUARD();
+    uint32_t since = now > TELEMETRY_HISTORY_JSON_SECS ? now - TELEMETRY_HISTORY_JSON_SECS : 0;
+    std::string json = "[";
+    char buf[192];
+    for (const Series &s : series) {
+        TelemetryStats stats;
+        if (!s.count || !getStats(s.node, s.metric, since, stats))
+            continue;
+        snprintf(buf, sizeof(buf),
+                 "%s{\"node\":%u,\"metric\":\"%s\",\"count\":%u,\"min\":%g,\"max\":%g,\"avg\":%g,\"last\":%g,"
+                 "\"last_time\":%u,\"sparkline\":[",
+                 json.size() > 1 ? "," : "", (unsigned)s.node, metricNames[s.metric], (unsigned)stats.count, stats.min, stats.max,
+                 stats.avg, stats.last, (unsigned)stats.lastTime);
+        json += buf;
+
+        float sparkline[TELEMETRY_HISTORY_JSON_BUCKETS];
+        getSparkline(s.node, s.metric, since, now, sparkline, TELEMETRY_HISTORY_JSON_BUCKETS);
+        for (size_t b = 0; b < TELEMETRY_HISTORY_JSON_BUCKETS; b++) {
+            if (isnan(sparkline[b]))
+                snprintf(buf, sizeof(buf), "%snull", b ? "," : "");
+            else
+                snprintf(buf, sizeof(buf), "%s%g", b ? "," : "", sparkline[b]);
+            json += buf;
+        }
+        json += "]}";
+    }
+    json += "]";
+    return json;
+}
+
+#endif
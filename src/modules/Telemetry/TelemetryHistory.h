@@ -0,0 +1,164 @@
+#pragma once
+
+#include "configuration.h"
+
+#if !MESHTASTIC_EXCLUDE_ENVIRONMENTAL_SENSOR
+
+#include "MeshTypes.h"
+#include "mesh/generated/meshtastic/telemetry.pb.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#ifdef ARCH_PORTDUINO
+#include <mutex>
+#endif
+
+/// Number of (node, metric) series kept, least recently updated series are recycled first
+#ifndef TELEMETRY_HISTORY_SERIES
+#if defined(ARCH_STM32WL)
+#define TELEMETRY_HISTORY_SERIES 4
+#else
+#define TELEMETRY_HISTORY_SERIES 16
+#endif
+#endif
+
+/// Samples kept per series, 48 covers a day at the default 30 minute interval
+#ifndef TELEMETRY_HISTORY_SAMPLES
+#define TELEMETRY_HISTORY_SAMPLES 48
+#endif
+
+/// Widest sparkline getSparkline() fills, roughly the width of a screen in pixels
+#define TELEMETRY_SPARKLINE_MAX_BUCKETS 128
+
+/// toJson() summarises this much of each series, in a sparkline of this many slots
+#define TELEMETRY_HISTORY_JSON_SECS (24 * 60 * 60)
+#define TELEMETRY_HISTORY_JSON_BUCKETS 24
+
+/// The metrics we keep a history of. Values are stored quantised, see metricScale in TelemetryHistory.cpp.
+enum TelemetryMetric : uint8_t {
+    TELEMETRY_METRIC_BATTERY_LEVEL,
+    TELEMETRY_METRIC_DEVICE_VOLTAGE,
+    TELEMETRY_METRIC_CHANNEL_UTILIZATION,
+    TELEMETRY_METRIC_AIR_UTIL_TX,
+    TELEMETRY_METRIC_TEMPERATURE,
+    TELEMETRY_METRIC_RELATIVE_HUMIDITY,
+    TELEMETRY_METRIC_BAROMETRIC_PRESSURE,
+    TELEMETRY_METRIC_GAS_RESISTANCE,
+    TELEMETRY_METRIC_IAQ,
+    TELEMETRY_METRIC_LUX,
+    TELEMETRY_METRIC_ENV_VOLTAGE,
+    TELEMETRY_METRIC_ENV_CURRENT,
+    TELEMETRY_METRIC_WIND_SPEED,
+    TELEMETRY_METRIC_CH1_VOLTAGE,
+    TELEMETRY_METRIC_CH1_CURRENT,
+    TELEMETRY_METRIC_CH2_VOLTAGE,
+    TELEMETRY_METRIC_CH2_CURRENT,
+    TELEMETRY_METRIC_CH3_VOLTAGE,
+    TELEMETRY_METRIC_CH3_CURRENT,
+    TELEMETRY_METRIC_PM10,
+    TELEMETRY_METRIC_PM25,
+    TELEMETRY_METRIC_PM100,
+    TELEMETRY_METRIC_CO2,
+    TELEMETRY_METRIC_HEART_BPM,
+    TELEMETRY_METRIC_SPO2,
+    TELEMETRY_METRIC_BODY_TEMPERATURE,
+    TELEMETRY_METRIC_COUNT
+};
+
+/// Summary of the samples of one series in a time range
+struct TelemetryStats {
+    uint32_t count;
+    float min, max, avg, last;
+    uint32_t firstTime, lastTime;
+};
+
+/// The most recent telemetry packet a module has seen, kept decoded instead of as a copy of the whole MeshPacket
+struct LastTelemetry {
+    bool valid = false;
+    NodeNum from = 0;
+    uint32_t rxTime = 0;
+    meshtastic_Telemetry telemetry = meshtastic_Telemetry_init_zero;
+
+    void set(const meshtastic_MeshPacket &mp, const meshtastic_Telemetry &t);
+    /// Seconds since the packet was received
+    uint32_t age() const;
+};
+
+/**
+ * Fixed-memory history of telemetry readings per node and metric, shared by the telemetry modules.
+ *
+ * Storage is columnar: for each series a ring of 16 bit time deltas (seconds since the previous sample) and a ring of 16 bit
+ * quantised values, plus the absolute time of the oldest sample. Nothing is allocated after startup.
+ */
+class TelemetryHistory
+{
+  public:
+    TelemetryHistory();
+
+    /// Record one reading of `metric` from `node`, taken at `time` (seconds since the epoch)
+    void append(NodeNum node, TelemetryMetric metric, uint32_t time, float value);
+
+    /// Record every metric we keep a history of that is present in `t`
+    void append(NodeNum node, const meshtastic_Telemetry &t, uint32_t time);
+
+    /// Convenience for received or sent telemetry packets
+    void append(const meshtastic_MeshPacket &mp, const meshtastic_Telemetry &t);
+
+    /**
+     * Min/max/average of the samples taken at or after `since`.
+     * @return false if there are none
+     */
+    bool getStats(NodeNum node, TelemetryMetric metric, uint32_t since, TelemetryStats &stats) const;
+
+    /**
+     * Average the samples between `since` and `until` into `buckets` equal time slots, for drawing a sparkline.
+     * Slots without samples are set to NAN. At most TELEMETRY_SPARKLINE_MAX_BUCKETS are filled.
+     * @return the number of samples used
+     */
+    uint32_t getSparkline(NodeNum node, TelemetryMetric metric, uint32_t since, uint32_t until, float *out,
+                          size_t buckets) const;
+
+    /**
+     * Every series as [{"node":..,"metric":"..","count":..,"min":..,"max":..,"avg":..,"last":..,"last_time":..,
+     * "sparkline":[..]}], summarising the TELEMETRY_HISTORY_JSON_SECS before `now`. Empty sparkline slots are null.
+     */
+    std::string toJson(uint32_t now) const;
+
+    /// Forget all series
+    void clear();
+
+    /// Step between two quantised values of a metric, i.e. the resolution it is stored with
+    static float metricScale(TelemetryMetric metric);
+
+    /// Short snake_case name of a metric, as used in toJson()
+    static const char *metricName(TelemetryMetric metric);
+
+  private:
+    struct Series {
+        NodeNum node;
+        TelemetryMetric metric;
+        uint8_t count; // Number of valid samples
+        uint8_t head;  // Slot the next sample goes into
+        uint32_t firstTime; // Time of the oldest sample
+        uint32_t lastTime;  // Time of the newest sample
+    };
+
+    Series series[TELEMETRY_HISTORY_SERIES];
+    uint16_t deltas[TELEMETRY_HISTORY_SERIES][TELEMETRY_HISTORY_SAMPLES];
+    int16_t values[TELEMETRY_HISTORY_SERIES][TELEMETRY_HISTORY_SAMPLES];
+
+#ifdef ARCH_PORTDUINO
+    // The Linux web server answers requests from its own threads
+    mutable std::recursive_mutex mutex;
+#endif
+
+    const Series *find(NodeNum node, TelemetryMetric metric) const;
+    Series *findOrRecycle(NodeNum node, TelemetryMetric metric);
+
+    /// Call `fn(time, value)` for every sample of `s`, oldest first
+    template <typename F> void forEach(const Series &s, F fn) const;
+};
+
+extern TelemetryHistory telemetryHistory;
+
+#endif
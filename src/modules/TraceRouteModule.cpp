@@ -4,6 +4,7 @@
 #include "graphics/ScreenFonts.h"
 #include "graphics/SharedUIDisplay.h"
 #include "mesh/Router.h"
+#include "mesh/TopologyGraph.h"
 #include "meshUtils.h"
 #include <vector>
 
@@ -31,6 +32,14 @@ void TraceRouteModule::alterReceivedProtobuf(meshtastic_MeshPacket &p, meshtasti
     else
         printRoute(r, p.to, p.from, false);
 
+    // Keep the links the route went over, rather than only printing them
+    if (!incoming.request_id) {
+        topologyGraph.addRoute(p.from, r->route, r->route_count, p.to, r->snr_towards, r->snr_towards_count, millis());
+    } else {
+        topologyGraph.addRoute(p.to, r->route, r->route_count, p.from, r->snr_towards, r->snr_towards_count, millis());
+        topologyGraph.addRoute(p.from, r->route_back, r->route_back_count, p.to, r->snr_back, r->snr_back_count, millis());
+    }
+
     // Set updated route to the payload of the to be flooded packet
     p.decoded.payload.size =
         pb_encode_to_bytes(p.decoded.payload.bytes, sizeof(p.decoded.payload.bytes), &meshtastic_RouteDiscovery_msg, r);
@@ -56,6 +56,9 @@ class MQTT : private concurrency::OSThread
 
     bool isEnabled() { return this->enabled; };
 
+    /// Envelopes waiting for the broker to be reachable
+    int getQueueDepth() { return mqttQueue.numUsed(); }
+
     void start() { setIntervalFromNow(0); };
 
     bool isUsingDefaultServer() { return isConfiguredForDefaultServer; }
@@ -468,6 +468,7 @@ bool loadConfig(const char *configPath)
                 settingsMap[logoutputlevel] = level_error;
             }
             settingsStrings[traceFilename] = yamlConfig["Logging"]["TraceFile"].as<std::string>("");
+            settingsStrings[bootTraceFilename] = yamlConfig["Logging"]["BootTraceFile"].as<std::string>("");
             if (yamlConfig["Logging"]["AsciiLogs"]) {
                 // Default is !isatty(1) but can be set explicitly in config.yaml
                 settingsMap[ascii_logs] = yamlConfig["Logging"]["AsciiLogs"].as<bool>();
@@ -672,6 +673,12 @@ bool loadConfig(const char *configPath)
             settingsMap[hostMetrics_channel] = (yamlConfig["HostMetrics"]["Channel"]).as<int>(0);
             settingsMap[hostMetrics_interval] = (yamlConfig["HostMetrics"]["ReportInterval"]).as<int>(0);
             settingsStrings[hostMetrics_user_command] = (yamlConfig["HostMetrics"]["UserStringCommand"]).as<std::string>("");
+            settingsMap[hostMetrics_user_command_timeout] = (yamlConfig["HostMetrics"]["UserStringTimeout"]).as<int>(5);
+        }
+
+        if (yamlConfig["StoreForward"]) {
+            settingsStrings[storeforward_history_file] = (yamlConfig["StoreForward"]["HistoryFile"]).as<std::string>("");
+            settingsMap[storeforward_records] = (yamlConfig["StoreForward"]["Records"]).as<int>(0);
         }
 
         if (yamlConfig["Config"]) {
@@ -96,6 +96,7 @@ enum configNames {
     pointerDevice,
     logoutputlevel,
     traceFilename,
+    bootTraceFilename,
     webserver,
     webserverport,
     webserverrootpath,
@@ -110,6 +111,9 @@ enum configNames {
     hostMetrics_interval,
     hostMetrics_channel,
     hostMetrics_user_command,
+    hostMetrics_user_command_timeout,
+    storeforward_history_file,
+    storeforward_records,
     configDisplayMode,
     has_configDisplayMode
 };
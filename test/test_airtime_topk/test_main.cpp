@@ -0,0 +1,149 @@
+#include "TestUtil.h"
+#include "mesh/AirtimeTopK.h"
+#include <stdio.h>
+#include <unity.h>
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_counts_each_key(void)
+{
+    AirtimeTopK t;
+    t.add(0xA, 100);
+    t.add(0xB, 300);
+    t.add(0xA, 50);
+
+    AirtimeTopK::Entry top[AIRTIME_TOPK_SLOTS];
+    TEST_ASSERT_EQUAL(2, t.getTop(top, AIRTIME_TOPK_SLOTS));
+    TEST_ASSERT_EQUAL_HEX32(0xB, top[0].key);
+    TEST_ASSERT_EQUAL(300, top[0].airtimeMs);
+    TEST_ASSERT_EQUAL(1, top[0].packets);
+    TEST_ASSERT_EQUAL_HEX32(0xA, top[1].key);
+    TEST_ASSERT_EQUAL(150, top[1].airtimeMs);
+    TEST_ASSERT_EQUAL(2, top[1].packets);
+    TEST_ASSERT_EQUAL(0, top[1].errorMs);
+    TEST_ASSERT_EQUAL(450, t.getTotalAirtimeMs());
+    TEST_ASSERT_EQUAL(3, t.getTotalPackets());
+
+    // Asking for fewer still gives the heaviest
+    TEST_ASSERT_EQUAL(1, t.getTop(top, 1));
+    TEST_ASSERT_EQUAL_HEX32(0xB, top[0].key);
+}
+
+/// A heavy sender among many light ones that keep taking each other's slots must still come out on top
+void test_heavy_hitter_survives_churn(void)
+{
+    AirtimeTopK t;
+    uint32_t heavyMs = 0;
+    for (uint32_t i = 0; i < 2000; i++) {
+        t.add(1000 + i, 40); // Every light sender is heard only once
+        if (i % 4 == 0) {
+            t.add(0x42, 200);
+            heavyMs += 200;
+        }
+    }
+
+    AirtimeTopK::Entry top[AIRTIME_TOPK_SLOTS];
+    TEST_ASSERT_EQUAL(AIRTIME_TOPK_SLOTS, t.getTop(top, AIRTIME_TOPK_SLOTS));
+    TEST_ASSERT_EQUAL_HEX32(0x42, top[0].key);
+    // Never underestimated, and overestimated by no more than it says
+    TEST_ASSERT_GREATER_OR_EQUAL(heavyMs, top[0].airtimeMs);
+    TEST_ASSERT_LESS_OR_EQUAL(heavyMs, top[0].airtimeMs - top[0].errorMs);
+    for (size_t i = 1; i < AIRTIME_TOPK_SLOTS; i++)
+        TEST_ASSERT_LESS_OR_EQUAL(top[i - 1].airtimeMs, top[i].airtimeMs);
+}
+
+void test_decay_forgets_quiet_keys(void)
+{
+    AirtimeTopK t;
+    t.add(0xA, 1000);
+    t.add(0xB, 1);
+    t.decay();
+
+    AirtimeTopK::Entry top[AIRTIME_TOPK_SLOTS];
+    TEST_ASSERT_EQUAL(1, t.getTop(top, AIRTIME_TOPK_SLOTS));
+    TEST_ASSERT_EQUAL_HEX32(0xA, top[0].key);
+    TEST_ASSERT_EQUAL(500, top[0].airtimeMs);
+    TEST_ASSERT_EQUAL(500, t.getTotalAirtimeMs());
+}
+
+void test_json(void)
+{
+    AirtimeTopK t;
+    TEST_ASSERT_EQUAL_STRING("[]", t.toJson("port").c_str());
+    t.add(3, 120);
+    t.add(67, 80);
+    TEST_ASSERT_EQUAL_STRING("[{\"port\":3,\"airtime_ms\":120,\"packets\":1,\"error_ms\":0},"
+                             "{\"port\":67,\"airtime_ms\":80,\"packets\":1,\"error_ms\":0}]",
+                             t.toJson("port").c_str());
+}
+
+/// Each copy is charged to its packet's port, held back while the port isn't known yet
+void test_port_tracker_charges_every_copy(void)
+{
+    AirtimeTopK ports;
+    AirtimePortTracker tracker(ports);
+
+    // Heard, then decoded, then heard twice more as it gets relayed
+    tracker.logAirtime(0xA, 1, 100);
+    TEST_ASSERT_EQUAL(0, ports.getTotalPackets());
+    tracker.setPort(0xA, 1, 1);
+    tracker.logAirtime(0xA, 1, 100);
+    tracker.logAirtime(0xA, 1, 100);
+
+    // Our own send, charged when the radio sends it
+    tracker.setPort(0xB, 2, 67);
+    TEST_ASSERT_EQUAL(3, ports.getTotalPackets());
+    tracker.logAirtime(0xB, 2, 50);
+
+    AirtimeTopK::Entry top[AIRTIME_TOPK_SLOTS];
+    TEST_ASSERT_EQUAL(2, ports.getTop(top, AIRTIME_TOPK_SLOTS));
+    TEST_ASSERT_EQUAL(1, top[0].key);
+    TEST_ASSERT_EQUAL(300, top[0].airtimeMs);
+    TEST_ASSERT_EQUAL(3, top[0].packets);
+    TEST_ASSERT_EQUAL(67, top[1].key);
+    TEST_ASSERT_EQUAL(50, top[1].airtimeMs);
+
+    // A packet that is never decoded goes to port 0 once newer packets push it out
+    tracker.logAirtime(0xC, 3, 200);
+    for (uint32_t id = 100; id < 100 + AIRTIME_PACKET_PORTS; id++)
+        tracker.setPort(0xD, id, 1);
+    TEST_ASSERT_EQUAL(3, ports.getTop(top, AIRTIME_TOPK_SLOTS));
+    TEST_ASSERT_EQUAL(0, top[1].key);
+    TEST_ASSERT_EQUAL(200, top[1].airtimeMs);
+    TEST_ASSERT_EQUAL(5, ports.getTotalPackets());
+}
+
+/// Every packet heard or sent goes through add(), so it has to stay cheap with all slots taken
+void test_benchmark_add(void)
+{
+    AirtimeTopK t;
+    const uint32_t PACKETS = 100000;
+    uint32_t start = micros();
+    for (uint32_t i = 0; i < PACKETS; i++)
+        t.add((i * 2654435761u) % 50, 50 + i % 200);
+    uint32_t elapsed = micros() - start;
+    printf("%u packets in %u us, %.0f ns each\n", PACKETS, elapsed, elapsed * 1000.0 / PACKETS);
+    TEST_ASSERT_EQUAL(PACKETS, t.getTotalPackets());
+}
+
+void setup()
+{
+    // NOTE!!! Wait for >2 secs
+    // if board doesn't support software reset via Serial.DTR/RTS
+    delay(10);
+    delay(2000);
+
+    initializeTestEnvironment();
+    UNITY_BEGIN(); // IMPORTANT LINE!
+    RUN_TEST(test_counts_each_key);
+    RUN_TEST(test_heavy_hitter_survives_churn);
+    RUN_TEST(test_decay_forgets_quiet_keys);
+    RUN_TEST(test_json);
+    RUN_TEST(test_port_tracker_charges_every_copy);
+    RUN_TEST(test_benchmark_add);
+    exit(UNITY_END()); // stop unit testing
+}
+
+void loop() {}
@@ -0,0 +1,105 @@
+#include "BootTrace.h"
+#include "TestUtil.h"
+#include <string.h>
+#include <unity.h>
+
+static BootTrace *trace;
+
+void setUp(void)
+{
+    trace = new BootTrace();
+}
+
+void tearDown(void)
+{
+    delete trace;
+}
+
+void test_modules_nest_in_phases(void)
+{
+    trace->module("before"); // Not booting yet, ignored
+    trace->phase("fs");
+    delay(2);
+    trace->phase("modules");
+    trace->module("a");
+    delay(5);
+    trace->module("b");
+    trace->phase("radio");
+    trace->finish();
+    trace->phase("late"); // Boot is over, ignored
+
+    TEST_ASSERT_EQUAL(5, trace->getNumEvents());
+    TEST_ASSERT_EQUAL_STRING("fs", trace->getEvent(0).name);
+    TEST_ASSERT_EQUAL_STRING("modules", trace->getEvent(1).name);
+    TEST_ASSERT_EQUAL_STRING("a", trace->getEvent(2).name);
+    TEST_ASSERT_EQUAL(1, trace->getEvent(2).depth);
+    TEST_ASSERT_EQUAL_STRING("b", trace->getEvent(3).name);
+    TEST_ASSERT_EQUAL(0, trace->getEvent(4).depth);
+
+    // A module ends when the next one starts, and so does the phase around it
+    TEST_ASSERT_GREATER_OR_EQUAL(5000, trace->getEvent(2).durationUs);
+    TEST_ASSERT_LESS_OR_EQUAL(trace->getEvent(1).durationUs, trace->getEvent(2).durationUs + trace->getEvent(3).durationUs);
+    TEST_ASSERT_GREATER_OR_EQUAL(7000, trace->getBootUs());
+    TEST_ASSERT_TRUE(trace->isFinished());
+}
+
+void test_slowest_phases_first(void)
+{
+    trace->phase("quick");
+    trace->phase("slow");
+    delay(20);
+    trace->phase("medium");
+    delay(5);
+    trace->finish();
+
+    char buf[64];
+    trace->formatSlowest(buf, sizeof(buf), 2);
+    TEST_ASSERT_EQUAL(0, strncmp(buf, "slow 2", 6));
+    TEST_ASSERT_NOT_NULL(strstr(buf, ", medium "));
+    TEST_ASSERT_NULL(strstr(buf, "quick"));
+
+    // Truncated to fit, still terminated
+    char small[8];
+    TEST_ASSERT_EQUAL(7, trace->formatSlowest(small, sizeof(small), 3));
+    TEST_ASSERT_EQUAL(7, strlen(small));
+}
+
+void test_chrome_trace(void)
+{
+    trace->phase("gps");
+    trace->span("say \"hi\"", micros());
+    trace->finish();
+
+    std::string json = trace->toChromeTrace();
+    TEST_ASSERT_EQUAL(0, json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+    TEST_ASSERT_NOT_EQUAL(std::string::npos, json.find("{\"name\":\"gps\",\"cat\":\"boot\",\"ph\":\"X\""));
+    TEST_ASSERT_NOT_EQUAL(std::string::npos, json.find("\"name\":\"say \\\"hi\\\"\""));
+    TEST_ASSERT_EQUAL(0, json.compare(json.size() - 2, 2, "]}"));
+}
+
+void test_full_trace_drops_events(void)
+{
+    trace->phase("modules");
+    for (int i = 0; i < BOOT_TRACE_MAX_EVENTS + 10; i++)
+        trace->module("m");
+    trace->finish();
+    TEST_ASSERT_EQUAL(BOOT_TRACE_MAX_EVENTS, trace->getNumEvents());
+}
+
+void setup()
+{
+    // NOTE!!! Wait for >2 secs
+    // if board doesn't support software reset via Serial.DTR/RTS
+    delay(10);
+    delay(2000);
+
+    initializeTestEnvironment();
+    UNITY_BEGIN(); // IMPORTANT LINE!
+    RUN_TEST(test_modules_nest_in_phases);
+    RUN_TEST(test_slowest_phases_first);
+    RUN_TEST(test_chrome_trace);
+    RUN_TEST(test_full_trace_drops_events);
+    exit(UNITY_END()); // stop unit testing
+}
+
+void loop() {}
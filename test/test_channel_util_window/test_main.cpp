@@ -0,0 +1,67 @@
+#include "TestUtil.h"
+#include "mesh/ChannelUtilWindow.h"
+#include <unity.h>
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_burst_shows_at_once_and_is_forgotten(void)
+{
+    ChannelUtilWindow w;
+    TEST_ASSERT_EQUAL_FLOAT(0, w.getPercent());
+
+    w.add(500);
+    w.add(500);
+    TEST_ASSERT_EQUAL_FLOAT(10, w.getPercent());
+
+    for (int i = 0; i < CHANNEL_UTIL_WINDOW_SECS - 1; i++)
+        w.tick();
+    TEST_ASSERT_EQUAL_FLOAT(10, w.getPercent());
+    w.tick();
+    TEST_ASSERT_EQUAL_FLOAT(0, w.getPercent());
+}
+
+/// A packet longer than a second was on the air in the seconds before it ended too, so it leaves the window as they do
+void test_long_airtime_spreads_back(void)
+{
+    ChannelUtilWindow w;
+    w.tick();
+    w.tick();
+    w.add(300); // Heard earlier in the same second
+    w.add(2500);
+    TEST_ASSERT_EQUAL_FLOAT(28, w.getPercent());
+
+    for (int i = 0; i < CHANNEL_UTIL_WINDOW_SECS - 2; i++)
+        w.tick();
+    TEST_ASSERT_EQUAL_FLOAT(20, w.getPercent()); // The 800 ms that went two seconds back is gone
+    w.tick();
+    TEST_ASSERT_EQUAL_FLOAT(10, w.getPercent());
+    w.tick();
+    TEST_ASSERT_EQUAL_FLOAT(0, w.getPercent());
+}
+
+void test_saturates(void)
+{
+    ChannelUtilWindow w;
+    w.add(CHANNEL_UTIL_WINDOW_SECS * 1000 + 5000);
+    w.add(100);
+    TEST_ASSERT_EQUAL_FLOAT(100, w.getPercent());
+}
+
+void setup()
+{
+    // NOTE!!! Wait for >2 secs
+    // if board doesn't support software reset via Serial.DTR/RTS
+    delay(10);
+    delay(2000);
+
+    initializeTestEnvironment();
+    UNITY_BEGIN(); // IMPORTANT LINE!
+    RUN_TEST(test_burst_shows_at_once_and_is_forgotten);
+    RUN_TEST(test_long_airtime_spreads_back);
+    RUN_TEST(test_saturates);
+    exit(UNITY_END()); // stop unit testing
+}
+
+void loop() {}
@@ -0,0 +1,174 @@
+#include "MeshTypes.h"
+#include "RadioInterface.h"
+#include "TestUtil.h"
+#include "mesh/compression/PayloadCompressor.h"
+#include <unity.h>
+
+// Short messages as they are typically sent over the mesh
+static const char *corpus[] = {
+    "Hello everyone, anyone on the mesh today?",
+    "Good morning from the hill node",
+    "ok thanks",
+    "Test test 123",
+    "I'm heading back to the car now, will check in later.",
+    "Can you hear me? Signal is weak here.",
+    "Copy that, working on the antenna",
+    "lol",
+    "What is the range you are getting with this radio?",
+    "Anyone know if the repeater on the ridge is still up?",
+    "Thanks for the test, I hear you loud and clear",
+    "Going to be at the meetup at 6pm, see you there",
+    "Good night all",
+    "Battery at 40%, switching to the solar panel",
+    "Is the node on the water tower back online?",
+    "Ünïcödé tëxt 🙂 here",
+};
+
+// Only used to get at the airtime calculation for the default modem settings
+class AirtimeRadio : public RadioInterface
+{
+  public:
+    virtual ErrorCode send(meshtastic_MeshPacket *p) override { return ERRNO_OK; }
+};
+
+static meshtastic_Data makeText(const char *text)
+{
+    meshtastic_Data d = meshtastic_Data_init_zero;
+    d.portnum = meshtastic_PortNum_TEXT_MESSAGE_APP;
+    d.payload.size = strlen(text);
+    memcpy(d.payload.bytes, text, d.payload.size);
+    return d;
+}
+
+void setUp(void)
+{
+    // set stuff up here
+}
+
+void tearDown(void)
+{
+    // clean stuff up here
+}
+
+void test_codec_roundtrip(void)
+{
+    const PayloadCodec codecs[] = {PAYLOAD_CODEC_UNISHOX2, PAYLOAD_CODEC_STATIC_DICT};
+    for (PayloadCodec codec : codecs) {
+        for (const char *text : corpus) {
+            uint8_t compressed[meshtastic_Constants_DATA_PAYLOAD_LEN];
+            uint8_t decompressed[meshtastic_Constants_DATA_PAYLOAD_LEN];
+            size_t len = PayloadCompressor::encode(codec, (const uint8_t *)text, strlen(text), compressed, sizeof(compressed));
+            TEST_ASSERT_NOT_EQUAL(0, len);
+            size_t outLen = PayloadCompressor::decode(codec, compressed, len, decompressed, sizeof(decompressed));
+            TEST_ASSERT_EQUAL(strlen(text), outLen);
+            TEST_ASSERT_EQUAL_MEMORY(text, decompressed, outLen);
+        }
+    }
+}
+
+void test_compress_only_when_smaller(void)
+{
+    for (const char *text : corpus) {
+        meshtastic_Data in = makeText(text);
+        meshtastic_Data out;
+        if (PayloadCompressor::compress(in, out)) {
+            TEST_ASSERT_LESS_THAN(in.payload.size, out.payload.size);
+            TEST_ASSERT_EQUAL(TEXT_MESSAGE_CODEC_PORTNUM, out.portnum);
+            TEST_ASSERT_TRUE(PayloadCompressor::decompress(out));
+            TEST_ASSERT_EQUAL(meshtastic_PortNum_TEXT_MESSAGE_APP, out.portnum);
+            TEST_ASSERT_EQUAL(in.payload.size, out.payload.size);
+            TEST_ASSERT_EQUAL_MEMORY(in.payload.bytes, out.payload.bytes, in.payload.size);
+        }
+    }
+
+    // Incompressible input and ports without a compressed twin are left alone
+    meshtastic_Data in = makeText("\xf0\x9f\x99\x82");
+    meshtastic_Data out;
+    TEST_ASSERT_FALSE(PayloadCompressor::compress(in, out));
+    in.portnum = meshtastic_PortNum_POSITION_APP;
+    TEST_ASSERT_FALSE(PayloadCompressor::compress(in, out));
+}
+
+void test_decompress_rejects_garbage(void)
+{
+    meshtastic_Data d = meshtastic_Data_init_zero;
+    d.portnum = (meshtastic_PortNum)TEXT_MESSAGE_CODEC_PORTNUM;
+    d.payload.size = 3;
+    d.payload.bytes[0] = PAYLOAD_CODEC_STATIC_DICT;
+    d.payload.bytes[1] = 'a';
+    d.payload.bytes[2] = 0xFE; // Escape without a following byte
+    TEST_ASSERT_FALSE(PayloadCompressor::decompress(d));
+
+    d.payload.bytes[0] = 0x7F; // Unknown codec
+    TEST_ASSERT_FALSE(PayloadCompressor::decompress(d));
+}
+
+/// Senders that predate the codec id put raw unishox2 on TEXT_MESSAGE_COMPRESSED_APP
+void test_decompress_raw_unishox2(void)
+{
+    const char *text = corpus[0];
+    meshtastic_Data d = meshtastic_Data_init_zero;
+    d.portnum = meshtastic_PortNum_TEXT_MESSAGE_COMPRESSED_APP;
+    d.payload.size = PayloadCompressor::encode(PAYLOAD_CODEC_UNISHOX2, (const uint8_t *)text, strlen(text), d.payload.bytes,
+                                               sizeof(d.payload.bytes));
+    TEST_ASSERT_GREATER_THAN(0, d.payload.size);
+    TEST_ASSERT_TRUE(PayloadCompressor::isCompressed(d.portnum));
+    TEST_ASSERT_TRUE(PayloadCompressor::decompress(d));
+    TEST_ASSERT_EQUAL(meshtastic_PortNum_TEXT_MESSAGE_APP, d.portnum);
+    TEST_ASSERT_EQUAL(strlen(text), d.payload.size);
+    TEST_ASSERT_EQUAL_MEMORY(text, d.payload.bytes, d.payload.size);
+    TEST_ASSERT_FALSE(PayloadCompressor::isCompressed(d.portnum));
+}
+
+// Not a pass/fail test: reports compression ratio, airtime saved and CPU cost over the corpus
+void test_corpus_benchmark(void)
+{
+    AirtimeRadio radio;
+    const int rounds = 100;
+    size_t original = 0, compressed = 0;
+    uint32_t airtimeOriginal = 0, airtimeCompressed = 0;
+
+    uint32_t start = micros();
+    for (int i = 0; i < rounds; i++) {
+        for (const char *text : corpus) {
+            meshtastic_Data in = makeText(text);
+            meshtastic_Data out;
+            bool used = PayloadCompressor::compress(in, out);
+            if (i == 0) {
+                // 4 bytes cover the portnum and payload tags of the encoded Data message
+                const meshtastic_Data &sent = used ? out : in;
+                original += in.payload.size;
+                compressed += sent.payload.size;
+                airtimeOriginal += radio.getPacketTime(in.payload.size + sizeof(PacketHeader) + 4);
+                airtimeCompressed += radio.getPacketTime(sent.payload.size + sizeof(PacketHeader) + 4);
+            }
+        }
+    }
+    uint32_t elapsed = micros() - start;
+    size_t packets = rounds * (sizeof(corpus) / sizeof(corpus[0]));
+
+    printf("Compression ratio: %.3f (%u -> %u bytes)\n", (float)compressed / original, (unsigned)original, (unsigned)compressed);
+    printf("Airtime: %u ms -> %u ms (%.1f%% saved)\n", airtimeOriginal, airtimeCompressed,
+           100.0f * (airtimeOriginal - airtimeCompressed) / airtimeOriginal);
+    printf("CPU: %.1f us per packet\n", (float)elapsed / packets);
+    TEST_ASSERT_LESS_OR_EQUAL(original, compressed);
+}
+
+void setup()
+{
+    // NOTE!!! Wait for >2 secs
+    // if board doesn't support software reset via Serial.DTR/RTS
+    delay(10);
+    delay(2000);
+
+    initializeTestEnvironment();
+    UNITY_BEGIN(); // IMPORTANT LINE!
+    RUN_TEST(test_codec_roundtrip);
+    RUN_TEST(test_compress_only_when_smaller);
+    RUN_TEST(test_decompress_rejects_garbage);
+    RUN_TEST(test_decompress_raw_unishox2);
+    RUN_TEST(test_corpus_benchmark);
+    exit(UNITY_END()); // stop unit testing
+}
+
+void loop() {}
@@ -0,0 +1,132 @@
+#include "TestUtil.h"
+#include "gps/GPSProbeCache.h"
+#include <string>
+#include <unity.h>
+#include <vector>
+
+/// A GPS UART that answers known commands with responses recorded from real chips, amid the NMEA they send unasked
+class SimulatedUart : public Stream
+{
+  public:
+    struct Reply {
+        std::string command;
+        std::string response;
+    };
+    std::vector<Reply> replies;
+    std::string written;
+    std::string rx;
+    size_t rxPos = 0;
+
+    void answer(const std::string &command, const std::string &response) { replies.push_back({command, response}); }
+
+    int available() override { return rx.size() - rxPos; }
+
+    int read() override { return rxPos < rx.size() ? (uint8_t)rx[rxPos++] : -1; }
+
+    int peek() override { return rxPos < rx.size() ? (uint8_t)rx[rxPos] : -1; }
+
+    using Print::write;
+    size_t write(uint8_t c) override
+    {
+        written += (char)c;
+        for (const Reply &r : replies) {
+            if (written.size() >= r.command.size() &&
+                written.compare(written.size() - r.command.size(), r.command.size(), r.command) == 0)
+                rx += r.response;
+        }
+        return 1;
+    }
+};
+
+static const char *RMC = "$GNRMC,,V,,,,,,,,,,N*4D\r\n";
+static const char *GGA = "$GNGGA,,,,,,0,00,25.5,,,,,,*64\r\n";
+
+static const std::string UBX_CFG_RATE_POLL("\xB5\x62\x06\x08\x00\x00\x0E\x30", 8);
+static const std::string UBX_CFG_RATE("\xB5\x62\x06\x08\x06\x00\xE8\x03\x01\x00\x01\x00\x01\x39", 14);
+static const std::string UBX_ACK_CFG_RATE("\xB5\x62\x05\x01\x02\x00\x06\x08\x16\x3F", 10);
+
+static SimulatedUart *uart;
+
+void setUp(void)
+{
+    uart = new SimulatedUart();
+    // Chatter already waiting when the probe is sent
+    uart->rx = std::string(RMC) + GGA;
+}
+
+void tearDown(void)
+{
+    delete uart;
+}
+
+void test_atgm336h_verified(void)
+{
+    uart->answer("$PCAS06,1*1A\r\n", std::string(RMC) + "$GPTXT,01,01,02,HW=ATGM336H,0001010379462*1F\r\n");
+    TEST_ASSERT_TRUE(GPSProbeCache::verify(*uart, GNSS_MODEL_ATGM336H));
+    TEST_ASSERT_EQUAL_STRING("$PCAS06,1*1A\r\n", uart->written.c_str());
+}
+
+void test_ublox_ack_found_in_binary_and_nmea(void)
+{
+    uart->answer(UBX_CFG_RATE_POLL, UBX_CFG_RATE + GGA + UBX_ACK_CFG_RATE);
+    TEST_ASSERT_TRUE(GPSProbeCache::verify(*uart, GNSS_MODEL_UBLOX8));
+    TEST_ASSERT_TRUE(uart->written == UBX_CFG_RATE_POLL);
+}
+
+void test_any_chip_of_the_model_matches(void)
+{
+    uart->answer("$PMTK605*31\r\n", "$PMTK705,AXN_5.1.7_3333_19020118,0027,Quectel-L96,1.0*76\r\n");
+    TEST_ASSERT_TRUE(GPSProbeCache::verify(*uart, GNSS_MODEL_MTK_L76B));
+}
+
+void test_other_chip_is_not_verified(void)
+{
+    // A PA1010D answers the same command as an L76B, but it isn't the chip that was remembered
+    uart->answer("$PMTK605*31\r\n", "$PMTK705,AXN_5.1.7_3333_19020118,0027,PA1010D,1.0*76\r\n");
+    uint32_t start = millis();
+    TEST_ASSERT_FALSE(GPSProbeCache::verify(*uart, GNSS_MODEL_MTK_L76B));
+    TEST_ASSERT_GREATER_OR_EQUAL(500, millis() - start);
+}
+
+void test_wrong_baud_is_not_verified(void)
+{
+    // At the wrong baud rate the chip can't make sense of the probe, and what it sends is garbage
+    uart->rx = "\xF0\x0F\xE6\x18\x78\x80\xFE";
+    TEST_ASSERT_FALSE(GPSProbeCache::verify(*uart, GNSS_MODEL_MTK));
+}
+
+void test_unknown_model_sends_nothing(void)
+{
+    TEST_ASSERT_FALSE(GPSProbeCache::verify(*uart, GNSS_MODEL_UNKNOWN));
+    TEST_ASSERT_EQUAL(0, uart->written.size());
+}
+
+void test_answer_after_lots_of_chatter(void)
+{
+    std::string chatter;
+    for (int i = 0; i < 20; i++)
+        chatter += std::string(RMC) + GGA;
+    uart->answer("$PAIR021*39\r\n", chatter + "$PAIR021,AG3335M_V2.5.0.AG3335_20230308,S,N,8a2c6f8,2209141930,2bb,3,,*1A\r\n");
+    TEST_ASSERT_TRUE(GPSProbeCache::verify(*uart, GNSS_MODEL_AG3335));
+}
+
+void setup()
+{
+    // NOTE!!! Wait for >2 secs
+    // if board doesn't support software reset via Serial.DTR/RTS
+    delay(10);
+    delay(2000);
+
+    initializeTestEnvironment();
+    UNITY_BEGIN(); // IMPORTANT LINE!
+    RUN_TEST(test_atgm336h_verified);
+    RUN_TEST(test_ublox_ack_found_in_binary_and_nmea);
+    RUN_TEST(test_any_chip_of_the_model_matches);
+    RUN_TEST(test_other_chip_is_not_verified);
+    RUN_TEST(test_wrong_baud_is_not_verified);
+    RUN_TEST(test_unknown_model_sends_nothing);
+    RUN_TEST(test_answer_after_lots_of_chatter);
+    exit(UNITY_END()); // stop unit testing
+}
+
+void loop() {}
@@ -0,0 +1,196 @@
+#include "TestUtil.h"
+#include "detect/I2CScanManifest.h"
+#include "detect/ScanI2C.h"
+#include <map>
+#include <unity.h>
+
+// Rough bus time of an address probe at 100kHz, and of telling a found device apart (a register read after a 20ms wait)
+static const uint32_t PROBE_US = 100;
+static const uint32_t IDENTIFY_US = 20000;
+
+/// A scanner over a simulated bus, that adds up how long a real scan would have spent on it instead of talking to hardware
+class MockScanner : public ScanI2C
+{
+  public:
+    std::map<uint8_t, DeviceType> bus[3];
+    std::map<uint8_t, DeviceType> found[3];
+    uint32_t busMicros = 0;
+    uint32_t probes = 0;
+
+    void scanPort(I2CPort port) override { scanPort(port, nullptr, 0); }
+
+    void scanPort(I2CPort port, uint8_t *addresses, uint8_t count) override
+    {
+        if (count) {
+            for (uint8_t i = 0; i < count; i++)
+                probe(port, addresses[i]);
+        } else {
+            for (uint8_t address = 8; address < 120; address++)
+                probe(port, address);
+        }
+    }
+
+    size_t countDevices() const override { return found[WIRE].size() + found[WIRE1].size(); }
+
+    size_t getDevices(I2CPort port, FoundDevice *out, size_t max) const override
+    {
+        size_t n = 0;
+        for (const auto &f : found[port]) {
+            if (n < max)
+                out[n++] = FoundDevice(f.second, DeviceAddress(port, f.first));
+        }
+        return n;
+    }
+
+  protected:
+    void forgetPort(I2CPort port) override { found[port].clear(); }
+
+  private:
+    void probe(I2CPort port, uint8_t address)
+    {
+        probes++;
+        busMicros += PROBE_US;
+        auto device = bus[port].find(address);
+        if (device != bus[port].end()) {
+            busMicros += IDENTIFY_US;
+            found[port][address] = device->second;
+        }
+    }
+};
+
+static I2CScanManifest *manifest;
+
+/// The same board booting again
+static MockScanner reboot(const MockScanner &board)
+{
+    MockScanner scanner;
+    for (int port = 0; port < 3; port++)
+        scanner.bus[port] = board.bus[port];
+    return scanner;
+}
+
+static MockScanner typicalBoard()
+{
+    MockScanner board;
+    board.bus[ScanI2C::WIRE][0x3c] = ScanI2C::SCREEN_SSD1306;
+    board.bus[ScanI2C::WIRE][0x76] = ScanI2C::BME_280;
+    board.bus[ScanI2C::WIRE1][0x44] = ScanI2C::SHT31;
+    return board;
+}
+
+static void scanBoth(MockScanner &scanner)
+{
+    scanner.scanPortCached(ScanI2C::WIRE1, *manifest);
+    scanner.scanPortCached(ScanI2C::WIRE, *manifest);
+}
+
+void setUp(void)
+{
+    manifest = new I2CScanManifest();
+}
+
+void tearDown(void)
+{
+    delete manifest;
+}
+
+void test_known_devices_are_verified_only(void)
+{
+    MockScanner first = typicalBoard();
+    scanBoth(first);
+    TEST_ASSERT_EQUAL(2 * 112, first.probes);
+    TEST_ASSERT_EQUAL(3, first.countDevices());
+    manifest->record(first);
+    TEST_ASSERT_TRUE(manifest->isDirty());
+    TEST_ASSERT_TRUE(manifest->hasPort(ScanI2C::WIRE));
+    TEST_ASSERT_TRUE(manifest->hasPort(ScanI2C::WIRE1));
+
+    MockScanner second = reboot(first);
+    scanBoth(second);
+    TEST_ASSERT_EQUAL(3, second.probes);
+    TEST_ASSERT_EQUAL(3, second.countDevices());
+    TEST_ASSERT_EQUAL(ScanI2C::BME_280, second.found[ScanI2C::WIRE][0x76]);
+
+    // The probes of empty addresses are what the manifest saves, identifying the devices costs the same either way
+    TEST_ASSERT_EQUAL(2 * 112 * PROBE_US + 3 * IDENTIFY_US, first.busMicros);
+    TEST_ASSERT_EQUAL(3 * PROBE_US + 3 * IDENTIFY_US, second.busMicros);
+}
+
+void test_missing_device_rescans_port(void)
+{
+    MockScanner first = typicalBoard();
+    scanBoth(first);
+    manifest->record(first);
+
+    MockScanner second = reboot(first);
+    second.bus[ScanI2C::WIRE].erase(0x76);
+    second.bus[ScanI2C::WIRE][0x77] = ScanI2C::BMP_280;
+    scanBoth(second);
+
+    // WIRE1 is unchanged and only verified, WIRE is verified then scanned in full
+    TEST_ASSERT_EQUAL(1 + 2 + 112, second.probes);
+    TEST_ASSERT_EQUAL(2, second.found[ScanI2C::WIRE].size());
+    TEST_ASSERT_EQUAL(ScanI2C::BMP_280, second.found[ScanI2C::WIRE][0x77]);
+
+    manifest->record(second);
+    uint8_t addresses[I2C_SCAN_MANIFEST_MAX_DEVICES];
+    TEST_ASSERT_EQUAL(2, manifest->getAddresses(ScanI2C::WIRE, addresses, I2C_SCAN_MANIFEST_MAX_DEVICES));
+    TEST_ASSERT_EQUAL(0x3c, addresses[0]);
+    TEST_ASSERT_EQUAL(0x77, addresses[1]);
+}
+
+void test_changed_type_rescans_port(void)
+{
+    MockScanner first = typicalBoard();
+    scanBoth(first);
+    manifest->record(first);
+
+    MockScanner second = reboot(first);
+    second.bus[ScanI2C::WIRE1][0x44] = ScanI2C::SHT4X;
+    scanBoth(second);
+    TEST_ASSERT_EQUAL(1 + 112 + 2, second.probes);
+    TEST_ASSERT_EQUAL(ScanI2C::SHT4X, second.found[ScanI2C::WIRE1][0x44]);
+}
+
+void test_empty_port_is_always_scanned(void)
+{
+    MockScanner board;
+    board.bus[ScanI2C::WIRE][0x3c] = ScanI2C::SCREEN_SSD1306;
+    scanBoth(board);
+    manifest->record(board);
+    TEST_ASSERT_FALSE(manifest->hasPort(ScanI2C::WIRE1));
+
+    // A sensor plugged into the empty port is found on the next boot
+    MockScanner second = reboot(board);
+    second.bus[ScanI2C::WIRE1][0x44] = ScanI2C::SHT31;
+    scanBoth(second);
+    TEST_ASSERT_EQUAL(112 + 1, second.probes);
+    TEST_ASSERT_EQUAL(2, second.countDevices());
+}
+
+void test_nothing_found_is_not_dirty(void)
+{
+    MockScanner board;
+    scanBoth(board);
+    manifest->record(board);
+    TEST_ASSERT_FALSE(manifest->isDirty());
+}
+
+void setup()
+{
+    // NOTE!!! Wait for >2 secs
+    // if board doesn't support software reset via Serial.DTR/RTS
+    delay(10);
+    delay(2000);
+
+    initializeTestEnvironment();
+    UNITY_BEGIN(); // IMPORTANT LINE!
+    RUN_TEST(test_known_devices_are_verified_only);
+    RUN_TEST(test_missing_device_rescans_port);
+    RUN_TEST(test_changed_type_rescans_port);
+    RUN_TEST(test_empty_port_is_always_scanned);
+    RUN_TEST(test_nothing_found_is_not_dirty);
+    exit(UNITY_END()); // stop unit testing
+}
+
+void loop() {}
@@ -0,0 +1,129 @@
+#include "TestUtil.h"
+#include "mesh/LatencyTrace.h"
+#include <stdio.h>
+#include <unity.h>
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_buckets_stay_within_a_quarter(void)
+{
+    for (uint32_t us = 1; us < (1u << 24); us = us * 9 / 8 + 1) {
+        uint8_t b = LatencyHistogram::bucketOf(us);
+        TEST_ASSERT_LESS_OR_EQUAL(us, LatencyHistogram::bucketStart(b));
+        TEST_ASSERT_GREATER_THAN(us, LatencyHistogram::bucketStart(b + 1));
+        TEST_ASSERT_LESS_OR_EQUAL(us / 4 + 1, LatencyHistogram::bucketStart(b + 1) - LatencyHistogram::bucketStart(b));
+    }
+    TEST_ASSERT_EQUAL(LatencyHistogram::NUM_BUCKETS - 1, LatencyHistogram::bucketOf(UINT32_MAX));
+}
+
+void test_percentiles(void)
+{
+    LatencyHistogram h;
+    TEST_ASSERT_EQUAL(0, h.getPercentile(50));
+    for (uint32_t i = 0; i < 90; i++)
+        h.record(1000);
+    for (uint32_t i = 0; i < 10; i++)
+        h.record(50000);
+
+    TEST_ASSERT_EQUAL(100, h.getCount());
+    TEST_ASSERT_EQUAL(50000, h.getMax());
+    TEST_ASSERT_UINT32_WITHIN(250, 1000, h.getPercentile(50));
+    TEST_ASSERT_UINT32_WITHIN(250, 1000, h.getPercentile(89));
+    TEST_ASSERT_EQUAL(50000, h.getPercentile(99));
+}
+
+void test_rx_stages_follow_the_packet(void)
+{
+    LatencyTrace t;
+    LatencyTrace::markIsr(1000);
+    t.mark(LatencyTrace::RX_RADIO, 0xA, 1, 1200);
+    t.mark(LatencyTrace::RX_RADIO, 0xB, 2, 1300); // Another packet in between, timed from when it was read
+    t.mark(LatencyTrace::RX_QUEUED, 0xA, 1, 1250);
+    t.mark(LatencyTrace::RX_DECODED, 0xA, 1, 5250);
+    t.mark(LatencyTrace::RX_TO_PHONE, 0xA, 1, 6250); // No module stage, timed from decoding
+    t.mark(LatencyTrace::RX_FROM_RADIO, 0xA, 1, 26250);
+    t.mark(LatencyTrace::RX_FROM_RADIO, 0xA, 1, 30000); // A second client, the trace is over
+
+    TEST_ASSERT_EQUAL(2, t.getStage(LatencyTrace::RX_RADIO).getCount());
+    TEST_ASSERT_EQUAL(200, t.getStage(LatencyTrace::RX_RADIO).getMax());
+    TEST_ASSERT_EQUAL(50, t.getStage(LatencyTrace::RX_QUEUED).getMax());
+    TEST_ASSERT_EQUAL(4000, t.getStage(LatencyTrace::RX_DECODED).getMax());
+    TEST_ASSERT_EQUAL(0, t.getStage(LatencyTrace::RX_MODULES).getCount());
+    TEST_ASSERT_EQUAL(1000, t.getStage(LatencyTrace::RX_TO_PHONE).getMax());
+    TEST_ASSERT_EQUAL(1, t.getStage(LatencyTrace::RX_FROM_RADIO).getCount());
+    TEST_ASSERT_EQUAL(1, t.getRxTotal().getCount());
+    TEST_ASSERT_EQUAL(25250, t.getRxTotal().getMax());
+}
+
+void test_tx_is_traced_apart_from_rx(void)
+{
+    LatencyTrace t;
+    t.mark(LatencyTrace::RX_RADIO, 0xA, 1, 0); // Heard, then relayed by us
+    t.mark(LatencyTrace::TX_QUEUED, 0xA, 1, 100);
+    t.mark(LatencyTrace::TX_STARTED, 0xA, 1, 3100);
+    t.mark(LatencyTrace::RX_QUEUED, 0xA, 1, 3200);
+    t.mark(LatencyTrace::TX_COMPLETED, 0xA, 1, 400100);
+
+    TEST_ASSERT_EQUAL(3000, t.getStage(LatencyTrace::TX_STARTED).getMax());
+    TEST_ASSERT_EQUAL(397000, t.getStage(LatencyTrace::TX_COMPLETED).getMax());
+    TEST_ASSERT_EQUAL(400000, t.getTxTotal().getMax());
+    TEST_ASSERT_EQUAL(3200, t.getStage(LatencyTrace::RX_QUEUED).getMax());
+
+    // Packets nobody saw start aren't timed
+    t.mark(LatencyTrace::TX_STARTED, 0xC, 3, 500000);
+    TEST_ASSERT_EQUAL(1, t.getStage(LatencyTrace::TX_STARTED).getCount());
+}
+
+void test_json(void)
+{
+    LatencyTrace t;
+    t.mark(LatencyTrace::TX_QUEUED, 0xA, 1, 0);
+    t.mark(LatencyTrace::TX_STARTED, 0xA, 1, 10);
+    std::string json = t.toJson();
+    TEST_ASSERT_TRUE(json.find("{\"stages\":[{\"name\":\"rx_radio\",\"count\":0,") == 0);
+    TEST_ASSERT_TRUE(json.find("{\"name\":\"tx_started\",\"count\":1,\"p50\":10,\"p90\":10,\"p99\":10,\"max\":10}") !=
+                     std::string::npos);
+    TEST_ASSERT_TRUE(json.find("tx_queued") == std::string::npos);
+    TEST_ASSERT_TRUE(json.find("\"tx_total\"") != std::string::npos);
+}
+
+/// A mark has to be cheap enough to leave in every packet's path
+void test_benchmark_mark(void)
+{
+    LatencyTrace t;
+    const uint32_t PACKETS = 20000;
+    uint32_t start = micros();
+    for (uint32_t i = 0; i < PACKETS; i++) {
+        t.mark(LatencyTrace::RX_RADIO, 0xA, i, i * 1000);
+        t.mark(LatencyTrace::RX_QUEUED, 0xA, i, i * 1000 + 10);
+        t.mark(LatencyTrace::RX_DECODED, 0xA, i, i * 1000 + 300);
+        t.mark(LatencyTrace::RX_MODULES, 0xA, i, i * 1000 + 700);
+        t.mark(LatencyTrace::RX_TO_PHONE, 0xA, i, i * 1000 + 800);
+        t.mark(LatencyTrace::RX_FROM_RADIO, 0xA, i, i * 1000 + 900);
+    }
+    uint32_t elapsed = micros() - start;
+    printf("%u marks in %u us, %.0f ns each\n", PACKETS * 6, elapsed, elapsed * 1000.0 / (PACKETS * 6));
+    TEST_ASSERT_EQUAL(PACKETS, t.getRxTotal().getCount());
+}
+
+void setup()
+{
+    // NOTE!!! Wait for >2 secs
+    // if board doesn't support software reset via Serial.DTR/RTS
+    delay(10);
+    delay(2000);
+
+    initializeTestEnvironment();
+    UNITY_BEGIN(); // IMPORTANT LINE!
+    RUN_TEST(test_buckets_stay_within_a_quarter);
+    RUN_TEST(test_percentiles);
+    RUN_TEST(test_rx_stages_follow_the_packet);
+    RUN_TEST(test_tx_is_traced_apart_from_rx);
+    RUN_TEST(test_json);
+    RUN_TEST(test_benchmark_mark);
+    exit(UNITY_END()); // stop unit testing
+}
+
+void loop() {}
@@ -0,0 +1,119 @@
+#include "TestUtil.h"
+#include "mesh/MetricsRegistry.h"
+#include <stdio.h>
+#include <unity.h>
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static bool contains(const std::string &s, const char *what)
+{
+    return s.find(what) != std::string::npos;
+}
+
+void test_counters_and_gauges(void)
+{
+    MetricsRegistry r;
+    MetricsRegistry::Metric *rx = r.add(MetricsRegistry::COUNTER, "meshtastic_rx_good_total", "Packets received");
+    MetricsRegistry::Metric *nodes = r.add(MetricsRegistry::GAUGE, "meshtastic_nodes", "Nodes in the NodeDB");
+    rx->set(1234567);
+    nodes->set(42.5);
+
+    TEST_ASSERT_EQUAL_STRING("# HELP meshtastic_rx_good_total Packets received\n"
+                             "# TYPE meshtastic_rx_good_total counter\n"
+                             "meshtastic_rx_good_total 1234567\n"
+                             "# HELP meshtastic_nodes Nodes in the NodeDB\n"
+                             "# TYPE meshtastic_nodes gauge\n"
+                             "meshtastic_nodes 42.5\n",
+                             r.render().c_str());
+}
+
+void test_labels_share_one_family(void)
+{
+    MetricsRegistry r;
+    r.add(MetricsRegistry::GAUGE, "queue_depth", "Waiting", "queue=\"phone\"")->set(3);
+    r.add(MetricsRegistry::GAUGE, "queue_depth", "Waiting", "queue=\"mqtt\"")->set(7);
+    std::string out = r.render();
+
+    TEST_ASSERT_EQUAL_STRING("# HELP queue_depth Waiting\n"
+                             "# TYPE queue_depth gauge\n"
+                             "queue_depth{queue=\"phone\"} 3\n"
+                             "queue_depth{queue=\"mqtt\"} 7\n",
+                             out.c_str());
+}
+
+void test_histogram(void)
+{
+    MetricsRegistry r;
+    LatencyHistogram h;
+    for (int i = 0; i < 3; i++)
+        h.record(1000);
+    h.record(50000);
+    r.addHistogram("latency_seconds", "Latency", &h, "direction=\"rx\"");
+    std::string out = r.render();
+
+    TEST_ASSERT_TRUE(out.find("# HELP latency_seconds Latency\n# TYPE latency_seconds histogram\n") == 0);
+    TEST_ASSERT_TRUE(contains(out, "latency_seconds_bucket{direction=\"rx\",le=\"0.000512\"} 0\n"));
+    TEST_ASSERT_TRUE(contains(out, "latency_seconds_bucket{direction=\"rx\",le=\"0.001024\"} 3\n"));
+    TEST_ASSERT_TRUE(contains(out, "latency_seconds_bucket{direction=\"rx\",le=\"0.032768\"} 3\n"));
+    TEST_ASSERT_TRUE(contains(out, "latency_seconds_bucket{direction=\"rx\",le=\"0.065536\"} 4\n"));
+    TEST_ASSERT_TRUE(contains(out, "latency_seconds_bucket{direction=\"rx\",le=\"+Inf\"} 4\n"));
+    TEST_ASSERT_TRUE(contains(out, "latency_seconds_count{direction=\"rx\"} 4\n"));
+
+    // The sum is estimated from bucket middles, within the 25% the buckets are wide
+    size_t at = out.find("latency_seconds_sum{direction=\"rx\"} ");
+    TEST_ASSERT_TRUE(at != std::string::npos);
+    double sum = atof(out.c_str() + at + strlen("latency_seconds_sum{direction=\"rx\"} "));
+    TEST_ASSERT_FLOAT_WITHIN(0.053 * 0.25, 0.053, sum);
+}
+
+void test_full_registry(void)
+{
+    MetricsRegistry r;
+    for (int i = 0; i < METRICS_MAX; i++)
+        TEST_ASSERT_NOT_NULL(r.add(MetricsRegistry::GAUGE, "g", "Gauge"));
+    TEST_ASSERT_NULL(r.add(MetricsRegistry::GAUGE, "g", "Gauge"));
+    TEST_ASSERT_EQUAL(METRICS_MAX, r.getNumMetrics());
+}
+
+/// A scrape runs on a web server thread, but should still be cheap
+void test_benchmark_render(void)
+{
+    MetricsRegistry r;
+    LatencyHistogram h;
+    for (uint32_t i = 1; i < 10000; i++)
+        h.record(i * 37);
+    for (int i = 0; i < 20; i++)
+        r.add(MetricsRegistry::COUNTER, "meshtastic_counter_total", "Counter")->set(i);
+    for (int i = 0; i < 10; i++)
+        r.addHistogram("meshtastic_latency_seconds", "Latency", &h);
+
+    const int SCRAPES = 200;
+    size_t len = 0;
+    uint32_t start = micros();
+    for (int i = 0; i < SCRAPES; i++)
+        len += r.render().size();
+    uint32_t elapsed = micros() - start;
+    printf("%d scrapes of %u bytes in %u us, %u us each\n", SCRAPES, (unsigned)(len / SCRAPES), elapsed, elapsed / SCRAPES);
+    TEST_ASSERT_GREATER_THAN(0, len);
+}
+
+void setup()
+{
+    // NOTE!!! Wait for >2 secs
+    // if board doesn't support software reset via Serial.DTR/RTS
+    delay(10);
+    delay(2000);
+
+    initializeTestEnvironment();
+    UNITY_BEGIN(); // IMPORTANT LINE!
+    RUN_TEST(test_counters_and_gauges);
+    RUN_TEST(test_labels_share_one_family);
+    RUN_TEST(test_histogram);
+    RUN_TEST(test_full_registry);
+    RUN_TEST(test_benchmark_render);
+    exit(UNITY_END()); // stop unit testing
+}
+
+void loop() {}
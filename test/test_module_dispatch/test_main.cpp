@@ -0,0 +1,142 @@
+#include "TestUtil.h"
+#include "mesh/ModuleDispatchIndex.h"
+#include <stdio.h>
+#include <unity.h>
+#include <vector>
+
+static const int32_t ANY = ModuleDispatchIndex<int>::anyPort;
+
+/// Stands in for a module, with the same virtual call callModules() makes for each one it asks
+class FakeModule
+{
+  public:
+    int32_t port;
+    bool encryptedOk;
+    uint32_t asked = 0;
+
+    FakeModule(int32_t port, bool encryptedOk = false) : port(port), encryptedOk(encryptedOk) {}
+    virtual ~FakeModule() {}
+
+    virtual bool wantPacket(uint32_t portnum)
+    {
+        asked++;
+        return port == ANY || (uint32_t)port == portnum;
+    }
+};
+
+static std::vector<int> ids(const std::vector<int *> &list)
+{
+    std::vector<int> out;
+    for (int *p : list)
+        out.push_back(*p);
+    return out;
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_candidates_keep_registration_order(void)
+{
+    int m[6] = {0, 1, 2, 3, 4, 5};
+    ModuleDispatchIndex<int> index;
+    index.add(&m[0], 10, false);
+    index.add(&m[1], ANY, false);
+    index.add(&m[2], 20, false);
+    index.add(&m[3], 10, false);
+    index.add(&m[4], ANY, false);
+    index.add(&m[5], 20, false);
+
+    TEST_ASSERT_TRUE(ids(index.getCandidates(true, 10)) == std::vector<int>({0, 1, 3, 4}));
+    TEST_ASSERT_TRUE(ids(index.getCandidates(true, 20)) == std::vector<int>({1, 2, 4, 5}));
+}
+
+void test_unbound_port_gets_any_port_modules(void)
+{
+    int m[3] = {0, 1, 2};
+    ModuleDispatchIndex<int> index;
+    index.add(&m[0], 10, false);
+    index.add(&m[1], ANY, false);
+    index.add(&m[2], ANY, false);
+
+    TEST_ASSERT_TRUE(ids(index.getCandidates(true, 99)) == std::vector<int>({1, 2}));
+}
+
+void test_encrypted_packets_only_go_to_encrypted_ok_modules(void)
+{
+    int m[3] = {0, 1, 2};
+    ModuleDispatchIndex<int> index;
+    index.add(&m[0], 10, true);
+    index.add(&m[1], ANY, false);
+    index.add(&m[2], ANY, true);
+
+    TEST_ASSERT_TRUE(ids(index.getCandidates(false, 10)) == std::vector<int>({0, 2}));
+}
+
+/// A typical build: ~30 single port modules and a handful that look at everything, fed a mix of packets
+void test_benchmark_dispatch(void)
+{
+    const uint32_t PACKETS = 100000;
+    std::vector<FakeModule *> modules;
+    for (int32_t i = 0; i < 36; i++)
+        modules.push_back(new FakeModule(i % 6 == 5 ? ANY : i + 1));
+
+    ModuleDispatchIndex<FakeModule> index;
+    for (FakeModule *m : modules)
+        index.add(m, m->port, m->encryptedOk);
+
+    uint32_t scanWanted = 0, indexWanted = 0;
+    uint32_t start = micros();
+    for (uint32_t i = 0; i < PACKETS; i++) {
+        uint32_t portnum = (i * 7) % 40 + 1;
+        for (FakeModule *m : modules)
+            if (m->wantPacket(portnum))
+                scanWanted++;
+    }
+    uint32_t scanUs = micros() - start;
+    uint32_t scanAsked = 0;
+    for (FakeModule *m : modules) {
+        scanAsked += m->asked;
+        m->asked = 0;
+    }
+
+    start = micros();
+    for (uint32_t i = 0; i < PACKETS; i++) {
+        uint32_t portnum = (i * 7) % 40 + 1;
+        for (FakeModule *m : index.getCandidates(true, portnum))
+            if (m->wantPacket(portnum))
+                indexWanted++;
+    }
+    uint32_t indexUs = micros() - start;
+    uint32_t indexAsked = 0;
+    for (FakeModule *m : modules)
+        indexAsked += m->asked;
+
+    printf("%u packets, %u modules: scan asked %u in %u us, index asked %u in %u us\n", PACKETS, (unsigned)modules.size(),
+           scanAsked, scanUs, indexAsked, indexUs);
+
+    // Every module that wanted a packet still gets it, and far fewer are asked
+    TEST_ASSERT_EQUAL(scanWanted, indexWanted);
+    TEST_ASSERT_LESS_THAN(scanAsked / 3, indexAsked);
+
+    for (FakeModule *m : modules)
+        delete m;
+}
+
+void setup()
+{
+    // NOTE!!! Wait for >2 secs
+    // if board doesn't support software reset via Serial.DTR/RTS
+    delay(10);
+    delay(2000);
+
+    initializeTestEnvironment();
+    UNITY_BEGIN(); // IMPORTANT LINE!
+    RUN_TEST(test_candidates_keep_registration_order);
+    RUN_TEST(test_unbound_port_gets_any_port_modules);
+    RUN_TEST(test_encrypted_packets_only_go_to_encrypted_ok_modules);
+    RUN_TEST(test_benchmark_dispatch);
+    exit(UNITY_END()); // stop unit testing
+}
+
+void loop() {}
@@ -0,0 +1,206 @@
+#include "TestUtil.h"
+#include "TinyGPS++.h"
+#include "gps/NMEAFramer.h"
+#include <stdio.h>
+#include <string>
+#include <time.h>
+#include <unity.h>
+#include <vector>
+
+/// "$<body>*<checksum>\r\n"
+static std::string sentence(const char *body)
+{
+    uint8_t checksum = 0;
+    for (const char *c = body; *c; c++)
+        checksum ^= (uint8_t)*c;
+    char tail[8];
+    snprintf(tail, sizeof(tail), "*%02X\r\n", checksum);
+    return std::string("$") + body + tail;
+}
+
+/// One second of output from a u-blox M8 with a fix, as GPS::setup() leaves it configured plus the sentences it can't turn off
+static std::string epoch(int second)
+{
+    char gga[96], rmc[96], gll[64];
+    snprintf(gga, sizeof(gga), "GNGGA,1234%02d.00,4807.03812,N,01131.00000,E,1,08,0.9,545.4,M,46.9,M,,", second);
+    snprintf(rmc, sizeof(rmc), "GNRMC,1234%02d.00,A,4807.03812,N,01131.00000,E,0.022,,230394,,,A", second);
+    snprintf(gll, sizeof(gll), "GNGLL,4807.03812,N,01131.00000,E,1234%02d.00,A,A", second);
+    return sentence(gga) + sentence(rmc) + sentence("GNGSA,A,3,04,05,09,12,24,,,,,,,,2.5,1.3,2.1") +
+           sentence("GNGSA,A,3,65,66,,,,,,,,,,,2.5,1.3,2.1") +
+           sentence("GPGSV,3,1,11,03,03,111,00,04,15,270,00,06,01,010,00,13,06,292,00") +
+           sentence("GPGSV,3,2,11,14,25,170,00,16,57,208,39,18,67,296,40,19,40,246,00") +
+           sentence("GPGSV,3,3,11,22,42,067,42,24,14,311,43,27,05,244,00") +
+           sentence("GLGSV,1,1,02,65,48,025,35,66,62,282,38") + sentence("GNVTG,,T,,M,0.022,N,0.041,K,A") +
+           sentence(gll);
+}
+
+struct Collected {
+    std::vector<std::string> sentences;
+    std::vector<const char *> pointers;
+    void operator()(const char *s, size_t len)
+    {
+        sentences.push_back(std::string(s, len));
+        pointers.push_back(s);
+    }
+};
+
+static NMEAFramer *framer;
+
+void setUp(void)
+{
+    framer = new NMEAFramer();
+}
+
+void tearDown(void)
+{
+    delete framer;
+}
+
+void test_whole_sentences_are_not_copied(void)
+{
+    std::string data = sentence("GPGGA,1") + sentence("GPRMC,2");
+    Collected c;
+    TEST_ASSERT_EQUAL(2, framer->feed((const uint8_t *)data.data(), data.size(), c));
+    TEST_ASSERT_TRUE(c.sentences[0] + "\r\n" == sentence("GPGGA,1"));
+    TEST_ASSERT_EQUAL_PTR(data.data(), c.pointers[0]);
+    TEST_ASSERT_EQUAL_PTR(data.data() + sentence("GPGGA,1").size(), c.pointers[1]);
+    TEST_ASSERT_EQUAL(2, framer->getPassedChecksums());
+}
+
+void test_sentence_split_across_reads(void)
+{
+    std::string data = epoch(0);
+    Collected whole, bytes;
+    framer->feed((const uint8_t *)data.data(), data.size(), whole);
+    NMEAFramer byByte;
+    for (char b : data)
+        byByte.feed((const uint8_t *)&b, 1, bytes);
+    TEST_ASSERT_EQUAL(10, whole.sentences.size());
+    TEST_ASSERT_TRUE(whole.sentences == bytes.sentences);
+}
+
+void test_bad_checksums_are_dropped(void)
+{
+    std::string good = sentence("GPGGA,1");
+    std::string corrupt = good;
+    corrupt[4] = 'X';
+    std::string data = corrupt + "$GPGGA,1\r\n" + "$GPGGA,1*ZZ\r\n" + good;
+    Collected c;
+    TEST_ASSERT_EQUAL(1, framer->feed((const uint8_t *)data.data(), data.size(), c));
+    TEST_ASSERT_EQUAL(3, framer->getFailedChecksums());
+}
+
+void test_ubx_between_sentences_is_skipped(void)
+{
+    std::string ubx("\xB5\x62\x05\x01\x02\x00\x06\x08\x16\x3F", 10);
+    std::string data = sentence("GPGGA,1") + ubx + sentence("GPRMC,2");
+    Collected c;
+    TEST_ASSERT_EQUAL(2, framer->feed((const uint8_t *)data.data(), data.size(), c));
+    TEST_ASSERT_EQUAL(0, framer->getFailedChecksums());
+}
+
+void test_cut_short_sentence(void)
+{
+    std::string first = "$GPGGA,123";
+    std::string data = sentence("GPRMC,2");
+    Collected c;
+    framer->feed((const uint8_t *)first.data(), first.size(), c);
+    TEST_ASSERT_EQUAL(1, framer->feed((const uint8_t *)data.data(), data.size(), c));
+    TEST_ASSERT_TRUE(c.sentences[0] + "\r\n" == data);
+    TEST_ASSERT_EQUAL(1, framer->getFailedChecksums());
+}
+
+void test_overlong_sentence_is_dropped(void)
+{
+    std::string junk = "$GPTXT," + std::string(NMEA_FRAMER_MAX_SENTENCE, 'x');
+    std::string data = sentence("GPRMC,2");
+    Collected c;
+    framer->feed((const uint8_t *)junk.data(), junk.size() / 2, c);
+    framer->feed((const uint8_t *)junk.data() + junk.size() / 2, junk.size() - junk.size() / 2, c);
+    TEST_ASSERT_EQUAL(0, framer->feed((const uint8_t *)"\r\n", 2, c));
+    TEST_ASSERT_EQUAL(1, framer->feed((const uint8_t *)data.data(), data.size(), c));
+    TEST_ASSERT_EQUAL(1, framer->getOverflows());
+}
+
+void test_sentence_types(void)
+{
+    TEST_ASSERT_TRUE(NMEAFramer::isType("$GNGGA,1*4A", 11, "GGA"));
+    TEST_ASSERT_TRUE(NMEAFramer::isType("$GPGGA,1*4A", 11, "GGA"));
+    TEST_ASSERT_FALSE(NMEAFramer::isType("$GPGSV,1*4A", 11, "GGA"));
+    TEST_ASSERT_FALSE(NMEAFramer::isType("$PUBX,40*4A", 11, "GGA"));
+    TEST_ASSERT_FALSE(NMEAFramer::isType("$GPGGA", 6, "GGA"));
+}
+
+/// Replay 3600 fixes worth of output through both ways of feeding TinyGPS++, in the reads GPS::whileActive() makes
+void test_replay_benchmark(void)
+{
+    std::string data;
+    for (int second = 0; second < 60; second++)
+        data += epoch(second);
+    const int repeats = 60;
+    const size_t sentences = 10 * 60 * repeats;
+
+    TinyGPSPlus everyChar;
+    clock_t cpu = clock();
+    uint32_t start = micros();
+    for (int r = 0; r < repeats; r++) {
+        for (char c : data)
+            everyChar.encode(c);
+    }
+    uint32_t everyCharUs = micros() - start;
+    double everyCharCpu = (double)(clock() - cpu) / CLOCKS_PER_SEC;
+
+    TinyGPSPlus framed;
+    cpu = clock();
+    start = micros();
+    for (int r = 0; r < repeats; r++) {
+        for (size_t i = 0; i < data.size(); i += 64) {
+            size_t len = data.size() - i < 64 ? data.size() - i : 64;
+            framer->feed((const uint8_t *)data.data() + i, len, [&](const char *s, size_t sLen) {
+                if (!NMEAFramer::isType(s, sLen, "GGA") && !NMEAFramer::isType(s, sLen, "RMC") &&
+                    !NMEAFramer::isType(s, sLen, "GSA"))
+                    return;
+                for (size_t j = 0; j < sLen; j++)
+                    framed.encode(s[j]);
+                framed.encode('\r');
+                framed.encode('\n');
+            });
+        }
+    }
+    uint32_t framedUs = micros() - start;
+    double framedCpu = (double)(clock() - cpu) / CLOCKS_PER_SEC;
+
+    // Same answers either way
+    TEST_ASSERT_EQUAL(sentences, framer->getPassedChecksums());
+    TEST_ASSERT_EQUAL(0, framer->getFailedChecksums());
+    TEST_ASSERT_EQUAL(everyChar.location.lat() * 1e7, framed.location.lat() * 1e7);
+    TEST_ASSERT_EQUAL(everyChar.location.lng() * 1e7, framed.location.lng() * 1e7);
+    TEST_ASSERT_EQUAL(everyChar.time.value(), framed.time.value());
+    TEST_ASSERT_EQUAL(everyChar.satellites.value(), framed.satellites.value());
+    TEST_ASSERT_EQUAL(59, framed.time.second());
+
+    printf("Every char to TinyGPS++: %.0f sentences/s, %.3f s CPU\n", sentences * 1e6 / everyCharUs, everyCharCpu);
+    printf("Framed, 4 of 10 sentences to TinyGPS++: %.0f sentences/s, %.3f s CPU\n", sentences * 1e6 / framedUs, framedCpu);
+}
+
+void setup()
+{
+    // NOTE!!! Wait for >2 secs
+    // if board doesn't support software reset via Serial.DTR/RTS
+    delay(10);
+    delay(2000);
+
+    initializeTestEnvironment();
+    UNITY_BEGIN(); // IMPORTANT LINE!
+    RUN_TEST(test_whole_sentences_are_not_copied);
+    RUN_TEST(test_sentence_split_across_reads);
+    RUN_TEST(test_bad_checksums_are_dropped);
+    RUN_TEST(test_ubx_between_sentences_is_skipped);
+    RUN_TEST(test_cut_short_sentence);
+    RUN_TEST(test_overlong_sentence_is_dropped);
+    RUN_TEST(test_sentence_types);
+    RUN_TEST(test_replay_benchmark);
+    exit(UNITY_END()); // stop unit testing
+}
+
+void loop() {}
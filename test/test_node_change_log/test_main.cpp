@@ -0,0 +1,119 @@
+#include "TestUtil.h"
+#include "mesh/NodeChangeLog.h"
+#include <unity.h>
+#include <vector>
+
+static NodeChangeLog *changeLog;
+
+static std::vector<NodeNum> removedSince(uint32_t since)
+{
+    std::vector<NodeNum> nums;
+    uint32_t readIndex = 0;
+    NodeNum num;
+    while (changeLog->readNextTombstone(readIndex, since, num))
+        nums.push_back(num);
+    return nums;
+}
+
+void setUp(void)
+{
+    changeLog = new NodeChangeLog(1000);
+}
+
+void tearDown(void)
+{
+    delete changeLog;
+}
+
+void test_untouched_nodes_are_unchanged(void)
+{
+    TEST_ASSERT_EQUAL(1000, changeLog->version());
+    TEST_ASSERT_TRUE(changeLog->canSyncSince(1000));
+    TEST_ASSERT_FALSE(changeLog->changedSince(1, 1000));
+    // A client that never synced with this boot sees every node as changed
+    TEST_ASSERT_FALSE(changeLog->canSyncSince(999));
+    TEST_ASSERT_TRUE(changeLog->changedSince(1, 999));
+}
+
+void test_touch(void)
+{
+    uint32_t synced = changeLog->version();
+    changeLog->touch(1);
+    changeLog->touch(2);
+    uint32_t later = changeLog->version();
+    changeLog->touch(2);
+
+    TEST_ASSERT_TRUE(changeLog->changedSince(1, synced));
+    TEST_ASSERT_TRUE(changeLog->changedSince(2, synced));
+    TEST_ASSERT_FALSE(changeLog->changedSince(3, synced));
+    TEST_ASSERT_FALSE(changeLog->changedSince(1, later));
+    TEST_ASSERT_TRUE(changeLog->changedSince(2, later));
+    TEST_ASSERT_FALSE(changeLog->changedSince(2, changeLog->version()));
+
+    // Versions from the future are from another boot
+    TEST_ASSERT_FALSE(changeLog->canSyncSince(changeLog->version() + 1));
+}
+
+void test_tombstones(void)
+{
+    changeLog->touch(1);
+    changeLog->touch(2);
+    uint32_t synced = changeLog->version();
+    changeLog->remove(1);
+    changeLog->remove(3);
+
+    std::vector<NodeNum> removed = removedSince(synced);
+    TEST_ASSERT_EQUAL(2, removed.size());
+    TEST_ASSERT_EQUAL(1, removed[0]);
+    TEST_ASSERT_EQUAL(3, removed[1]);
+    TEST_ASSERT_EQUAL(0, removedSince(changeLog->version()).size());
+}
+
+void test_tombstone_overflow_moves_floor(void)
+{
+    uint32_t synced = changeLog->version();
+    changeLog->remove(1);
+    uint32_t afterFirst = changeLog->version();
+    for (NodeNum n = 2; n <= NODE_TOMBSTONES + 1; n++)
+        changeLog->remove(n);
+
+    // The first removal fell off the ring, so a client from before it has to fetch everything
+    TEST_ASSERT_FALSE(changeLog->canSyncSince(synced));
+    TEST_ASSERT_TRUE(changeLog->canSyncSince(afterFirst));
+    std::vector<NodeNum> removed = removedSince(afterFirst);
+    TEST_ASSERT_EQUAL(NODE_TOMBSTONES, removed.size());
+    TEST_ASSERT_EQUAL(2, removed.front());
+    TEST_ASSERT_EQUAL(NODE_TOMBSTONES + 1, removed.back());
+}
+
+void test_reset(void)
+{
+    changeLog->touch(1);
+    changeLog->remove(2);
+    uint32_t synced = changeLog->version();
+    changeLog->reset();
+
+    TEST_ASSERT_FALSE(changeLog->canSyncSince(synced));
+    TEST_ASSERT_TRUE(changeLog->canSyncSince(changeLog->version()));
+    TEST_ASSERT_EQUAL(0, removedSince(synced).size());
+    TEST_ASSERT_FALSE(changeLog->changedSince(1, changeLog->version()));
+}
+
+void setup()
+{
+    // NOTE!!! Wait for >2 secs
+    // if board doesn't support software reset via Serial.DTR/RTS
+    delay(10);
+    delay(2000);
+
+    initializeTestEnvironment();
+    UNITY_BEGIN(); // IMPORTANT LINE!
+    RUN_TEST(test_untouched_nodes_are_unchanged);
+    RUN_TEST(test_touch);
+    RUN_TEST(test_tombstones);
+    RUN_TEST(test_tombstone_overflow_moves_floor);
+    RUN_TEST(test_reset);
+    exit(UNITY_END()); // stop unit testing
+}
+
+void loop() {}
@@ -0,0 +1,253 @@
+#include "TestUtil.h"
+#include "mesh/NodeDB.h"
+#include "mesh/TypeConversions.h"
+#include "mesh/mesh-pb-constants.h"
+#include <unity.h>
+
+static const uint32_t DUMP_NODES = 250;
+
+static uint32_t seed = 1;
+
+static uint32_t nextRandom(uint32_t max)
+{
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 8) % max;
+}
+
+/// How PhoneAPI used to send a node, through a whole NodeInfo
+static size_t encodeViaNodeInfo(uint8_t *buf, const meshtastic_NodeInfoLite *lite)
+{
+    meshtastic_FromRadio fromRadio = meshtastic_FromRadio_init_zero;
+    fromRadio.which_payload_variant = meshtastic_FromRadio_node_info_tag;
+    fromRadio.node_info = TypeConversions::ConvertToNodeInfo(lite);
+    return pb_encode_to_bytes(buf, meshtastic_FromRadio_size, &meshtastic_FromRadio_msg, &fromRadio);
+}
+
+static void assertSameBytes(const meshtastic_NodeInfoLite *lite)
+{
+    uint8_t expected[meshtastic_FromRadio_size], actual[meshtastic_FromRadio_size];
+    size_t expectedLen = encodeViaNodeInfo(expected, lite);
+    size_t actualLen = TypeConversions::EncodeFromRadioNodeInfo(actual, sizeof(actual), lite);
+
+    TEST_ASSERT_GREATER_THAN(0, expectedLen);
+    TEST_ASSERT_EQUAL(expectedLen, actualLen);
+    TEST_ASSERT_EQUAL_MEMORY(expected, actual, expectedLen);
+}
+
+static meshtastic_NodeInfoLite makeFullNode(uint32_t num)
+{
+    meshtastic_NodeInfoLite lite = meshtastic_NodeInfoLite_init_default;
+    lite.num = num;
+    lite.snr = 6.25f;
+    lite.last_heard = 1700000000;
+    lite.channel = 2;
+    lite.via_mqtt = true;
+    lite.has_hops_away = true;
+    lite.hops_away = 3;
+    lite.is_favorite = true;
+    lite.is_ignored = true;
+    lite.bitfield = NODEINFO_BITFIELD_IS_KEY_MANUALLY_VERIFIED_MASK;
+
+    lite.has_user = true;
+    strcpy(lite.user.long_name, "Meshtastic 1a2b");
+    strcpy(lite.user.short_name, "1a2b");
+    for (uint8_t i = 0; i < sizeof(lite.user.macaddr); i++)
+        lite.user.macaddr[i] = 0xa0 + i;
+    lite.user.hw_model = meshtastic_HardwareModel_HELTEC_V3;
+    lite.user.role = meshtastic_Config_DeviceConfig_Role_ROUTER;
+    lite.user.is_licensed = true;
+    lite.user.public_key.size = 32;
+    for (uint8_t i = 0; i < 32; i++)
+        lite.user.public_key.bytes[i] = i * 7;
+    lite.user.has_is_unmessagable = true;
+    lite.user.is_unmessagable = true;
+
+    lite.has_position = true;
+    lite.position.latitude_i = 523456789;
+    lite.position.longitude_i = -12345678;
+    lite.position.altitude = 42;
+    lite.position.time = 1700000100;
+    lite.position.location_source = meshtastic_Position_LocSource_LOC_INTERNAL;
+
+    lite.has_device_metrics = true;
+    lite.device_metrics.has_battery_level = true;
+    lite.device_metrics.battery_level = 87;
+    lite.device_metrics.has_voltage = true;
+    lite.device_metrics.voltage = 3.95f;
+    lite.device_metrics.has_channel_utilization = true;
+    lite.device_metrics.channel_utilization = 12.5f;
+    lite.device_metrics.has_air_util_tx = true;
+    lite.device_metrics.air_util_tx = 1.5f;
+    lite.device_metrics.has_uptime_seconds = true;
+    lite.device_metrics.uptime_seconds = 86400;
+    return lite;
+}
+
+static meshtastic_NodeInfoLite makeRandomNode()
+{
+    meshtastic_NodeInfoLite lite = meshtastic_NodeInfoLite_init_default;
+    lite.num = nextRandom(4) ? nextRandom(0x7fffffff) * 2 + nextRandom(2) : 0;
+    lite.snr = nextRandom(3) ? ((int)nextRandom(400) - 200) / 4.0f : 0;
+    lite.last_heard = nextRandom(2) ? nextRandom(0x7fffffff) : 0;
+    lite.channel = nextRandom(2) ? nextRandom(8) : 0;
+    lite.via_mqtt = nextRandom(2);
+    lite.has_hops_away = nextRandom(2);
+    lite.hops_away = nextRandom(8);
+    lite.is_favorite = nextRandom(2);
+    lite.is_ignored = nextRandom(2);
+    lite.bitfield = nextRandom(4);
+
+    lite.has_user = nextRandom(2);
+    if (lite.has_user) {
+        uint32_t len = nextRandom(sizeof(lite.user.long_name));
+        for (uint32_t i = 0; i < len; i++)
+            lite.user.long_name[i] = 'a' + nextRandom(26);
+        len = nextRandom(sizeof(lite.user.short_name));
+        for (uint32_t i = 0; i < len; i++)
+            lite.user.short_name[i] = 'A' + nextRandom(26);
+        for (uint8_t i = 0; i < sizeof(lite.user.macaddr); i++)
+            lite.user.macaddr[i] = nextRandom(3) ? nextRandom(256) : 0;
+        lite.user.hw_model = (meshtastic_HardwareModel)(nextRandom(2) ? nextRandom(100) : 0);
+        lite.user.role = (meshtastic_Config_DeviceConfig_Role)nextRandom(12);
+        lite.user.is_licensed = nextRandom(2);
+        lite.user.public_key.size = nextRandom(2) ? 32 : 0;
+        for (uint8_t i = 0; i < lite.user.public_key.size; i++)
+            lite.user.public_key.bytes[i] = nextRandom(256);
+        lite.user.has_is_unmessagable = nextRandom(2);
+        lite.user.is_unmessagable = nextRandom(2);
+    }
+
+    lite.has_position = nextRandom(2);
+    if (lite.has_position) {
+        lite.position.latitude_i = nextRandom(2) ? (int32_t)nextRandom(1800000000) - 900000000 : 0;
+        lite.position.longitude_i = nextRandom(2) ? (int32_t)nextRandom(1800000000) - 900000000 : 0;
+        lite.position.altitude = nextRandom(2) ? (int32_t)nextRandom(9000) - 500 : 0;
+        lite.position.time = nextRandom(2) ? nextRandom(0x7fffffff) : 0;
+        lite.position.location_source = (meshtastic_Position_LocSource)nextRandom(4);
+    }
+
+    lite.has_device_metrics = nextRandom(2);
+    if (lite.has_device_metrics) {
+        lite.device_metrics.has_battery_level = nextRandom(2);
+        lite.device_metrics.battery_level = nextRandom(102);
+        lite.device_metrics.has_voltage = nextRandom(2);
+        lite.device_metrics.voltage = nextRandom(450) / 100.0f;
+        lite.device_metrics.has_uptime_seconds = nextRandom(2);
+        lite.device_metrics.uptime_seconds = nextRandom(0x7fffffff);
+    }
+    return lite;
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+/// What PhoneAPI sends for a node that was removed
+void test_num_only(void)
+{
+    meshtastic_NodeInfoLite lite = meshtastic_NodeInfoLite_init_default;
+    assertSameBytes(&lite);
+    lite.num = 0x12345678;
+    assertSameBytes(&lite);
+}
+
+void test_full_node(void)
+{
+    meshtastic_NodeInfoLite lite = makeFullNode(0xdeadbeef);
+    assertSameBytes(&lite);
+}
+
+/// Coordinates of zero and empty strings are left out, as ConvertToNodeInfo leaves their has_ flags clear
+void test_zero_and_empty_fields(void)
+{
+    meshtastic_NodeInfoLite lite = makeFullNode(0x1234);
+    lite.position.latitude_i = 0;
+    lite.position.altitude = 0;
+    lite.position.time = 0;
+    lite.user.long_name[0] = '\0';
+    lite.user.public_key.size = 0;
+    lite.user.is_unmessagable = false; // Still sent, has_is_unmessagable is set
+    lite.device_metrics.has_voltage = false;
+    lite.hops_away = 0; // Still sent, has_hops_away is set
+    assertSameBytes(&lite);
+
+    lite.position = meshtastic_PositionLite_init_default;
+    lite.device_metrics = meshtastic_DeviceMetrics_init_default;
+    assertSameBytes(&lite); // Empty submessages are sent while their has_ flag is set
+}
+
+void test_negative_values(void)
+{
+    meshtastic_NodeInfoLite lite = makeFullNode(0xffffffff);
+    lite.position.altitude = -120;
+    lite.position.latitude_i = -1;
+    lite.snr = -20.75f;
+    assertSameBytes(&lite);
+
+    lite.snr = -0.0f; // Not the default to nanopb, it compares the bytes
+    assertSameBytes(&lite);
+}
+
+void test_random_nodes(void)
+{
+    seed = 1;
+    for (int i = 0; i < 1000; i++) {
+        meshtastic_NodeInfoLite lite = makeRandomNode();
+        assertSameBytes(&lite);
+    }
+}
+
+void test_unterminated_string_fails(void)
+{
+    meshtastic_NodeInfoLite lite = makeFullNode(0x1234);
+    memset(lite.user.short_name, 'x', sizeof(lite.user.short_name));
+    uint8_t buf[meshtastic_FromRadio_size];
+    TEST_ASSERT_EQUAL(0, TypeConversions::EncodeFromRadioNodeInfo(buf, sizeof(buf), &lite));
+}
+
+/// The time to send a whole NodeDB to a client both ways
+void test_full_dump_benchmark(void)
+{
+    static meshtastic_NodeInfoLite nodes[DUMP_NODES];
+    for (uint32_t i = 0; i < DUMP_NODES; i++)
+        nodes[i] = makeFullNode(0x10000 + i);
+
+    uint8_t buf[meshtastic_FromRadio_size];
+    size_t viaNodeInfoBytes = 0, directBytes = 0;
+    uint32_t start = micros();
+    for (uint32_t i = 0; i < DUMP_NODES; i++)
+        viaNodeInfoBytes += encodeViaNodeInfo(buf, &nodes[i]);
+    uint32_t viaNodeInfoUs = micros() - start;
+
+    start = micros();
+    for (uint32_t i = 0; i < DUMP_NODES; i++) {
+        meshtastic_NodeInfoLite forPhone = nodes[i]; // PhoneAPI keeps a copy between available() and getFromRadio()
+        directBytes += TypeConversions::EncodeFromRadioNodeInfo(buf, sizeof(buf), &forPhone);
+    }
+    uint32_t directUs = micros() - start;
+
+    printf("%u nodes, %u bytes: via NodeInfo %u us, from NodeInfoLite %u us\n", DUMP_NODES, (unsigned)directBytes,
+           viaNodeInfoUs, directUs);
+    TEST_ASSERT_EQUAL(viaNodeInfoBytes, directBytes);
+}
+
+void setup()
+{
+    // NOTE!!! Wait for >2 secs
+    // if board doesn't support software reset via Serial.DTR/RTS
+    delay(10);
+    delay(2000);
+
+    initializeTestEnvironment();
+    UNITY_BEGIN(); // IMPORTANT LINE!
+    RUN_TEST(test_num_only);
+    RUN_TEST(test_full_node);
+    RUN_TEST(test_zero_and_empty_fields);
+    RUN_TEST(test_negative_values);
+    RUN_TEST(test_random_nodes);
+    RUN_TEST(test_unterminated_string_fails);
+    RUN_TEST(test_full_dump_benchmark);
+    exit(UNITY_END()); // stop unit testing
+}
+
+void loop() {}
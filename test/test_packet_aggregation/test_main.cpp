@@ -0,0 +1,184 @@
+#include "TestUtil.h"
+#include "mesh/AggregateFrame.h"
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+#include <vector>
+
+// LongFast: SF11, 250 kHz, coding rate 4/5, 16 symbol preamble, explicit header and CRC
+static const int SF = 11;
+static const float SYMBOL_MSEC = (1 << SF) / 250.0f;
+static const int PREAMBLE_SYMBOLS = 16;
+static const int HEADER_LEN = 16;            // PacketHeader
+static const int DATA_OVERHEAD = 8;          // The container's portnum, payload length and bitfield
+static const float CONTENTION_MSEC = 4 * 60; // Mean wait of the smallest contention window of RadioInterface
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+/// Time on air of a LoRa frame of len bytes, as in the Semtech datasheets
+static float airtimeMsec(int len)
+{
+    float symbols = ceilf((8.0f * len - 4 * SF + 28 + 16) / (4 * SF)) * 5;
+    return (PREAMBLE_SYMBOLS + 4.25f + 8 + (symbols > 0 ? symbols : 0)) * SYMBOL_MSEC;
+}
+
+void test_records_round_trip(void)
+{
+    uint8_t a[] = {1, 2, 3}, b[AGGREGATE_MAX_PACKET_LEN];
+    memset(b, 0x5a, sizeof(b));
+    AggregateRecord in[] = {{0xffffffff, 0x12345678, 0, 8, sizeof(a), a}, {0xabcd0102, 0xfedcba98, 0x42, 8, sizeof(b), b}};
+
+    uint8_t frame[AGGREGATE_MAX_FRAME_LEN];
+    size_t len = 0;
+    TEST_ASSERT_TRUE(AggregateFrame::append(frame, len, sizeof(frame), in[0]));
+    TEST_ASSERT_TRUE(AggregateFrame::append(frame, len, sizeof(frame), in[1]));
+    TEST_ASSERT_EQUAL(2 * AggregateFrame::RECORD_HEADER_LEN + sizeof(a) + sizeof(b), len);
+
+    AggregateRecord out = {};
+    size_t offset = 0;
+    for (const AggregateRecord &r : in) {
+        TEST_ASSERT_TRUE(AggregateFrame::next(frame, len, offset, out));
+        TEST_ASSERT_EQUAL_HEX32(r.to, out.to);
+        TEST_ASSERT_EQUAL_HEX32(r.id, out.id);
+        TEST_ASSERT_EQUAL(r.nextHop, out.nextHop);
+        TEST_ASSERT_EQUAL(r.channelHash, out.channelHash);
+        TEST_ASSERT_EQUAL(r.size, out.size);
+        TEST_ASSERT_EQUAL_MEMORY(r.bytes, out.bytes, r.size);
+    }
+    TEST_ASSERT_FALSE(AggregateFrame::next(frame, len, offset, out));
+}
+
+void test_full_or_truncated_frames(void)
+{
+    uint8_t bytes[AGGREGATE_MAX_PACKET_LEN] = {};
+    AggregateRecord r = {0xffffffff, 1, 0, 8, sizeof(bytes), bytes};
+    uint8_t frame[AGGREGATE_MAX_FRAME_LEN];
+    size_t len = 0;
+    TEST_ASSERT_TRUE(AggregateFrame::append(frame, len, sizeof(frame), r));
+    TEST_ASSERT_TRUE(AggregateFrame::append(frame, len, sizeof(frame), r));
+    TEST_ASSERT_FALSE(AggregateFrame::append(frame, len, sizeof(frame), r));
+    TEST_ASSERT_EQUAL(2 * (AggregateFrame::RECORD_HEADER_LEN + sizeof(bytes)), len);
+
+    // A frame cut short yields the whole records before the cut and nothing after
+    AggregateRecord out = {};
+    size_t offset = 0;
+    TEST_ASSERT_TRUE(AggregateFrame::next(frame, len - 1, offset, out));
+    TEST_ASSERT_FALSE(AggregateFrame::next(frame, len - 1, offset, out));
+    TEST_ASSERT_EQUAL(AggregateFrame::RECORD_HEADER_LEN + sizeof(bytes), offset);
+}
+
+struct SimPacket {
+    uint32_t atMsec;
+    uint8_t size; // Encrypted
+};
+
+/**
+ * What a busy node sends in an hour: routing acks and nodeinfo replies for what it hears, often both at once, plus its
+ * own position and telemetry, which modules tend to send in the same loop pass.
+ */
+static std::vector<SimPacket> simulateTraffic(uint32_t seed)
+{
+    std::vector<SimPacket> packets;
+    uint32_t rng = seed;
+    auto next = [&rng]() { return (rng = rng * 1664525 + 1013904223) >> 8; };
+    for (uint32_t t = 0; t < 3600 * 1000;) {
+        t += 5000 + next() % 40000;
+        packets.push_back({t, 12}); // Ack
+        if (next() % 3 == 0)
+            packets.push_back({t + 20 + next() % 200, 88}); // NodeInfo reply with a public key
+    }
+    for (uint32_t t = 0; t < 3600 * 1000; t += 15 * 60 * 1000) {
+        packets.push_back({t + 100, 36}); // Position
+        packets.push_back({t + 150 + next() % 300, 30}); // Device telemetry
+        packets.push_back({t + 150 + next() % 300, 28}); // Environment telemetry
+    }
+    std::sort(packets.begin(), packets.end(), [](const SimPacket &a, const SimPacket &b) { return a.atMsec < b.atMsec; });
+    return packets;
+}
+
+struct SimResult {
+    float airtimeMsec;
+    uint32_t frames;
+    float meanDelayMsec;
+};
+
+/// Send the packets as PacketAggregator would with the given window, 0 sends each as it comes
+static SimResult simulateSending(const std::vector<SimPacket> &packets, uint32_t windowMsec)
+{
+    SimResult result = {0, 0, 0};
+    uint8_t frame[AGGREGATE_MAX_FRAME_LEN], bytes[AGGREGATE_MAX_PACKET_LEN] = {};
+    size_t len = 0, inFrame = 0, lastSize = 0;
+    uint32_t startedMsec = 0;
+
+    auto flush = [&]() {
+        result.airtimeMsec += CONTENTION_MSEC + airtimeMsec(HEADER_LEN + (inFrame > 1 ? len + DATA_OVERHEAD : lastSize));
+        result.frames++;
+        len = inFrame = 0;
+    };
+    for (const SimPacket &p : packets) {
+        if (inFrame && p.atMsec - startedMsec >= windowMsec)
+            flush();
+        AggregateRecord r = {0xffffffff, 0, 0, 8, p.size, bytes};
+        if (!AggregateFrame::append(frame, len, sizeof(frame), r)) {
+            flush();
+            AggregateFrame::append(frame, len, sizeof(frame), r);
+        }
+        if (!inFrame++)
+            startedMsec = p.atMsec;
+        lastSize = p.size;
+        result.meanDelayMsec += windowMsec - (p.atMsec - startedMsec);
+    }
+    if (inFrame)
+        flush();
+    result.meanDelayMsec /= packets.size();
+    return result;
+}
+
+void test_simulated_airtime_saved(void)
+{
+    const uint32_t windows[] = {0, 250, 500, 1000};
+    SimResult results[4] = {};
+    uint32_t numPackets = 0;
+    const uint32_t RUNS = 20;
+    for (uint32_t seed = 1; seed <= RUNS; seed++) {
+        std::vector<SimPacket> packets = simulateTraffic(seed);
+        numPackets += packets.size();
+        for (int i = 0; i < 4; i++) {
+            SimResult r = simulateSending(packets, windows[i]);
+            results[i].airtimeMsec += r.airtimeMsec / RUNS;
+            results[i].frames += r.frames;
+            results[i].meanDelayMsec += r.meanDelayMsec / RUNS;
+        }
+    }
+
+    printf("%u packets an hour:\n", numPackets / RUNS);
+    for (int i = 0; i < 4; i++)
+        printf("  window %4u ms: %3u frames, %5.1f s airtime (%4.1f%% saved), %3.0f ms mean added delay\n", windows[i],
+               results[i].frames / RUNS, results[i].airtimeMsec / 1000,
+               100 * (1 - results[i].airtimeMsec / results[0].airtimeMsec), results[i].meanDelayMsec);
+
+    TEST_ASSERT_EQUAL(numPackets, results[0].frames);
+    TEST_ASSERT_LESS_THAN(results[0].frames, results[2].frames);
+    TEST_ASSERT_LESS_THAN(results[0].airtimeMsec * 0.9, results[2].airtimeMsec);
+}
+
+void setup()
+{
+    // NOTE!!! Wait for >2 secs
+    // if board doesn't support software reset via Serial.DTR/RTS
+    delay(10);
+    delay(2000);
+
+    initializeTestEnvironment();
+    UNITY_BEGIN(); // IMPORTANT LINE!
+    RUN_TEST(test_records_round_trip);
+    RUN_TEST(test_full_or_truncated_frames);
+    RUN_TEST(test_simulated_airtime_saved);
+    exit(UNITY_END()); // stop unit testing
+}
+
+void loop() {}
@@ -0,0 +1,165 @@
+#include "TestUtil.h"
+#include "mesh-pb-constants.h"
+#include "mesh/PhoneQueue.h"
+#include <unity.h>
+#include <vector>
+
+static const size_t CAPACITY = 8;
+
+static PhoneQueue *queue;
+static std::vector<meshtastic_MeshPacket *> allocated;
+
+static meshtastic_MeshPacket *makePacket(NodeNum from, meshtastic_PortNum port, PacketId id = 0)
+{
+    meshtastic_MeshPacket *p = new meshtastic_MeshPacket();
+    *p = meshtastic_MeshPacket_init_zero;
+    p->which_payload_variant = meshtastic_MeshPacket_decoded_tag;
+    p->from = from;
+    p->id = id;
+    p->decoded.portnum = port;
+    allocated.push_back(p);
+    return p;
+}
+
+static meshtastic_MeshPacket *makeTelemetry(NodeNum from, pb_size_t variant)
+{
+    meshtastic_MeshPacket *p = makePacket(from, meshtastic_PortNum_TELEMETRY_APP);
+    meshtastic_Telemetry t = meshtastic_Telemetry_init_zero;
+    t.which_variant = variant;
+    p->decoded.payload.size =
+        pb_encode_to_bytes(p->decoded.payload.bytes, sizeof(p->decoded.payload.bytes), &meshtastic_Telemetry_msg, &t);
+    return p;
+}
+
+static uint32_t droppedOn(meshtastic_PortNum port, bool coalesced)
+{
+    PhoneQueue::PortStats stats[PHONE_QUEUE_STAT_PORTS];
+    size_t n = queue->getStats(stats, PHONE_QUEUE_STAT_PORTS);
+    for (size_t i = 0; i < n; i++) {
+        if (stats[i].port == port)
+            return coalesced ? stats[i].coalesced : stats[i].dropped;
+    }
+    return 0;
+}
+
+void setUp(void)
+{
+    queue = new PhoneQueue(CAPACITY);
+}
+
+void tearDown(void)
+{
+    delete queue;
+    for (meshtastic_MeshPacket *p : allocated)
+        delete p;
+    allocated.clear();
+}
+
+void test_fifo(void)
+{
+    meshtastic_MeshPacket *a = makePacket(1, meshtastic_PortNum_TEXT_MESSAGE_APP);
+    meshtastic_MeshPacket *b = makePacket(2, meshtastic_PortNum_POSITION_APP);
+    TEST_ASSERT_NULL(queue->enqueue(a));
+    TEST_ASSERT_NULL(queue->enqueue(b));
+    TEST_ASSERT_EQUAL_PTR(a, queue->dequeue());
+    TEST_ASSERT_EQUAL_PTR(b, queue->dequeue());
+    TEST_ASSERT_NULL(queue->dequeue());
+    TEST_ASSERT_TRUE(queue->isEmpty());
+}
+
+void test_coalesce_position(void)
+{
+    meshtastic_MeshPacket *text = makePacket(1, meshtastic_PortNum_TEXT_MESSAGE_APP);
+    meshtastic_MeshPacket *old = makePacket(1, meshtastic_PortNum_POSITION_APP);
+    meshtastic_MeshPacket *other = makePacket(2, meshtastic_PortNum_POSITION_APP);
+    meshtastic_MeshPacket *newer = makePacket(1, meshtastic_PortNum_POSITION_APP);
+    queue->enqueue(old);
+    queue->enqueue(text);
+    queue->enqueue(other);
+
+    // The newer position takes the place of the old one
+    TEST_ASSERT_EQUAL_PTR(old, queue->enqueue(newer));
+    TEST_ASSERT_EQUAL(3, queue->numUsed());
+    TEST_ASSERT_EQUAL_PTR(newer, queue->dequeue());
+    TEST_ASSERT_EQUAL(1, droppedOn(meshtastic_PortNum_POSITION_APP, true));
+    // Nothing was lost, so there are no drops to warn the client about
+    TEST_ASSERT_EQUAL(0, queue->getTotalDropped());
+    TEST_ASSERT_EQUAL(1, queue->getTotalCoalesced());
+}
+
+void test_coalesce_telemetry_per_variant(void)
+{
+    queue->enqueue(makeTelemetry(1, meshtastic_Telemetry_device_metrics_tag));
+    TEST_ASSERT_NULL(queue->enqueue(makeTelemetry(1, meshtastic_Telemetry_environment_metrics_tag)));
+    TEST_ASSERT_NOT_NULL(queue->enqueue(makeTelemetry(1, meshtastic_Telemetry_device_metrics_tag)));
+    TEST_ASSERT_EQUAL(2, queue->numUsed());
+}
+
+void test_text_never_dropped_for_other_traffic(void)
+{
+    for (size_t i = 0; i < CAPACITY / 2; i++)
+        TEST_ASSERT_NULL(queue->enqueue(makePacket(100 + i, meshtastic_PortNum_TEXT_MESSAGE_APP)));
+    // Positions from distinct nodes fill their half of the queue, then push out their own oldest
+    for (size_t i = 0; i < CAPACITY; i++)
+        queue->enqueue(makePacket(200 + i, meshtastic_PortNum_POSITION_APP));
+    TEST_ASSERT_EQUAL(CAPACITY, queue->numUsed());
+    TEST_ASSERT_EQUAL(CAPACITY / 2, droppedOn(meshtastic_PortNum_POSITION_APP, false));
+
+    // A full queue makes room for text by dropping positions, never text
+    TEST_ASSERT_EQUAL(meshtastic_PortNum_POSITION_APP,
+                      queue->enqueue(makePacket(300, meshtastic_PortNum_TEXT_MESSAGE_APP))->decoded.portnum);
+    TEST_ASSERT_EQUAL(0, droppedOn(meshtastic_PortNum_TEXT_MESSAGE_APP, false));
+
+    // Other traffic can't push out text
+    for (size_t i = 0; i < CAPACITY; i++)
+        queue->enqueue(makePacket(400, meshtastic_PortNum_TEXT_MESSAGE_APP));
+    meshtastic_MeshPacket *other = makePacket(500, meshtastic_PortNum_PRIVATE_APP);
+    TEST_ASSERT_EQUAL_PTR(other, queue->enqueue(other));
+    TEST_ASSERT_EQUAL(1, droppedOn(meshtastic_PortNum_PRIVATE_APP, false));
+}
+
+void test_find_destination(void)
+{
+    meshtastic_MeshPacket *p = makePacket(1, meshtastic_PortNum_ROUTING_APP, 42);
+    p->to = 7;
+    queue->enqueue(p);
+    TEST_ASSERT_EQUAL(7, queue->findDestination(42));
+    TEST_ASSERT_EQUAL(0, queue->findDestination(43));
+    TEST_ASSERT_EQUAL(1, queue->numUsed());
+}
+
+/// Class budgets keep working for queues of more than 255 packets
+void test_large_capacity(void)
+{
+    PhoneQueue large(600);
+    for (NodeNum i = 0; i < 300; i++)
+        TEST_ASSERT_NULL(large.enqueue(makePacket(1000 + i, meshtastic_PortNum_POSITION_APP)));
+    TEST_ASSERT_EQUAL(300, large.numUsed());
+    TEST_ASSERT_EQUAL(0, large.getTotalDropped());
+
+    // The state half of the queue is full now, so the next position pushes out the oldest one
+    meshtastic_MeshPacket *evicted = large.enqueue(makePacket(2000, meshtastic_PortNum_POSITION_APP));
+    TEST_ASSERT_NOT_NULL(evicted);
+    TEST_ASSERT_EQUAL(1000, evicted->from);
+    TEST_ASSERT_EQUAL(1, large.getTotalDropped());
+}
+
+void setup()
+{
+    // NOTE!!! Wait for >2 secs
+    // if board doesn't support software reset via Serial.DTR/RTS
+    delay(10);
+    delay(2000);
+
+    initializeTestEnvironment();
+    UNITY_BEGIN(); // IMPORTANT LINE!
+    RUN_TEST(test_fifo);
+    RUN_TEST(test_coalesce_position);
+    RUN_TEST(test_coalesce_telemetry_per_variant);
+    RUN_TEST(test_text_never_dropped_for_other_traffic);
+    RUN_TEST(test_find_destination);
+    RUN_TEST(test_large_capacity);
+    exit(UNITY_END()); // stop unit testing
+}
+
+void loop() {}
@@ -0,0 +1,209 @@
+#include "TestUtil.h"
+#include "mesh/RebroadcastSuppression.h"
+#include <math.h>
+#include <queue>
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+#include <vector>
+
+// Radio timing close to a LongFast packet, with the contention window of RadioInterface
+static const uint32_t AIRTIME_MSEC = 400;
+static const uint32_t SLOT_MSEC = 60;
+static const uint8_t CW_MIN = 3;
+static const uint8_t CW_MAX = 8;
+static const uint8_t HOP_LIMIT = 3;
+static const uint8_t RELAYERS_KEPT = 3; // NUM_RELAYERS in PacketHistory
+
+enum Policy { CANCEL_ON_DUPE, COUNT_RELAYERS };
+
+struct SimNode {
+    float x, y;
+    bool router;
+    bool heard;
+    bool queued;
+    bool cancelled;
+    uint8_t relayers[RELAYERS_KEPT]; // Most recent first, node index + 1, like PacketRecord::relayed_by
+};
+
+struct SimEvent {
+    uint32_t at;
+    int node;
+    int from; // -1 for our own transmission
+    uint8_t hopLimit;
+    bool operator<(const SimEvent &o) const { return at > o.at; }
+};
+
+struct SimResult {
+    float reach;
+    uint32_t transmissions;
+};
+
+static uint32_t rng;
+
+static uint32_t nextRandom()
+{
+    rng = rng * 1664525 + 1013904223;
+    return rng >> 8;
+}
+
+static void addRelayer(SimNode &n, int relayer)
+{
+    uint8_t id = relayer + 1;
+    uint8_t merged[RELAYERS_KEPT] = {id};
+    uint8_t j = 1;
+    for (uint8_t i = 0; i < RELAYERS_KEPT && j < RELAYERS_KEPT; i++)
+        if (n.relayers[i] && n.relayers[i] != id)
+            merged[j++] = n.relayers[i];
+    memcpy(n.relayers, merged, sizeof(merged));
+}
+
+static uint8_t countOtherRelayers(const SimNode &n, int self)
+{
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < RELAYERS_KEPT; i++)
+        if (n.relayers[i] && n.relayers[i] != self + 1)
+            count++;
+    return count;
+}
+
+/// The client delay of getTxDelayMsecWeighted(): weaker links wait less, so the farthest nodes relay first
+static uint32_t txDelay(bool router, float snr)
+{
+    float clamped = snr < -20 ? -20 : (snr > 10 ? 10 : snr);
+    uint8_t cw = CW_MIN + (uint8_t)((clamped + 20) * (CW_MAX - CW_MIN) / 30);
+    if (router)
+        return (nextRandom() % (2 * cw)) * SLOT_MSEC;
+    return 2 * CW_MAX * SLOT_MSEC + (nextRandom() % (1u << cw)) * SLOT_MSEC;
+}
+
+/**
+ * Flood one packet from the middle of a random mesh. There are no collisions or fading: every node within range hears
+ * every transmission, so this compares how many rebroadcasts each policy spends for how many nodes it reaches.
+ */
+static SimResult simulate(Policy policy, int numNodes, float side, float range, float channelUtil, uint32_t seed)
+{
+    rng = seed;
+    std::vector<SimNode> nodes(numNodes);
+    for (int i = 0; i < numNodes; i++) {
+        nodes[i] = {};
+        nodes[i].x = i ? side * (nextRandom() % 10000) / 10000 : side / 2;
+        nodes[i].y = i ? side * (nextRandom() % 10000) / 10000 : side / 2;
+        nodes[i].router = nextRandom() % 10 == 0;
+    }
+
+    std::priority_queue<SimEvent> events;
+    uint32_t transmissions = 0;
+    nodes[0].heard = true;
+    events.push({0, 0, -1, HOP_LIMIT});
+
+    while (!events.empty()) {
+        SimEvent e = events.top();
+        events.pop();
+        SimNode &n = nodes[e.node];
+
+        if (e.from < 0) { // Our turn to transmit, unless cancelled while we waited
+            if (n.cancelled)
+                continue;
+            transmissions++;
+            for (int j = 0; j < numNodes; j++) {
+                float d = hypotf(nodes[j].x - n.x, nodes[j].y - n.y);
+                if (j != e.node && d <= range)
+                    events.push({e.at + AIRTIME_MSEC, j, e.node, e.hopLimit});
+            }
+            continue;
+        }
+
+        addRelayer(n, e.from);
+        if (!n.heard) {
+            n.heard = true;
+            if (e.hopLimit > 0) {
+                float d = hypotf(nodes[e.from].x - n.x, nodes[e.from].y - n.y);
+                n.queued = true;
+                addRelayer(n, e.node); // Queueing our copy records us as a relayer too
+                events.push({e.at + txDelay(n.router, 10 - 30 * d / range), e.node, -1, (uint8_t)(e.hopLimit - 1)});
+            }
+        } else if (n.queued && !n.cancelled) {
+            if (policy == CANCEL_ON_DUPE) {
+                n.cancelled = !n.router;
+            } else {
+                uint8_t threshold = RebroadcastSuppression::getThreshold(channelUtil, n.router);
+                n.cancelled = threshold && countOtherRelayers(n, e.node) >= threshold;
+            }
+        }
+    }
+
+    int reached = 0;
+    for (const SimNode &n : nodes)
+        reached += n.heard;
+    return {(float)reached / numNodes, transmissions};
+}
+
+static void compare(const char *name, int numNodes, float side, float range, float channelUtil, SimResult &dupe,
+                    SimResult &counted)
+{
+    const uint32_t RUNS = 20;
+    dupe = counted = {0, 0};
+    for (uint32_t seed = 1; seed <= RUNS; seed++) {
+        SimResult a = simulate(CANCEL_ON_DUPE, numNodes, side, range, channelUtil, seed);
+        SimResult b = simulate(COUNT_RELAYERS, numNodes, side, range, channelUtil, seed);
+        dupe.reach += a.reach / RUNS;
+        dupe.transmissions += a.transmissions;
+        counted.reach += b.reach / RUNS;
+        counted.transmissions += b.transmissions;
+    }
+    dupe.transmissions /= RUNS;
+    counted.transmissions /= RUNS;
+    printf("%s, %d nodes at %.0f%% channel use:\n", name, numNodes, channelUtil);
+    printf("  cancel on first dupe: reach %.1f%%, %u rebroadcasts, %.1f s airtime\n", dupe.reach * 100, dupe.transmissions,
+           dupe.transmissions * AIRTIME_MSEC / 1000.0);
+    printf("  count relayers:       reach %.1f%%, %u rebroadcasts, %.1f s airtime\n", counted.reach * 100,
+           counted.transmissions, counted.transmissions * AIRTIME_MSEC / 1000.0);
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_threshold_adapts_to_channel_use(void)
+{
+    TEST_ASSERT_EQUAL(3, RebroadcastSuppression::getThreshold(2, false));
+    TEST_ASSERT_EQUAL(2, RebroadcastSuppression::getThreshold(40, false));
+    TEST_ASSERT_EQUAL(0, RebroadcastSuppression::getThreshold(2, true));
+    TEST_ASSERT_EQUAL(0, RebroadcastSuppression::getThreshold(15, true));
+    TEST_ASSERT_EQUAL(3, RebroadcastSuppression::getThreshold(40, true));
+}
+
+/// A sparse rural mesh on a quiet channel: extra coverage matters more than airtime
+void test_sparse_mesh_keeps_reach(void)
+{
+    SimResult dupe, counted;
+    compare("Sparse", 60, 8, 1.5, 5, dupe, counted);
+    TEST_ASSERT_GREATER_OR_EQUAL(dupe.reach * 1000, counted.reach * 1000);
+}
+
+/// A dense event mesh on a busy channel with many nodes wrongly set as routers
+void test_dense_mesh_saves_airtime(void)
+{
+    SimResult dupe, counted;
+    compare("Dense", 300, 4, 1.5, 35, dupe, counted);
+    TEST_ASSERT_LESS_THAN(dupe.transmissions, counted.transmissions);
+    TEST_ASSERT_GREATER_OR_EQUAL(dupe.reach * 0.98 * 1000, counted.reach * 1000);
+}
+
+void setup()
+{
+    // NOTE!!! Wait for >2 secs
+    // if board doesn't support software reset via Serial.DTR/RTS
+    delay(10);
+    delay(2000);
+
+    initializeTestEnvironment();
+    UNITY_BEGIN(); // IMPORTANT LINE!
+    RUN_TEST(test_threshold_adapts_to_channel_use);
+    RUN_TEST(test_sparse_mesh_keeps_reach);
+    RUN_TEST(test_dense_mesh_saves_airtime);
+    exit(UNITY_END()); // stop unit testing
+}
+
+void loop() {}
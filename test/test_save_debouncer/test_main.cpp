@@ -0,0 +1,85 @@
+#include "TestUtil.h"
+#include "mesh/NodeDB.h"
+#include "mesh/SaveDebouncer.h"
+#include <unity.h>
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_nothing_pending(void)
+{
+    SaveDebouncer d;
+    TEST_ASSERT_EQUAL(-1, d.getDelay(1000));
+    TEST_ASSERT_EQUAL(0, d.takeDue(1000));
+    d.mark(0, 1000);
+    TEST_ASSERT_EQUAL(-1, d.getDelay(1000));
+}
+
+/// Fifty favourites toggled one after another are saved once, after the client stops
+void test_burst_is_saved_once(void)
+{
+    SaveDebouncer d;
+    uint32_t now = 1000;
+    int saves = 0;
+    for (int i = 0; i < 50; i++) {
+        d.mark(SEGMENT_NODEDATABASE, now);
+        now += 200;
+        if (d.takeDue(now))
+            saves++;
+    }
+    TEST_ASSERT_EQUAL(0, saves);
+    TEST_ASSERT_EQUAL(SAVE_DEBOUNCE_MS - 200, d.getDelay(now));
+    TEST_ASSERT_EQUAL(0, d.takeDue(now + SAVE_DEBOUNCE_MS - 201));
+    TEST_ASSERT_EQUAL(SEGMENT_NODEDATABASE, d.takeDue(now + SAVE_DEBOUNCE_MS - 200));
+    TEST_ASSERT_EQUAL(-1, d.getDelay(now + SAVE_DEBOUNCE_MS));
+}
+
+/// Changes that never stop are still saved, SAVE_MAX_DELAY_MS after the first one
+void test_max_delay(void)
+{
+    SaveDebouncer d;
+    uint32_t first = UINT32_MAX - 1000; // Across millis() wrapping around
+    uint32_t now = first;
+    d.mark(SEGMENT_NODEDATABASE, now);
+    while (now - first < SAVE_MAX_DELAY_MS - SAVE_DEBOUNCE_MS / 2) {
+        now += SAVE_DEBOUNCE_MS / 2;
+        d.mark(SEGMENT_DEVICESTATE, now);
+        TEST_ASSERT_EQUAL(0, d.takeDue(now));
+    }
+    TEST_ASSERT_EQUAL(SAVE_MAX_DELAY_MS - (now - first), d.getDelay(now));
+    TEST_ASSERT_EQUAL(SEGMENT_NODEDATABASE | SEGMENT_DEVICESTATE, d.takeDue(first + SAVE_MAX_DELAY_MS));
+}
+
+void test_saved_elsewhere(void)
+{
+    SaveDebouncer d;
+    d.mark(SEGMENT_NODEDATABASE | SEGMENT_CONFIG, 0);
+    d.clear(SEGMENT_CONFIG);
+    TEST_ASSERT_EQUAL(SEGMENT_NODEDATABASE, d.getPending());
+    d.clear(SEGMENT_NODEDATABASE);
+    TEST_ASSERT_EQUAL(-1, d.getDelay(0));
+
+    // Cleared segments don't leave the next change waiting for less than the full debounce
+    d.mark(SEGMENT_CHANNELS, SAVE_MAX_DELAY_MS);
+    TEST_ASSERT_EQUAL(SAVE_DEBOUNCE_MS, d.getDelay(SAVE_MAX_DELAY_MS));
+    TEST_ASSERT_EQUAL(SEGMENT_CHANNELS, d.takeAll());
+}
+
+void setup()
+{
+    // NOTE!!! Wait for >2 secs
+    // if board doesn't support software reset via Serial.DTR/RTS
+    delay(10);
+    delay(2000);
+
+    initializeTestEnvironment();
+    UNITY_BEGIN(); // IMPORTANT LINE!
+    RUN_TEST(test_nothing_pending);
+    RUN_TEST(test_burst_is_saved_once);
+    RUN_TEST(test_max_delay);
+    RUN_TEST(test_saved_elsewhere);
+    exit(UNITY_END()); // stop unit testing
+}
+
+void loop() {}
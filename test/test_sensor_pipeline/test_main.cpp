@@ -0,0 +1,188 @@
+#include "TestUtil.h"
+#include "modules/Telemetry/SensorPipeline.h"
+#include <unity.h>
+
+static const uint32_t CONVERSION_MS = 50;
+static const uint32_t PERIOD_MS = 60 * 1000;
+
+/// Stands in for the I2C bus, every transaction takes a millisecond like a short transfer at 100kHz does
+struct MockI2C {
+    uint32_t transactions = 0;
+
+    void transfer()
+    {
+        transactions++;
+        delay(1);
+    }
+};
+
+static MockI2C bus;
+
+/// A sensor that converts for `conversionMs` after being triggered, like most of the ones we drive
+class MockSensor : public TelemetrySensor
+{
+  public:
+    float temperature;
+    float humidity;
+    bool fail = false;
+    uint32_t readyAt = 0;
+    uint32_t earlyReads = 0;
+
+    MockSensor(float temperature, float humidity)
+        : TelemetrySensor(meshtastic_TelemetrySensorType_SENSOR_UNSET, "Mock"), temperature(temperature), humidity(humidity)
+    {
+    }
+
+    virtual int32_t runOnce() override { return 0; }
+
+    // What drivers without a split API do: trigger, wait out the conversion, read
+    virtual bool getMetrics(meshtastic_Telemetry *measurement) override
+    {
+        startMeasurement();
+        delay(CONVERSION_MS);
+        return collectMetrics(measurement);
+    }
+
+    virtual uint32_t startMeasurement() override
+    {
+        bus.transfer();
+        readyAt = millis() + CONVERSION_MS;
+        return CONVERSION_MS;
+    }
+
+    virtual bool collectMetrics(meshtastic_Telemetry *measurement) override
+    {
+        if ((int32_t)(millis() - readyAt) < 0)
+            earlyReads++;
+        bus.transfer();
+        measurement->variant.environment_metrics.has_temperature = true;
+        measurement->variant.environment_metrics.temperature = temperature;
+        measurement->variant.environment_metrics.has_relative_humidity = true;
+        measurement->variant.environment_metrics.relative_humidity = humidity;
+        return !fail;
+    }
+
+  protected:
+    virtual void setup() override {}
+};
+
+static SensorPipeline *pipeline;
+
+/// Drive the pipeline the way OSThread would, returns the time the whole round took
+static uint32_t runRound()
+{
+    uint32_t start = millis();
+    uint32_t wait = pipeline->step(millis(), PERIOD_MS);
+    while (pipeline->isBusy()) {
+        delay(wait);
+        wait = pipeline->step(millis(), PERIOD_MS);
+    }
+    return millis() - start;
+}
+
+void setUp(void)
+{
+    pipeline = new SensorPipeline();
+    bus.transactions = 0;
+}
+
+void tearDown(void)
+{
+    delete pipeline;
+}
+
+void test_loop_stall(void)
+{
+    MockSensor sensors[3] = {{20, 50}, {21, 51}, {22, 52}};
+    meshtastic_Telemetry m = meshtastic_Telemetry_init_zero;
+
+    // Before: reading one sensor after the other keeps the loop busy for the sum of the conversions
+    uint32_t start = millis();
+    for (MockSensor &s : sensors)
+        s.getMetrics(&m);
+    uint32_t sequentialMs = millis() - start;
+    TEST_ASSERT_GREATER_OR_EQUAL(3 * CONVERSION_MS, sequentialMs);
+
+    // After: conversions overlap, and no single step waits for one
+    for (MockSensor &s : sensors)
+        pipeline->add(&s);
+    uint32_t roundMs = runRound();
+    TEST_ASSERT_LESS_THAN(2 * CONVERSION_MS, roundMs);
+    TEST_ASSERT_LESS_THAN(CONVERSION_MS / 2, pipeline->getMaxStepMs());
+    for (MockSensor &s : sensors)
+        TEST_ASSERT_EQUAL(0, s.earlyReads);
+    TEST_ASSERT_EQUAL(12, bus.transactions);
+
+    TEST_ASSERT_TRUE(pipeline->getResult(&m));
+    TEST_ASSERT_EQUAL(meshtastic_Telemetry_environment_metrics_tag, m.which_variant);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 22, m.variant.environment_metrics.temperature);
+}
+
+void test_merge_order(void)
+{
+    MockSensor temperature(20, 40);
+    MockSensor humidity(30, 60);
+    pipeline->add(&temperature);
+    pipeline->add(&humidity, SensorPipeline::MERGE_HUMIDITY_ONLY);
+
+    TEST_ASSERT_FALSE(pipeline->hasResult());
+    TEST_ASSERT_TRUE(pipeline->readNow());
+    meshtastic_Telemetry m = meshtastic_Telemetry_init_zero;
+    TEST_ASSERT_TRUE(pipeline->getResult(&m));
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 20, m.variant.environment_metrics.temperature);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 60, m.variant.environment_metrics.relative_humidity);
+}
+
+void test_failed_sensor(void)
+{
+    MockSensor bad(20, 40);
+    MockSensor good(30, 60);
+    bad.fail = true;
+    pipeline->add(&bad);
+    pipeline->add(&good);
+
+    runRound();
+    meshtastic_Telemetry m = meshtastic_Telemetry_init_zero;
+    TEST_ASSERT_TRUE(pipeline->hasResult());
+    TEST_ASSERT_FALSE(pipeline->getResult(&m));
+    // The conversion of the sensor after the failed one is still collected
+    TEST_ASSERT_EQUAL(4, bus.transactions);
+}
+
+void test_period(void)
+{
+    MockSensor sensor(20, 40);
+    pipeline->add(&sensor);
+    runRound();
+    uint32_t transactions = bus.transactions;
+    uint32_t resultMs = pipeline->getResultMs();
+
+    // The cached result is served until the period is up
+    uint32_t now = millis();
+    uint32_t wait = pipeline->step(now, PERIOD_MS);
+    TEST_ASSERT_FALSE(pipeline->isBusy());
+    TEST_ASSERT_GREATER_THAN(PERIOD_MS - 1000, wait);
+    TEST_ASSERT_EQUAL(transactions, bus.transactions);
+
+    pipeline->step(now + PERIOD_MS, PERIOD_MS);
+    TEST_ASSERT_TRUE(pipeline->isBusy());
+    TEST_ASSERT_EQUAL(resultMs, pipeline->getResultMs());
+}
+
+void setup()
+{
+    // NOTE!!! Wait for >2 secs
+    // if board doesn't support software reset via Serial.DTR/RTS
+    delay(10);
+    delay(2000);
+
+    initializeTestEnvironment();
+    UNITY_BEGIN(); // IMPORTANT LINE!
+    RUN_TEST(test_loop_stall);
+    RUN_TEST(test_merge_order);
+    RUN_TEST(test_failed_sensor);
+    RUN_TEST(test_period);
+    exit(UNITY_END()); // stop unit testing
+}
+
+void loop() {}
@@ -0,0 +1,250 @@
+#include "TestUtil.h"
+#include "mesh-pb-constants.h"
+#include "mesh/NodeDB.h"
+#include "mesh/NodeSpatialIndex.h"
+#include <algorithm>
+#include <memory>
+#include <unity.h>
+#include <vector>
+
+static NodeSpatialIndex *spatialIndex;
+
+// Deterministic pseudo random positions, so that failures are reproducible
+static uint32_t lcg = 12345;
+static int32_t randomIn(int32_t low, int32_t high)
+{
+    lcg = lcg * 1103515245 + 12345;
+    return low + (int32_t)((lcg >> 8) % (uint32_t)(high - low));
+}
+
+struct TestNode {
+    NodeNum num;
+    int32_t lat, lon;
+};
+
+// Nodes scattered over a region of about 200x200 km around the origin
+static std::vector<TestNode> makeNodes(size_t count, int32_t lat, int32_t lon)
+{
+    std::vector<TestNode> nodes;
+    for (size_t i = 0; i < count; i++)
+        nodes.push_back({(NodeNum)(i + 1), lat + randomIn(-9000000, 9000000), lon + randomIn(-12000000, 12000000)});
+    return nodes;
+}
+
+void setUp(void)
+{
+    spatialIndex = new NodeSpatialIndex();
+}
+
+void tearDown(void)
+{
+    delete spatialIndex;
+}
+
+void test_range_matches_linear_scan(void)
+{
+    const int32_t lat = 473000000, lon = 85000000;
+    std::vector<TestNode> nodes = makeNodes(MAX_NUM_NODES, lat, lon);
+    for (const auto &n : nodes)
+        spatialIndex->update(n.num, n.lat, n.lon);
+    TEST_ASSERT_EQUAL(nodes.size(), spatialIndex->size());
+
+    const float radii[] = {1000, 25000, 80000, 500000};
+    for (float radius : radii) {
+        std::vector<NodeSpatialIndex::Hit> hits;
+        spatialIndex->queryRange(lat, lon, radius, hits);
+        size_t expected = 0;
+        for (const auto &n : nodes) {
+            if (NodeSpatialIndex::distanceMeters(lat, lon, n.lat, n.lon) <= radius)
+                expected++;
+        }
+        TEST_ASSERT_EQUAL(expected, hits.size());
+    }
+}
+
+void test_nearest_matches_linear_scan(void)
+{
+    const int32_t lat = -338000000, lon = 1512000000;
+    std::vector<TestNode> nodes = makeNodes(MAX_NUM_NODES, lat, lon);
+    for (const auto &n : nodes)
+        spatialIndex->update(n.num, n.lat, n.lon);
+
+    std::vector<float> distances;
+    for (const auto &n : nodes)
+        distances.push_back(NodeSpatialIndex::distanceMeters(lat, lon, n.lat, n.lon));
+    std::sort(distances.begin(), distances.end());
+
+    std::vector<NodeSpatialIndex::Hit> hits;
+    spatialIndex->queryNearest(lat, lon, 5, hits);
+    TEST_ASSERT_EQUAL(5, hits.size());
+    for (size_t i = 0; i < hits.size(); i++)
+        TEST_ASSERT_EQUAL_FLOAT(distances[i], hits[i].distanceMeters);
+
+    // Asking for more than we have returns everything
+    spatialIndex->queryNearest(lat, lon, nodes.size() + 10, hits);
+    TEST_ASSERT_EQUAL(nodes.size(), hits.size());
+}
+
+void test_antimeridian(void)
+{
+    // 1.1 km apart, on either side of 180 degrees
+    spatialIndex->update(1, 0, 1799995000);
+    spatialIndex->update(2, 0, -1799995000);
+    spatialIndex->update(3, 0, 1790000000);
+
+    std::vector<NodeSpatialIndex::Hit> hits;
+    spatialIndex->queryRange(0, 1799995000, 5000, hits);
+    TEST_ASSERT_EQUAL(2, hits.size());
+
+    spatialIndex->queryNearest(0, -1799995000, 2, hits);
+    TEST_ASSERT_EQUAL(2, hits.size());
+    TEST_ASSERT_EQUAL(2, hits[0].num);
+    TEST_ASSERT_EQUAL(1, hits[1].num);
+}
+
+void test_move_and_remove(void)
+{
+    spatialIndex->update(1, 100000000, 100000000);
+    spatialIndex->update(1, 100000100, 100000000); // Same cell
+    spatialIndex->update(1, 200000000, 100000000); // Another cell
+    TEST_ASSERT_EQUAL(1, spatialIndex->size());
+
+    std::vector<NodeSpatialIndex::Hit> hits;
+    spatialIndex->queryRange(100000000, 100000000, 10000, hits);
+    TEST_ASSERT_EQUAL(0, hits.size());
+    spatialIndex->queryRange(200000000, 100000000, 10000, hits);
+    TEST_ASSERT_EQUAL(1, hits.size());
+
+    spatialIndex->remove(1);
+    spatialIndex->remove(1);
+    TEST_ASSERT_EQUAL(0, spatialIndex->size());
+}
+
+void test_origin_cache(void)
+{
+    float distance, bearing;
+    spatialIndex->update(1, 10000000, 0); // 1 degree north of the origin
+    TEST_ASSERT_FALSE(spatialIndex->distanceFromOrigin(1, distance));
+
+    spatialIndex->setOrigin(0, 0);
+    TEST_ASSERT_TRUE(spatialIndex->distanceFromOrigin(1, distance, &bearing));
+    TEST_ASSERT_FLOAT_WITHIN(100, 111195, distance);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0, bearing);
+
+    // Either end moving invalidates the cached values
+    spatialIndex->update(1, 0, 10000000);
+    TEST_ASSERT_TRUE(spatialIndex->distanceFromOrigin(1, distance, &bearing));
+    TEST_ASSERT_FLOAT_WITHIN(0.001, PI / 2, bearing);
+    spatialIndex->setOrigin(0, 20000000);
+    TEST_ASSERT_TRUE(spatialIndex->distanceFromOrigin(1, distance, &bearing));
+    TEST_ASSERT_FLOAT_WITHIN(100, 111195, distance);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, -PI / 2, bearing);
+}
+
+static void placeNode(NodeNum num, int32_t lat, int32_t lon)
+{
+    meshtastic_Position p = meshtastic_Position_init_default;
+    p.latitude_i = lat;
+    p.longitude_i = lon;
+    nodeDB->updatePosition(num, p);
+}
+
+/// Queries from our own position leave us out, and replace what the caller's vector held
+void test_nodedb_queries_skip_us(void)
+{
+    const std::unique_ptr<NodeDB> db(new NodeDB());
+    nodeDB = db.get();
+    nodeDB->resetNodes();
+    NodeNum us = nodeDB->getNodeNum();
+    placeNode(us, 473000000, 85000000);
+    placeNode(us + 1, 473010000, 85000000); // About 111 m north
+    placeNode(us + 2, 473100000, 85000000); // About 1.1 km north
+
+    std::vector<NodeSpatialIndex::Hit> hits = {{us + 3, 0}};
+    nodeDB->getNodesWithin(500, hits);
+    TEST_ASSERT_EQUAL(1, hits.size());
+    TEST_ASSERT_EQUAL(us + 1, hits[0].num);
+
+    nodeDB->getNodesWithin(5000, hits);
+    TEST_ASSERT_EQUAL(2, hits.size());
+
+    nodeDB->getNearestNodes(1, hits);
+    TEST_ASSERT_EQUAL(1, hits.size());
+    TEST_ASSERT_EQUAL(us + 1, hits[0].num);
+    TEST_ASSERT_FLOAT_WITHIN(5, 111, hits[0].distanceMeters);
+
+    float distance;
+    TEST_ASSERT_FALSE(nodeDB->getDistanceTo(nodeDB->getMeshNode(us), distance));
+    TEST_ASSERT_TRUE(nodeDB->getDistanceTo(nodeDB->getMeshNode(us + 2), distance));
+    nodeDB = nullptr;
+}
+
+// Not a pass/fail test: compares the index against a linear haversine scan with a full NodeDB
+void test_benchmark(void)
+{
+    const int32_t lat = 473000000, lon = 85000000;
+    std::vector<TestNode> nodes = makeNodes(MAX_NUM_NODES, lat, lon);
+    for (const auto &n : nodes)
+        spatialIndex->update(n.num, n.lat, n.lon);
+    spatialIndex->setOrigin(lat, lon);
+
+    const int rounds = 1000;
+    std::vector<NodeSpatialIndex::Hit> hits;
+    size_t found = 0;
+
+    uint32_t start = micros();
+    for (int i = 0; i < rounds; i++) {
+        for (const auto &n : nodes) {
+            if (NodeSpatialIndex::distanceMeters(lat, lon, n.lat, n.lon) <= 20000)
+                found++;
+        }
+    }
+    uint32_t linear = micros() - start;
+
+    start = micros();
+    for (int i = 0; i < rounds; i++) {
+        hits.clear();
+        spatialIndex->queryRange(lat, lon, 20000, hits);
+        found -= hits.size();
+    }
+    uint32_t range = micros() - start;
+
+    start = micros();
+    for (int i = 0; i < rounds; i++)
+        spatialIndex->queryNearest(lat, lon, 10, hits);
+    uint32_t nearest = micros() - start;
+
+    start = micros();
+    float distance;
+    for (int i = 0; i < rounds; i++) {
+        for (const auto &n : nodes)
+            spatialIndex->distanceFromOrigin(n.num, distance);
+    }
+    uint32_t cached = micros() - start;
+
+    printf("%u nodes: linear scan %.2f us, range query %.2f us, 10 nearest %.2f us, all distances (cached) %.2f us\n",
+           (unsigned)nodes.size(), (float)linear / rounds, (float)range / rounds, (float)nearest / rounds,
+           (float)cached / rounds);
+    TEST_ASSERT_EQUAL(0, found);
+}
+
+void setup()
+{
+    // NOTE!!! Wait for >2 secs
+    // if board doesn't support software reset via Serial.DTR/RTS
+    delay(10);
+    delay(2000);
+
+    initializeTestEnvironment();
+    UNITY_BEGIN(); // IMPORTANT LINE!
+    RUN_TEST(test_range_matches_linear_scan);
+    RUN_TEST(test_nearest_matches_linear_scan);
+    RUN_TEST(test_antimeridian);
+    RUN_TEST(test_move_and_remove);
+    RUN_TEST(test_origin_cache);
+    RUN_TEST(test_nodedb_queries_skip_us);
+    RUN_TEST(test_benchmark);
+    exit(UNITY_END()); // stop unit testing
+}
+
+void loop() {}
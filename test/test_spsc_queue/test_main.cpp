@@ -0,0 +1,136 @@
+#include "TestUtil.h"
+#include "mesh/SPSCQueue.h"
+#include <atomic>
+#include <stdio.h>
+#include <thread>
+#include <unity.h>
+#include <vector>
+
+static const uint32_t PACKETS = 100000;
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_fifo_and_overflow(void)
+{
+    SPSCQueue<uint32_t, 4> q;
+    uint32_t v;
+    TEST_ASSERT_TRUE(q.isEmpty());
+    TEST_ASSERT_FALSE(q.dequeue(&v));
+    for (uint32_t i = 1; i <= 4; i++)
+        TEST_ASSERT_TRUE(q.enqueue(i));
+    TEST_ASSERT_FALSE(q.enqueue(5));
+    TEST_ASSERT_EQUAL(1, q.getOverflows());
+    TEST_ASSERT_EQUAL(0, q.numFree());
+    TEST_ASSERT_EQUAL(4, q.getHighWater());
+    for (uint32_t i = 1; i <= 4; i++) {
+        TEST_ASSERT_TRUE(q.dequeue(&v));
+        TEST_ASSERT_EQUAL(i, v);
+    }
+    TEST_ASSERT_FALSE(q.dequeue(&v));
+}
+
+void test_indexes_wrap(void)
+{
+    SPSCQueue<uint32_t, 2> q;
+    uint32_t v;
+    for (uint32_t i = 0; i < 1000; i++) {
+        TEST_ASSERT_TRUE(q.enqueue(i));
+        TEST_ASSERT_TRUE(q.dequeue(&v));
+        TEST_ASSERT_EQUAL(i, v);
+    }
+    TEST_ASSERT_EQUAL(1, q.getHighWater());
+}
+
+/// A radio thread delivering bursts as fast as it can while the router thread drains: every packet the queue accepted must
+/// come out once and in order, and every one it refused must be counted
+void test_burst_stress(void)
+{
+    SPSCQueue<uint32_t, 16> q;
+    std::vector<uint32_t> received;
+    received.reserve(PACKETS);
+    uint32_t accepted = 0;
+    std::atomic<bool> done{false};
+
+    std::thread radio([&]() {
+        for (uint32_t i = 1; i <= PACKETS; i++) {
+            if (q.enqueue(i))
+                accepted++;
+            if (i % 64 == 0)
+                std::this_thread::yield(); // Gap between bursts
+        }
+        done = true;
+    });
+    std::thread router([&]() {
+        uint32_t v;
+        for (;;) {
+            bool finished = done; // Read before the queue, so nothing enqueued before done is missed
+            if (q.dequeue(&v))
+                received.push_back(v);
+            else if (finished)
+                break;
+            else
+                std::this_thread::yield();
+        }
+    });
+    radio.join();
+    router.join();
+
+    TEST_ASSERT_EQUAL(accepted, received.size());
+    TEST_ASSERT_EQUAL(PACKETS, accepted + q.getOverflows());
+    for (size_t i = 1; i < received.size(); i++) {
+        if (received[i] <= received[i - 1])
+            TEST_FAIL_MESSAGE("Packet lost order or duplicated");
+    }
+    printf("%u packets in bursts of 64: %u delivered, %u dropped, at most %u waiting\n", PACKETS, accepted, q.getOverflows(),
+           q.getHighWater());
+}
+
+/// With a producer that waits for room nothing is dropped at all
+void test_lossless_with_backpressure(void)
+{
+    SPSCQueue<uint32_t, 8> q;
+    uint64_t sum = 0;
+    uint32_t count = 0, last = 0;
+    bool ordered = true;
+
+    std::thread producer([&]() {
+        for (uint32_t i = 1; i <= PACKETS; i++) {
+            while (!q.enqueue(i))
+                std::this_thread::yield();
+        }
+    });
+    while (count < PACKETS) {
+        uint32_t v;
+        if (!q.dequeue(&v))
+            continue;
+        ordered = ordered && v == last + 1;
+        last = v;
+        sum += v;
+        count++;
+    }
+    producer.join();
+
+    TEST_ASSERT_TRUE(ordered);
+    TEST_ASSERT_TRUE(sum == (uint64_t)PACKETS * (PACKETS + 1) / 2);
+    TEST_ASSERT_TRUE(q.isEmpty());
+}
+
+void setup()
+{
+    // NOTE!!! Wait for >2 secs
+    // if board doesn't support software reset via Serial.DTR/RTS
+    delay(10);
+    delay(2000);
+
+    initializeTestEnvironment();
+    UNITY_BEGIN(); // IMPORTANT LINE!
+    RUN_TEST(test_fifo_and_overflow);
+    RUN_TEST(test_indexes_wrap);
+    RUN_TEST(test_burst_stress);
+    RUN_TEST(test_lossless_with_backpressure);
+    exit(UNITY_END()); // stop unit testing
+}
+
+void loop() {}
@@ -0,0 +1,151 @@
+#include "TestUtil.h"
+#include "modules/StoreForwardHistory.h"
+#include <unity.h>
+
+static const uint32_t RECORDS = 8;
+static const NodeNum client = 0x1234;
+static const NodeNum other = 0x5678;
+static const NodeNum sender = 0x9abc;
+
+static PacketHistoryStruct ring[RECORDS];
+static StoreForwardHistory history;
+
+static uint32_t add(NodeNum to, NodeNum from = sender, uint32_t time = 1000)
+{
+    PacketHistoryStruct rec = {};
+    rec.to = to;
+    rec.from = from;
+    rec.time = time;
+    return history.add(rec);
+}
+
+void setUp(void)
+{
+    memset(ring, 0, sizeof(ring));
+    history.attach(ring, RECORDS);
+}
+
+void tearDown(void) {}
+
+void test_empty(void)
+{
+    uint32_t count = 1;
+    TEST_ASSERT_EQUAL(0, history.size());
+    TEST_ASSERT_EQUAL(0, history.next(client, 0, 0, &count));
+    TEST_ASSERT_EQUAL(0, count);
+    TEST_ASSERT_NULL(history.get(0));
+    TEST_ASSERT_NULL(history.get(1));
+
+    StoreForwardHistory none;
+    TEST_ASSERT_EQUAL(0, none.add(PacketHistoryStruct{}));
+}
+
+/// A client gets broadcasts and what was sent to it, in order, but neither what others were sent nor what it sent itself
+void test_cursor_merges_broadcast_and_direct(void)
+{
+    TEST_ASSERT_EQUAL(1, add(NODENUM_BROADCAST));
+    TEST_ASSERT_EQUAL(2, add(other));
+    TEST_ASSERT_EQUAL(3, add(client));
+    TEST_ASSERT_EQUAL(4, add(NODENUM_BROADCAST, client));
+    TEST_ASSERT_EQUAL(5, add(NODENUM_BROADCAST));
+    TEST_ASSERT_EQUAL(6, add(client));
+
+    uint32_t count;
+    TEST_ASSERT_EQUAL(1, history.next(client, 0, 0, &count));
+    TEST_ASSERT_EQUAL(4, count);
+
+    uint32_t cursor = 0;
+    uint32_t expected[] = {1, 3, 5, 6};
+    for (uint32_t seq : expected) {
+        cursor = history.next(client, cursor, 0);
+        TEST_ASSERT_EQUAL(seq, cursor);
+    }
+    TEST_ASSERT_EQUAL(0, history.next(client, cursor, 0));
+
+    // Another node is owed what was sent to it and every broadcast
+    TEST_ASSERT_EQUAL(2, history.next(other, 1, 0));
+    TEST_ASSERT_EQUAL(4, history.next(other, 2, 0));
+    TEST_ASSERT_EQUAL(0, history.next(other, 5, 0));
+}
+
+void test_time_window(void)
+{
+    add(NODENUM_BROADCAST, sender, 100);
+    add(client, sender, 200);
+    add(NODENUM_BROADCAST, sender, 300);
+
+    uint32_t count;
+    TEST_ASSERT_EQUAL(2, history.next(client, 0, 150, &count));
+    TEST_ASSERT_EQUAL(2, count);
+    TEST_ASSERT_EQUAL(0, history.next(client, 0, 300));
+}
+
+/// Once full the oldest records are overwritten, and a cursor that fell behind skips what was lost
+void test_ring_wraps(void)
+{
+    for (uint32_t i = 0; i < RECORDS + 3; i++)
+        add(i % 2 ? client : NODENUM_BROADCAST);
+
+    TEST_ASSERT_EQUAL(RECORDS, history.size());
+    TEST_ASSERT_EQUAL(RECORDS + 3, history.getTotalCount());
+    TEST_ASSERT_EQUAL(4, history.oldestSeq());
+    TEST_ASSERT_NULL(history.get(3));
+    TEST_ASSERT_NOT_NULL(history.get(4));
+    TEST_ASSERT_EQUAL(4, history.get(4)->seq);
+    TEST_ASSERT_NULL(history.get(RECORDS + 4));
+
+    uint32_t count;
+    TEST_ASSERT_EQUAL(4, history.next(client, 2, 0, &count));
+    TEST_ASSERT_EQUAL(RECORDS, count);
+    TEST_ASSERT_EQUAL(RECORDS + 3, history.next(client, RECORDS + 2, 0));
+
+    // An overwritten direct record leaves the index along with the ring
+    setUp();
+    add(other);
+    for (uint32_t i = 0; i < RECORDS; i++)
+        add(NODENUM_BROADCAST);
+    TEST_ASSERT_NULL(history.get(1));
+    TEST_ASSERT_EQUAL(2, history.next(other, 0, 0, &count));
+    TEST_ASSERT_EQUAL(RECORDS, count);
+}
+
+/// A ring restored from a file is re-indexed and continues counting where it left off
+void test_attach_restores(void)
+{
+    for (uint32_t i = 0; i < RECORDS + 2; i++)
+        add(i == RECORDS ? client : NODENUM_BROADCAST);
+
+    StoreForwardHistory restored;
+    restored.attach(ring, RECORDS, history.getTotalCount());
+    TEST_ASSERT_EQUAL(RECORDS, restored.size());
+    TEST_ASSERT_EQUAL(RECORDS + 1, restored.next(client, RECORDS, 0));
+
+    uint32_t count;
+    TEST_ASSERT_EQUAL(3, restored.next(client, 0, 0, &count));
+    TEST_ASSERT_EQUAL(RECORDS, count);
+
+    PacketHistoryStruct rec = {};
+    rec.to = client;
+    rec.time = 1000;
+    TEST_ASSERT_EQUAL(RECORDS + 3, restored.add(rec));
+    TEST_ASSERT_EQUAL(RECORDS + 3, restored.next(client, RECORDS + 2, 0));
+}
+
+void setup()
+{
+    // NOTE!!! Wait for >2 secs
+    // if board doesn't support software reset via Serial.DTR/RTS
+    delay(10);
+    delay(2000);
+
+    initializeTestEnvironment();
+    UNITY_BEGIN(); // IMPORTANT LINE!
+    RUN_TEST(test_empty);
+    RUN_TEST(test_cursor_merges_broadcast_and_direct);
+    RUN_TEST(test_time_window);
+    RUN_TEST(test_ring_wraps);
+    RUN_TEST(test_attach_restores);
+    exit(UNITY_END()); // stop unit testing
+}
+
+void loop() {}
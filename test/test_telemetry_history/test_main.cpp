@@ -0,0 +1,156 @@
+#include "TestUtil.h"
+#include "modules/Telemetry/TelemetryHistory.h"
+#include <math.h>
+#include <unity.h>
+
+static const NodeNum node = 0x1234;
+static const uint32_t start = 1700000000;
+
+void setUp(void)
+{
+    telemetryHistory.clear();
+}
+
+void tearDown(void)
+{
+    // clean stuff up here
+}
+
+void test_stats(void)
+{
+    for (int i = 0; i < 10; i++)
+        telemetryHistory.append(node, TELEMETRY_METRIC_TEMPERATURE, start + i * 60, 20.0f + i * 0.5f);
+
+    TelemetryStats stats;
+    TEST_ASSERT_TRUE(telemetryHistory.getStats(node, TELEMETRY_METRIC_TEMPERATURE, 0, stats));
+    TEST_ASSERT_EQUAL(10, stats.count);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 20.0, stats.min);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 24.5, stats.max);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 22.25, stats.avg);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 24.5, stats.last);
+    TEST_ASSERT_EQUAL(start, stats.firstTime);
+    TEST_ASSERT_EQUAL(start + 9 * 60, stats.lastTime);
+
+    // Only the last 5 minutes
+    TEST_ASSERT_TRUE(telemetryHistory.getStats(node, TELEMETRY_METRIC_TEMPERATURE, start + 5 * 60, stats));
+    TEST_ASSERT_EQUAL(5, stats.count);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 22.5, stats.min);
+
+    TEST_ASSERT_FALSE(telemetryHistory.getStats(node, TELEMETRY_METRIC_RELATIVE_HUMIDITY, 0, stats));
+    TEST_ASSERT_FALSE(telemetryHistory.getStats(node + 1, TELEMETRY_METRIC_TEMPERATURE, 0, stats));
+}
+
+void test_ring_wraps(void)
+{
+    const int total = TELEMETRY_HISTORY_SAMPLES * 3 + 5;
+    for (int i = 0; i < total; i++)
+        telemetryHistory.append(node, TELEMETRY_METRIC_IAQ, start + i * 30 + (i % 7), i);
+
+    TelemetryStats stats;
+    TEST_ASSERT_TRUE(telemetryHistory.getStats(node, TELEMETRY_METRIC_IAQ, 0, stats));
+    TEST_ASSERT_EQUAL(TELEMETRY_HISTORY_SAMPLES, stats.count);
+    int first = total - TELEMETRY_HISTORY_SAMPLES;
+    TEST_ASSERT_EQUAL(start + first * 30 + (first % 7), stats.firstTime);
+    TEST_ASSERT_EQUAL(start + (total - 1) * 30 + ((total - 1) % 7), stats.lastTime);
+    TEST_ASSERT_FLOAT_WITHIN(0.5, first, stats.min);
+    TEST_ASSERT_FLOAT_WITHIN(0.5, total - 1, stats.max);
+}
+
+void test_quantisation_and_gaps(void)
+{
+    // Values are stored with the resolution of their metric and clamped to its range
+    telemetryHistory.append(node, TELEMETRY_METRIC_DEVICE_VOLTAGE, start, 4.1234f);
+    telemetryHistory.append(node, TELEMETRY_METRIC_DEVICE_VOLTAGE, start + 60, 1000.0f);
+    TelemetryStats stats;
+    TEST_ASSERT_TRUE(telemetryHistory.getStats(node, TELEMETRY_METRIC_DEVICE_VOLTAGE, 0, stats));
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 4.123, stats.min);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, INT16_MAX * 0.001, stats.max);
+
+    // A gap longer than a delta can hold, or the clock going backwards, restarts the series
+    telemetryHistory.append(node, TELEMETRY_METRIC_DEVICE_VOLTAGE, start + 100000, 3.7f);
+    TEST_ASSERT_TRUE(telemetryHistory.getStats(node, TELEMETRY_METRIC_DEVICE_VOLTAGE, 0, stats));
+    TEST_ASSERT_EQUAL(1, stats.count);
+    telemetryHistory.append(node, TELEMETRY_METRIC_DEVICE_VOLTAGE, start, 3.8f);
+    TEST_ASSERT_TRUE(telemetryHistory.getStats(node, TELEMETRY_METRIC_DEVICE_VOLTAGE, 0, stats));
+    TEST_ASSERT_EQUAL(1, stats.count);
+    TEST_ASSERT_EQUAL(start, stats.firstTime);
+}
+
+void test_series_recycled(void)
+{
+    // Fill every series, then one more node pushes out the least recently updated one
+    for (int i = 0; i < TELEMETRY_HISTORY_SERIES; i++)
+        telemetryHistory.append(node + i, TELEMETRY_METRIC_CO2, start + i, 400 + i);
+    telemetryHistory.append(node + TELEMETRY_HISTORY_SERIES, TELEMETRY_METRIC_CO2, start + 100, 800);
+
+    TelemetryStats stats;
+    TEST_ASSERT_FALSE(telemetryHistory.getStats(node, TELEMETRY_METRIC_CO2, 0, stats));
+    TEST_ASSERT_TRUE(telemetryHistory.getStats(node + 1, TELEMETRY_METRIC_CO2, 0, stats));
+    TEST_ASSERT_TRUE(telemetryHistory.getStats(node + TELEMETRY_HISTORY_SERIES, TELEMETRY_METRIC_CO2, 0, stats));
+}
+
+void test_telemetry_and_sparkline(void)
+{
+    meshtastic_Telemetry t = meshtastic_Telemetry_init_zero;
+    t.which_variant = meshtastic_Telemetry_environment_metrics_tag;
+    t.variant.environment_metrics.has_temperature = true;
+    t.variant.environment_metrics.has_relative_humidity = true;
+    for (int i = 0; i < 8; i++) {
+        t.variant.environment_metrics.temperature = i < 4 ? 10 : 20;
+        t.variant.environment_metrics.relative_humidity = 50;
+        telemetryHistory.append(node, t, start + i * 900);
+    }
+
+    TelemetryStats stats;
+    TEST_ASSERT_TRUE(telemetryHistory.getStats(node, TELEMETRY_METRIC_RELATIVE_HUMIDITY, 0, stats));
+    TEST_ASSERT_EQUAL(8, stats.count);
+    TEST_ASSERT_FALSE(telemetryHistory.getStats(node, TELEMETRY_METRIC_BAROMETRIC_PRESSURE, 0, stats));
+
+    // Two hours in four buckets, plus an empty one at the end
+    float spark[5];
+    uint32_t used = telemetryHistory.getSparkline(node, TELEMETRY_METRIC_TEMPERATURE, start, start + 5 * 1800 - 1, spark, 5);
+    TEST_ASSERT_EQUAL(8, used);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 10, spark[0]);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 10, spark[1]);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 20, spark[2]);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 20, spark[3]);
+    TEST_ASSERT_TRUE(isnan(spark[4]));
+}
+
+/// What /json/telemetry serves: one object per series, with null for the slots of the day without samples
+void test_json(void)
+{
+    TEST_ASSERT_EQUAL_STRING("[]", telemetryHistory.toJson(start).c_str());
+
+    uint32_t now = start + TELEMETRY_HISTORY_JSON_SECS;
+    telemetryHistory.append(node, TELEMETRY_METRIC_TEMPERATURE, now - 60, 21.5f);
+    telemetryHistory.append(node, TELEMETRY_METRIC_TEMPERATURE, now - 30, 22.5f);
+    telemetryHistory.append(node, TELEMETRY_METRIC_RELATIVE_HUMIDITY, start - 60, 50.0f); // Older than a day
+
+    std::string json = telemetryHistory.toJson(now);
+    TEST_ASSERT_EQUAL_STRING("[{\"node\":4660,\"metric\":\"temperature\",\"count\":2,\"min\":21.5,\"max\":22.5,\"avg\":22,"
+                             "\"last\":22.5,\"last_time\":1700086370,\"sparkline\":[null,null,null,null,null,null,null,null,"
+                             "null,null,null,null,null,null,null,null,null,null,null,null,null,null,null,22]}]",
+                             json.c_str());
+    TEST_ASSERT_EQUAL_STRING("relative_humidity", TelemetryHistory::metricName(TELEMETRY_METRIC_RELATIVE_HUMIDITY));
+}
+
+void setup()
+{
+    // NOTE!!! Wait for >2 secs
+    // if board doesn't support software reset via Serial.DTR/RTS
+    delay(10);
+    delay(2000);
+
+    initializeTestEnvironment();
+    UNITY_BEGIN(); // IMPORTANT LINE!
+    RUN_TEST(test_stats);
+    RUN_TEST(test_ring_wraps);
+    RUN_TEST(test_quantisation_and_gaps);
+    RUN_TEST(test_series_recycled);
+    RUN_TEST(test_telemetry_and_sparkline);
+    RUN_TEST(test_json);
+    exit(UNITY_END()); // stop unit testing
+}
+
+void loop() {}
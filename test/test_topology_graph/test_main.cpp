@@ -0,0 +1,168 @@
+#include "TestUtil.h"
+#include "mesh/TopologyGraph.h"
+#include <stdio.h>
+#include <unity.h>
+
+static const NodeNum US = 0x1000;
+static const int8_t GOOD = 10 * 4; // Quarter dB, as in RouteDiscovery
+static const int8_t POOR = -15 * 4;
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_first_hop_follows_cheapest_path(void)
+{
+    TopologyGraph g;
+    // US hears A and B well, both hear C, but only B hears D
+    g.addEdge(0xA, US, GOOD, TopologyGraph::HEARD, 0);
+    g.addEdge(0xB, US, GOOD, TopologyGraph::HEARD, 0);
+    g.addEdge(0xA, 0xC, GOOD, TopologyGraph::NEIGHBORINFO, 0);
+    g.addEdge(0xB, 0xC, POOR, TopologyGraph::NEIGHBORINFO, 0);
+    g.addEdge(0xB, 0xD, GOOD, TopologyGraph::NEIGHBORINFO, 0);
+
+    TEST_ASSERT_EQUAL(0xA, g.getFirstHop(US, 0xC, 0));
+    TEST_ASSERT_EQUAL(2, g.getHopCount(US, 0xC, 0));
+    TEST_ASSERT_EQUAL(0xB, g.getFirstHop(US, 0xD, 0));
+    TEST_ASSERT_EQUAL(0xA, g.getFirstHop(US, 0xA, 0));
+    TEST_ASSERT_EQUAL(0, g.getFirstHop(US, 0xE, 0));
+
+    // The link to C through A fades, so B becomes the better way
+    g.addEdge(0xA, 0xC, POOR, TopologyGraph::NEIGHBORINFO, 1000);
+    g.addEdge(0xB, 0xC, GOOD, TopologyGraph::NEIGHBORINFO, 1000);
+    TEST_ASSERT_EQUAL(0xB, g.getFirstHop(US, 0xC, 1000));
+}
+
+/// A link that let a packet down is forgotten both ways, so the next path avoids it
+void test_removed_link_reroutes(void)
+{
+    TopologyGraph g;
+    g.addEdge(0xA, US, GOOD, TopologyGraph::HEARD, 0);
+    g.addEdge(US, 0xA, GOOD, TopologyGraph::NEIGHBORINFO, 0);
+    g.addEdge(0xB, US, POOR, TopologyGraph::HEARD, 0);
+    g.addEdge(0xA, 0xC, GOOD, TopologyGraph::NEIGHBORINFO, 0);
+    g.addEdge(0xB, 0xC, GOOD, TopologyGraph::NEIGHBORINFO, 0);
+    TEST_ASSERT_EQUAL(0xA, g.getFirstHop(US, 0xC, 0));
+
+    g.removeLink(US, 0xA);
+    TEST_ASSERT_EQUAL(3, g.getNumEdges());
+    TEST_ASSERT_EQUAL(0xB, g.getFirstHop(US, 0xC, 0));
+    TEST_ASSERT_EQUAL(0, g.findNeighborByRelayByte(US, 0xA, 0));
+
+    g.removeLink(US, 0xD); // Unknown links are ignored
+    TEST_ASSERT_EQUAL(3, g.getNumEdges());
+}
+
+void test_traceroute_adds_links_and_skips_unknown_hops(void)
+{
+    TopologyGraph g;
+    uint32_t route[] = {0xA, NODENUM_BROADCAST, 0xC};
+    int8_t snr[] = {GOOD, TOPOLOGY_SNR_UNKNOWN, GOOD, POOR};
+    g.addRoute(US, route, 3, 0xD, snr, 4, 0);
+
+    // US->A and C->D, nothing across the unknown hop
+    TEST_ASSERT_EQUAL(2, g.getNumEdges());
+    TEST_ASSERT_EQUAL(0xA, g.getFirstHop(US, 0xA, 0));
+    TEST_ASSERT_EQUAL(0, g.getFirstHop(US, 0xD, 0));
+
+    // A route that hasn't reached its destination yet stops at the last hop
+    TopologyGraph partial;
+    partial.addRoute(US, route, 1, 0xD, snr, 1, 0);
+    TEST_ASSERT_EQUAL(1, partial.getNumEdges());
+    TEST_ASSERT_EQUAL(0, partial.getFirstHop(US, 0xD, 0));
+}
+
+void test_relay_byte_resolves_only_unambiguous_neighbors(void)
+{
+    TopologyGraph g;
+    g.addEdge(0x1234AB, US, GOOD, TopologyGraph::HEARD, 0);
+    g.addEdge(0x5678CD, US, GOOD, TopologyGraph::HEARD, 0);
+    g.addEdge(0x9999CD, 0x5678CD, GOOD, TopologyGraph::NEIGHBORINFO, 0); // Not heard by us, doesn't count
+
+    TEST_ASSERT_EQUAL(0x1234AB, g.findNeighborByRelayByte(US, 0xAB, 0));
+    TEST_ASSERT_EQUAL(0x5678CD, g.findNeighborByRelayByte(US, 0xCD, 0));
+
+    g.addEdge(0x4321CD, US, GOOD, TopologyGraph::HEARD, 0);
+    TEST_ASSERT_EQUAL(0, g.findNeighborByRelayByte(US, 0xCD, 0));
+}
+
+void test_old_links_expire(void)
+{
+    TopologyGraph g;
+    g.addEdge(0xA, US, GOOD, TopologyGraph::HEARD, 0);
+    g.addEdge(0xA, 0xB, GOOD, TopologyGraph::NEIGHBORINFO, TOPOLOGY_EDGE_MAX_AGE_MS / 2);
+    TEST_ASSERT_EQUAL(0xA, g.getFirstHop(US, 0xB, TOPOLOGY_EDGE_MAX_AGE_MS / 2));
+
+    // Hearing US->A again doesn't save A->B once that is too old
+    g.addEdge(0xA, US, GOOD, TopologyGraph::HEARD, TOPOLOGY_EDGE_MAX_AGE_MS);
+    TEST_ASSERT_EQUAL(0xA, g.getFirstHop(US, 0xB, TOPOLOGY_EDGE_MAX_AGE_MS));
+    TEST_ASSERT_EQUAL(0, g.getFirstHop(US, 0xB, TOPOLOGY_EDGE_MAX_AGE_MS * 3 / 2));
+    TEST_ASSERT_EQUAL(1, g.getNumEdges());
+}
+
+void test_full_graph_replaces_least_recently_heard(void)
+{
+    TopologyGraph g;
+    for (uint32_t i = 0; i < TOPOLOGY_MAX_EDGES; i++)
+        g.addEdge(0x100 + i, US, GOOD, TopologyGraph::HEARD, i);
+    g.addEdge(0x100, US, GOOD, TopologyGraph::HEARD, TOPOLOGY_MAX_EDGES); // Refresh the oldest
+    g.addEdge(0xFFFF, US, GOOD, TopologyGraph::HEARD, TOPOLOGY_MAX_EDGES);
+
+    TEST_ASSERT_EQUAL(TOPOLOGY_MAX_EDGES, g.getNumEdges());
+    TEST_ASSERT_EQUAL(0x100, g.getFirstHop(US, 0x100, TOPOLOGY_MAX_EDGES));
+    TEST_ASSERT_EQUAL(0, g.getFirstHop(US, 0x101, TOPOLOGY_MAX_EDGES));
+    TEST_ASSERT_EQUAL(0xFFFF, g.getFirstHop(US, 0xFFFF, TOPOLOGY_MAX_EDGES));
+}
+
+void test_json_lists_edges(void)
+{
+    TopologyGraph g;
+    g.addEdge(1, 2, -22, TopologyGraph::HEARD, 0);
+    g.addEdge(2, 3, TOPOLOGY_SNR_UNKNOWN, TopologyGraph::TRACEROUTE, 0);
+    TEST_ASSERT_EQUAL_STRING("{\"edges\":[{\"from\":1,\"to\":2,\"snr\":-5.50,\"age\":3,\"sources\":1},"
+                             "{\"from\":2,\"to\":3,\"snr\":null,\"age\":3,\"sources\":4}]}",
+                             g.toJson(3500).c_str());
+}
+
+/// Lookups for every node of a full graph should cost one search, not one each
+void test_benchmark_next_hop_lookups(void)
+{
+    TopologyGraph g;
+    uint32_t seed = 1;
+    for (uint32_t i = 0; i < TOPOLOGY_MAX_EDGES; i++) {
+        seed = seed * 1664525 + 1013904223;
+        NodeNum a = 0x100 + (seed >> 8) % (TOPOLOGY_MAX_EDGES / 2), b = 0x100 + (seed >> 20) % (TOPOLOGY_MAX_EDGES / 2);
+        g.addEdge(i < 8 ? 0x100 + i : a, i < 8 ? US : b, (int8_t)((seed >> 4) % 120 - 60), TopologyGraph::NEIGHBORINFO, 0);
+    }
+
+    uint32_t reachable = 0;
+    uint32_t start = micros();
+    for (NodeNum to = 0x100; to < 0x100 + TOPOLOGY_MAX_EDGES / 2; to++)
+        reachable += g.getFirstHop(US, to, 0) != 0;
+    uint32_t elapsed = micros() - start;
+    printf("%u edges, %u of %u nodes reachable, all looked up in %u us\n", (unsigned)g.getNumEdges(), reachable,
+           TOPOLOGY_MAX_EDGES / 2, elapsed);
+    TEST_ASSERT_GREATER_THAN(0, reachable);
+}
+
+void setup()
+{
+    // NOTE!!! Wait for >2 secs
+    // if board doesn't support software reset via Serial.DTR/RTS
+    delay(10);
+    delay(2000);
+
+    initializeTestEnvironment();
+    UNITY_BEGIN(); // IMPORTANT LINE!
+    RUN_TEST(test_first_hop_follows_cheapest_path);
+    RUN_TEST(test_removed_link_reroutes);
+    RUN_TEST(test_traceroute_adds_links_and_skips_unknown_hops);
+    RUN_TEST(test_relay_byte_resolves_only_unambiguous_neighbors);
+    RUN_TEST(test_old_links_expire);
+    RUN_TEST(test_full_graph_replaces_least_recently_heard);
+    RUN_TEST(test_json_lists_edges);
+    RUN_TEST(test_benchmark_next_hop_lookups);
+    exit(UNITY_END()); // stop unit testing
+}
+
+void loop() {}